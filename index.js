@@ -14,6 +14,26 @@ const core = require(addonPath);
 
 let chatClient = null;
 let mainWindow = null;
+
+// --- Scene Autosave ---
+// Only scenes changed since the last save are serialized and journaled.
+const AUTOSAVE_INTERVAL_MS = 5000;
+let savedSceneVersion = 0;
+let autosaveTimer = null;
+let pendingSave = Promise.resolve();
+
+function saveSceneDelta() {
+  // Saves are chained so a slow write never overlaps the next one.
+  pendingSave = pendingSave.then(async () => {
+    // Serialized natively; only the document text crosses into JS.
+    const delta = core.getSceneDelta(savedSceneVersion, { format: 'json' });
+    if (delta.full || delta.changed > 0 || delta.removed > 0) {
+      await db.appendDelta(delta);
+    }
+    savedSceneVersion = delta.version;
+  }).catch(error => console.error('Autosave failed:', error));
+  return pendingSave;
+}
 let botSettings = { enabled: false, commands: [] };
 
 function createWindow() {
@@ -35,14 +55,39 @@ app.whenReady().then(async () => {
   core.startup();
 
   // Load saved state from DB and apply it to OBS Core
-  const savedState = await db.loadState();
+  const savedState = await db.loadStateJson();
   if (savedState) {
-    core.loadFullSceneData(savedState);
-    console.log("Loaded previous scene collection.");
+    // Sources are created on native worker threads; the main process stays responsive.
+    // Only the program and preview scenes are created before the UI shows;
+    // the rest of the collection is created in the background.
+    const stats = await core.loadFullSceneDataAsync(savedState, {
+      lazy: true,
+      onProgress: ({ phase, done, total }) => console.log(`Loading scene collection: ${phase} ${done}/${total}`)
+    });
+    console.log(`Loaded previous scene collection: ${stats.scenes} scenes, ${stats.sources} sources in ${stats.durationMs.toFixed(0)} ms (${stats.pendingScenes} scenes deferred).`);
+    // What was just loaded is already on disk; fold the journal into the snapshot.
+    savedSceneVersion = core.getSceneVersion();
+    await db.compact();
+  }
+  autosaveTimer = setInterval(saveSceneDelta, AUTOSAVE_INTERVAL_MS);
+
+  // Reuse the encoder and preset picked by the last benchmark on this
+  // machine; bitrate and size stay the configured ones.
+  const benchmark = await db.loadEncoderBenchmark();
+  if (benchmark && benchmark.config) {
+    const { encoderId, preset } = benchmark.config;
+    if (core.setEncoderConfig({ ...core.getEncoderConfig(), encoderId, preset })) {
+      console.log(`Using benchmarked encoder config from ${benchmark.savedAt}:`, benchmark.config);
+    } else {
+      console.log(`Benchmarked encoder '${benchmark.config.encoderId}' is no longer available; using defaults.`);
+    }
   }
 
   await initTwitch();
   createWindow();
+  mainWindow.webContents.once('did-finish-load', () => {
+    console.log('Startup timings:', core.getStartupTimings());
+  });
 
   app.on('activate', function () {
     if (BrowserWindow.getAllWindows().length === 0) createWindow();
@@ -57,10 +102,9 @@ app.on('before-quit', async (event) => {
     isQuitting = true;
 
     console.log("Saving application state before quitting...");
-    const state = core.getFullSceneData();
-    if (state) {
-        await db.saveState(state);
-    }
+    clearInterval(autosaveTimer);
+    await saveSceneDelta();
+    await db.compact();
 
     if (chatClient) {
         chatClient.disconnect();
@@ -71,6 +115,51 @@ app.on('before-quit', async (event) => {
 });
 
 
+// Runs the encoder benchmark, applies its recommendation and keeps the
+// result for the next start.
+ipcMain.handle('benchmark-encoders', async (event, options = {}) => {
+  const result = await core.benchmarkEncoders({
+    durationSec: options.durationSec,
+    resolutions: options.resolutions,
+    fps: options.fps,
+    apply: true,
+    onProgress: ({ done, total }) => console.log(`Benchmarking encoders: ${done}/${total}`)
+  });
+  await db.saveEncoderBenchmark(result);
+  return result;
+});
+
+// Outputs run here, on the same core the benchmark configures. Progress
+// callbacks can't cross IPC; the renderer names a channel to send them on.
+function withProgress(event, options = {}) {
+  const { progressChannel, ...rest } = options || {};
+  if (progressChannel) rest.onProgress = (progress) => event.sender.send(progressChannel, progress);
+  return rest;
+}
+
+ipcMain.handle('start-streaming', (event, server, key) => core.startStreaming(server, key));
+ipcMain.handle('stop-streaming', () => core.stopStreaming());
+ipcMain.handle('is-streaming', () => core.isStreaming());
+ipcMain.handle('start-recording', () => core.startRecording());
+ipcMain.handle('stop-recording', () => core.stopRecording());
+ipcMain.handle('is-recording', () => core.isRecording());
+ipcMain.handle('start-streaming-async', (event, server, key, options) => core.startStreamingAsync(server, key, withProgress(event, options)));
+ipcMain.handle('start-recording-async', (event, options) => core.startRecordingAsync(withProgress(event, options)));
+ipcMain.handle('get-encoder-config', () => core.getEncoderConfig());
+ipcMain.handle('set-encoder-config', (event, config) => core.setEncoderConfig(config));
+ipcMain.handle('set-output-config', (event, name, config) => core.setOutputConfig(name, config));
+ipcMain.handle('start-output-async', (event, name, options) => core.startOutputAsync(name, withProgress(event, options)));
+ipcMain.handle('stop-output', (event, name) => core.stopOutput(name));
+ipcMain.handle('is-output-active', (event, name) => core.isOutputActive(name));
+ipcMain.handle('get-outputs', () => core.getOutputs());
+ipcMain.handle('set-output-thread-budget', (event, threads) => core.setOutputThreadBudget(threads));
+ipcMain.handle('start-replay-buffer-async', (event, options) => core.startReplayBufferAsync(withProgress(event, options)));
+ipcMain.handle('stop-replay-buffer', () => core.stopReplayBuffer());
+ipcMain.handle('save-replay', (event, path, seconds, options) => core.saveReplay(path, seconds, withProgress(event, options)));
+ipcMain.handle('get-replay-buffer-stats', () => core.getReplayBufferStats());
+ipcMain.handle('set-adaptive-bitrate', (event, config) => core.setAdaptiveBitrate(config));
+ipcMain.handle('get-adaptive-bitrate', () => core.getAdaptiveBitrate());
+
 ipcMain.handle('select-logo', async (event) => {
     const result = await dialog.showOpenDialog({
         properties: ['openFile'],
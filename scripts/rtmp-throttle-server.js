@@ -0,0 +1,391 @@
+#!/usr/bin/env node
+// Local stand-in for an RTMP ingest that reads at a limited rate, for trying
+// the adaptive bitrate controller without a real uplink. It accepts one or
+// more publishers, answers just enough of the RTMP handshake and commands
+// for libobs' rtmp_output to start streaming, and discards the media. Once
+// the limit is below the stream's bitrate, TCP backpressure fills the
+// sender's buffer and the output reports congestion and drops frames.
+//
+//   node scripts/rtmp-throttle-server.js --kbps 6000 --schedule 30:1500,90:6000
+//
+// then stream to rtmp://127.0.0.1:1935/live (any key) with
+// setAdaptiveBitrate({ enabled: true }) and watch getAdaptiveBitrate().
+//
+//   --port N          Listen port (1935)
+//   --kbps N          Read limit in kbit/s (6000); 0 means unlimited
+//   --schedule T:K,.. Change the limit to K kbit/s T seconds after start
+//
+// Typing a number on stdin sets the limit right away.
+'use strict';
+
+const net = require('net');
+
+function parseArgs(argv) {
+  const args = { port: 1935, kbps: 6000, schedule: [] };
+  for (let i = 0; i < argv.length; i++) {
+    const value = argv[i + 1];
+    switch (argv[i]) {
+      case '--port': args.port = Number(value); i++; break;
+      case '--kbps': args.kbps = Number(value); i++; break;
+      case '--schedule':
+        args.schedule = value.split(',').map((step) => {
+          const [at, kbps] = step.split(':').map(Number);
+          return { at, kbps };
+        });
+        i++;
+        break;
+      case '--help':
+        console.log('Usage: rtmp-throttle-server.js [--port N] [--kbps N] [--schedule T:K,...]');
+        process.exit(0);
+        break;
+      default:
+        console.error(`Unknown argument ${argv[i]}`);
+        process.exit(1);
+    }
+  }
+  if (!(args.port > 0) || !(args.kbps >= 0) || args.schedule.some((s) => !(s.at >= 0) || !(s.kbps >= 0))) {
+    console.error('Invalid --port, --kbps or --schedule');
+    process.exit(1);
+  }
+  return args;
+}
+
+// --- AMF0 ---
+
+function amfEncode(value) {
+  if (value === null) return Buffer.from([0x05]);
+  if (value === undefined) return Buffer.from([0x06]);
+  if (typeof value === 'number') {
+    const buf = Buffer.alloc(9);
+    buf[0] = 0x00;
+    buf.writeDoubleBE(value, 1);
+    return buf;
+  }
+  if (typeof value === 'boolean') return Buffer.from([0x01, value ? 1 : 0]);
+  if (typeof value === 'string') return Buffer.concat([Buffer.from([0x02]), amfKey(value)]);
+  const parts = [Buffer.from([0x03])];
+  for (const [key, item] of Object.entries(value)) parts.push(amfKey(key), amfEncode(item));
+  parts.push(Buffer.from([0, 0, 0x09]));
+  return Buffer.concat(parts);
+}
+
+function amfKey(key) {
+  const bytes = Buffer.from(key, 'utf8');
+  const len = Buffer.alloc(2);
+  len.writeUInt16BE(bytes.length);
+  return Buffer.concat([len, bytes]);
+}
+
+// Returns [value, nextOffset].
+function amfDecode(buf, pos) {
+  const type = buf[pos++];
+  switch (type) {
+    case 0x00: return [buf.readDoubleBE(pos), pos + 8];
+    case 0x01: return [buf[pos] !== 0, pos + 1];
+    case 0x02: {
+      const len = buf.readUInt16BE(pos);
+      return [buf.toString('utf8', pos + 2, pos + 2 + len), pos + 2 + len];
+    }
+    case 0x03:
+    case 0x08: {
+      if (type === 0x08) pos += 4; // ECMA array count
+      const obj = {};
+      for (;;) {
+        const len = buf.readUInt16BE(pos);
+        pos += 2;
+        if (len === 0 && buf[pos] === 0x09) return [obj, pos + 1];
+        const key = buf.toString('utf8', pos, pos + len);
+        let item;
+        [item, pos] = amfDecode(buf, pos + len);
+        obj[key] = item;
+      }
+    }
+    case 0x05: return [null, pos];
+    case 0x06: return [undefined, pos];
+    case 0x0a: {
+      const count = buf.readUInt32BE(pos);
+      pos += 4;
+      const list = [];
+      for (let i = 0; i < count; i++) {
+        let item;
+        [item, pos] = amfDecode(buf, pos);
+        list.push(item);
+      }
+      return [list, pos];
+    }
+    default: throw new Error(`Unsupported AMF0 type 0x${type.toString(16)}`);
+  }
+}
+
+function amfDecodeAll(buf) {
+  const values = [];
+  let pos = 0;
+  while (pos < buf.length) {
+    let value;
+    [value, pos] = amfDecode(buf, pos);
+    values.push(value);
+  }
+  return values;
+}
+
+// --- Throttle ---
+
+// Token bucket shared by all connections, in bytes. Sockets that overdraw
+// it are paused until it has refilled.
+class Throttle {
+  constructor(kbps) {
+    this.setKbps(kbps);
+    this.tokens = 0;
+    this.last = Date.now();
+  }
+
+  setKbps(kbps) {
+    this.kbps = kbps;
+    this.bytesPerMs = (kbps * 1000) / 8 / 1000;
+  }
+
+  // Returns how long to pause after taking `bytes`, in ms.
+  take(bytes) {
+    if (!this.kbps) return 0;
+    const now = Date.now();
+    const burst = this.bytesPerMs * 250;
+    this.tokens = Math.min(burst, this.tokens + (now - this.last) * this.bytesPerMs);
+    this.last = now;
+    this.tokens -= bytes;
+    return this.tokens < 0 ? Math.ceil(-this.tokens / this.bytesPerMs) : 0;
+  }
+}
+
+// --- RTMP session ---
+
+const HANDSHAKE_SIZE = 1536;
+const WINDOW_ACK_SIZE = 2500000;
+
+class Session {
+  constructor(socket, id, throttle, stats) {
+    this.socket = socket;
+    this.id = id;
+    this.throttle = throttle;
+    this.stats = stats;
+    this.buffer = Buffer.alloc(0);
+    this.state = 'c0c1';
+    this.inChunkSize = 128;
+    this.streams = new Map(); // csid -> { fmt0 fields, partial payload }
+    this.received = 0;
+    this.lastAck = 0;
+
+    socket.setNoDelay(true);
+    socket.on('data', (data) => this.onData(data));
+    socket.on('error', (err) => console.log(`[${id}] ${err.message}`));
+    socket.on('close', () => console.log(`[${id}] closed`));
+  }
+
+  onData(data) {
+    this.received += data.length;
+    this.stats.bytes += data.length;
+    const wait = this.throttle.take(data.length);
+    if (wait > 0) {
+      this.socket.pause();
+      setTimeout(() => this.socket.resume(), wait);
+    }
+    if (this.received - this.lastAck >= WINDOW_ACK_SIZE) {
+      this.lastAck = this.received;
+      const ack = Buffer.alloc(4);
+      ack.writeUInt32BE(this.received >>> 0);
+      this.send(2, 3, 0, ack);
+    }
+
+    this.buffer = this.buffer.length ? Buffer.concat([this.buffer, data]) : data;
+    try {
+      this.process();
+    } catch (err) {
+      console.log(`[${this.id}] protocol error: ${err.message}`);
+      this.socket.destroy();
+    }
+  }
+
+  process() {
+    if (this.state === 'c0c1') {
+      if (this.buffer.length < 1 + HANDSHAKE_SIZE) return;
+      const c1 = this.buffer.subarray(1, 1 + HANDSHAKE_SIZE);
+      const s1 = Buffer.alloc(HANDSHAKE_SIZE); // Zero version: plain handshake
+      s1.writeUInt32BE(0, 0);
+      for (let i = 8; i < HANDSHAKE_SIZE; i++) s1[i] = Math.floor(Math.random() * 256);
+      this.socket.write(Buffer.concat([Buffer.from([0x03]), s1, c1]));
+      this.buffer = this.buffer.subarray(1 + HANDSHAKE_SIZE);
+      this.state = 'c2';
+    }
+    if (this.state === 'c2') {
+      if (this.buffer.length < HANDSHAKE_SIZE) return;
+      this.buffer = this.buffer.subarray(HANDSHAKE_SIZE);
+      this.state = 'chunks';
+    }
+    let pos = 0;
+    for (;;) {
+      const next = this.readChunk(pos);
+      if (next < 0) break;
+      pos = next;
+    }
+    this.buffer = this.buffer.subarray(pos);
+  }
+
+  // Parses one chunk at `pos`; returns the offset after it, or -1 if it
+  // has not fully arrived yet.
+  readChunk(pos) {
+    const buf = this.buffer;
+    if (pos >= buf.length) return -1;
+    const fmt = buf[pos] >> 6;
+    let csid = buf[pos] & 0x3f;
+    pos++;
+    if (csid === 0) {
+      if (pos + 1 > buf.length) return -1;
+      csid = 64 + buf[pos];
+      pos += 1;
+    } else if (csid === 1) {
+      if (pos + 2 > buf.length) return -1;
+      csid = 64 + buf[pos] + buf[pos + 1] * 256;
+      pos += 2;
+    }
+
+    const prev = this.streams.get(csid) || { timestamp: 0, length: 0, type: 0, streamId: 0, extended: false };
+    const header = { ...prev };
+    const headerSize = [11, 7, 3, 0][fmt];
+    if (pos + headerSize > buf.length) return -1;
+    let ts = 0;
+    if (fmt <= 2) ts = buf.readUIntBE(pos, 3);
+    if (fmt <= 1) {
+      header.length = buf.readUIntBE(pos + 3, 3);
+      header.type = buf[pos + 6];
+    }
+    if (fmt === 0) header.streamId = buf.readUInt32LE(pos + 7);
+    pos += headerSize;
+    if (fmt <= 2) header.extended = ts === 0xffffff;
+    if (header.extended) {
+      if (pos + 4 > buf.length) return -1;
+      ts = buf.readUInt32BE(pos);
+      pos += 4;
+    }
+    if (fmt === 0) header.timestamp = ts;
+    else if (fmt <= 2) header.timestamp = prev.timestamp + ts;
+
+    const partial = fmt === 3 && prev.partial ? prev.partial : [];
+    const have = partial.reduce((sum, part) => sum + part.length, 0);
+    const size = Math.min(this.inChunkSize, header.length - have);
+    if (pos + size > buf.length) return -1;
+    partial.push(buf.subarray(pos, pos + size));
+    pos += size;
+
+    if (have + size >= header.length) {
+      header.partial = null;
+      this.streams.set(csid, header);
+      this.onMessage(header, Buffer.concat(partial));
+    } else {
+      header.partial = partial;
+      this.streams.set(csid, header);
+    }
+    return pos;
+  }
+
+  onMessage(header, payload) {
+    switch (header.type) {
+      case 1: this.inChunkSize = payload.readUInt32BE(0) & 0x7fffffff; break;
+      case 8: this.stats.audio++; break;
+      case 9: this.stats.video++; break;
+      case 20: this.onCommand(header, amfDecodeAll(payload)); break;
+      default: break; // Acks, window size, metadata
+    }
+  }
+
+  onCommand(header, [name, txn]) {
+    switch (name) {
+      case 'connect':
+        this.sendControl(5, WINDOW_ACK_SIZE);
+        this.sendControl(6, WINDOW_ACK_SIZE, 2);
+        this.sendCommand(0, ['_result', txn, { fmsVer: 'FMS/3,0,1,123', capabilities: 31 },
+          { level: 'status', code: 'NetConnection.Connect.Success', description: 'Connection succeeded.',
+            objectEncoding: 0 }]);
+        break;
+      case 'createStream':
+        this.sendCommand(0, ['_result', txn, null, 1]);
+        break;
+      case 'publish':
+        console.log(`[${this.id}] publishing`);
+        this.sendCommand(header.streamId || 1, ['onStatus', 0, null,
+          { level: 'status', code: 'NetStream.Publish.Start', description: 'Publishing.' }]);
+        break;
+      case 'deleteStream':
+      case 'FCUnpublish':
+        break;
+      default:
+        if (txn) this.sendCommand(0, ['_result', txn, null]);
+        break;
+    }
+  }
+
+  sendControl(type, value, extra) {
+    const payload = Buffer.alloc(extra === undefined ? 4 : 5);
+    payload.writeUInt32BE(value);
+    if (extra !== undefined) payload[4] = extra;
+    this.send(2, type, 0, payload);
+  }
+
+  sendCommand(streamId, values) {
+    this.send(streamId ? 5 : 3, 20, streamId, Buffer.concat(values.map(amfEncode)));
+  }
+
+  // Sends one message in 128-byte chunks (the default we never change).
+  send(csid, type, streamId, payload) {
+    const header = Buffer.alloc(12);
+    header[0] = csid;
+    header.writeUIntBE(0, 1, 3);
+    header.writeUIntBE(payload.length, 4, 3);
+    header[7] = type;
+    header.writeUInt32LE(streamId, 8);
+    const parts = [header];
+    for (let pos = 0; pos < payload.length; pos += 128) {
+      if (pos > 0) parts.push(Buffer.from([0xc0 | csid]));
+      parts.push(payload.subarray(pos, pos + 128));
+    }
+    this.socket.write(Buffer.concat(parts));
+  }
+}
+
+// --- Main ---
+
+const args = parseArgs(process.argv.slice(2));
+const throttle = new Throttle(args.kbps);
+const stats = { bytes: 0, video: 0, audio: 0 };
+const started = Date.now();
+let nextId = 1;
+
+function setLimit(kbps, why) {
+  throttle.setKbps(kbps);
+  console.log(`limit ${kbps ? `${kbps} kbps` : 'off'} (${why})`);
+}
+
+for (const step of args.schedule) {
+  setTimeout(() => setLimit(step.kbps, `schedule at ${step.at}s`), step.at * 1000);
+}
+
+setInterval(() => {
+  if (stats.bytes === 0) return;
+  const seconds = Math.round((Date.now() - started) / 1000);
+  const kbps = Math.round((stats.bytes * 8) / 1000);
+  console.log(`t=${seconds}s in ${kbps} kbps (limit ${throttle.kbps || 'off'}), ` +
+              `${stats.video} video / ${stats.audio} audio messages`);
+  stats.bytes = stats.video = stats.audio = 0;
+}, 1000);
+
+process.stdin.setEncoding('utf8');
+process.stdin.on('data', (line) => {
+  const kbps = Number(line.trim());
+  if (line.trim() && kbps >= 0) setLimit(kbps, 'stdin');
+});
+
+net.createServer((socket) => {
+  const id = nextId++;
+  console.log(`[${id}] connection from ${socket.remoteAddress}`);
+  new Session(socket, id, throttle, stats);
+}).listen(args.port, () => {
+  console.log(`RTMP stand-in on rtmp://127.0.0.1:${args.port}/live, limit ${args.kbps || 'off'} kbps`);
+});
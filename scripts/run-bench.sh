@@ -0,0 +1,33 @@
+#!/bin/sh
+# Builds and runs titan_bench headless, e.g. on a CPU-only CI box: Mesa's
+# llvmpipe renders OpenGL in software and xvfb-run provides the X display
+# libobs-opengl needs. Needs the libobs from `npm install` (deps/libobs),
+# cmake, Mesa and xvfb. No network once SIMDE is on disk: the script reuses
+# the main build's checkout (build/_deps/simde-src, or SIMDE_DIR), and only
+# if there is none does configuring clone it.
+#
+#   scripts/run-bench.sh --resolutions 1080p,4k --seconds 10 --json bench.json
+#
+# Arguments are passed to titan_bench (--help lists them).
+set -e
+
+ROOT=$(cd "$(dirname "$0")/.." && pwd)
+BUILD_DIR=${BUILD_DIR:-"$ROOT/build-bench"}
+SIMDE_DIR=${SIMDE_DIR:-"$ROOT/build/_deps/simde-src"}
+
+if [ -f "$SIMDE_DIR/simde/simde-common.h" ]; then
+  cmake -S "$ROOT" -B "$BUILD_DIR" -DTITAN_BUILD_BENCH=ON -DCMAKE_BUILD_TYPE=Release \
+    -DFETCHCONTENT_SOURCE_DIR_SIMDE="$SIMDE_DIR" >/dev/null
+else
+  cmake -S "$ROOT" -B "$BUILD_DIR" -DTITAN_BUILD_BENCH=ON -DCMAKE_BUILD_TYPE=Release >/dev/null
+fi
+cmake --build "$BUILD_DIR" --target titan_bench -j"$(nproc)"
+
+# libobs loads libobs-opengl by name at obs_reset_video.
+export LD_LIBRARY_PATH="$ROOT/deps/libobs/usr/local/lib/x86_64-linux-gnu${LD_LIBRARY_PATH:+:$LD_LIBRARY_PATH}"
+export LIBGL_ALWAYS_SOFTWARE=1
+
+if [ -n "$DISPLAY" ]; then
+  exec "$BUILD_DIR/titan_bench" "$@"
+fi
+exec xvfb-run -a -s "-screen 0 1280x720x24" "$BUILD_DIR/titan_bench" "$@"
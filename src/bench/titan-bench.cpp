@@ -0,0 +1,599 @@
+// titan_bench: headless benchmark of the frame pipeline.
+//
+// Starts libobs without a window, puts a color-bar test pattern with a
+// moving bar on the program output, and runs the same path the addon runs
+// for every frame: GPU readback through GpuReadback, conversion into a
+// FrameExchange slab with FrameScaler, and Publish. A consumer thread does
+// what getLatestFrame() does under Electron, which can't hand out external
+// buffers: take the newest slab and copy it into a new buffer.
+//
+// Each resolution is reported with frames/sec, bytes moved per frame,
+// p50/p99 latencies and allocations per frame. Runs offline on CPU-only
+// Linux through Mesa's llvmpipe; see scripts/run-bench.sh.
+
+#include <obs.h>
+#include <util/base.h>
+#include <util/platform.h>
+#ifdef __linux__
+#include <obs-nix-platform.h>
+#include <X11/Xlib.h>
+#endif
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdarg>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <string>
+#include <thread>
+#include <vector>
+#include "frame-exchange.h"
+#include "gpu-readback.h"
+#include "pixel-convert.h"
+
+#ifndef TITAN_BENCH_PLUGIN_DIR
+#define TITAN_BENCH_PLUGIN_DIR ""
+#endif
+#ifndef TITAN_BENCH_DATA_DIR
+#define TITAN_BENCH_DATA_DIR ""
+#endif
+
+// --- Allocation Counting ---
+// Every operator new in the process goes through here. Each thread counts
+// its own, so the graphics and consumer sides can be measured separately;
+// libobs allocates with bmalloc and doesn't show up.
+static thread_local uint64_t t_allocations = 0;
+
+static void* counted_alloc(size_t size, size_t alignment) {
+    t_allocations++;
+    if (size == 0) size = 1;
+    void* ptr;
+    if (alignment > alignof(std::max_align_t)) {
+        ptr = std::aligned_alloc(alignment, (size + alignment - 1) / alignment * alignment);
+    } else {
+        ptr = std::malloc(size);
+    }
+    if (!ptr) throw std::bad_alloc();
+    return ptr;
+}
+
+void* operator new(size_t size) { return counted_alloc(size, 0); }
+void* operator new[](size_t size) { return counted_alloc(size, 0); }
+void* operator new(size_t size, std::align_val_t align) { return counted_alloc(size, (size_t)align); }
+void* operator new[](size_t size, std::align_val_t align) { return counted_alloc(size, (size_t)align); }
+void operator delete(void* ptr) noexcept { std::free(ptr); }
+void operator delete[](void* ptr) noexcept { std::free(ptr); }
+void operator delete(void* ptr, size_t) noexcept { std::free(ptr); }
+void operator delete[](void* ptr, size_t) noexcept { std::free(ptr); }
+void operator delete(void* ptr, std::align_val_t) noexcept { std::free(ptr); }
+void operator delete[](void* ptr, std::align_val_t) noexcept { std::free(ptr); }
+void operator delete(void* ptr, size_t, std::align_val_t) noexcept { std::free(ptr); }
+void operator delete[](void* ptr, size_t, std::align_val_t) noexcept { std::free(ptr); }
+
+// --- Options ---
+
+struct BenchOptions {
+    std::vector<std::pair<uint32_t, uint32_t>> resolutions = {
+        {1280, 720}, {1920, 1080}, {2560, 1440}, {3840, 2160},
+    };
+    double seconds = 5.0;        // Measured, per resolution
+    double warmup_seconds = 1.0;
+    uint32_t fps = 60;           // Canvas and consumer rate
+    FrameFormat format = FrameFormat::RGBA;
+    uint32_t latency = GpuReadback::kDefaultLatency;
+    bool copy = true;            // Copy each frame out, as getLatestFrame does under Electron
+    bool verbose = false;
+    std::string plugin_dir = TITAN_BENCH_PLUGIN_DIR;
+    std::string data_dir = TITAN_BENCH_DATA_DIR;
+    std::string json_path;
+};
+
+static void print_usage() {
+    printf("Usage: titan_bench [options]\n"
+           "  --resolutions LIST  720p,1080p,1440p,4k or WxH (default: all four)\n"
+           "  --seconds N         measured seconds per resolution (default 5)\n"
+           "  --warmup N          seconds before measuring (default 1)\n"
+           "  --fps N             canvas and consumer frame rate (default 60)\n"
+           "  --format F          rgba, bgra, nv12 or i420 (default rgba)\n"
+           "  --latency N         readback latency in frames, 0-%u (default %u)\n"
+           "  --no-copy           consumer reads frames in place (zero-copy buffers)\n"
+           "  --json PATH         also write the results as JSON\n"
+           "  --plugin-dir DIR    libobs plugin directory\n"
+           "  --data-dir DIR      libobs data directory (containing libobs/ and obs-plugins/)\n"
+           "  --verbose           show libobs log output\n",
+           GpuReadback::kMaxLatency, GpuReadback::kDefaultLatency);
+}
+
+static bool parse_resolution(const std::string& name, uint32_t* width, uint32_t* height) {
+    if (name == "720p") *width = 1280, *height = 720;
+    else if (name == "1080p") *width = 1920, *height = 1080;
+    else if (name == "1440p") *width = 2560, *height = 1440;
+    else if (name == "4k" || name == "2160p") *width = 3840, *height = 2160;
+    else if (sscanf(name.c_str(), "%ux%u", width, height) != 2) return false;
+    return *width >= 2 && *height >= 2 && *width <= 8192 && *height <= 8192;
+}
+
+static bool parse_options(int argc, char** argv, BenchOptions* options) {
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        auto value = [&](const char** out) {
+            if (i + 1 >= argc) return false;
+            *out = argv[++i];
+            return true;
+        };
+        const char* v = nullptr;
+        if (arg == "--help" || arg == "-h") {
+            print_usage();
+            exit(0);
+        } else if (arg == "--no-copy") {
+            options->copy = false;
+        } else if (arg == "--verbose") {
+            options->verbose = true;
+        } else if (arg == "--resolutions" && value(&v)) {
+            options->resolutions.clear();
+            std::string list = v;
+            size_t start = 0;
+            while (start <= list.size()) {
+                size_t end = list.find(',', start);
+                if (end == std::string::npos) end = list.size();
+                uint32_t width, height;
+                if (!parse_resolution(list.substr(start, end - start), &width, &height)) return false;
+                options->resolutions.push_back({width, height});
+                start = end + 1;
+            }
+        } else if (arg == "--seconds" && value(&v)) {
+            options->seconds = atof(v);
+            if (!(options->seconds > 0.0)) return false;
+        } else if (arg == "--warmup" && value(&v)) {
+            options->warmup_seconds = atof(v);
+            if (!(options->warmup_seconds >= 0.0)) return false;
+        } else if (arg == "--fps" && value(&v)) {
+            options->fps = (uint32_t)atoi(v);
+            if (options->fps < 1 || options->fps > 240) return false;
+        } else if (arg == "--format" && value(&v)) {
+            if (!ParseFrameFormat(v, &options->format)) return false;
+        } else if (arg == "--latency" && value(&v)) {
+            options->latency = (uint32_t)atoi(v);
+            if (options->latency > GpuReadback::kMaxLatency) return false;
+        } else if (arg == "--json" && value(&v)) {
+            options->json_path = v;
+        } else if (arg == "--plugin-dir" && value(&v)) {
+            options->plugin_dir = v;
+        } else if (arg == "--data-dir" && value(&v)) {
+            options->data_dir = v;
+        } else {
+            return false;
+        }
+    }
+    return !options->resolutions.empty();
+}
+
+// --- Frame Pipeline ---
+
+struct Pipeline {
+    GpuReadback readback;
+    FrameScaler scaler;
+    FrameExchange frames;
+    FrameFormat format = FrameFormat::RGBA;
+
+    // Written by the graphics and consumer threads while measuring.
+    std::mutex mutex;
+    bool measuring = false;
+    std::vector<uint64_t> publish_ns;  // Stage + map + convert + publish, per frame
+    uint64_t frames_published = 0;
+    uint64_t frames_unchanged = 0;     // Same content hash, not published
+    uint64_t bytes_converted = 0;
+    uint64_t graphics_allocations = 0;
+    std::vector<uint64_t> latency_ns;  // Publish to copied out by the consumer
+    uint64_t frames_consumed = 0;
+    uint64_t bytes_copied = 0;
+    uint64_t consumer_allocations = 0;
+};
+
+static bool frame_format_from_gs(gs_color_format format, FrameFormat* out) {
+    switch (format) {
+        case GS_RGBA: *out = FrameFormat::RGBA; return true;
+        case GS_BGRA:
+        case GS_BGRX: *out = FrameFormat::BGRA; return true;
+        default: return false;
+    }
+}
+
+// Graphics thread; mirrors main_render_callback's program path at full size.
+static void bench_render(void* param, uint32_t cx, uint32_t cy) {
+    auto* pipeline = static_cast<Pipeline*>(param);
+    gs_texture_t* texture = obs_get_main_texture();
+    if (!texture) return;
+
+    uint64_t start_ns = os_gettime_ns();
+    uint64_t allocations = t_allocations;
+    uint8_t* data = nullptr;
+    uint32_t linesize = 0;
+    if (!pipeline->readback.StageAndMap(texture, &data, &linesize)) return;
+
+    FrameFormat src_format;
+    uint32_t width = pipeline->readback.width();
+    uint32_t height = pipeline->readback.height();
+    FrameFormat dst_format = pipeline->format;
+    if (IsYuvFormat(dst_format)) {
+        width &= ~1u;
+        height &= ~1u;
+    }
+    FramePlane planes[3];
+    size_t size;
+    GetFramePlanes(dst_format, width, height, planes, &size);
+
+    FrameSlab* slab = frame_format_from_gs(pipeline->readback.format(), &src_format)
+                          ? pipeline->frames.BeginWrite(size)
+                          : nullptr;
+    bool published = false;
+    if (slab) {
+        slab->width = width;
+        slab->height = height;
+        slab->stride = planes[0].stride;
+        slab->format = dst_format;
+        if (IsYuvFormat(dst_format)) {
+            pipeline->scaler.ScaleToYuv(data, linesize, pipeline->readback.width(), pipeline->readback.height(),
+                                        src_format, slab->data, width, height, dst_format, YuvColorspace::BT709,
+                                        YuvRange::Limited);
+        } else {
+            pipeline->scaler.Scale(data, linesize, pipeline->readback.width(), pipeline->readback.height(),
+                                   src_format, slab->data, slab->stride, width, height, dst_format);
+        }
+        published = pipeline->frames.Publish(start_ns, HashPixels(slab->data, slab->size));
+    }
+    pipeline->readback.Unmap();
+    uint64_t elapsed_ns = os_gettime_ns() - start_ns;
+
+    std::lock_guard<std::mutex> lock(pipeline->mutex);
+    if (!pipeline->measuring || !slab) return;
+    pipeline->graphics_allocations += t_allocations - allocations;
+    if (!published) {
+        pipeline->frames_unchanged++;
+        return;
+    }
+    pipeline->frames_published++;
+    pipeline->bytes_converted += size;
+    if (pipeline->publish_ns.size() < pipeline->publish_ns.capacity()) pipeline->publish_ns.push_back(elapsed_ns);
+}
+
+// getLatestFrame() polled at the canvas rate.
+static void consume_frames(Pipeline* pipeline, uint32_t fps, bool copy, const std::atomic<bool>* stop) {
+    using clock = std::chrono::steady_clock;
+    const auto interval = std::chrono::nanoseconds(1000000000ULL / fps);
+    auto next = clock::now();
+    uint64_t last_sequence = 0;
+    // The previous copy stays alive until the next one, like a Buffer JS
+    // holds until its next call.
+    std::unique_ptr<uint8_t[]> held;
+
+    while (!stop->load(std::memory_order_relaxed)) {
+        next += interval;
+        std::this_thread::sleep_until(next);
+        if (clock::now() > next + interval) next = clock::now();
+
+        uint64_t allocations = t_allocations;
+        FrameSlab* slab = pipeline->frames.AcquireLatest();
+        if (!slab) continue;
+        if (slab->sequence == last_sequence) {
+            FrameExchange::Release(slab);
+            continue;
+        }
+        last_sequence = slab->sequence;
+        size_t copied = 0;
+        if (copy) {
+            held.reset(new uint8_t[slab->size]);
+            memcpy(held.get(), slab->data, slab->size);
+            copied = slab->size;
+        }
+        uint64_t latency_ns = os_gettime_ns() - slab->timestamp_ns;
+        FrameExchange::Release(slab);
+
+        std::lock_guard<std::mutex> lock(pipeline->mutex);
+        if (!pipeline->measuring) continue;
+        pipeline->consumer_allocations += t_allocations - allocations;
+        pipeline->frames_consumed++;
+        pipeline->bytes_copied += copied;
+        if (pipeline->latency_ns.size() < pipeline->latency_ns.capacity()) pipeline->latency_ns.push_back(latency_ns);
+    }
+}
+
+// --- Test Pattern ---
+
+// 75% SMPTE color bars (ABGR) under a white bar that sweeps across every
+// two seconds, so every frame differs and none is deduplicated.
+static const uint32_t kBarColors[] = {
+    0xFFBFBFBF, 0xFF00BFBF, 0xFFBFBF00, 0xFF00BF00, 0xFFBF00BF, 0xFF0000BF, 0xFFBF0000,
+};
+
+struct TestPattern {
+    obs_scene_t* scene = nullptr;
+    obs_sceneitem_t* sweep = nullptr;
+    uint32_t width = 0;
+    float x = 0.0f;
+};
+
+static obs_source_t* create_color_source(const char* name, uint32_t color, uint32_t width, uint32_t height) {
+    obs_data_t* settings = obs_data_create();
+    obs_data_set_int(settings, "color", color);
+    obs_data_set_int(settings, "width", width);
+    obs_data_set_int(settings, "height", height);
+    obs_source_t* source = obs_source_create("color_source_v3", name, settings, nullptr);
+    obs_data_release(settings);
+    return source;
+}
+
+static bool create_test_pattern(uint32_t width, uint32_t height, TestPattern* pattern) {
+    pattern->scene = obs_scene_create("titan_bench_pattern");
+    pattern->width = width;
+    pattern->x = 0.0f;
+    const size_t bars = sizeof(kBarColors) / sizeof(kBarColors[0]);
+    uint32_t bar_width = (width + bars - 1) / bars;
+    for (size_t i = 0; i < bars; i++) {
+        std::string name = "titan_bench_bar_" + std::to_string(i);
+        obs_source_t* source = create_color_source(name.c_str(), kBarColors[i], bar_width, height);
+        if (!source) return false;
+        obs_sceneitem_t* item = obs_scene_add(pattern->scene, source);
+        struct vec2 pos = {(float)(i * bar_width), 0.0f};
+        obs_sceneitem_set_pos(item, &pos);
+        obs_source_release(source);
+    }
+    obs_source_t* sweep = create_color_source("titan_bench_sweep", 0xFFFFFFFF, std::max(2u, width / 32), height);
+    if (!sweep) return false;
+    pattern->sweep = obs_scene_add(pattern->scene, sweep);
+    obs_source_release(sweep);
+    obs_set_output_source(0, obs_scene_get_source(pattern->scene));
+    return true;
+}
+
+static void destroy_test_pattern(TestPattern* pattern) {
+    obs_set_output_source(0, nullptr);
+    obs_scene_release(pattern->scene);
+    *pattern = TestPattern();
+}
+
+// Graphics thread, once per frame before rendering.
+static void move_sweep(void* param, float seconds) {
+    auto* pattern = static_cast<TestPattern*>(param);
+    pattern->x += pattern->width * seconds / 2.0f;
+    if (pattern->x >= pattern->width) pattern->x = 0.0f;
+    struct vec2 pos = {pattern->x, 0.0f};
+    obs_sceneitem_set_pos(pattern->sweep, &pos);
+}
+
+// --- Benchmark ---
+
+struct BenchResult {
+    uint32_t width = 0;
+    uint32_t height = 0;
+    double seconds = 0.0;
+    double render_fps = 0.0;     // Frames libobs rendered
+    double publish_fps = 0.0;    // Frames read back and published
+    double consume_fps = 0.0;    // Frames the consumer copied out
+    uint32_t lagged_frames = 0;
+    uint64_t unchanged_frames = 0;
+    double bytes_per_frame = 0.0; // Converted into the slab plus copied out, per published frame
+    double publish_p50_ms = 0.0;
+    double publish_p99_ms = 0.0;
+    double latency_p50_ms = 0.0;
+    double latency_p99_ms = 0.0;
+    double allocs_per_frame = 0.0; // Graphics and consumer threads, per published frame
+    std::string error;
+};
+
+static double percentile_ms(std::vector<uint64_t>& values, double fraction) {
+    if (values.empty()) return 0.0;
+    size_t index = std::min(values.size() - 1, (size_t)(fraction * values.size()));
+    std::nth_element(values.begin(), values.begin() + index, values.end());
+    return values[index] / 1e6;
+}
+
+static bool reset_video(uint32_t width, uint32_t height, uint32_t fps) {
+    struct obs_video_info ovi = {};
+    ovi.graphics_module = "libobs-opengl";
+    ovi.fps_num = fps;
+    ovi.fps_den = 1;
+    ovi.base_width = ovi.output_width = width;
+    ovi.base_height = ovi.output_height = height;
+    ovi.output_format = VIDEO_FORMAT_NV12;
+    ovi.gpu_conversion = true;
+    ovi.colorspace = VIDEO_CS_709;
+    ovi.range = VIDEO_RANGE_PARTIAL;
+    ovi.scale_type = OBS_SCALE_BICUBIC;
+    return obs_reset_video(&ovi) == OBS_VIDEO_SUCCESS;
+}
+
+static BenchResult run_resolution(const BenchOptions& options, uint32_t width, uint32_t height) {
+    BenchResult result;
+    result.width = width;
+    result.height = height;
+    if (!reset_video(width, height, options.fps)) {
+        result.error = "obs_reset_video failed";
+        return result;
+    }
+    TestPattern pattern;
+    if (!create_test_pattern(width, height, &pattern)) {
+        destroy_test_pattern(&pattern);
+        result.error = "Failed to create color sources (is the image-source plugin loaded?)";
+        return result;
+    }
+
+    Pipeline pipeline;
+    pipeline.format = options.format;
+    pipeline.readback.SetLatency(options.latency);
+    // Sized up front so recording never allocates.
+    size_t capacity = (size_t)((options.seconds + 1.0) * options.fps * 2);
+    pipeline.publish_ns.reserve(capacity);
+    pipeline.latency_ns.reserve(capacity);
+
+    obs_add_tick_callback(move_sweep, &pattern);
+    obs_add_main_render_callback(bench_render, &pipeline);
+    std::atomic<bool> stop{false};
+    std::thread consumer(consume_frames, &pipeline, options.fps, options.copy, &stop);
+
+    std::this_thread::sleep_for(std::chrono::duration<double>(options.warmup_seconds));
+    uint32_t rendered_before = obs_get_total_frames();
+    uint32_t lagged_before = obs_get_lagged_frames();
+    uint64_t start_ns = os_gettime_ns();
+    {
+        std::lock_guard<std::mutex> lock(pipeline.mutex);
+        pipeline.measuring = true;
+    }
+    std::this_thread::sleep_for(std::chrono::duration<double>(options.seconds));
+    {
+        std::lock_guard<std::mutex> lock(pipeline.mutex);
+        pipeline.measuring = false;
+    }
+    result.seconds = (os_gettime_ns() - start_ns) / 1e9;
+    uint32_t rendered = obs_get_total_frames() - rendered_before;
+    result.lagged_frames = obs_get_lagged_frames() - lagged_before;
+
+    stop = true;
+    consumer.join();
+    obs_remove_main_render_callback(bench_render, &pipeline);
+    obs_remove_tick_callback(move_sweep, &pattern);
+    destroy_test_pattern(&pattern);
+    obs_enter_graphics();
+    pipeline.readback.Destroy();
+    obs_leave_graphics();
+
+    result.render_fps = rendered / result.seconds;
+    result.publish_fps = pipeline.frames_published / result.seconds;
+    result.consume_fps = pipeline.frames_consumed / result.seconds;
+    result.unchanged_frames = pipeline.frames_unchanged;
+    result.publish_p50_ms = percentile_ms(pipeline.publish_ns, 0.50);
+    result.publish_p99_ms = percentile_ms(pipeline.publish_ns, 0.99);
+    result.latency_p50_ms = percentile_ms(pipeline.latency_ns, 0.50);
+    result.latency_p99_ms = percentile_ms(pipeline.latency_ns, 0.99);
+    if (pipeline.frames_published) {
+        result.bytes_per_frame =
+            (double)(pipeline.bytes_converted + pipeline.bytes_copied) / pipeline.frames_published;
+        result.allocs_per_frame =
+            (double)(pipeline.graphics_allocations + pipeline.consumer_allocations) / pipeline.frames_published;
+    } else {
+        result.error = "No frames were read back";
+    }
+    return result;
+}
+
+// --- Setup & Reporting ---
+
+static void log_handler(int level, const char* message, va_list args, void* param) {
+    bool verbose = *static_cast<bool*>(param);
+    if (!verbose && level > LOG_WARNING) return;
+    vfprintf(stderr, message, args);
+    fputc('\n', stderr);
+}
+
+static bool load_image_source(const BenchOptions& options) {
+#ifdef _WIN32
+    std::string binary = options.plugin_dir + "/image-source.dll";
+#else
+    std::string binary = options.plugin_dir + "/image-source.so";
+#endif
+    std::string data = options.data_dir + "/obs-plugins/image-source";
+    obs_module_t* module = nullptr;
+    if (obs_open_module(&module, binary.c_str(), data.c_str()) != MODULE_SUCCESS) {
+        fprintf(stderr, "Failed to open %s\n", binary.c_str());
+        return false;
+    }
+    return obs_init_module(module);
+}
+
+static void print_results(const BenchOptions& options, const std::vector<BenchResult>& results) {
+    printf("format %s, readback latency %u, %s, %.1f s per resolution\n\n", FrameFormatName(options.format),
+           options.latency, options.copy ? "copy out" : "zero-copy", options.seconds);
+    printf("%-10s %8s %8s %8s %10s %16s %16s %12s\n", "resolution", "render", "publish", "consume", "MB/frame",
+           "publish p50/p99", "latency p50/p99", "allocs/frame");
+    for (const BenchResult& r : results) {
+        std::string resolution = std::to_string(r.width) + "x" + std::to_string(r.height);
+        if (!r.error.empty()) {
+            printf("%-10s %s\n", resolution.c_str(), r.error.c_str());
+            continue;
+        }
+        printf("%-10s %8.1f %8.1f %8.1f %10.2f %7.2f/%5.2f ms %7.2f/%5.2f ms %12.2f\n", resolution.c_str(),
+               r.render_fps, r.publish_fps, r.consume_fps, r.bytes_per_frame / (1024.0 * 1024.0), r.publish_p50_ms,
+               r.publish_p99_ms, r.latency_p50_ms, r.latency_p99_ms, r.allocs_per_frame);
+    }
+}
+
+static bool write_json(const BenchOptions& options, const std::vector<BenchResult>& results) {
+    FILE* file = fopen(options.json_path.c_str(), "w");
+    if (!file) return false;
+    fprintf(file, "{\"format\":\"%s\",\"latency\":%u,\"copy\":%s,\"fps\":%u,\"results\":[",
+            FrameFormatName(options.format), options.latency, options.copy ? "true" : "false", options.fps);
+    for (size_t i = 0; i < results.size(); i++) {
+        const BenchResult& r = results[i];
+        fprintf(file,
+                "%s{\"width\":%u,\"height\":%u,\"seconds\":%.3f,\"renderFps\":%.2f,\"publishFps\":%.2f,"
+                "\"consumeFps\":%.2f,\"laggedFrames\":%u,\"unchangedFrames\":%llu,\"bytesPerFrame\":%.0f,"
+                "\"publishP50Ms\":%.3f,\"publishP99Ms\":%.3f,\"latencyP50Ms\":%.3f,\"latencyP99Ms\":%.3f,"
+                "\"allocsPerFrame\":%.3f,\"error\":%s%s%s}",
+                i ? "," : "", r.width, r.height, r.seconds, r.render_fps, r.publish_fps, r.consume_fps,
+                r.lagged_frames, (unsigned long long)r.unchanged_frames, r.bytes_per_frame, r.publish_p50_ms,
+                r.publish_p99_ms, r.latency_p50_ms, r.latency_p99_ms, r.allocs_per_frame,
+                r.error.empty() ? "" : "\"", r.error.empty() ? "null" : r.error.c_str(), r.error.empty() ? "" : "\"");
+    }
+    fprintf(file, "]}\n");
+    return fclose(file) == 0;
+}
+
+int main(int argc, char** argv) {
+    BenchOptions options;
+    if (!parse_options(argc, argv, &options)) {
+        print_usage();
+        return 2;
+    }
+    base_set_log_handler(log_handler, &options.verbose);
+
+#ifdef __linux__
+    // libobs-opengl needs an EGL display; on a box without one, run under
+    // xvfb-run (scripts/run-bench.sh does).
+    Display* display = XOpenDisplay(nullptr);
+    if (!display) {
+        fprintf(stderr, "No X display. Run under xvfb-run, e.g. scripts/run-bench.sh.\n");
+        return 1;
+    }
+    obs_set_nix_platform(OBS_NIX_PLATFORM_X11_EGL);
+    obs_set_nix_platform_display(display);
+#endif
+
+    if (!obs_startup("en-US", nullptr, nullptr)) {
+        fprintf(stderr, "obs_startup failed\n");
+        return 1;
+    }
+    obs_add_data_path((options.data_dir + "/libobs/").c_str());
+    struct obs_audio_info oai = {48000, SPEAKERS_STEREO};
+    obs_reset_audio(&oai);
+
+    int status = 0;
+    std::vector<BenchResult> results;
+    if (!reset_video(options.resolutions[0].first, options.resolutions[0].second, options.fps)) {
+        fprintf(stderr, "obs_reset_video failed; is libobs-opengl on the library path?\n");
+        status = 1;
+    } else if (!load_image_source(options)) {
+        status = 1;
+    } else {
+        for (auto const& [width, height] : options.resolutions) {
+            fprintf(stderr, "Running %ux%u...\n", width, height);
+            results.push_back(run_resolution(options, width, height));
+            if (!results.back().error.empty()) status = 1;
+        }
+        print_results(options, results);
+        if (!options.json_path.empty() && !write_json(options, results)) {
+            fprintf(stderr, "Failed to write %s\n", options.json_path.c_str());
+            status = 1;
+        }
+    }
+
+    obs_shutdown();
+#ifdef __linux__
+    XCloseDisplay(display);
+#endif
+    return status;
+}
@@ -0,0 +1,149 @@
+#include "adaptive-bitrate.h"
+
+#include <algorithm>
+
+static const PerfOutputSample* find_output(const PerfSample& sample, const std::string& name) {
+    for (const PerfOutputSample& output : sample.outputs) {
+        if (output.name == name) return &output;
+    }
+    return nullptr;
+}
+
+AdaptiveBitrate::AdaptiveBitrate(ApplyFn apply) : apply_(std::move(apply)) {}
+
+void AdaptiveBitrate::Configure(const AdaptiveBitrateConfig& config) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    config_ = config;
+}
+
+AdaptiveBitrateConfig AdaptiveBitrate::config() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return config_;
+}
+
+void AdaptiveBitrate::OnSample(const PerfSample& sample) {
+    std::string output_name;
+    BitrateAdjustment adjustment;
+    bool restore = false;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        const PerfOutputSample* output = tracking_ ? find_output(sample, tracked_output_) : nullptr;
+
+        // A stopped or restarted output took its encoder with it; the next
+        // one starts at its configured bitrate again.
+        if (tracking_ && (!output || !output->active || output->total_frames < last_total_frames_)) {
+            tracking_ = false;
+            suspended_ = false;
+        }
+        if (tracking_ && (!config_.enabled || tracked_output_ != config_.output)) {
+            tracking_ = false;
+            if (current_kbps_ != start_kbps_ && !suspended_) {
+                output_name = tracked_output_;
+                adjustment.to_kbps = start_kbps_;
+                adjustment.reason = "disabled";
+                restore = true;
+            }
+        }
+
+        if (!tracking_ && !restore) {
+            if (!config_.enabled) return;
+            output = find_output(sample, config_.output);
+            if (!output || !output->active || !output->video_bitrate) return;
+            // The first tick only sets the baseline.
+            tracking_ = true;
+            suspended_ = false;
+            last_error_.clear();
+            tracked_output_ = config_.output;
+            start_kbps_ = current_kbps_ = output->video_bitrate;
+            last_total_frames_ = output->total_frames;
+            bad_ticks_ = good_ticks_ = 0;
+            return;
+        }
+
+        if (!restore) {
+            int sent = output->total_frames - last_total_frames_;
+            last_total_frames_ = output->total_frames;
+            if (suspended_) return;
+
+            double drop_ratio = output->frames_dropped_delta / (double)std::max(1, sent);
+            bool congested = output->congestion >= config_.congestion_high;
+            bool dropping = output->frames_dropped_delta > 0 && drop_ratio >= config_.drop_ratio_high;
+            if (congested || dropping) {
+                bad_ticks_++;
+                good_ticks_ = 0;
+            } else if (output->congestion <= config_.congestion_low && output->frames_dropped_delta == 0) {
+                good_ticks_++;
+                bad_ticks_ = 0;
+            } else {
+                // Between the marks: neither streak survives.
+                bad_ticks_ = good_ticks_ = 0;
+            }
+
+            uint32_t max_kbps = config_.max_kbps ? config_.max_kbps : start_kbps_;
+            uint32_t min_kbps = std::min(config_.min_kbps, max_kbps);
+            if (current_kbps_ > max_kbps || current_kbps_ < min_kbps) {
+                // The limits changed under us.
+                adjustment.to_kbps = std::clamp(current_kbps_, min_kbps, max_kbps);
+                adjustment.reason = "limits";
+            } else if (bad_ticks_ >= config_.down_ticks && current_kbps_ > min_kbps) {
+                adjustment.to_kbps = std::max(min_kbps, (uint32_t)(current_kbps_ * config_.down_factor));
+                adjustment.reason = congested ? "congestion" : "dropped_frames";
+            } else if (good_ticks_ >= config_.up_ticks && current_kbps_ < max_kbps) {
+                uint32_t step = std::max(1u, (uint32_t)(max_kbps * config_.up_step));
+                adjustment.to_kbps = std::min(max_kbps, current_kbps_ + step);
+                adjustment.reason = "recovered";
+            } else {
+                return;
+            }
+            bad_ticks_ = good_ticks_ = 0;
+            output_name = tracked_output_;
+        }
+
+        adjustment.time_ms = sample.time_ms;
+        adjustment.from_kbps = current_kbps_;
+        if (output) {
+            adjustment.congestion = output->congestion;
+            adjustment.frames_dropped = output->frames_dropped_delta;
+        }
+    }
+    Apply(output_name, std::move(adjustment), restore);
+}
+
+void AdaptiveBitrate::Apply(const std::string& output, BitrateAdjustment adjustment, bool restore) {
+    adjustment.error = apply_(output, adjustment.to_kbps);
+
+    if (adjustment.error.empty()) {
+        blog(LOG_INFO, "Adaptive bitrate: %s %u -> %u kbps (%s, congestion %.2f, %d dropped)", output.c_str(),
+             adjustment.from_kbps, adjustment.to_kbps, adjustment.reason.c_str(), adjustment.congestion,
+             adjustment.frames_dropped);
+    } else {
+        blog(LOG_WARNING, "Adaptive bitrate: %s %u -> %u kbps failed: %s", output.c_str(), adjustment.from_kbps,
+             adjustment.to_kbps, adjustment.error.c_str());
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!restore) {
+        if (adjustment.error.empty()) {
+            current_kbps_ = adjustment.to_kbps;
+        } else {
+            suspended_ = true;
+            last_error_ = adjustment.error;
+        }
+    }
+    adjustments_.push_back(std::move(adjustment));
+    if (adjustments_.size() > kHistory) adjustments_.pop_front();
+}
+
+AdaptiveBitrateStatus AdaptiveBitrate::Status() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    AdaptiveBitrateStatus status;
+    status.config = config_;
+    status.tracking = tracking_ && !suspended_;
+    status.start_kbps = tracking_ ? start_kbps_ : 0;
+    status.current_kbps = tracking_ ? current_kbps_ : 0;
+    status.bad_ticks = bad_ticks_;
+    status.good_ticks = good_ticks_;
+    status.last_error = last_error_;
+    status.adjustments.assign(adjustments_.begin(), adjustments_.end());
+    return status;
+}
@@ -0,0 +1,96 @@
+#pragma once
+
+#include "perf-stats.h"
+
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <vector>
+
+struct AdaptiveBitrateConfig {
+    bool enabled = false;
+    std::string output = "stream";
+    uint32_t min_kbps = 500;
+    uint32_t max_kbps = 0;          // 0: the bitrate the output started with
+    float congestion_high = 0.25f;  // A tick at or above this is bad
+    float congestion_low = 0.05f;   // A tick at or below this (and no drops) is good
+    double drop_ratio_high = 0.01;  // Dropped / sent frames that make a tick bad
+    uint32_t down_ticks = 2;        // Consecutive bad ticks before stepping down
+    uint32_t up_ticks = 10;         // Consecutive good ticks before stepping up
+    double down_factor = 0.7;       // New bitrate after a step down, of the current one
+    double up_step = 0.1;           // Added per step up, of the max bitrate
+};
+
+struct BitrateAdjustment {
+    uint64_t time_ms = 0;           // Wall clock, ms since the epoch
+    uint32_t from_kbps = 0;
+    uint32_t to_kbps = 0;
+    std::string reason;             // congestion, dropped_frames, recovered, disabled
+    float congestion = 0.0f;
+    int frames_dropped = 0;         // In the tick that triggered it
+    std::string error;              // Set if the encoder could not be updated
+};
+
+struct AdaptiveBitrateStatus {
+    AdaptiveBitrateConfig config;
+    bool tracking = false;          // The output is active and being controlled
+    uint32_t start_kbps = 0;        // Bitrate the output started with
+    uint32_t current_kbps = 0;
+    uint32_t bad_ticks = 0;
+    uint32_t good_ticks = 0;
+    std::string last_error;         // Why control stopped, until the output restarts
+    std::vector<BitrateAdjustment> adjustments;  // Oldest first
+};
+
+// Steps an output's video bitrate down when the connection can't keep up
+// and back up once it has been clean for a while, fed once per perf-stats
+// sample. Bad ticks (congestion or dropped frames above the high marks)
+// step down multiplicatively after down_ticks in a row; good ticks (below
+// the low mark, nothing dropped) step up additively after up_ticks in a
+// row, so the bitrate backs off fast and recovers slowly instead of
+// oscillating around the link rate.
+//
+// Adjustments go through ApplyFn, called without the lock held, and are
+// logged and kept in a short history. Disabling restores the bitrate the
+// output started with.
+class AdaptiveBitrate {
+public:
+    // Sets the video bitrate of `output`. Returns an error message, or "".
+    using ApplyFn = std::function<std::string(const std::string& output, uint32_t kbps)>;
+
+    static constexpr size_t kHistory = 100;
+
+    explicit AdaptiveBitrate(ApplyFn apply);
+
+    AdaptiveBitrate(const AdaptiveBitrate&) = delete;
+    AdaptiveBitrate& operator=(const AdaptiveBitrate&) = delete;
+
+    // Takes effect on the next sample.
+    void Configure(const AdaptiveBitrateConfig& config);
+    AdaptiveBitrateConfig config() const;
+
+    // From the perf-stats sampling thread.
+    void OnSample(const PerfSample& sample);
+
+    AdaptiveBitrateStatus Status() const;
+
+private:
+    void Apply(const std::string& output, BitrateAdjustment adjustment, bool restore);
+
+    ApplyFn apply_;
+
+    mutable std::mutex mutex_;
+    AdaptiveBitrateConfig config_;
+    std::string tracked_output_;
+    bool tracking_ = false;
+    bool suspended_ = false;        // Apply failed; wait for the output to restart
+    uint32_t start_kbps_ = 0;
+    uint32_t current_kbps_ = 0;
+    int last_total_frames_ = 0;
+    uint32_t bad_ticks_ = 0;
+    uint32_t good_ticks_ = 0;
+    std::string last_error_;
+    std::deque<BitrateAdjustment> adjustments_;
+};
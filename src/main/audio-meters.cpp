@@ -0,0 +1,210 @@
+#include "audio-meters.h"
+
+#include <algorithm>
+#include <cmath>
+#include <util/platform.h>
+
+AudioMeterTable::AudioMeterTable() {
+    for (auto& slot : slots_) {
+        slot.owner = this;
+        ResetSlot(slot);
+    }
+}
+
+void AudioMeterTable::ResetSlot(AudioMeterSlot& slot) {
+    const float silence = -INFINITY;
+    for (int ch = 0; ch < MAX_AUDIO_CHANNELS; ch++) {
+        slot.magnitude[ch].store(silence, std::memory_order_relaxed);
+        slot.peak[ch].store(silence, std::memory_order_relaxed);
+        slot.input_peak[ch].store(silence, std::memory_order_relaxed);
+        slot.peak_hold[ch].store(silence, std::memory_order_relaxed);
+        slot.decayed_peak[ch] = silence;
+        slot.held_peak[ch] = silence;
+        slot.hold_until_ns[ch] = 0;
+    }
+    slot.channels.store(0, std::memory_order_relaxed);
+    slot.updated_ns.store(0, std::memory_order_relaxed);
+    slot.last_update_ns = 0;
+}
+
+void AudioMeterTable::Connect() {
+    if (connected_) return;
+    signal_handler_t* handler = obs_get_signal_handler();
+    signal_handler_connect(handler, "source_remove", OnSourceGone, this);
+    signal_handler_connect(handler, "source_destroy", OnSourceGone, this);
+    signal_handler_connect(handler, "source_rename", OnSourceRename, this);
+    connected_ = true;
+}
+
+void AudioMeterTable::Disconnect() {
+    if (connected_) {
+        signal_handler_t* handler = obs_get_signal_handler();
+        signal_handler_disconnect(handler, "source_remove", OnSourceGone, this);
+        signal_handler_disconnect(handler, "source_destroy", OnSourceGone, this);
+        signal_handler_disconnect(handler, "source_rename", OnSourceRename, this);
+        connected_ = false;
+    }
+    DetachAll();
+}
+
+uint32_t AudioMeterTable::Attach(obs_source_t* source) {
+    const char* source_name = obs_source_get_name(source);
+    std::string name = source_name ? source_name : "";
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    AudioMeterSlot* free_slot = nullptr;
+    for (uint32_t i = 0; i < kMaxSlots; i++) {
+        AudioMeterSlot& slot = slots_[i];
+        if (slot.in_use.load(std::memory_order_relaxed)) {
+            if (slot.source == source) return i;
+        } else if (!free_slot) {
+            free_slot = &slot;
+        }
+    }
+    if (!free_slot) {
+        blog(LOG_WARNING, "Audio meter table is full, no meter for '%s'", name.c_str());
+        return kInvalidIndex;
+    }
+
+    // The slot is ready before the first callback can reach it.
+    ResetSlot(*free_slot);
+    free_slot->source = source;
+    free_slot->name = name;
+    free_slot->in_use.store(true, std::memory_order_release);
+
+    free_slot->volmeter = obs_volmeter_create(OBS_FADER_LOG);
+    obs_volmeter_add_callback(free_slot->volmeter, VolmeterCallback, free_slot);
+    if (!obs_volmeter_attach_source(free_slot->volmeter, source)) {
+        FreeSlot(*free_slot);
+        return kInvalidIndex;
+    }
+
+    layout_version_.fetch_add(1, std::memory_order_acq_rel);
+    return (uint32_t)(free_slot - slots_);
+}
+
+void AudioMeterTable::FreeSlot(AudioMeterSlot& slot) {
+    // Destroying the volmeter detaches it from the source's audio callback,
+    // so the audio thread is done with the slot once this returns.
+    obs_volmeter_destroy(slot.volmeter);
+    slot.volmeter = nullptr;
+    slot.source = nullptr;
+    slot.name.clear();
+    slot.in_use.store(false, std::memory_order_release);
+    ResetSlot(slot);
+}
+
+void AudioMeterTable::Detach(obs_source_t* source) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (auto& slot : slots_) {
+        if (slot.in_use.load(std::memory_order_relaxed) && slot.source == source) {
+            FreeSlot(slot);
+            layout_version_.fetch_add(1, std::memory_order_acq_rel);
+            return;
+        }
+    }
+}
+
+void AudioMeterTable::DetachAll() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    bool changed = false;
+    for (auto& slot : slots_) {
+        if (slot.in_use.load(std::memory_order_relaxed)) {
+            FreeSlot(slot);
+            changed = true;
+        }
+    }
+    if (changed) layout_version_.fetch_add(1, std::memory_order_acq_rel);
+}
+
+uint32_t AudioMeterTable::Find(const std::string& name) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (uint32_t i = 0; i < kMaxSlots; i++) {
+        if (slots_[i].in_use.load(std::memory_order_relaxed) && slots_[i].name == name) return i;
+    }
+    return kInvalidIndex;
+}
+
+std::vector<std::pair<uint32_t, std::string>> AudioMeterTable::Entries() const {
+    std::vector<std::pair<uint32_t, std::string>> entries;
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (uint32_t i = 0; i < kMaxSlots; i++) {
+        if (slots_[i].in_use.load(std::memory_order_relaxed)) entries.emplace_back(i, slots_[i].name);
+    }
+    return entries;
+}
+
+bool AudioMeterTable::Read(uint32_t index, AudioMeterReading* out) const {
+    if (index >= kMaxSlots) return false;
+    const AudioMeterSlot& slot = slots_[index];
+    if (!slot.in_use.load(std::memory_order_acquire)) return false;
+
+    out->updated_ns = slot.updated_ns.load(std::memory_order_acquire);
+    out->channels = slot.channels.load(std::memory_order_relaxed);
+    for (int ch = 0; ch < MAX_AUDIO_CHANNELS; ch++) {
+        out->magnitude[ch] = slot.magnitude[ch].load(std::memory_order_relaxed);
+        out->peak[ch] = slot.peak[ch].load(std::memory_order_relaxed);
+        out->input_peak[ch] = slot.input_peak[ch].load(std::memory_order_relaxed);
+        out->peak_hold[ch] = slot.peak_hold[ch].load(std::memory_order_relaxed);
+    }
+    return true;
+}
+
+void AudioMeterTable::SetBallistics(float decay_rate_db_per_sec, float peak_hold_seconds) {
+    decay_rate_.store(std::max(decay_rate_db_per_sec, 0.0f), std::memory_order_relaxed);
+    peak_hold_ns_.store((uint64_t)(std::max(peak_hold_seconds, 0.0f) * 1e9f), std::memory_order_relaxed);
+}
+
+// Signal handlers run on whichever thread removed, destroyed or renamed the
+// source.
+
+void AudioMeterTable::OnSourceGone(void* data, calldata_t* cd) {
+    obs_source_t* source = static_cast<obs_source_t*>(calldata_ptr(cd, "source"));
+    if (source) static_cast<AudioMeterTable*>(data)->Detach(source);
+}
+
+void AudioMeterTable::OnSourceRename(void* data, calldata_t* cd) {
+    auto* table = static_cast<AudioMeterTable*>(data);
+    obs_source_t* source = static_cast<obs_source_t*>(calldata_ptr(cd, "source"));
+    const char* new_name = calldata_string(cd, "new_name");
+    if (!source || !new_name) return;
+
+    std::lock_guard<std::mutex> lock(table->mutex_);
+    for (auto& slot : table->slots_) {
+        if (slot.in_use.load(std::memory_order_relaxed) && slot.source == source) {
+            slot.name = new_name;
+            table->layout_version_.fetch_add(1, std::memory_order_acq_rel);
+            return;
+        }
+    }
+}
+
+// Runs on the audio thread. Levels from the volmeter already are in dB.
+void AudioMeterTable::VolmeterCallback(void* param, const float magnitude[MAX_AUDIO_CHANNELS],
+                                       const float peak[MAX_AUDIO_CHANNELS],
+                                       const float input_peak[MAX_AUDIO_CHANNELS]) {
+    AudioMeterSlot* slot = static_cast<AudioMeterSlot*>(param);
+    AudioMeterTable* table = slot->owner;
+
+    uint64_t now = os_gettime_ns();
+    float elapsed = slot->last_update_ns ? (float)(now - slot->last_update_ns) * 1e-9f : 0.0f;
+    slot->last_update_ns = now;
+    float decay = table->decay_rate_.load(std::memory_order_relaxed) * elapsed;
+    uint64_t hold_ns = table->peak_hold_ns_.load(std::memory_order_relaxed);
+
+    for (int ch = 0; ch < MAX_AUDIO_CHANNELS; ch++) {
+        float decayed = std::max(peak[ch], slot->decayed_peak[ch] - decay);
+        slot->decayed_peak[ch] = decayed;
+        if (peak[ch] >= slot->held_peak[ch] || now >= slot->hold_until_ns[ch]) {
+            slot->held_peak[ch] = peak[ch];
+            slot->hold_until_ns[ch] = now + hold_ns;
+        }
+
+        slot->magnitude[ch].store(magnitude[ch], std::memory_order_relaxed);
+        slot->peak[ch].store(decayed, std::memory_order_relaxed);
+        slot->input_peak[ch].store(input_peak[ch], std::memory_order_relaxed);
+        slot->peak_hold[ch].store(slot->held_peak[ch], std::memory_order_relaxed);
+    }
+    slot->channels.store((uint32_t)obs_volmeter_get_nr_channels(slot->volmeter), std::memory_order_relaxed);
+    slot->updated_ns.store(now, std::memory_order_release);
+}
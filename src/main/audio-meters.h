@@ -0,0 +1,110 @@
+#pragma once
+
+#include <obs.h>
+#include <obs-audio-controls.h>
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+class AudioMeterTable;
+
+// One meter per audio source. Everything JS reads is a relaxed atomic written
+// by the audio thread, so readers never block the audio thread and the other
+// way round. Slots are cache-line aligned so meters of different sources do
+// not share a line either. All levels are in dBFS (-inf for silence).
+struct alignas(64) AudioMeterSlot {
+    std::atomic<float> magnitude[MAX_AUDIO_CHANNELS];
+    // Peak with the configured decay applied, for drawing the meter bar.
+    std::atomic<float> peak[MAX_AUDIO_CHANNELS];
+    std::atomic<float> input_peak[MAX_AUDIO_CHANNELS];
+    // Highest peak within the hold time.
+    std::atomic<float> peak_hold[MAX_AUDIO_CHANNELS];
+    std::atomic<uint32_t> channels{0};
+    std::atomic<uint64_t> updated_ns{0};
+    std::atomic<bool> in_use{false};
+
+    // Audio thread only.
+    float decayed_peak[MAX_AUDIO_CHANNELS];
+    float held_peak[MAX_AUDIO_CHANNELS];
+    uint64_t hold_until_ns[MAX_AUDIO_CHANNELS];
+    uint64_t last_update_ns = 0;
+
+    // Control path only, under the table mutex.
+    obs_volmeter_t* volmeter = nullptr;
+    obs_source_t* source = nullptr; // Identity only, never dereferenced
+    std::string name;               // Kept current by source_rename
+    AudioMeterTable* owner = nullptr;
+};
+
+struct AudioMeterReading {
+    uint32_t channels = 0;
+    uint64_t updated_ns = 0;
+    float magnitude[MAX_AUDIO_CHANNELS];
+    float peak[MAX_AUDIO_CHANNELS];
+    float input_peak[MAX_AUDIO_CHANNELS];
+    float peak_hold[MAX_AUDIO_CHANNELS];
+};
+
+// Fixed-capacity table of audio meters, indexed by a small integer assigned
+// when a source's meter is attached. Slots belong to a source, not a name:
+// the libobs source_rename signal renames the meter, and source_remove and
+// source_destroy free it, so removing one scene item of a source that is
+// still in another scene keeps its meter. Attaching and detaching take a
+// mutex; the volmeter callback and Read() are lock-free.
+class AudioMeterTable {
+public:
+    static constexpr uint32_t kMaxSlots = 128;
+    static constexpr uint32_t kInvalidIndex = UINT32_MAX;
+    // OBS' "fast" meter decay and a short peak hold.
+    static constexpr float kDefaultDecayRate = 20.0f / 0.85f; // dB per second
+    static constexpr float kDefaultPeakHoldSeconds = 1.5f;
+
+    AudioMeterTable();
+    ~AudioMeterTable() = default;
+
+    AudioMeterTable(const AudioMeterTable&) = delete;
+    AudioMeterTable& operator=(const AudioMeterTable&) = delete;
+
+    // Hooks up the libobs signals. Call after obs_startup.
+    void Connect();
+    // Detaches every meter. Call before obs_shutdown.
+    void Disconnect();
+
+    // Attaches a volmeter to the source and returns its slot index. A source
+    // that already has a meter keeps its slot. Returns kInvalidIndex if the
+    // table is full or the volmeter could not be attached.
+    uint32_t Attach(obs_source_t* source);
+    // Only needed for private sources, which the signals don't cover.
+    void Detach(obs_source_t* source);
+    void DetachAll();
+
+    uint32_t Find(const std::string& name) const;
+    // (index, name) of every attached meter, ordered by index.
+    std::vector<std::pair<uint32_t, std::string>> Entries() const;
+    // Bumped whenever a meter is attached or detached.
+    uint64_t layout_version() const { return layout_version_.load(std::memory_order_acquire); }
+
+    // Lock-free; returns false if the slot is not in use.
+    bool Read(uint32_t index, AudioMeterReading* out) const;
+
+    void SetBallistics(float decay_rate_db_per_sec, float peak_hold_seconds);
+
+private:
+    static void VolmeterCallback(void* param, const float magnitude[MAX_AUDIO_CHANNELS],
+                                 const float peak[MAX_AUDIO_CHANNELS],
+                                 const float input_peak[MAX_AUDIO_CHANNELS]);
+    static void OnSourceGone(void* data, calldata_t* cd);
+    static void OnSourceRename(void* data, calldata_t* cd);
+    static void ResetSlot(AudioMeterSlot& slot);
+    void FreeSlot(AudioMeterSlot& slot);
+
+    AudioMeterSlot slots_[kMaxSlots];
+    mutable std::mutex mutex_;
+    std::atomic<uint64_t> layout_version_{0};
+    std::atomic<float> decay_rate_{kDefaultDecayRate};
+    std::atomic<uint64_t> peak_hold_ns_{(uint64_t)(kDefaultPeakHoldSeconds * 1e9f)};
+    bool connected_ = false;
+};
@@ -27,37 +27,177 @@ async function setupDb() {
         CREATE TABLE IF NOT EXISTS app_state (
             key TEXT PRIMARY KEY,
             value TEXT NOT NULL
+        );
+        CREATE TABLE IF NOT EXISTS scene_journal (
+            seq INTEGER PRIMARY KEY AUTOINCREMENT,
+            version INTEGER NOT NULL,
+            delta TEXT NOT NULL
         )
     `);
     console.log('Database setup complete.');
 }
 
+// `state` is the scene collection object or its JSON text.
 async function saveState(state) {
     const db = await openDb();
-    const jsonState = JSON.stringify(state);
-    await db.run(
-        "INSERT OR REPLACE INTO app_state (key, value) VALUES (?, ?)",
-        'full_scene_collection',
-        jsonState
-    );
+    const jsonState = typeof state === 'string' ? state : JSON.stringify(state);
+    // A full snapshot supersedes every journaled delta.
+    await db.exec('BEGIN');
+    try {
+        await db.run(
+            "INSERT OR REPLACE INTO app_state (key, value) VALUES (?, ?)",
+            'full_scene_collection',
+            jsonState
+        );
+        await db.run("DELETE FROM scene_journal");
+        await db.exec('COMMIT');
+        journalRows = 0;
+    } catch (error) {
+        await db.exec('ROLLBACK');
+        throw error;
+    }
     console.log('Application state saved.');
 }
 
+async function loadSnapshotJson(db) {
+    const result = await db.get("SELECT value FROM app_state WHERE key = ?", 'full_scene_collection');
+    return result ? result.value : null;
+}
+
+async function loadSnapshot(db) {
+    const json = await loadSnapshotJson(db);
+    return json ? JSON.parse(json) : null;
+}
+
+// Folds a delta from core.getSceneDelta() into a full scene collection.
+function applyDelta(state, delta) {
+    if (delta.full || !state) {
+        return { program: delta.program, preview: delta.preview, scenes: delta.scenes };
+    }
+    const scenes = new Map(state.scenes.map(scene => [scene.name, scene]));
+    for (const name of delta.removed) scenes.delete(name);
+    for (const scene of delta.scenes) scenes.set(scene.name, scene);
+    // Scenes missing from `order` were never persisted by libobs; keep them last.
+    const ordered = delta.order.filter(name => scenes.has(name)).map(name => scenes.get(name));
+    for (const scene of scenes.values()) {
+        if (!delta.order.includes(scene.name)) ordered.push(scene);
+    }
+    return { program: delta.program, preview: delta.preview, scenes: ordered };
+}
+
+async function loadJournal(db) {
+    const rows = await db.all("SELECT delta FROM scene_journal ORDER BY seq");
+    return rows.map(row => JSON.parse(row.delta));
+}
+
 async function loadState() {
     const db = await openDb();
-    const result = await db.get("SELECT value FROM app_state WHERE key = ?", 'full_scene_collection');
+    let state = await loadSnapshot(db);
+    for (const delta of await loadJournal(db)) {
+        state = applyDelta(state, delta);
+    }
 
-    if (result) {
+    if (state) {
         console.log('Application state loaded.');
-        return JSON.parse(result.value);
+        return state;
     }
 
     console.log('No saved state found.');
     return null;
 }
 
+// Same state as loadState(), as JSON text for core.loadFullSceneDataAsync().
+// With an empty journal the stored text is returned untouched, so it is
+// never parsed in JS.
+async function loadStateJson() {
+    const db = await openDb();
+    const journalCount = (await db.get("SELECT COUNT(*) AS count FROM scene_journal")).count;
+    if (journalCount === 0) {
+        const json = await loadSnapshotJson(db);
+        console.log(json ? 'Application state loaded.' : 'No saved state found.');
+        return json;
+    }
+    const state = await loadState();
+    return state ? JSON.stringify(state) : null;
+}
+
+// Journal rows kept before appendDelta folds them into the snapshot.
+const JOURNAL_COMPACT_THRESHOLD = 200;
+let journalRows = null;
+
+// Persists only what changed. A full delta replaces the snapshot outright.
+// Deltas from getSceneDelta(v, { format: 'json' }) carry their document in
+// `json` and are stored as is.
+async function appendDelta(delta) {
+    const json = delta.json !== undefined ? delta.json : JSON.stringify(delta);
+    if (delta.full) {
+        await saveState(json);
+        return;
+    }
+    const db = await openDb();
+    await db.run("INSERT INTO scene_journal (version, delta) VALUES (?, ?)", delta.version, json);
+    if (journalRows === null) {
+        journalRows = (await db.get("SELECT COUNT(*) AS count FROM scene_journal")).count;
+    } else {
+        journalRows++;
+    }
+    if (journalRows >= JOURNAL_COMPACT_THRESHOLD) {
+        await compact();
+    }
+}
+
+// Replays the journal into the snapshot and empties it, in one transaction.
+async function compact() {
+    const db = await openDb();
+    await db.exec('BEGIN');
+    try {
+        const journal = await loadJournal(db);
+        if (journal.length > 0) {
+            let state = await loadSnapshot(db);
+            for (const delta of journal) {
+                state = applyDelta(state, delta);
+            }
+            await db.run(
+                "INSERT OR REPLACE INTO app_state (key, value) VALUES (?, ?)",
+                'full_scene_collection',
+                JSON.stringify(state)
+            );
+            await db.run("DELETE FROM scene_journal");
+        }
+        await db.exec('COMMIT');
+        journalRows = 0;
+    } catch (error) {
+        await db.exec('ROLLBACK');
+        throw error;
+    }
+}
+
+// Last core.benchmarkEncoders() result, reused on the next start so the
+// benchmark only has to run once per machine.
+async function saveEncoderBenchmark(result) {
+    const db = await openDb();
+    const saved = { ...result, savedAt: new Date().toISOString() };
+    await db.run(
+        "INSERT OR REPLACE INTO app_state (key, value) VALUES (?, ?)",
+        'encoder_benchmark',
+        JSON.stringify(saved)
+    );
+}
+
+async function loadEncoderBenchmark() {
+    const db = await openDb();
+    const result = await db.get("SELECT value FROM app_state WHERE key = ?", 'encoder_benchmark');
+    return result ? JSON.parse(result.value) : null;
+}
+
 module.exports = {
     openDb,
     saveState,
-    loadState
+    loadState,
+    loadStateJson,
+    appendDelta,
+    compact,
+    applyDelta,
+    saveEncoderBenchmark,
+    loadEncoderBenchmark
 };
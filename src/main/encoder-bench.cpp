@@ -0,0 +1,282 @@
+#include "encoder-bench.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <mutex>
+#include <thread>
+#include <util/platform.h>
+
+// x264 presets worth running live, slowest last. The rank is what the
+// recommendation maximizes.
+static const struct {
+    const char* name;
+    int rank;
+} kX264Presets[] = {
+    {"veryfast", 1}, {"faster", 2}, {"fast", 3}, {"medium", 4}, {"slow", 5},
+};
+// Texture-based hardware encoders land around x264 "fast" at the same
+// bitrate; other encoders (openh264, software fallbacks) below veryfast.
+static const int kHardwareRank = 3;
+static const int kOtherRank = 0;
+
+// A run holds the frame rate if it encoded nearly every frame and skipped
+// almost none, with some CPU left for everything else.
+static const double kMinEncodedRatio = 0.97;
+static const double kMaxSkippedRatio = 0.01;
+static const double kMaxCpuPercent = 90.0;
+
+obs_encoder_t* CreateVideoEncoder(const EncoderConfig& config, const char* name) {
+    obs_data_t* settings = obs_data_create();
+    obs_data_set_int(settings, "bitrate", config.bitrate);
+    obs_data_set_string(settings, "rate_control", "CBR");
+    if (!config.preset.empty()) obs_data_set_string(settings, "preset", config.preset.c_str());
+    if (config.threads && config.encoder_id == "obs_x264") {
+        obs_data_set_string(settings, "x264opts", ("threads=" + std::to_string(config.threads)).c_str());
+    }
+    obs_encoder_t* encoder = obs_video_encoder_create(config.encoder_id.c_str(), name, settings, nullptr);
+    obs_data_release(settings);
+    if (!encoder) return nullptr;
+
+    struct obs_video_info ovi;
+    if (config.width && config.height && obs_get_video_info(&ovi) &&
+        (config.width != ovi.output_width || config.height != ovi.output_height)) {
+        obs_encoder_set_scaled_size(encoder, config.width, config.height);
+        obs_encoder_set_gpu_scale_type(encoder, OBS_SCALE_BICUBIC);
+    }
+    if (config.frame_rate_divisor > 1) obs_encoder_set_frame_rate_divisor(encoder, config.frame_rate_divisor);
+    obs_encoder_set_video(encoder, obs_get_video());
+    return encoder;
+}
+
+uint32_t DefaultBitrate(uint32_t width, uint32_t height, uint32_t fps) {
+    // ~0.08 bits per pixel, rounded to 500 kbps.
+    double kbps = (double)width * height * fps * 0.08 / 1000.0;
+    uint32_t rounded = (uint32_t)std::lround(kbps / 500.0) * 500;
+    return std::clamp<uint32_t>(rounded, 2500, 20000);
+}
+
+struct BenchCandidate {
+    std::string encoder_id;
+    std::string preset;
+    int quality_rank;
+};
+
+// H.264 only: that is what the stream and record outputs take today.
+static std::vector<BenchCandidate> bench_candidates() {
+    std::vector<BenchCandidate> candidates;
+    const char* id;
+    for (size_t i = 0; obs_enum_encoder_types(i, &id); i++) {
+        if (obs_get_encoder_type(id) != OBS_ENCODER_VIDEO) continue;
+        const char* codec = obs_get_encoder_codec(id);
+        if (!codec || strcmp(codec, "h264") != 0) continue;
+        uint32_t caps = obs_get_encoder_caps(id);
+        if (caps & (OBS_ENCODER_CAP_DEPRECATED | OBS_ENCODER_CAP_INTERNAL)) continue;
+
+        if (strcmp(id, "obs_x264") == 0) {
+            for (auto const& preset : kX264Presets) candidates.push_back({id, preset.name, preset.rank});
+        } else {
+            int rank = (caps & OBS_ENCODER_CAP_PASS_TEXTURE) ? kHardwareRank : kOtherRank;
+            candidates.push_back({id, "", rank});
+        }
+    }
+    return candidates;
+}
+
+// Longest an encoder may take to emit its first packet (startup plus
+// lookahead) before the run counts as failed.
+static const double kMaxStartupSec = 10.0;
+
+// Filled from the output's packet callback, on the output's thread.
+struct PacketStats {
+    std::mutex mutex;
+    std::vector<uint64_t> encode_ns;
+    uint64_t frames = 0;
+    uint64_t bytes = 0;
+    uint64_t first_packet_ns = 0;
+};
+
+static void collect_packet(obs_output_t*, struct encoder_packet* packet, struct encoder_packet_time* time,
+                           void* param) {
+    if (packet->type != OBS_ENCODER_VIDEO) return;
+    auto* stats = static_cast<PacketStats*>(param);
+    std::lock_guard<std::mutex> lock(stats->mutex);
+    if (!stats->first_packet_ns) stats->first_packet_ns = os_gettime_ns();
+    stats->frames++;
+    stats->bytes += packet->size;
+    if (time && time->fer && time->ferc >= time->fer) stats->encode_ns.push_back(time->ferc - time->fer);
+}
+
+static void wait_for_stop(obs_output_t* output) {
+    for (int i = 0; i < 100 && obs_output_active(output); i++) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    }
+}
+
+static EncoderBenchResult run_bench(const EncoderConfig& config, uint32_t fps, double duration_sec) {
+    EncoderBenchResult result;
+    result.config = config;
+    result.fps = fps;
+
+    obs_encoder_t* video_encoder = CreateVideoEncoder(config, "titan_bench_video");
+    obs_encoder_t* audio_encoder = obs_audio_encoder_create("ffmpeg_aac", "titan_bench_audio", nullptr, 0, nullptr);
+    obs_output_t* output = obs_output_create("null_output", "titan_bench_output", nullptr, nullptr);
+    if (!video_encoder || !audio_encoder || !output) {
+        result.error = !video_encoder ? "Failed to create video encoder."
+                       : !audio_encoder ? "Failed to create audio encoder."
+                                        : "Failed to create null output.";
+        obs_output_release(output);
+        obs_encoder_release(video_encoder);
+        obs_encoder_release(audio_encoder);
+        return result;
+    }
+    obs_encoder_set_audio(audio_encoder, obs_get_audio());
+    obs_output_set_video_encoder(output, video_encoder);
+    obs_output_set_audio_encoder(output, audio_encoder, 0);
+
+    PacketStats stats;
+    stats.encode_ns.reserve((size_t)(duration_sec * fps * 1.25));
+    obs_output_add_packet_callback(output, collect_packet, &stats);
+
+    // Measures steady state only: the window starts at the first packet, so
+    // encoder startup and lookahead (x264 rc-lookahead, B-frames, frame
+    // threads) don't count as missing frames, and it ends before the stop,
+    // which does not flush the frames still in the encoder.
+    os_cpu_usage_info_t* cpu = nullptr;
+    uint64_t window_start_ns = 0, window_end_ns = 0, window_frames = 0, window_first_frames = 0;
+    if (obs_output_start(output)) {
+        // The encoder's own video (scaled or divided) only exists once started.
+        video_t* video = obs_encoder_video(video_encoder);
+        uint32_t skipped_before = 0, lagged_before = 0;
+        uint64_t start_ns = os_gettime_ns();
+
+        while (obs_output_active(output)) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(50));
+            uint64_t now = os_gettime_ns();
+            uint64_t first_packet_ns, frames;
+            {
+                std::lock_guard<std::mutex> lock(stats.mutex);
+                first_packet_ns = stats.first_packet_ns;
+                frames = stats.frames;
+            }
+            if (!first_packet_ns) {
+                if (now - start_ns > (uint64_t)(kMaxStartupSec * 1e9)) break;
+                continue;
+            }
+            if (!window_start_ns) {
+                window_start_ns = now;
+                window_first_frames = frames;
+                skipped_before = video ? video_output_get_skipped_frames(video) : 0;
+                lagged_before = obs_get_lagged_frames();
+                cpu = os_cpu_usage_info_start();
+            } else if (now - window_start_ns >= (uint64_t)(duration_sec * 1e9)) {
+                window_end_ns = now;
+                window_frames = frames - window_first_frames;
+                break;
+            }
+        }
+
+        if (!window_start_ns) {
+            result.error = obs_output_active(output) ? "The encoder produced no packets." : "Output stopped during the run.";
+        } else if (!window_end_ns) {
+            result.error = "Output stopped during the run.";
+        } else {
+            result.frames_skipped = video ? video_output_get_skipped_frames(video) - skipped_before : 0;
+            result.frames_lagged = obs_get_lagged_frames() - lagged_before;
+            result.cpu_percent = os_cpu_usage_info_query(cpu);
+        }
+        obs_output_stop(output);
+        wait_for_stop(output);
+    } else {
+        const char* error = obs_output_get_last_error(output);
+        result.error = error ? error : "Failed to start null output.";
+    }
+    if (cpu) os_cpu_usage_info_destroy(cpu);
+
+    obs_output_remove_packet_callback(output, collect_packet, &stats);
+    obs_output_release(output);
+    obs_encoder_release(video_encoder);
+    obs_encoder_release(audio_encoder);
+
+    std::lock_guard<std::mutex> lock(stats.mutex);
+    if (window_end_ns) {
+        result.frames_expected = (uint64_t)std::llround((window_end_ns - window_start_ns) / 1e9 * fps);
+        result.frames_encoded = window_frames;
+    }
+    if (stats.frames) result.bytes_per_frame = (double)stats.bytes / stats.frames;
+    if (!stats.encode_ns.empty()) {
+        std::vector<uint64_t>& times = stats.encode_ns;
+        uint64_t total = 0;
+        for (uint64_t t : times) total += t;
+        result.encode_ms_avg = total / 1e6 / times.size();
+        std::nth_element(times.begin(), times.begin() + times.size() * 95 / 100, times.end());
+        result.encode_ms_p95 = times[times.size() * 95 / 100] / 1e6;
+        result.encode_ms_max = *std::max_element(times.begin(), times.end()) / 1e6;
+    }
+    result.holds_fps = result.error.empty() && result.frames_expected > 0 &&
+                       result.frames_encoded >= result.frames_expected * kMinEncodedRatio &&
+                       result.frames_skipped <= result.frames_expected * kMaxSkippedRatio &&
+                       result.cpu_percent <= kMaxCpuPercent;
+    return result;
+}
+
+std::vector<EncoderBenchResult> BenchmarkEncoders(const EncoderBenchOptions& options,
+                                                  const EncoderBenchProgressFn& progress) {
+    std::vector<EncoderBenchResult> results;
+    struct obs_video_info ovi;
+    if (!obs_get_video() || !obs_get_video_info(&ovi) || !ovi.fps_den) return results;
+
+    uint32_t canvas_fps = (uint32_t)std::lround((double)ovi.fps_num / ovi.fps_den);
+    uint32_t divisor = 1;
+    if (options.fps && options.fps < canvas_fps) divisor = std::max<uint32_t>(1, canvas_fps / options.fps);
+    uint32_t fps = std::max<uint32_t>(1, canvas_fps / divisor);
+
+    std::vector<std::pair<uint32_t, uint32_t>> resolutions = options.resolutions;
+    if (resolutions.empty()) resolutions.push_back({ovi.output_width, ovi.output_height});
+
+    std::vector<BenchCandidate> candidates = bench_candidates();
+    size_t total = candidates.size() * resolutions.size();
+    size_t done = 0;
+    for (auto const& [width, height] : resolutions) {
+        for (auto const& candidate : candidates) {
+            if (progress) progress("benchmark", done, total);
+            EncoderConfig config;
+            config.encoder_id = candidate.encoder_id;
+            config.preset = candidate.preset;
+            config.width = width;
+            config.height = height;
+            config.bitrate = DefaultBitrate(width, height, fps);
+            config.frame_rate_divisor = divisor;
+            EncoderBenchResult result = run_bench(config, fps, options.duration_sec);
+            result.quality_rank = candidate.quality_rank;
+            results.push_back(std::move(result));
+            done++;
+        }
+    }
+    if (progress) progress("benchmark", done, total);
+    return results;
+}
+
+int RecommendEncoderConfig(const std::vector<EncoderBenchResult>& results) {
+    int best = -1;
+    for (size_t i = 0; i < results.size(); i++) {
+        const EncoderBenchResult& result = results[i];
+        if (!result.holds_fps) continue;
+        if (best < 0) {
+            best = (int)i;
+            continue;
+        }
+        const EncoderBenchResult& current = results[best];
+        uint64_t pixels = (uint64_t)result.config.width * result.config.height;
+        uint64_t best_pixels = (uint64_t)current.config.width * current.config.height;
+        if (pixels != best_pixels) {
+            if (pixels > best_pixels) best = (int)i;
+        } else if (result.quality_rank != current.quality_rank) {
+            if (result.quality_rank > current.quality_rank) best = (int)i;
+        } else if (result.cpu_percent < current.cpu_percent) {
+            best = (int)i;
+        }
+    }
+    return best;
+}
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <obs.h>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+// Video encoder choice: encoder type, x264 preset and output size.
+struct EncoderConfig {
+    std::string encoder_id = "obs_x264";
+    std::string preset;      // x264 preset; empty: the encoder's default
+    uint32_t width = 0;      // 0: canvas size
+    uint32_t height = 0;
+    uint32_t bitrate = 2500; // kbps, CBR
+    uint32_t frame_rate_divisor = 1; // Encode every Nth canvas frame
+    uint32_t threads = 0;    // x264 only; 0: x264's default
+};
+
+// Creates a video encoder for `config` on the main video output, scaled on
+// the GPU when the config asks for a size other than the canvas.
+obs_encoder_t* CreateVideoEncoder(const EncoderConfig& config, const char* name);
+// Bitrate a benchmark run uses for a resolution and frame rate.
+uint32_t DefaultBitrate(uint32_t width, uint32_t height, uint32_t fps);
+
+struct EncoderBenchOptions {
+    double duration_sec = 5.0;                               // Per run
+    std::vector<std::pair<uint32_t, uint32_t>> resolutions;  // Empty: canvas size
+    uint32_t fps = 0;                                        // 0: canvas frame rate
+};
+
+struct EncoderBenchResult {
+    EncoderConfig config;
+    uint32_t fps = 0;              // Frame rate actually encoded
+    uint64_t frames_expected = 0;  // Over the window, from the first packet on
+    uint64_t frames_encoded = 0;
+    uint64_t frames_skipped = 0;   // Raw frames the encoder fell too far behind to get
+    uint64_t frames_lagged = 0;    // Frames the render thread missed meanwhile
+    double encode_ms_avg = 0.0;    // Frame submitted to packet out, per frame
+    double encode_ms_p95 = 0.0;
+    double encode_ms_max = 0.0;
+    double cpu_percent = 0.0;      // Whole process, all cores
+    double bytes_per_frame = 0.0;
+    int quality_rank = 0;          // Higher is better at the same bitrate
+    bool holds_fps = false;
+    std::string error;
+};
+
+using EncoderBenchProgressFn = std::function<void(const char* phase, size_t done, size_t total)>;
+
+// Runs every available H.264 encoder (x264 once per preset) at each
+// resolution against the current program output, through a null output,
+// so nothing is streamed or written. Runs one configuration at a time and
+// measures each for options.duration_sec once its first packet is out.
+// Requires a running video output.
+std::vector<EncoderBenchResult> BenchmarkEncoders(const EncoderBenchOptions& options,
+                                                  const EncoderBenchProgressFn& progress);
+// Index of the best result that held the frame rate: largest resolution,
+// then highest quality rank, then lowest CPU use. -1 if none did.
+int RecommendEncoderConfig(const std::vector<EncoderBenchResult>& results);
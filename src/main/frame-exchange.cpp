@@ -0,0 +1,140 @@
+#include "frame-exchange.h"
+
+#include <new>
+
+namespace {
+constexpr std::align_val_t kSlabAlignment{64};
+}
+
+FrameExchange::~FrameExchange() {
+    for (auto& slab : slabs_) {
+        if (slab && slab->data) {
+            ::operator delete[](slab->data, kSlabAlignment);
+        }
+    }
+}
+
+void FrameExchange::Reserve(FrameSlab* slab, size_t size) {
+    if (slab->capacity >= size) return;
+    if (slab->data) {
+        ::operator delete[](slab->data, kSlabAlignment);
+    }
+    slab->data = static_cast<uint8_t*>(::operator new[](size, kSlabAlignment));
+    slab->capacity = size;
+}
+
+FrameSlab* FrameExchange::TakeFreeSlab() {
+    FrameSlab* head = free_head_.load(std::memory_order_acquire);
+    while (head && !free_head_.compare_exchange_weak(head, head->next_free,
+                                                    std::memory_order_acquire,
+                                                    std::memory_order_acquire)) {
+    }
+    if (head) return head;
+
+    size_t count = slab_count_.load(std::memory_order_relaxed);
+    if (count == kMaxSlabs) return nullptr;
+
+    slabs_[count] = std::make_unique<FrameSlab>();
+    slabs_[count]->owner = this;
+    slab_count_.store(count + 1, std::memory_order_relaxed);
+    return slabs_[count].get();
+}
+
+void FrameExchange::PushFree(FrameSlab* slab) {
+    FrameSlab* head = free_head_.load(std::memory_order_relaxed);
+    do {
+        slab->next_free = head;
+    } while (!free_head_.compare_exchange_weak(head, slab,
+                                               std::memory_order_release,
+                                               std::memory_order_relaxed));
+}
+
+void FrameExchange::Release(FrameSlab* slab) {
+    if (slab->refs.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        slab->owner->PushFree(slab);
+    }
+}
+
+FrameSlab* FrameExchange::BeginWrite(size_t size) {
+    // The back slab may still be referenced by a Buffer JS got earlier. Swap
+    // it out for a free one instead of writing underneath the reader.
+    if (!back_ || back_->refs.load(std::memory_order_acquire) != 1) {
+        FrameSlab* fresh = TakeFreeSlab();
+        if (!fresh) {
+            dropped_frames_.fetch_add(1, std::memory_order_relaxed);
+            return nullptr;
+        }
+        fresh->refs.store(1, std::memory_order_relaxed);
+        if (back_) Release(back_);
+        back_ = fresh;
+    }
+
+    Reserve(back_, size);
+    back_->size = size;
+    return back_;
+}
+
+bool FrameExchange::Publish(uint64_t timestamp_ns, uint64_t content_hash) {
+    if (!back_) return false;
+
+    // The same bytes in another layout (RGBA and BGRA of a grey frame, or
+    // another colorspace) are a different frame: JS must see its metadata.
+    bool empty = back_->size == 0;
+    // Colorspace and range are left over from older frames in RGBA slabs.
+    bool same_layout = back_->width == last_width_ && back_->height == last_height_ &&
+                       back_->format == last_format_ &&
+                       (!IsYuvFormat(back_->format) ||
+                        (back_->colorspace == last_colorspace_ && back_->range == last_range_));
+    if (has_published_ && empty == last_empty_ && content_hash == last_hash_ && same_layout) {
+        return false; // Same picture as last time, nothing new for JS
+    }
+    has_published_ = true;
+    last_empty_ = empty;
+    last_hash_ = content_hash;
+    last_width_ = back_->width;
+    last_height_ = back_->height;
+    last_format_ = back_->format;
+    last_colorspace_ = back_->colorspace;
+    last_range_ = back_->range;
+
+    back_->sequence = sequence_.load(std::memory_order_relaxed) + 1;
+    back_->timestamp_ns = timestamp_ns;
+    back_->content_hash = content_hash;
+
+    FrameSlab* published = back_;
+    last_published_ = published;
+    uintptr_t previous = middle_.exchange(reinterpret_cast<uintptr_t>(published) | kFreshBit,
+                                          std::memory_order_acq_rel);
+    back_ = reinterpret_cast<FrameSlab*>(previous & ~kFreshBit);
+    sequence_.store(published->sequence, std::memory_order_release);
+    return true;
+}
+
+FrameSlab* FrameExchange::PublishEmpty(uint64_t timestamp_ns) {
+    if (has_published_ && last_empty_) return nullptr;
+
+    FrameSlab* slab = BeginWrite(0);
+    if (!slab) return nullptr;
+    slab->width = 0;
+    slab->height = 0;
+    slab->stride = 0;
+    return Publish(timestamp_ns, 0) ? slab : nullptr;
+}
+
+FrameSlab* FrameExchange::AcquirePublished() {
+    if (!last_published_) return nullptr;
+    last_published_->refs.fetch_add(1, std::memory_order_relaxed);
+    return last_published_;
+}
+
+FrameSlab* FrameExchange::AcquireLatest() {
+    if (middle_.load(std::memory_order_acquire) & kFreshBit) {
+        uintptr_t latest = middle_.exchange(reinterpret_cast<uintptr_t>(front_),
+                                            std::memory_order_acq_rel);
+        front_ = reinterpret_cast<FrameSlab*>(latest & ~kFreshBit);
+    }
+
+    if (!front_ || front_->size == 0) return nullptr;
+    front_->refs.fetch_add(1, std::memory_order_relaxed);
+    return front_;
+}
@@ -0,0 +1,120 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include "pixel-convert.h"
+
+class FrameExchange;
+
+// A pooled, reference-counted frame buffer. The exchange itself holds one
+// reference while the slab sits in the triple buffer; every Buffer handed to
+// JS holds another one, dropped again by the buffer's finalizer.
+struct FrameSlab {
+    uint8_t* data = nullptr;
+    size_t capacity = 0;
+    size_t size = 0;
+    uint32_t width = 0;
+    uint32_t height = 0;
+    uint32_t stride = 0;
+    FrameFormat format = FrameFormat::RGBA;
+    // Only meaningful for YUV formats.
+    YuvColorspace colorspace = YuvColorspace::BT709;
+    YuvRange range = YuvRange::Limited;
+    // Monotonic per exchange; only bumped when the content changed.
+    uint64_t sequence = 0;
+    uint64_t timestamp_ns = 0;
+    uint64_t content_hash = 0;
+
+    std::atomic<uint32_t> refs{0};
+    FrameSlab* next_free = nullptr;
+    FrameExchange* owner = nullptr;
+};
+
+// Lock-free triple buffer between the graphics thread (single producer) and
+// the JS thread (single consumer). The producer writes into its back slab and
+// publishes it with one atomic swap; the consumer picks up the newest
+// published slab with another swap. Slabs still referenced from JS are
+// swapped out of the ring and recycled through a free list once their last
+// Buffer is finalized, so neither side ever copies or waits on the other.
+class FrameExchange {
+public:
+    // Upper bound on slabs per exchange: three for the ring, the rest for
+    // frames JS is still holding on to.
+    static constexpr size_t kMaxSlabs = 8;
+
+    FrameExchange() = default;
+    ~FrameExchange();
+
+    FrameExchange(const FrameExchange&) = delete;
+    FrameExchange& operator=(const FrameExchange&) = delete;
+
+    // --- Producer (graphics thread) ---
+
+    // Returns a slab with at least `size` bytes that nobody else is reading,
+    // or nullptr if every slab is pinned by JS (the frame is then dropped).
+    FrameSlab* BeginWrite(size_t size);
+    // Makes the slab returned by BeginWrite the latest frame, stamping it
+    // with the next sequence number. Frames whose content hash, size,
+    // format, colorspace and range all match the last published frame are
+    // not published again; returns false then.
+    bool Publish(uint64_t timestamp_ns, uint64_t content_hash);
+    // Publishes an empty frame, e.g. when a view has nothing to show.
+    // Returns the slab, or nullptr if nothing changed or no slab was free.
+    FrameSlab* PublishEmpty(uint64_t timestamp_ns);
+
+    // Takes a reference on the newest published frame (possibly an empty
+    // one) from the producer side, for handing it to push subscribers.
+    // Producer thread only.
+    FrameSlab* AcquirePublished();
+
+    // --- Consumer (JS thread) ---
+
+    // Returns the newest published frame with an extra reference taken, or
+    // nullptr if there is none. Pair with FrameExchange::Release.
+    FrameSlab* AcquireLatest();
+
+    // Drops one reference; safe from any thread.
+    static void Release(FrameSlab* slab);
+
+    // Sequence number of the newest published frame; safe from any thread.
+    uint64_t latest_sequence() const { return sequence_.load(std::memory_order_acquire); }
+    uint64_t dropped_frames() const { return dropped_frames_.load(std::memory_order_relaxed); }
+    size_t allocated_slabs() const { return slab_count_.load(std::memory_order_relaxed); }
+
+private:
+    static constexpr uintptr_t kFreshBit = 1;
+
+    FrameSlab* TakeFreeSlab();
+    void PushFree(FrameSlab* slab);
+    static void Reserve(FrameSlab* slab, size_t size);
+
+    // Producer-owned.
+    FrameSlab* back_ = nullptr;
+    // Shared: slab pointer tagged with kFreshBit when it has not been
+    // picked up by the consumer yet.
+    std::atomic<uintptr_t> middle_{0};
+    // Consumer-owned.
+    FrameSlab* front_ = nullptr;
+
+    // Treiber stack; pushed from finalizers, popped by the producer only,
+    // which keeps it ABA-free.
+    std::atomic<FrameSlab*> free_head_{nullptr};
+
+    std::unique_ptr<FrameSlab> slabs_[kMaxSlabs];
+    std::atomic<size_t> slab_count_{0};
+    std::atomic<uint64_t> sequence_{0};
+    // Producer-owned: the last published frame. It is never the back slab,
+    // so the producer cannot overwrite it while it is still the newest.
+    FrameSlab* last_published_ = nullptr;
+    uint64_t last_hash_ = 0;
+    uint32_t last_width_ = 0;
+    uint32_t last_height_ = 0;
+    FrameFormat last_format_ = FrameFormat::RGBA;
+    YuvColorspace last_colorspace_ = YuvColorspace::BT709;
+    YuvRange last_range_ = YuvRange::Limited;
+    bool last_empty_ = false;
+    bool has_published_ = false;
+    std::atomic<uint64_t> dropped_frames_{0};
+};
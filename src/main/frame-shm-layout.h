@@ -0,0 +1,72 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+// Layout of the shared-memory program frame ring, shared by the publisher
+// in the addon (frame-shm.h) and the out-of-process reader library
+// (src/reader/frame-shm-reader.h). Plain data and lock-free atomics only,
+// so both sides can map it at different addresses.
+//
+//   [FrameShmHeader][FrameShmSlot 0][data 0][FrameShmSlot 1][data 1]...
+//
+// Each slot is kFrameShmAlign-aligned and holds one frame. The publisher
+// writes the slots round-robin: it clears the slot's sequence, writes the
+// pixels and metadata, stores the frame's sequence in the slot and then in
+// header.latest, and bumps header.futex_word to wake waiting readers
+// (FUTEX_WAKE on a shared mapping). Readers use the pixels in place and
+// check afterwards that the slot still carries the sequence they started
+// with; with slot_count slots they have slot_count - 1 frame times.
+
+static constexpr uint32_t kFrameShmMagic = 0x4d524654;  // "TFRM"
+static constexpr uint32_t kFrameShmVersion = 1;
+static constexpr size_t kFrameShmAlign = 4096;
+static constexpr const char* kFrameShmDefaultName = "/titan-program";
+
+enum FrameShmFormat : uint32_t {
+    FRAME_SHM_RGBA = 1,
+    FRAME_SHM_BGRA = 2,
+};
+
+// Publisher state in FrameShmHeader::state.
+enum FrameShmState : uint32_t {
+    FRAME_SHM_CLOSED = 0,
+    FRAME_SHM_RUNNING = 1,
+};
+
+struct FrameShmHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t header_size;          // sizeof(FrameShmHeader)
+    uint32_t slot_count;
+    uint64_t slot_stride;          // Bytes from one FrameShmSlot to the next
+    uint64_t data_capacity;        // Pixel bytes a slot holds
+    uint64_t slots_offset;         // Offset of slot 0 from the header
+    uint32_t publisher_pid;
+    std::atomic<uint32_t> state;   // FrameShmState
+    std::atomic<uint64_t> latest;  // Sequence of the newest complete frame, 0 for none
+    std::atomic<uint32_t> futex_word;  // Bumped on every frame and on close
+    std::atomic<uint32_t> waiters;     // Readers blocked on futex_word
+    std::atomic<uint64_t> frames_published;
+    std::atomic<uint64_t> frames_dropped;  // Larger than data_capacity
+};
+
+struct FrameShmSlot {
+    std::atomic<uint64_t> sequence;  // 0 while being written
+    uint64_t timestamp_ns;           // os_gettime_ns(): CLOCK_MONOTONIC
+    uint32_t width;
+    uint32_t height;
+    uint32_t stride;
+    uint32_t format;                 // FrameShmFormat
+    uint64_t size;                   // Pixel bytes, stride * height
+    // Pixel data follows at kFrameShmSlotDataOffset.
+};
+
+static constexpr size_t kFrameShmSlotDataOffset = 64;
+static_assert(sizeof(FrameShmSlot) <= kFrameShmSlotDataOffset, "slot header must fit before the pixels");
+static_assert(std::atomic<uint64_t>::is_always_lock_free, "shared atomics must be lock-free");
+
+inline size_t FrameShmAlignUp(size_t size) {
+    return (size + kFrameShmAlign - 1) & ~(kFrameShmAlign - 1);
+}
@@ -0,0 +1,163 @@
+#include "frame-shm.h"
+#include "profiler.h"
+
+#include <cerrno>
+#include <climits>
+#include <cstring>
+
+#ifdef __linux__
+#include <fcntl.h>
+#include <linux/futex.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+FrameShmPublisher::~FrameShmPublisher() {
+    Stop();
+}
+
+FrameShmSlot* FrameShmPublisher::SlotLocked(uint64_t sequence) const {
+    size_t index = (size_t)(sequence % header_->slot_count);
+    return reinterpret_cast<FrameShmSlot*>(base_ + header_->slots_offset + index * header_->slot_stride);
+}
+
+#ifdef __linux__
+
+static void futex_wake_all(std::atomic<uint32_t>* word) {
+    syscall(SYS_futex, reinterpret_cast<uint32_t*>(word), FUTEX_WAKE, INT_MAX, nullptr, nullptr, 0);
+}
+
+std::string FrameShmPublisher::Start(const std::string& name, uint32_t slots, size_t capacity) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (base_) return "Frame sharing is already running as " + name_ + ".";
+    if (name.size() < 2 || name[0] != '/' || name.find('/', 1) != std::string::npos) {
+        return "Segment name must be a single '/name'.";
+    }
+
+    size_t header_size = FrameShmAlignUp(sizeof(FrameShmHeader));
+    size_t slot_stride = FrameShmAlignUp(kFrameShmSlotDataOffset + capacity);
+    size_t total = header_size + slot_stride * slots;
+
+    // A publisher that crashed leaves its segment behind; readers still
+    // holding it just see no new frames.
+    shm_unlink(name.c_str());
+    int fd = shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+    if (fd < 0) return "shm_open(" + name + ") failed: " + strerror(errno);
+    if (ftruncate(fd, (off_t)total) != 0) {
+        std::string error = std::string("ftruncate failed: ") + strerror(errno);
+        close(fd);
+        shm_unlink(name.c_str());
+        return error;
+    }
+    void* base = mmap(nullptr, total, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (base == MAP_FAILED) {
+        shm_unlink(name.c_str());
+        return std::string("mmap failed: ") + strerror(errno);
+    }
+
+    // ftruncate zero-fills, so every atomic starts out at 0.
+    base_ = static_cast<uint8_t*>(base);
+    mapped_size_ = total;
+    name_ = name;
+    header_ = reinterpret_cast<FrameShmHeader*>(base_);
+    header_->version = kFrameShmVersion;
+    header_->header_size = sizeof(FrameShmHeader);
+    header_->slot_count = slots;
+    header_->slot_stride = slot_stride;
+    header_->data_capacity = slot_stride - kFrameShmSlotDataOffset;
+    header_->slots_offset = header_size;
+    header_->publisher_pid = (uint32_t)getpid();
+    header_->state.store(FRAME_SHM_RUNNING, std::memory_order_relaxed);
+    // Readers check the magic last; publish it after everything else.
+    std::atomic_thread_fence(std::memory_order_release);
+    header_->magic = kFrameShmMagic;
+    next_sequence_ = 1;
+    active_.store(true, std::memory_order_relaxed);
+    return "";
+}
+
+void FrameShmPublisher::Stop() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!base_) return;
+    active_.store(false, std::memory_order_relaxed);
+    header_->state.store(FRAME_SHM_CLOSED, std::memory_order_release);
+    header_->futex_word.fetch_add(1, std::memory_order_release);
+    futex_wake_all(&header_->futex_word);
+    munmap(base_, mapped_size_);
+    shm_unlink(name_.c_str());
+    base_ = nullptr;
+    header_ = nullptr;
+    mapped_size_ = 0;
+}
+
+void FrameShmPublisher::Publish(const uint8_t* data, uint32_t linesize, uint32_t width, uint32_t height,
+                                FrameShmFormat format, uint64_t timestamp_ns) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!base_) return;
+
+    uint32_t stride = width * 4;
+    uint64_t size = (uint64_t)stride * height;
+    if (size > header_->data_capacity) {
+        header_->frames_dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    uint64_t sequence = next_sequence_++;
+    FrameShmSlot* slot = SlotLocked(sequence);
+    // Readers still on the old frame in this slot see the change and retry.
+    slot->sequence.store(0, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    {
+        TITAN_PROFILE_SCOPE("render.shm_copy");
+        uint8_t* pixels = reinterpret_cast<uint8_t*>(slot) + kFrameShmSlotDataOffset;
+        if (linesize == stride) {
+            memcpy(pixels, data, size);
+        } else {
+            for (uint32_t y = 0; y < height; y++) {
+                memcpy(pixels + (size_t)y * stride, data + (size_t)y * linesize, stride);
+            }
+        }
+    }
+    slot->timestamp_ns = timestamp_ns;
+    slot->width = width;
+    slot->height = height;
+    slot->stride = stride;
+    slot->format = format;
+    slot->size = size;
+    slot->sequence.store(sequence, std::memory_order_release);
+    header_->latest.store(sequence, std::memory_order_release);
+    header_->frames_published.fetch_add(1, std::memory_order_relaxed);
+
+    // Pairs with the reader registering as a waiter before it re-checks latest.
+    header_->futex_word.fetch_add(1, std::memory_order_seq_cst);
+    if (header_->waiters.load(std::memory_order_seq_cst) > 0) futex_wake_all(&header_->futex_word);
+}
+
+#else
+
+std::string FrameShmPublisher::Start(const std::string&, uint32_t, size_t) {
+    return "Shared-memory frames are only supported on Linux.";
+}
+
+void FrameShmPublisher::Stop() {}
+
+void FrameShmPublisher::Publish(const uint8_t*, uint32_t, uint32_t, uint32_t, FrameShmFormat, uint64_t) {}
+
+#endif
+
+FrameShmStats FrameShmPublisher::GetStats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    FrameShmStats stats;
+    if (!header_) return stats;
+    stats.active = true;
+    stats.name = name_;
+    stats.slots = header_->slot_count;
+    stats.slot_capacity = header_->data_capacity;
+    stats.published = header_->frames_published.load(std::memory_order_relaxed);
+    stats.dropped = header_->frames_dropped.load(std::memory_order_relaxed);
+    stats.waiters = header_->waiters.load(std::memory_order_relaxed);
+    return stats;
+}
@@ -0,0 +1,64 @@
+#pragma once
+
+#include "frame-shm-layout.h"
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <string>
+
+struct FrameShmStats {
+    bool active = false;
+    std::string name;
+    uint32_t slots = 0;
+    uint64_t slot_capacity = 0;    // Largest frame in bytes
+    uint64_t published = 0;
+    uint64_t dropped = 0;          // Frames larger than slot_capacity
+    uint32_t waiters = 0;          // Readers blocked waiting for a frame
+};
+
+// Publishes program frames into a POSIX shared-memory ring (layout in
+// frame-shm-layout.h) for other local processes: monitoring and QC tools
+// open it by name with FrameShmReader and read frames in place, at no cost
+// to the JS thread. The graphics thread copies each mapped readback into
+// the next slot and wakes blocked readers with one futex call, skipped
+// while nobody is waiting.
+//
+// Linux only; elsewhere Start() reports that it is unsupported.
+class FrameShmPublisher {
+public:
+    static constexpr uint32_t kDefaultSlots = 4;
+    static constexpr uint32_t kMaxSlots = 16;
+
+    FrameShmPublisher() = default;
+    ~FrameShmPublisher();
+
+    FrameShmPublisher(const FrameShmPublisher&) = delete;
+    FrameShmPublisher& operator=(const FrameShmPublisher&) = delete;
+
+    // Creates segment `name` ("/titan-program") with `slots` slots of
+    // `capacity` pixel bytes each, replacing a stale one of the same name.
+    // Returns an error message, or "" on success.
+    std::string Start(const std::string& name, uint32_t slots, size_t capacity);
+    // Marks the segment closed, wakes readers and unlinks it. Readers that
+    // still have it mapped keep their mapping.
+    void Stop();
+    bool active() const { return active_.load(std::memory_order_relaxed); }
+
+    // Graphics thread: copies one mapped frame into the next slot.
+    void Publish(const uint8_t* data, uint32_t linesize, uint32_t width, uint32_t height, FrameShmFormat format,
+                 uint64_t timestamp_ns);
+
+    FrameShmStats GetStats() const;
+
+private:
+    FrameShmSlot* SlotLocked(uint64_t sequence) const;
+
+    mutable std::mutex mutex_;  // Start/Stop against Publish
+    std::string name_;
+    uint8_t* base_ = nullptr;
+    size_t mapped_size_ = 0;
+    FrameShmHeader* header_ = nullptr;
+    uint64_t next_sequence_ = 1;
+    std::atomic<bool> active_{false};
+};
@@ -0,0 +1,133 @@
+#include "gpu-readback.h"
+
+void GpuReadback::SetLatency(uint32_t frames) {
+    latency_.store(frames > kMaxLatency ? kMaxLatency : frames, std::memory_order_relaxed);
+}
+
+GpuReadbackStats GpuReadback::GetStats() const {
+    GpuReadbackStats stats;
+    stats.latency = latency_.load(std::memory_order_relaxed);
+    stats.frames_staged = frames_staged_.load(std::memory_order_relaxed);
+    stats.frames_mapped = frames_mapped_.load(std::memory_order_relaxed);
+    stats.stalls_avoided = stalls_avoided_.load(std::memory_order_relaxed);
+    stats.sync_maps = sync_maps_.load(std::memory_order_relaxed);
+    stats.map_failures = map_failures_.load(std::memory_order_relaxed);
+    return stats;
+}
+
+void GpuReadback::Reset() {
+    for (uint32_t i = 0; i < kMaxDepth; i++) {
+        staged_at_[i] = 0;
+    }
+}
+
+void GpuReadback::Destroy() {
+    Unmap();
+    for (uint32_t i = 0; i < kMaxDepth; i++) {
+        if (surfaces_[i]) {
+            gs_stagesurface_destroy(surfaces_[i]);
+            surfaces_[i] = nullptr;
+        }
+        staged_at_[i] = 0;
+    }
+    depth_ = 0;
+    width_ = 0;
+    height_ = 0;
+    format_ = GS_UNKNOWN;
+}
+
+bool GpuReadback::EnsureSurfaces(gs_texture_t* texture, uint32_t depth) {
+    uint32_t width = gs_texture_get_width(texture);
+    uint32_t height = gs_texture_get_height(texture);
+    gs_color_format format = gs_texture_get_color_format(texture);
+
+    if (width == width_ && height == height_ && format == format_ && depth == depth_) {
+        return true;
+    }
+
+    // Size, format or depth changed: everything in flight is stale.
+    Destroy();
+    for (uint32_t i = 0; i < depth; i++) {
+        surfaces_[i] = gs_stagesurface_create(width, height, format);
+        if (!surfaces_[i]) {
+            Destroy();
+            return false;
+        }
+    }
+    depth_ = depth;
+    width_ = width;
+    height_ = height;
+    format_ = format;
+    return true;
+}
+
+bool GpuReadback::Stage(gs_texture_t* texture) {
+    Unmap();
+
+    uint32_t latency = latency_.load(std::memory_order_relaxed);
+    if (!EnsureSurfaces(texture, latency + 1)) {
+        map_failures_.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    frame_++;
+    uint32_t write_idx = (uint32_t)(frame_ % depth_);
+    gs_stage_texture(surfaces_[write_idx], texture);
+    staged_at_[write_idx] = frame_;
+    frames_staged_.fetch_add(1, std::memory_order_relaxed);
+    return true;
+}
+
+bool GpuReadback::MapLatest(uint8_t** data, uint32_t* linesize) {
+    Unmap();
+
+    uint32_t latest = kMaxDepth;
+    for (uint32_t i = 0; i < depth_; i++) {
+        if (staged_at_[i] && (latest == kMaxDepth || staged_at_[i] > staged_at_[latest])) latest = i;
+    }
+    if (latest == kMaxDepth) return false;
+    // Whatever else is pending is older than what is shown now.
+    Reset();
+
+    if (!gs_stagesurface_map(surfaces_[latest], data, linesize)) {
+        map_failures_.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    mapped_ = surfaces_[latest];
+    frames_mapped_.fetch_add(1, std::memory_order_relaxed);
+    // The caller waited at least one output frame since staging it.
+    stalls_avoided_.fetch_add(1, std::memory_order_relaxed);
+    return true;
+}
+
+bool GpuReadback::StageAndMap(gs_texture_t* texture, uint8_t** data, uint32_t* linesize) {
+    if (!Stage(texture)) return false;
+
+    // With depth == latency + 1 the oldest surface is the next one to be
+    // overwritten, staged exactly `latency` frames ago.
+    uint32_t read_idx = (uint32_t)((frame_ + 1) % depth_);
+    if (staged_at_[read_idx] == 0) {
+        return false; // Pipeline still filling
+    }
+
+    if (!gs_stagesurface_map(surfaces_[read_idx], data, linesize)) {
+        map_failures_.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    mapped_ = surfaces_[read_idx];
+    frames_mapped_.fetch_add(1, std::memory_order_relaxed);
+    if (staged_at_[read_idx] < frame_) {
+        stalls_avoided_.fetch_add(1, std::memory_order_relaxed);
+    } else {
+        sync_maps_.fetch_add(1, std::memory_order_relaxed);
+    }
+    return true;
+}
+
+void GpuReadback::Unmap() {
+    if (mapped_) {
+        gs_stagesurface_unmap(mapped_);
+        mapped_ = nullptr;
+    }
+}
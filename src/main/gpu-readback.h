@@ -0,0 +1,87 @@
+#pragma once
+
+#include <obs.h>
+#include <atomic>
+#include <cstdint>
+
+struct GpuReadbackStats {
+    uint32_t latency;
+    uint64_t frames_staged;
+    uint64_t frames_mapped;
+    uint64_t stalls_avoided;
+    uint64_t sync_maps;
+    uint64_t map_failures;
+};
+
+// Pipelined GPU->CPU readback through a small ring of staging surfaces.
+// Every frame the source texture is copied into the next staging surface and
+// the surface staged `latency` frames earlier is mapped, so the GPU has had
+// that many frames to finish the copy and the map never waits on it.
+// A latency of 0 stages and maps the same surface (lowest latency, stalls
+// the graphics thread); higher values trade frames of delay for throughput.
+//
+// Everything except SetLatency/GetStats must run on the graphics thread.
+class GpuReadback {
+public:
+    static constexpr uint32_t kMaxLatency = 2;
+    static constexpr uint32_t kDefaultLatency = 1;
+
+    GpuReadback() = default;
+    ~GpuReadback() = default;
+
+    GpuReadback(const GpuReadback&) = delete;
+    GpuReadback& operator=(const GpuReadback&) = delete;
+
+    // Copies `texture` into the ring and maps the oldest pending surface.
+    // Returns false while the pipeline is still filling or if the map fails;
+    // on success the caller must call Unmap() before the next Stage().
+    bool StageAndMap(gs_texture_t* texture, uint8_t** data, uint32_t* linesize);
+    void Unmap();
+
+    // For views rendered below the output rate, where the surface staged
+    // `latency` calls earlier is a whole view interval old: Stage() copies
+    // `texture` without mapping anything, and the caller maps it with
+    // MapLatest() once `latency` output frames have passed. Returns false
+    // if the staging surfaces could not be created.
+    bool Stage(gs_texture_t* texture);
+    // Maps the most recently staged surface and drops the older ones.
+    // Returns false if nothing is staged or the map fails; on success the
+    // caller must call Unmap().
+    bool MapLatest(uint8_t** data, uint32_t* linesize);
+
+    // Drops the pending frames, e.g. when the source stops rendering.
+    void Reset();
+    // Frees the staging surfaces; requires the graphics context.
+    void Destroy();
+
+    uint32_t width() const { return width_; }
+    uint32_t height() const { return height_; }
+    gs_color_format format() const { return format_; }
+
+    // Takes effect on the next StageAndMap; safe from any thread.
+    void SetLatency(uint32_t frames);
+    uint32_t latency() const { return latency_.load(std::memory_order_relaxed); }
+    GpuReadbackStats GetStats() const;
+
+private:
+    static constexpr uint32_t kMaxDepth = kMaxLatency + 1;
+
+    bool EnsureSurfaces(gs_texture_t* texture, uint32_t depth);
+
+    gs_stagesurf_t* surfaces_[kMaxDepth] = {};
+    // Frame number each surface was staged at, 0 when empty.
+    uint64_t staged_at_[kMaxDepth] = {};
+    uint32_t depth_ = 0;
+    uint32_t width_ = 0;
+    uint32_t height_ = 0;
+    gs_color_format format_ = GS_UNKNOWN;
+    uint64_t frame_ = 0;
+    gs_stagesurf_t* mapped_ = nullptr;
+
+    std::atomic<uint32_t> latency_{kDefaultLatency};
+    std::atomic<uint64_t> frames_staged_{0};
+    std::atomic<uint64_t> frames_mapped_{0};
+    std::atomic<uint64_t> stalls_avoided_{0};
+    std::atomic<uint64_t> sync_maps_{0};
+    std::atomic<uint64_t> map_failures_{0};
+};
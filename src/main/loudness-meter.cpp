@@ -0,0 +1,621 @@
+#include "loudness-meter.h"
+#include "profiler.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <util/platform.h>
+
+#ifndef TITAN_DISABLE_SIMD
+#define SIMDE_ENABLE_NATIVE_ALIASES
+#include <simde/x86/avx2.h>
+#endif
+
+// BS.1770 gates: blocks below -70 LUFS never count; integrated loudness
+// then drops blocks 10 LU below the ungated mean, loudness range (EBU Tech
+// 3342) drops short-term values 20 LU below it.
+static const double kAbsoluteGate = -70.0;
+static const double kIntegratedRelativeGate = -10.0;
+static const double kRangeRelativeGate = -20.0;
+static const double kHistogramMin = -70.0;
+static const double kHistogramStep = 0.1;
+static const double kPi = 3.14159265358979323846;
+
+// BS.1770-4 Annex 2 interpolation filter, one row per tap, holding the
+// coefficient of each of the four output phases.
+alignas(16) static const float kTruePeakPhases[12][4] = {
+    {0.0017089843750f, -0.0291748046875f, -0.0189208984375f, -0.0083007812500f},
+    {0.0109863281250f, 0.0292968750000f, 0.0330810546875f, 0.0148925781250f},
+    {-0.0196533203125f, -0.0517578125000f, -0.0582275390625f, -0.0266113281250f},
+    {0.0332031250000f, 0.0891113281250f, 0.1015625000000f, 0.0476074218750f},
+    {-0.0594482421875f, -0.1665039062500f, -0.2003173828125f, -0.1022949218750f},
+    {0.1373291015625f, 0.4650878906250f, 0.7797851562500f, 0.9721679687500f},
+    {0.9721679687500f, 0.7797851562500f, 0.4650878906250f, 0.1373291015625f},
+    {-0.1022949218750f, -0.2003173828125f, -0.1665039062500f, -0.0594482421875f},
+    {0.0476074218750f, 0.1015625000000f, 0.0891113281250f, 0.0332031250000f},
+    {-0.0266113281250f, -0.0582275390625f, -0.0517578125000f, -0.0196533203125f},
+    {0.0148925781250f, 0.0330810546875f, 0.0292968750000f, 0.0109863281250f},
+    {-0.0083007812500f, -0.0189208984375f, -0.0291748046875f, 0.0017089843750f},
+};
+
+static double loudness_of(double mean_square) {
+    return mean_square > 0.0 ? -0.691 + 10.0 * std::log10(mean_square) : -INFINITY;
+}
+
+static float to_db(float linear) {
+    return linear > 0.0f ? 20.0f * std::log10(linear) : -INFINITY;
+}
+
+uint32_t LoudnessChannelWeights(enum speaker_layout speakers, float weights[MAX_AUDIO_CHANNELS]) {
+    // OBS channel order: FL FR FC LFE RL RR SL SR (4.0 and 4.1 put the
+    // rear centre after FC/LFE).
+    static const float kStereo[] = {1.0f, 1.0f};
+    static const float k2Point1[] = {1.0f, 1.0f, 0.0f};
+    static const float k4Point0[] = {1.0f, 1.0f, 1.0f, 1.41f};
+    static const float k4Point1[] = {1.0f, 1.0f, 1.0f, 0.0f, 1.41f};
+    static const float k5Point1[] = {1.0f, 1.0f, 1.0f, 0.0f, 1.41f, 1.41f};
+    static const float k7Point1[] = {1.0f, 1.0f, 1.0f, 0.0f, 1.41f, 1.41f, 1.41f, 1.41f};
+
+    const float* layout;
+    uint32_t channels;
+    switch (speakers) {
+        case SPEAKERS_MONO: layout = kStereo; channels = 1; break;
+        case SPEAKERS_2POINT1: layout = k2Point1; channels = 3; break;
+        case SPEAKERS_4POINT0: layout = k4Point0; channels = 4; break;
+        case SPEAKERS_4POINT1: layout = k4Point1; channels = 5; break;
+        case SPEAKERS_5POINT1: layout = k5Point1; channels = 6; break;
+        case SPEAKERS_7POINT1: layout = k7Point1; channels = 8; break;
+        default: layout = kStereo; channels = 2; break;
+    }
+    for (uint32_t ch = 0; ch < MAX_AUDIO_CHANNELS; ch++) weights[ch] = ch < channels ? layout[ch] : 0.0f;
+    return channels;
+}
+
+// --- Histogram ---
+
+void LoudnessMeter::Histogram::Clear() {
+    memset(count, 0, sizeof(count));
+    memset(energy, 0, sizeof(energy));
+    total_count = 0;
+    total_energy = 0.0;
+}
+
+uint32_t LoudnessMeter::Histogram::BinFor(double loudness) {
+    double bin = std::floor((loudness - kHistogramMin) / kHistogramStep);
+    return (uint32_t)std::clamp(bin, 0.0, (double)(kHistogramBins - 1));
+}
+
+void LoudnessMeter::Histogram::Add(double loudness, double block_energy) {
+    uint32_t bin = BinFor(loudness);
+    count[bin]++;
+    energy[bin] += block_energy;
+    total_count++;
+    total_energy += block_energy;
+}
+
+// --- Meter ---
+
+LoudnessMeter::LoudnessMeter(uint32_t sample_rate, uint32_t channels, const float* weights)
+    : sample_rate_(sample_rate),
+      channels_(std::min(std::max(channels, 1u), kMaxChannels)),
+      block_frames_(std::max(sample_rate / 10, 1u)),
+      momentary_blocks_(new Histogram),
+      short_term_blocks_(new Histogram),
+      silence_(kChunkFrames, 0.0f) {
+    for (uint32_t ch = 0; ch < kMaxChannels; ch++) weights_[ch] = ch < channels_ ? weights[ch] : 0.0;
+
+    // K-weighting for any sample rate (the BS.1770 coefficients are given
+    // for 48 kHz only): a high shelf for the head, then the RLB high-pass.
+    double fs = (double)sample_rate_;
+    double f0 = 1681.974450955533;
+    double gain = 3.999843853973347;
+    double q = 0.7071752369554196;
+    double k = std::tan(kPi * f0 / fs);
+    double vh = std::pow(10.0, gain / 20.0);
+    double vb = std::pow(vh, 0.4996667741545416);
+    double a0 = 1.0 + k / q + k * k;
+    shelf_b_[0] = (vh + vb * k / q + k * k) / a0;
+    shelf_b_[1] = 2.0 * (k * k - vh) / a0;
+    shelf_b_[2] = (vh - vb * k / q + k * k) / a0;
+    shelf_a_[0] = 2.0 * (k * k - 1.0) / a0;
+    shelf_a_[1] = (1.0 - k / q + k * k) / a0;
+
+    f0 = 38.13547087602444;
+    q = 0.5003270373238773;
+    k = std::tan(kPi * f0 / fs);
+    a0 = 1.0 + k / q + k * k;
+    highpass_b_[0] = 1.0;
+    highpass_b_[1] = -2.0;
+    highpass_b_[2] = 1.0;
+    highpass_a_[0] = 2.0 * (k * k - 1.0) / a0;
+    highpass_a_[1] = (1.0 - k / q + k * k) / a0;
+
+    Reset();
+}
+
+void LoudnessMeter::Reset() {
+    for (uint32_t ch = 0; ch < kMaxChannels; ch++) {
+        shelf_z1_[ch] = shelf_z2_[ch] = 0.0;
+        highpass_z1_[ch] = highpass_z2_[ch] = 0.0;
+        block_sum_[ch] = 0.0;
+        true_peak_[ch] = 0.0f;
+    }
+    memset(peak_history_, 0, sizeof(peak_history_));
+    peak_pos_ = 0;
+    block_filled_ = 0;
+    memset(recent_, 0, sizeof(recent_));
+    blocks_ = 0;
+    momentary_ = short_term_ = integrated_ = -INFINITY;
+    momentary_max_ = short_term_max_ = -INFINITY;
+    range_ = 0.0;
+    momentary_blocks_->Clear();
+    short_term_blocks_->Clear();
+}
+
+void LoudnessMeter::Process(const float* const* planes, uint32_t frames) {
+    const float* chunk[kMaxChannels];
+    uint32_t done = 0;
+    while (done < frames) {
+        uint32_t count = std::min({frames - done, block_frames_ - block_filled_, kChunkFrames});
+        for (uint32_t ch = 0; ch < channels_; ch++) chunk[ch] = planes[ch] ? planes[ch] + done : silence_.data();
+        FilterChunk(chunk, count);
+        TruePeakChunk(chunk, count);
+        done += count;
+        block_filled_ += count;
+        if (block_filled_ == block_frames_) FinishBlock();
+    }
+}
+
+// K-weights every channel and adds up the squares for the current block.
+void LoudnessMeter::FilterChunk(const float* const* planes, uint32_t frames) {
+#ifndef TITAN_DISABLE_SIMD
+    // Both biquads in transposed direct form II, two channels per vector;
+    // an odd last channel is paired with silence (weight 0).
+    const __m128d sb0 = _mm_set1_pd(shelf_b_[0]), sb1 = _mm_set1_pd(shelf_b_[1]), sb2 = _mm_set1_pd(shelf_b_[2]);
+    const __m128d sa1 = _mm_set1_pd(shelf_a_[0]), sa2 = _mm_set1_pd(shelf_a_[1]);
+    const __m128d hb0 = _mm_set1_pd(highpass_b_[0]), hb1 = _mm_set1_pd(highpass_b_[1]);
+    const __m128d hb2 = _mm_set1_pd(highpass_b_[2]);
+    const __m128d ha1 = _mm_set1_pd(highpass_a_[0]), ha2 = _mm_set1_pd(highpass_a_[1]);
+    for (uint32_t ch = 0; ch < channels_; ch += 2) {
+        const float* left = planes[ch];
+        const float* right = ch + 1 < channels_ ? planes[ch + 1] : silence_.data();
+        __m128d s1 = _mm_load_pd(shelf_z1_ + ch), s2 = _mm_load_pd(shelf_z2_ + ch);
+        __m128d h1 = _mm_load_pd(highpass_z1_ + ch), h2 = _mm_load_pd(highpass_z2_ + ch);
+        __m128d sum = _mm_load_pd(block_sum_ + ch);
+        for (uint32_t i = 0; i < frames; i++) {
+            __m128d x = _mm_set_pd((double)right[i], (double)left[i]);
+            __m128d y = _mm_add_pd(_mm_mul_pd(sb0, x), s1);
+            s1 = _mm_add_pd(_mm_sub_pd(_mm_mul_pd(sb1, x), _mm_mul_pd(sa1, y)), s2);
+            s2 = _mm_sub_pd(_mm_mul_pd(sb2, x), _mm_mul_pd(sa2, y));
+            __m128d z = _mm_add_pd(_mm_mul_pd(hb0, y), h1);
+            h1 = _mm_add_pd(_mm_sub_pd(_mm_mul_pd(hb1, y), _mm_mul_pd(ha1, z)), h2);
+            h2 = _mm_sub_pd(_mm_mul_pd(hb2, y), _mm_mul_pd(ha2, z));
+            sum = _mm_add_pd(sum, _mm_mul_pd(z, z));
+        }
+        _mm_store_pd(shelf_z1_ + ch, s1);
+        _mm_store_pd(shelf_z2_ + ch, s2);
+        _mm_store_pd(highpass_z1_ + ch, h1);
+        _mm_store_pd(highpass_z2_ + ch, h2);
+        _mm_store_pd(block_sum_ + ch, sum);
+    }
+#else
+    for (uint32_t ch = 0; ch < channels_; ch++) {
+        const float* in = planes[ch];
+        double s1 = shelf_z1_[ch], s2 = shelf_z2_[ch];
+        double h1 = highpass_z1_[ch], h2 = highpass_z2_[ch];
+        double sum = block_sum_[ch];
+        for (uint32_t i = 0; i < frames; i++) {
+            double x = in[i];
+            double y = shelf_b_[0] * x + s1;
+            s1 = shelf_b_[1] * x - shelf_a_[0] * y + s2;
+            s2 = shelf_b_[2] * x - shelf_a_[1] * y;
+            double z = highpass_b_[0] * y + h1;
+            h1 = highpass_b_[1] * y - highpass_a_[0] * z + h2;
+            h2 = highpass_b_[2] * y - highpass_a_[1] * z;
+            sum += z * z;
+        }
+        shelf_z1_[ch] = s1;
+        shelf_z2_[ch] = s2;
+        highpass_z1_[ch] = h1;
+        highpass_z2_[ch] = h2;
+        block_sum_[ch] = sum;
+    }
+#endif
+    // Decaying state would otherwise turn denormal during long silences.
+    for (uint32_t ch = 0; ch < kMaxChannels; ch++) {
+        if (std::fabs(shelf_z1_[ch]) < 1e-30) shelf_z1_[ch] = 0.0;
+        if (std::fabs(shelf_z2_[ch]) < 1e-30) shelf_z2_[ch] = 0.0;
+        if (std::fabs(highpass_z1_[ch]) < 1e-30) highpass_z1_[ch] = 0.0;
+        if (std::fabs(highpass_z2_[ch]) < 1e-30) highpass_z2_[ch] = 0.0;
+    }
+}
+
+// Tracks the highest 4x-oversampled (and plain sample) peak per channel.
+void LoudnessMeter::TruePeakChunk(const float* const* planes, uint32_t frames) {
+    uint32_t end_pos = peak_pos_;
+    for (uint32_t ch = 0; ch < channels_; ch++) {
+        const float* in = planes[ch];
+        float* history = peak_history_[ch];
+        uint32_t pos = peak_pos_;
+#ifndef TITAN_DISABLE_SIMD
+        __m128 taps[kTruePeakTaps];
+        for (uint32_t k = 0; k < kTruePeakTaps; k++) taps[k] = _mm_load_ps(kTruePeakPhases[k]);
+        const __m128 abs_mask = _mm_castsi128_ps(_mm_set1_epi32(0x7fffffff));
+        __m128 peak = _mm_set1_ps(true_peak_[ch]);
+        for (uint32_t i = 0; i < frames; i++) {
+            pos = pos ? pos - 1 : kTruePeakTaps - 1;
+            history[pos] = history[pos + kTruePeakTaps] = in[i];
+            const float* window = history + pos;
+            __m128 x = _mm_set1_ps(window[0]);
+            __m128 acc = _mm_mul_ps(taps[0], x);
+            for (uint32_t k = 1; k < kTruePeakTaps; k++) {
+                acc = _mm_add_ps(acc, _mm_mul_ps(taps[k], _mm_set1_ps(window[k])));
+            }
+            peak = _mm_max_ps(peak, _mm_and_ps(acc, abs_mask));
+            peak = _mm_max_ps(peak, _mm_and_ps(x, abs_mask));
+        }
+        peak = _mm_max_ps(peak, _mm_shuffle_ps(peak, peak, _MM_SHUFFLE(2, 3, 0, 1)));
+        peak = _mm_max_ps(peak, _mm_shuffle_ps(peak, peak, _MM_SHUFFLE(1, 0, 3, 2)));
+        true_peak_[ch] = _mm_cvtss_f32(peak);
+#else
+        float peak = true_peak_[ch];
+        for (uint32_t i = 0; i < frames; i++) {
+            pos = pos ? pos - 1 : kTruePeakTaps - 1;
+            history[pos] = history[pos + kTruePeakTaps] = in[i];
+            const float* window = history + pos;
+            peak = std::max(peak, std::fabs(window[0]));
+            for (uint32_t phase = 0; phase < 4; phase++) {
+                float acc = 0.0f;
+                for (uint32_t k = 0; k < kTruePeakTaps; k++) acc += kTruePeakPhases[k][phase] * window[k];
+                peak = std::max(peak, std::fabs(acc));
+            }
+        }
+        true_peak_[ch] = peak;
+#endif
+        end_pos = pos;
+    }
+    peak_pos_ = end_pos;
+}
+
+void LoudnessMeter::FinishBlock() {
+    double energy = 0.0;
+    for (uint32_t ch = 0; ch < channels_; ch++) {
+        energy += weights_[ch] * block_sum_[ch] / block_frames_;
+        block_sum_[ch] = 0.0;
+    }
+    block_filled_ = 0;
+    recent_[blocks_ % kShortTermBlocks] = energy;
+    blocks_++;
+
+    // Momentary: 400 ms windows every 100 ms, i.e. the 75% overlapping
+    // gating blocks of the integrated measurement.
+    if (blocks_ >= 4) {
+        double sum = 0.0;
+        for (uint64_t i = blocks_ - 4; i < blocks_; i++) sum += recent_[i % kShortTermBlocks];
+        double mean = sum / 4.0;
+        momentary_ = loudness_of(mean);
+        momentary_max_ = std::max(momentary_max_, momentary_);
+        if (momentary_ > kAbsoluteGate) {
+            momentary_blocks_->Add(momentary_, mean);
+            UpdateIntegrated();
+        }
+    }
+    if (blocks_ >= kShortTermBlocks) {
+        double sum = 0.0;
+        for (double block : recent_) sum += block;
+        double mean = sum / kShortTermBlocks;
+        short_term_ = loudness_of(mean);
+        short_term_max_ = std::max(short_term_max_, short_term_);
+        if (short_term_ > kAbsoluteGate) {
+            short_term_blocks_->Add(short_term_, mean);
+            UpdateRange();
+        }
+    }
+}
+
+// The relative gate is applied at bin resolution: blocks in the bin that
+// holds the gate all count, which moves the result by far less than 0.1 LU.
+void LoudnessMeter::UpdateIntegrated() {
+    const Histogram& blocks = *momentary_blocks_;
+    if (blocks.total_count == 0) return;
+    double gate = loudness_of(blocks.total_energy / blocks.total_count) + kIntegratedRelativeGate;
+    uint64_t count = 0;
+    double energy = 0.0;
+    for (uint32_t bin = Histogram::BinFor(gate); bin < kHistogramBins; bin++) {
+        count += blocks.count[bin];
+        energy += blocks.energy[bin];
+    }
+    integrated_ = count ? loudness_of(energy / count) : -INFINITY;
+}
+
+// EBU Tech 3342: the spread between the 10th and 95th percentiles of the
+// gated short-term loudness.
+void LoudnessMeter::UpdateRange() {
+    const Histogram& values = *short_term_blocks_;
+    if (values.total_count == 0) return;
+    double gate = loudness_of(values.total_energy / values.total_count) + kRangeRelativeGate;
+    uint32_t first = Histogram::BinFor(gate);
+    uint64_t count = 0;
+    for (uint32_t bin = first; bin < kHistogramBins; bin++) count += values.count[bin];
+    if (count == 0) return;
+
+    uint64_t low_rank = (uint64_t)((count - 1) * 0.10 + 0.5);
+    uint64_t high_rank = (uint64_t)((count - 1) * 0.95 + 0.5);
+    double low = 0.0, high = 0.0;
+    uint64_t seen = 0;
+    for (uint32_t bin = first; bin < kHistogramBins; bin++) {
+        if (values.count[bin] == 0) continue;
+        uint64_t next = seen + values.count[bin];
+        double center = kHistogramMin + (bin + 0.5) * kHistogramStep;
+        if (seen <= low_rank && low_rank < next) low = center;
+        if (seen <= high_rank && high_rank < next) {
+            high = center;
+            break;
+        }
+        seen = next;
+    }
+    range_ = high - low;
+}
+
+// --- Table ---
+
+LoudnessTable::LoudnessTable() {
+    for (auto& slot : slots_) ResetSlot(slot);
+}
+
+void LoudnessTable::ResetSlot(LoudnessSlot& slot) {
+    const double silence = -INFINITY;
+    slot.momentary.store(silence, std::memory_order_relaxed);
+    slot.short_term.store(silence, std::memory_order_relaxed);
+    slot.integrated.store(silence, std::memory_order_relaxed);
+    slot.range.store(0.0, std::memory_order_relaxed);
+    slot.momentary_max.store(silence, std::memory_order_relaxed);
+    slot.short_term_max.store(silence, std::memory_order_relaxed);
+    for (auto& peak : slot.true_peak) peak.store(-INFINITY, std::memory_order_relaxed);
+    slot.blocks.store(0, std::memory_order_relaxed);
+    slot.updated_ns.store(0, std::memory_order_relaxed);
+    slot.reset_requested.store(false, std::memory_order_relaxed);
+    slot.published_blocks = 0;
+}
+
+void LoudnessTable::Connect() {
+    if (connected_) return;
+    signal_handler_t* handler = obs_get_signal_handler();
+    signal_handler_connect(handler, "source_remove", OnSourceGone, this);
+    signal_handler_connect(handler, "source_destroy", OnSourceGone, this);
+    signal_handler_connect(handler, "source_rename", OnSourceRename, this);
+    connected_ = true;
+}
+
+void LoudnessTable::Disconnect() {
+    if (connected_) {
+        signal_handler_t* handler = obs_get_signal_handler();
+        signal_handler_disconnect(handler, "source_remove", OnSourceGone, this);
+        signal_handler_disconnect(handler, "source_destroy", OnSourceGone, this);
+        signal_handler_disconnect(handler, "source_rename", OnSourceRename, this);
+        connected_ = false;
+    }
+    DetachAll();
+}
+
+uint32_t LoudnessTable::FindLocked(obs_source_t* source, int mix) const {
+    for (uint32_t i = 0; i < kMaxSlots; i++) {
+        const LoudnessSlot& slot = slots_[i];
+        if (!slot.in_use.load(std::memory_order_relaxed) || slot.mix != mix) continue;
+        if (mix >= 0 || obs_weak_source_references_source(slot.source, source)) return i;
+    }
+    return kInvalidIndex;
+}
+
+uint32_t LoudnessTable::AttachSource(obs_source_t* source) {
+    if (!source) return kInvalidIndex;
+    const char* name = obs_source_get_name(source);
+    return Attach(name ? name : "", -1, source);
+}
+
+uint32_t LoudnessTable::AttachMix(uint32_t mix) {
+    if (mix >= MAX_AUDIO_MIXES) return kInvalidIndex;
+    return Attach("Mix " + std::to_string(mix + 1), (int)mix, nullptr);
+}
+
+uint32_t LoudnessTable::Attach(const std::string& name, int mix, obs_source_t* source) {
+    // Mixes and source audio both arrive as float planar in the output's
+    // rate and layout.
+    struct obs_audio_info oai;
+    if (!obs_get_audio_info(&oai)) return kInvalidIndex;
+    float weights[MAX_AUDIO_CHANNELS];
+    uint32_t channels = LoudnessChannelWeights(oai.speakers, weights);
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    uint32_t existing = FindLocked(source, mix);
+    if (existing != kInvalidIndex) return existing;
+    uint32_t index = 0;
+    while (index < kMaxSlots && slots_[index].in_use.load(std::memory_order_relaxed)) index++;
+    if (index == kMaxSlots) {
+        blog(LOG_WARNING, "Loudness table is full, no meter for '%s'", name.c_str());
+        return kInvalidIndex;
+    }
+
+    // The slot is ready before the first callback can reach it.
+    LoudnessSlot& slot = slots_[index];
+    ResetSlot(slot);
+    slot.meter.reset(new LoudnessMeter(oai.samples_per_sec, channels, weights));
+    slot.channels.store(channels, std::memory_order_relaxed);
+    slot.name = name;
+    slot.mix = mix;
+    slot.in_use.store(true, std::memory_order_release);
+    if (source) {
+        slot.source = obs_source_get_weak_source(source);
+        obs_source_add_audio_capture_callback(source, SourceCallback, &slot);
+    } else {
+        obs_add_raw_audio_callback((size_t)mix, nullptr, MixCallback, &slot);
+    }
+    return index;
+}
+
+void LoudnessTable::FreeSlotLocked(LoudnessSlot& slot, obs_source_t* live_source) {
+    // Removing the callback waits out one that is running, so the audio
+    // thread is done with the meter once this returns.
+    if (slot.mix >= 0) {
+        obs_remove_raw_audio_callback((size_t)slot.mix, MixCallback, &slot);
+    } else {
+        if (live_source) {
+            obs_source_remove_audio_capture_callback(live_source, SourceCallback, &slot);
+        } else if (obs_source_t* source = obs_weak_source_get_source(slot.source)) {
+            obs_source_remove_audio_capture_callback(source, SourceCallback, &slot);
+            obs_source_release(source);
+        }
+        obs_weak_source_release(slot.source);
+        slot.source = nullptr;
+    }
+    slot.meter.reset();
+    slot.name.clear();
+    slot.mix = -1;
+    slot.in_use.store(false, std::memory_order_release);
+    slot.channels.store(0, std::memory_order_relaxed);
+    ResetSlot(slot);
+}
+
+void LoudnessTable::DetachSource(obs_source_t* source) {
+    if (!source) return;
+    std::lock_guard<std::mutex> lock(mutex_);
+    uint32_t index = FindLocked(source, -1);
+    if (index != kInvalidIndex) FreeSlotLocked(slots_[index], source);
+}
+
+void LoudnessTable::DetachMix(uint32_t mix) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    uint32_t index = FindLocked(nullptr, (int)mix);
+    if (index != kInvalidIndex) FreeSlotLocked(slots_[index]);
+}
+
+void LoudnessTable::DetachAllSources() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (auto& slot : slots_) {
+        if (slot.in_use.load(std::memory_order_relaxed) && slot.mix < 0) FreeSlotLocked(slot);
+    }
+}
+
+void LoudnessTable::DetachAll() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (auto& slot : slots_) {
+        if (slot.in_use.load(std::memory_order_relaxed)) FreeSlotLocked(slot);
+    }
+}
+
+uint32_t LoudnessTable::FindSource(obs_source_t* source) const {
+    if (!source) return kInvalidIndex;
+    std::lock_guard<std::mutex> lock(mutex_);
+    return FindLocked(source, -1);
+}
+
+uint32_t LoudnessTable::FindMix(uint32_t mix) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return FindLocked(nullptr, (int)mix);
+}
+
+// Signal handlers run on whichever thread removed, destroyed or renamed the
+// source.
+
+void LoudnessTable::OnSourceGone(void* data, calldata_t* cd) {
+    obs_source_t* source = static_cast<obs_source_t*>(calldata_ptr(cd, "source"));
+    if (source) static_cast<LoudnessTable*>(data)->DetachSource(source);
+}
+
+void LoudnessTable::OnSourceRename(void* data, calldata_t* cd) {
+    auto* table = static_cast<LoudnessTable*>(data);
+    obs_source_t* source = static_cast<obs_source_t*>(calldata_ptr(cd, "source"));
+    const char* new_name = calldata_string(cd, "new_name");
+    if (!source || !new_name) return;
+
+    std::lock_guard<std::mutex> lock(table->mutex_);
+    uint32_t index = table->FindLocked(source, -1);
+    if (index != kInvalidIndex) table->slots_[index].name = new_name;
+}
+
+std::vector<LoudnessEntry> LoudnessTable::Entries() const {
+    std::vector<LoudnessEntry> entries;
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (uint32_t i = 0; i < kMaxSlots; i++) {
+        if (slots_[i].in_use.load(std::memory_order_relaxed)) entries.push_back({i, slots_[i].name, slots_[i].mix});
+    }
+    return entries;
+}
+
+bool LoudnessTable::Read(uint32_t index, LoudnessReading* out) const {
+    if (index >= kMaxSlots) return false;
+    const LoudnessSlot& slot = slots_[index];
+    if (!slot.in_use.load(std::memory_order_acquire)) return false;
+
+    out->updated_ns = slot.updated_ns.load(std::memory_order_acquire);
+    out->channels = slot.channels.load(std::memory_order_relaxed);
+    out->measured_seconds = slot.blocks.load(std::memory_order_relaxed) / 10.0;
+    out->momentary = slot.momentary.load(std::memory_order_relaxed);
+    out->short_term = slot.short_term.load(std::memory_order_relaxed);
+    out->integrated = slot.integrated.load(std::memory_order_relaxed);
+    out->range = slot.range.load(std::memory_order_relaxed);
+    out->momentary_max = slot.momentary_max.load(std::memory_order_relaxed);
+    out->short_term_max = slot.short_term_max.load(std::memory_order_relaxed);
+    out->true_peak = -INFINITY;
+    for (uint32_t ch = 0; ch < MAX_AUDIO_CHANNELS; ch++) {
+        out->channel_true_peak[ch] = slot.true_peak[ch].load(std::memory_order_relaxed);
+        if (ch < out->channels) out->true_peak = std::max(out->true_peak, out->channel_true_peak[ch]);
+    }
+    return true;
+}
+
+void LoudnessTable::Reset(uint32_t index) {
+    if (index >= kMaxSlots) return;
+    if (slots_[index].in_use.load(std::memory_order_acquire)) {
+        slots_[index].reset_requested.store(true, std::memory_order_release);
+    }
+}
+
+void LoudnessTable::ResetAll() {
+    for (uint32_t i = 0; i < kMaxSlots; i++) Reset(i);
+}
+
+// --- Audio Thread ---
+
+void LoudnessTable::Publish(LoudnessSlot& slot) {
+    const LoudnessMeter& meter = *slot.meter;
+    slot.momentary.store(meter.momentary(), std::memory_order_relaxed);
+    slot.short_term.store(meter.short_term(), std::memory_order_relaxed);
+    slot.integrated.store(meter.integrated(), std::memory_order_relaxed);
+    slot.range.store(meter.range(), std::memory_order_relaxed);
+    slot.momentary_max.store(meter.momentary_max(), std::memory_order_relaxed);
+    slot.short_term_max.store(meter.short_term_max(), std::memory_order_relaxed);
+    for (uint32_t ch = 0; ch < meter.channels(); ch++) {
+        slot.true_peak[ch].store(to_db(meter.true_peak(ch)), std::memory_order_relaxed);
+    }
+    slot.blocks.store(meter.blocks(), std::memory_order_relaxed);
+    slot.published_blocks = meter.blocks();
+    slot.updated_ns.store(os_gettime_ns(), std::memory_order_release);
+}
+
+void LoudnessTable::Feed(LoudnessSlot& slot, const struct audio_data* audio_data, bool muted) {
+    TITAN_PROFILE_THREAD("audio");
+    TITAN_PROFILE_SCOPE("audio.loudness");
+    LoudnessMeter& meter = *slot.meter;
+    bool reset = slot.reset_requested.exchange(false, std::memory_order_acq_rel);
+    if (reset) meter.Reset();
+
+    // A muted source measures as silence, which is what reaches the mix.
+    const float* planes[MAX_AUDIO_CHANNELS] = {};
+    if (!muted) {
+        for (uint32_t ch = 0; ch < meter.channels(); ch++) {
+            planes[ch] = reinterpret_cast<const float*>(audio_data->data[ch]);
+        }
+    }
+    meter.Process(planes, audio_data->frames);
+    // Values only change once per 100 ms block.
+    if (reset || meter.blocks() != slot.published_blocks) Publish(slot);
+}
+
+void LoudnessTable::SourceCallback(void* param, obs_source_t*, const struct audio_data* audio_data, bool muted) {
+    Feed(*static_cast<LoudnessSlot*>(param), audio_data, muted);
+}
+
+void LoudnessTable::MixCallback(void* param, size_t, struct audio_data* audio_data) {
+    Feed(*static_cast<LoudnessSlot*>(param), audio_data, false);
+}
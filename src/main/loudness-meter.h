@@ -0,0 +1,206 @@
+#pragma once
+
+#include <obs.h>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// EBU R128 / ITU-R BS.1770-4 loudness measurement of one planar float
+// stream. Audio runs through the K-weighting filters (two biquads, in
+// double precision, two channels per SSE2 vector) and is summed into 100 ms
+// blocks; every completed block updates momentary (400 ms) and short-term
+// (3 s) loudness, the gated integrated loudness and the loudness range.
+// True peak comes from 4x oversampling with the BS.1770 Annex 2
+// interpolation filter, all four phases in one SSE vector.
+//
+// Gating keeps block loudness in 0.1 LU histograms instead of every block,
+// so memory and the per-block cost stay fixed however long it runs.
+// Not thread-safe; LoudnessTable drives it from the audio thread.
+class LoudnessMeter {
+public:
+    static constexpr uint32_t kMaxChannels = MAX_AUDIO_CHANNELS;
+
+    // `weights` holds the BS.1770 channel weight per channel: 1.0 for
+    // front channels, 1.41 for surrounds, 0 for LFE.
+    LoudnessMeter(uint32_t sample_rate, uint32_t channels, const float* weights);
+
+    // Starts integration over: integrated, range, maxima and true peak.
+    void Reset();
+    // planes[ch] may be null for silence.
+    void Process(const float* const* planes, uint32_t frames);
+
+    // Loudness values are in LUFS, -inf until measured; range is in LU
+    // and 0 until measured.
+    double momentary() const { return momentary_; }
+    double short_term() const { return short_term_; }
+    double integrated() const { return integrated_; }
+    double range() const { return range_; }
+    double momentary_max() const { return momentary_max_; }
+    double short_term_max() const { return short_term_max_; }
+    // Highest true peak since Reset(), linear.
+    float true_peak(uint32_t channel) const { return true_peak_[channel]; }
+    uint32_t channels() const { return channels_; }
+    // 100 ms blocks completed since Reset().
+    uint64_t blocks() const { return blocks_; }
+
+private:
+    static constexpr uint32_t kShortTermBlocks = 30;  // 3 s of 100 ms blocks
+    static constexpr uint32_t kHistogramBins = 1000;  // -70 to +30 LUFS in 0.1 LU
+    static constexpr uint32_t kTruePeakTaps = 12;
+    static constexpr uint32_t kChunkFrames = 1024;
+
+    struct Histogram {
+        uint64_t count[kHistogramBins];
+        double energy[kHistogramBins];  // Sum of the blocks' mean squares
+        uint64_t total_count;
+        double total_energy;
+
+        void Clear();
+        void Add(double loudness, double energy);
+        // Bin of the first block at or above `loudness`.
+        static uint32_t BinFor(double loudness);
+    };
+
+    void FilterChunk(const float* const* planes, uint32_t frames);
+    void TruePeakChunk(const float* const* planes, uint32_t frames);
+    void FinishBlock();
+    void UpdateIntegrated();
+    void UpdateRange();
+
+    uint32_t sample_rate_;
+    uint32_t channels_;
+    uint32_t block_frames_;
+    double weights_[kMaxChannels];
+
+    // K-weighting coefficients (a0 = 1) and per-channel filter state.
+    double shelf_b_[3], shelf_a_[2];
+    double highpass_b_[3], highpass_a_[2];
+    alignas(16) double shelf_z1_[kMaxChannels];
+    alignas(16) double shelf_z2_[kMaxChannels];
+    alignas(16) double highpass_z1_[kMaxChannels];
+    alignas(16) double highpass_z2_[kMaxChannels];
+    alignas(16) double block_sum_[kMaxChannels];
+    uint32_t block_filled_ = 0;
+
+    // Newest first, doubled so the taps always read one contiguous run.
+    alignas(16) float peak_history_[kMaxChannels][kTruePeakTaps * 2];
+    uint32_t peak_pos_ = 0;
+    float true_peak_[kMaxChannels];
+
+    double recent_[kShortTermBlocks];  // Weighted mean square per block, ring
+    uint64_t blocks_ = 0;
+    double momentary_, short_term_, integrated_, range_;
+    double momentary_max_, short_term_max_;
+    std::unique_ptr<Histogram> momentary_blocks_;   // Integrated gating
+    std::unique_ptr<Histogram> short_term_blocks_;  // Loudness range
+    std::vector<float> silence_;
+};
+
+// BS.1770 channel weights for an OBS speaker layout; returns the channel
+// count.
+uint32_t LoudnessChannelWeights(enum speaker_layout speakers, float weights[MAX_AUDIO_CHANNELS]);
+
+// Values JS reads; written by the audio thread as relaxed atomics, like
+// AudioMeterSlot.
+struct alignas(64) LoudnessSlot {
+    std::atomic<double> momentary;
+    std::atomic<double> short_term;
+    std::atomic<double> integrated;
+    std::atomic<double> range;
+    std::atomic<double> momentary_max;
+    std::atomic<double> short_term_max;
+    std::atomic<float> true_peak[MAX_AUDIO_CHANNELS];  // dBTP
+    std::atomic<uint32_t> channels{0};
+    std::atomic<uint64_t> blocks{0};       // 100 ms blocks since the last reset
+    std::atomic<uint64_t> updated_ns{0};
+    std::atomic<bool> in_use{false};
+    std::atomic<bool> reset_requested{false};
+
+    // Audio thread only, while attached.
+    std::unique_ptr<LoudnessMeter> meter;
+    uint64_t published_blocks = 0;
+
+    // Control path only, under the table mutex.
+    std::string name;                        // Kept current by source_rename
+    int mix = -1;                            // Output mix, or -1 for a source
+    obs_weak_source_t* source = nullptr;     // Identifies a source's slot
+};
+
+struct LoudnessEntry {
+    uint32_t index;
+    std::string name;
+    int mix;                                 // -1 for a source
+};
+
+struct LoudnessReading {
+    uint32_t channels = 0;
+    uint64_t updated_ns = 0;
+    double measured_seconds = 0.0;
+    double momentary, short_term, integrated, range;
+    double momentary_max, short_term_max;
+    float true_peak;                         // Loudest channel, dBTP
+    float channel_true_peak[MAX_AUDIO_CHANNELS];
+};
+
+// Loudness meters for output mixes (obs_add_raw_audio_callback) and single
+// sources (audio capture callbacks), in a fixed table like AudioMeterTable.
+// Like there, a source's slot follows the source through renames and is
+// freed on source_remove or source_destroy. Attaching and detaching take a
+// mutex; the audio callbacks and Read() are lock-free.
+class LoudnessTable {
+public:
+    static constexpr uint32_t kMaxSlots = 128;
+    static constexpr uint32_t kInvalidIndex = UINT32_MAX;
+
+    LoudnessTable();
+    ~LoudnessTable() = default;
+
+    LoudnessTable(const LoudnessTable&) = delete;
+    LoudnessTable& operator=(const LoudnessTable&) = delete;
+
+    // Hooks up the libobs signals. Call after obs_startup.
+    void Connect();
+    // Detaches every meter. Call before obs_shutdown.
+    void Disconnect();
+
+    // Both return the slot index (an existing one if already attached) or
+    // kInvalidIndex if the table is full or audio is not set up.
+    uint32_t AttachSource(obs_source_t* source);
+    uint32_t AttachMix(uint32_t mix);
+    void DetachSource(obs_source_t* source);
+    void DetachMix(uint32_t mix);
+    void DetachAllSources();
+    void DetachAll();
+
+    uint32_t FindSource(obs_source_t* source) const;
+    uint32_t FindMix(uint32_t mix) const;
+    // Every attached meter, ordered by index.
+    std::vector<LoudnessEntry> Entries() const;
+    // Lock-free; returns false if the slot is not in use.
+    bool Read(uint32_t index, LoudnessReading* out) const;
+    // Restarts integration on the audio thread's next callback.
+    void Reset(uint32_t index);
+    void ResetAll();
+
+private:
+    static void SourceCallback(void* param, obs_source_t* source, const struct audio_data* audio_data, bool muted);
+    static void MixCallback(void* param, size_t mix_idx, struct audio_data* audio_data);
+    static void Feed(LoudnessSlot& slot, const struct audio_data* audio_data, bool muted);
+    static void Publish(LoudnessSlot& slot);
+    static void ResetSlot(LoudnessSlot& slot);
+    static void OnSourceGone(void* data, calldata_t* cd);
+    static void OnSourceRename(void* data, calldata_t* cd);
+    uint32_t Attach(const std::string& name, int mix, obs_source_t* source);
+    // A source's slot when `source` is set, otherwise the mix's.
+    uint32_t FindLocked(obs_source_t* source, int mix) const;
+    // `live_source` is the slot's source when the caller knows it is valid;
+    // while it is being destroyed its weak reference no longer resolves.
+    void FreeSlotLocked(LoudnessSlot& slot, obs_source_t* live_source = nullptr);
+
+    LoudnessSlot slots_[kMaxSlots];
+    mutable std::mutex mutex_;
+    bool connected_ = false;
+};
@@ -8,100 +8,773 @@
 #include <mutex>
 #include <string>
 #include <map>
+#include <atomic>
+#include <memory>
+#include <optional>
+#include <functional>
+#include <thread>
+#include <chrono>
+#include <condition_variable>
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstring>
+#include "adaptive-bitrate.h"
+#include "audio-meters.h"
+#include "encoder-bench.h"
+#include "frame-exchange.h"
+#include "frame-shm.h"
+#include "gpu-readback.h"
+#include "loudness-meter.h"
+#include "output-manager.h"
+#include "perf-stats.h"
+#include "pixel-convert.h"
+#include "profiler.h"
+#include "property-cache.h"
+#include "replay-buffer.h"
+#include "scene-batch.h"
+#include "scene-collection.h"
+#include "scene-json.h"
+#include "scene-library.h"
+#include "scene-thumbnails.h"
+#include "scene-tracker.h"
+#include "source-registry.h"
 
 // --- Global variables & state ---
-static std::vector<uint8_t> g_program_frame_data;
-static std::vector<uint8_t> g_preview_frame_data;
-static uint32_t g_frame_width = 0;
-static uint32_t g_frame_height = 0;
-static std::mutex g_frame_mutex;
+static FrameExchange g_program_frames;
+static FrameExchange g_preview_frames;
+static GpuReadback g_program_readback;
+static GpuReadback g_preview_readback;
+static FrameScaler g_frame_scaler; // graphics thread only
+
 static bool obs_is_running = false;
 
+enum FrameView : uint32_t {
+    FRAME_VIEW_PROGRAM = 0,
+    FRAME_VIEW_PREVIEW = 1,
+};
+
+// Output size/format requested by the UI through getLatestFrame(options),
+// one per view. Written by JS, picked up by the render thread on the next
+// frame.
+struct FrameRequest {
+    std::atomic<uint32_t> max_width{0};
+    std::atomic<uint32_t> max_height{0};
+    std::atomic<uint32_t> format{(uint32_t)FrameFormat::RGBA};
+    std::atomic<uint32_t> colorspace{(uint32_t)YuvColorspace::BT709};
+    std::atomic<uint32_t> range{(uint32_t)YuvRange::Limited};
+};
+static FrameRequest g_frame_requests[2];
+
+// --- View Scheduling ---
+// Per-view render budget. Views nobody is watching are not rendered or read
+// back at all, and each view can be capped to its own frame rate.
+struct ViewSchedule {
+    std::atomic<bool> active{true};
+    std::atomic<uint32_t> fps{0}; // 0: every output frame
+    uint64_t next_due_ns = 0;     // graphics thread only
+    std::atomic<uint64_t> frames_rendered{0};
+    std::atomic<uint64_t> skipped_inactive{0};
+    std::atomic<uint64_t> skipped_rate{0};
+    std::atomic<uint64_t> skipped_same_as_program{0};
+    std::atomic<uint32_t> render_width{0};
+    std::atomic<uint32_t> render_height{0};
+    // A capped view stages its readback when due and maps that frame once
+    // the readback latency has passed. Graphics thread only.
+    uint32_t map_countdown = 0; // Output frames until the staged frame is mapped
+    uint64_t staged_ns = 0;
+};
+static ViewSchedule g_view_schedules[2];
+
+// --- Frame Subscriptions ---
+// onFrame() callbacks are driven from the render thread through a
+// ThreadSafeFunction. Each subscription has at most one delivery in flight
+// and only ever receives a frame whose sequence number it has not seen.
+struct FrameSubscription {
+    uint32_t id;
+    FrameView view;
+    uint64_t min_interval_ns;
+    Napi::ThreadSafeFunction tsfn;
+    // Graphics thread only.
+    uint64_t delivered_sequence = 0;
+    uint64_t last_delivered_ns = 0;
+    std::atomic<bool> in_flight{false};
+};
+struct FrameDelivery {
+    std::shared_ptr<FrameSubscription> subscription;
+    FrameSlab* slab;
+};
+static std::vector<std::shared_ptr<FrameSubscription>> g_frame_subscriptions;
+static std::mutex g_frame_subscriptions_mutex;
+static uint32_t g_next_frame_subscription_id = 1;
+
+// --- Source Registry ---
+static SourceRegistry g_sources;
+
+// --- Property Cache ---
+static PropertyCache g_property_cache;
+
+// --- Scene Change Tracking ---
+static SceneChangeTracker g_scene_tracker;
+
+// --- Scene Library ---
+// Owns the loaded scenes; scenes not needed at startup are created lazily.
+static SceneLibrary g_scenes;
+
+// --- Startup Timing ---
+// Written by StartupOBS and whichever thread loads the collection; the
+// render thread stamps the first frame after the program scene was set.
+struct StartupTimings {
+    std::atomic<uint64_t> startup_ns{0};
+    std::atomic<uint64_t> obs_ready_ns{0};
+    std::atomic<uint64_t> parse_ns{0};
+    std::atomic<uint64_t> load_start_ns{0};
+    std::atomic<uint64_t> load_done_ns{0};
+    std::atomic<uint64_t> first_frame_ns{0};
+    std::atomic<bool> awaiting_first_frame{false};
+};
+static StartupTimings g_startup;
+
 // --- Studio Mode ---
 static obs_source_t* g_main_transition = nullptr;
-static obs_source_t* g_preview_scene = nullptr;
+// Written from the JS thread and the scene load worker, read on the
+// graphics thread.
+static std::atomic<obs_source_t*> g_preview_scene{nullptr};
 static gs_texrender_t* g_preview_texrender = nullptr;
 
-struct VolmeterData {
-    obs_volmeter_t* volmeter;
-    std::string* name_ptr;
+// --- Scene Thumbnails ---
+// Atlas of every (or the chosen) scene, refreshed from main_render_callback.
+static SceneThumbnails g_scene_thumbnails;
+
+// --- Shared-Memory Frames ---
+// Full-size program frames for other local processes (startFrameShm).
+static FrameShmPublisher g_frame_shm;
+
+// --- Audio Meters ---
+static AudioMeterTable g_audio_meters;
+
+// --- Loudness ---
+// EBU R128 meters on output mixes and sources. With allSources set, every
+// audio source gets one as it is created, like the audio meters.
+static LoudnessTable g_loudness;
+static std::atomic<bool> g_loudness_all_sources{false};
+
+// onAudioMeters() subscriptions. A timer thread per subscription wakes the
+// JS thread at the requested rate; the JS side then packs every meter into
+// one Float32Array that is reused between deliveries.
+struct AudioMeterSubscription : std::enable_shared_from_this<AudioMeterSubscription> {
+    uint32_t id;
+    uint64_t interval_ns;
+    Napi::ThreadSafeFunction tsfn;
+    std::thread timer;
+    std::mutex mutex;
+    std::condition_variable wake;
+    bool stopping = false;
+    std::atomic<bool> in_flight{false};
+
+    // JS thread only.
+    Napi::ObjectReference buffer;
+    std::vector<std::pair<uint32_t, std::string>> entries;
+    std::vector<AudioMeterReading> readings;
+    uint64_t layout_version = UINT64_MAX;
+    uint32_t sources = 0;
+    uint32_t channels = 0;
 };
-static std::map<std::string, VolmeterData> g_volmeters;
-static std::map<std::string, float> g_peak_levels;
-static std::mutex g_audio_mutex;
+static std::vector<std::shared_ptr<AudioMeterSubscription>> g_audio_meter_subscriptions; // JS thread only
+static uint32_t g_next_audio_meter_subscription_id = 1;
 
 // --- Output Management ---
-static obs_output_t* g_stream_output = nullptr;
-static obs_output_t* g_record_output = nullptr;
-static obs_encoder_t* g_video_encoder = nullptr;
-static obs_encoder_t* g_audio_encoder = nullptr;
+// Named outputs; startStreaming/startRecording drive "stream" and "record".
+static OutputManager g_outputs;
+// Video encoder for outputs without one of their own; defaults to x264 at
+// 2500 kbps, or what benchmarkEncoders() recommended.
+static EncoderConfig g_encoder_config;
+// What setOutputConfig() stored for an output, used when it next starts.
+struct OutputPreset {
+    std::string type;
+    std::optional<EncoderConfig> video; // Unset: g_encoder_config
+    uint32_t audio_bitrate = 160;
+    ObsDataPtr settings;
+};
+static std::map<std::string, OutputPreset> g_output_presets;
+// Guards g_encoder_config and g_output_presets; outputs may be started from
+// a worker thread (startStreamingAsync / startRecordingAsync).
+static std::mutex g_output_mutex;
+// Set while benchmarkEncoders() runs; g_outputs is blocked meanwhile.
+static std::atomic<bool> g_encoder_benchmark_running{false};
+static const char* const kEncoderBenchmarkRunning = "Encoder benchmark in progress.";
+
+// --- Replay Buffer ---
+// Fed by the "replay" output, a REPLAY_BUFFER_OUTPUT_ID registered in
+// StartupOBS.
+static ReplayBuffer g_replay_buffer;
+
+// --- Performance Stats ---
+// Per-second render and output counters, sampled from StartupOBS on.
+static PerfStatsRecorder g_perf_stats;
+
+// onPerfStats() subscriptions, called from the sampling thread with each
+// new sample. The mutex also keeps a subscription's TSFN from being
+// released while the sampler is queueing a call on it.
+struct PerfStatsSubscription {
+    uint32_t id;
+    Napi::ThreadSafeFunction tsfn;
+};
+static std::vector<PerfStatsSubscription> g_perf_stats_subscriptions;
+static std::mutex g_perf_stats_subscriptions_mutex;
+static uint32_t g_next_perf_stats_subscription_id = 1;
+
+// Steps an output's video bitrate with its congestion, once per perf sample.
+static AdaptiveBitrate g_adaptive_bitrate([](const std::string& output, uint32_t kbps) {
+    return g_outputs.SetVideoBitrate(output, kbps);
+});
+
+
+// --- Frame Delivery ---
+
+// Hands a frame slab to JS without copying. The slab stays out of the
+// render thread's rotation until V8 collects the Buffer. Runtimes that forbid
+// external buffers (Electron's V8 sandbox) get a copy instead, and the slab
+// is released right away.
+static void frame_slab_finalizer(Napi::Env, uint8_t*, FrameSlab* slab) {
+    FrameExchange::Release(slab);
+}
 
+static Napi::Buffer<uint8_t> WrapFrameSlab(Napi::Env env, FrameSlab* slab) {
+    return Napi::Buffer<uint8_t>::NewOrCopy(env, slab->data, slab->size, frame_slab_finalizer, slab);
+}
+
+static Napi::Array FramePlanesToNapi(Napi::Env env, const FrameSlab* slab) {
+    FramePlane planes[3];
+    size_t total_size;
+    uint32_t count = GetFramePlanes(slab->format, slab->width, slab->height, planes, &total_size);
+
+    Napi::Array result = Napi::Array::New(env, count);
+    for (uint32_t i = 0; i < count; i++) {
+        Napi::Object plane = Napi::Object::New(env);
+        plane.Set("offset", Napi::Number::New(env, (double)planes[i].offset));
+        plane.Set("stride", Napi::Number::New(env, planes[i].stride));
+        plane.Set("width", Napi::Number::New(env, planes[i].width));
+        plane.Set("height", Napi::Number::New(env, planes[i].height));
+        result[i] = plane;
+    }
+    return result;
+}
+
+// Format, plane layout and (for YUV) color description of a frame, written
+// into `target` with the given key prefix ("" or "program"/"preview").
+static void SetFrameLayout(Napi::Env env, Napi::Object target, const FrameSlab* slab, const std::string& prefix) {
+    auto key = [&prefix](const char* name) {
+        if (prefix.empty()) return std::string(name);
+        std::string k = prefix + name;
+        k[prefix.size()] = (char)toupper(k[prefix.size()]);
+        return k;
+    };
+
+    target.Set(key("format"), FrameFormatName(slab->format));
+    target.Set(key("planes"), FramePlanesToNapi(env, slab));
+    if (IsYuvFormat(slab->format)) {
+        target.Set(key("colorspace"), YuvColorspaceName(slab->colorspace));
+        target.Set(key("range"), YuvRangeName(slab->range));
+    }
+}
+
+static const char* FrameViewName(FrameView view) {
+    return view == FRAME_VIEW_PREVIEW ? "preview" : "program";
+}
 
-// --- OBS Audio Callback ---
-void volmeter_callback(void *param, const float magnitude[MAX_AUDIO_CHANNELS],
-                       const float peak[MAX_AUDIO_CHANNELS],
-                       const float input_peak[MAX_AUDIO_CHANNELS]) {
-    std::string* name = static_cast<std::string*>(param);
+static void deliver_frame_js(Napi::Env env, Napi::Function callback, FrameDelivery* delivery) {
+    FrameSlab* slab = delivery->slab;
+    delivery->subscription->in_flight.store(false, std::memory_order_release);
+
+    if (env != nullptr && callback != nullptr) {
+        Napi::Object event = Napi::Object::New(env);
+        event.Set("view", FrameViewName(delivery->subscription->view));
+        event.Set("sequence", Napi::Number::New(env, (double)slab->sequence));
+        event.Set("timestamp", Napi::Number::New(env, slab->timestamp_ns / 1000000.0));
+        if (slab->size > 0) {
+            event.Set("frame", WrapFrameSlab(env, slab));
+            event.Set("width", Napi::Number::New(env, slab->width));
+            event.Set("height", Napi::Number::New(env, slab->height));
+            SetFrameLayout(env, event, slab, "");
+            slab = nullptr; // Owned by the Buffer now
+        } else {
+            event.Set("frame", env.Null());
+        }
+        callback.Call({event});
+    }
 
-    // We only care about the peak value of the first channel for simplicity
-    float peak_db = obs_mul_to_db(peak[0]);
+    if (slab) FrameExchange::Release(slab);
+    delete delivery;
+}
 
-    std::lock_guard<std::mutex> lock(g_audio_mutex);
-    g_peak_levels[*name] = peak_db;
+// Runs once per rendered frame on the graphics thread.
+static void notify_frame_subscribers(uint64_t now) {
+    TITAN_PROFILE_SCOPE("render.notify_subscribers");
+    std::unique_lock<std::mutex> lock(g_frame_subscriptions_mutex, std::try_to_lock);
+    if (!lock.owns_lock()) return; // JS is (un)subscribing, catch up next frame
+
+    for (auto& subscription : g_frame_subscriptions) {
+        FrameExchange& frames = subscription->view == FRAME_VIEW_PREVIEW ? g_preview_frames : g_program_frames;
+        if (frames.latest_sequence() == subscription->delivered_sequence) continue;
+        if (now - subscription->last_delivered_ns < subscription->min_interval_ns) continue;
+        if (subscription->in_flight.load(std::memory_order_acquire)) continue;
+
+        FrameSlab* slab = frames.AcquirePublished();
+        if (!slab) continue;
+
+        subscription->in_flight.store(true, std::memory_order_relaxed);
+        auto* delivery = new FrameDelivery{subscription, slab};
+        if (subscription->tsfn.NonBlockingCall(delivery, deliver_frame_js) != napi_ok) {
+            subscription->in_flight.store(false, std::memory_order_relaxed);
+            FrameExchange::Release(slab);
+            delete delivery;
+            continue;
+        }
+        subscription->delivered_sequence = slab->sequence;
+        subscription->last_delivered_ns = now;
+    }
 }
 
 // --- OBS Render Callback ---
+static bool frame_format_from_gs(gs_color_format format, FrameFormat* out) {
+    switch (format) {
+        case GS_RGBA: *out = FrameFormat::RGBA; return true;
+        case GS_BGRA:
+        case GS_BGRX: *out = FrameFormat::BGRA; return true;
+        default: return false;
+    }
+}
+
+// Downscales the mapped readback to the size the UI asked for and swizzles
+// it into the requested channel order, straight into a frame slab.
+static void publish_mapped_frame(FrameExchange& frames, const GpuReadback& readback, const FrameRequest& request,
+                                 const uint8_t* video_data, uint32_t video_linesize, uint64_t now) {
+    FrameFormat src_format;
+    if (!frame_format_from_gs(readback.format(), &src_format)) return;
+
+    uint32_t width, height;
+    FitWithin(readback.width(), readback.height(),
+              request.max_width.load(std::memory_order_relaxed),
+              request.max_height.load(std::memory_order_relaxed), &width, &height);
+    FrameFormat dst_format = (FrameFormat)request.format.load(std::memory_order_relaxed);
+    bool yuv = IsYuvFormat(dst_format);
+    if (yuv) {
+        // 4:2:0 chroma needs even dimensions.
+        width = width > 2 ? width & ~1u : 2;
+        height = height > 2 ? height & ~1u : 2;
+    }
+
+    FramePlane planes[3];
+    size_t size;
+    GetFramePlanes(dst_format, width, height, planes, &size);
+
+    TITAN_PROFILE_SCOPE("render.frame_copy");
+    FrameSlab* slab = frames.BeginWrite(size);
+    if (!slab) return; // Every slab is still held by JS, drop this frame
+
+    slab->width = width;
+    slab->height = height;
+    slab->stride = planes[0].stride;
+    slab->format = dst_format;
+    if (yuv) {
+        slab->colorspace = (YuvColorspace)request.colorspace.load(std::memory_order_relaxed);
+        slab->range = (YuvRange)request.range.load(std::memory_order_relaxed);
+        g_frame_scaler.ScaleToYuv(video_data, video_linesize, readback.width(), readback.height(), src_format,
+                                  slab->data, width, height, dst_format, slab->colorspace, slab->range);
+    } else {
+        g_frame_scaler.Scale(video_data, video_linesize, readback.width(), readback.height(), src_format,
+                             slab->data, slab->stride, width, height, dst_format);
+    }
+    frames.Publish(now, HashPixels(slab->data, slab->size));
+}
+
+// Copies the mapped program readback, unscaled, into the shared-memory ring.
+static void publish_shm_frame(const GpuReadback& readback, const uint8_t* video_data, uint32_t video_linesize,
+                              uint64_t now) {
+    FrameFormat format;
+    if (!frame_format_from_gs(readback.format(), &format)) return;
+    g_frame_shm.Publish(video_data, video_linesize, readback.width(), readback.height(),
+                        format == FrameFormat::BGRA ? FRAME_SHM_BGRA : FRAME_SHM_RGBA, now);
+}
+
+// Returns whether the view should be rendered this output frame, keeping it
+// on a fixed grid of its target rate.
+static bool view_due(ViewSchedule& schedule, uint64_t now) {
+    uint32_t fps = schedule.fps.load(std::memory_order_relaxed);
+    if (fps > 0) {
+        uint64_t interval = 1000000000ULL / fps;
+        // Output frames never land exactly on the grid; allow half an output
+        // frame of slack so 15 fps out of 60 does not turn into 12.
+        uint64_t slack = obs_get_frame_interval_ns() / 2;
+        if (now + slack < schedule.next_due_ns) {
+            schedule.skipped_rate.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        schedule.next_due_ns += interval;
+        if (schedule.next_due_ns + slack <= now) {
+            schedule.next_due_ns = now + interval; // Don't try to catch up after a stall
+        }
+    }
+    schedule.frames_rendered.fetch_add(1, std::memory_order_relaxed);
+    return true;
+}
+
+// Whether a view reads back through Stage/MapLatest instead of the
+// StageAndMap pipeline. Below the output rate the pipeline would map the
+// frame staged one view interval ago, not `latency` output frames ago.
+static bool view_stages_ahead(const ViewSchedule& schedule, const GpuReadback& readback) {
+    return schedule.fps.load(std::memory_order_relaxed) > 0 && readback.latency() > 0;
+}
+
+// Runs every output frame a staging view is active: maps and publishes its
+// staged frame once the readback latency has passed.
+static void publish_staged_view(ViewSchedule& schedule, GpuReadback& readback, FrameExchange& frames,
+                                const FrameRequest& request) {
+    if (schedule.map_countdown == 0 || --schedule.map_countdown > 0) return;
+    uint8_t* video_data = nullptr;
+    uint32_t video_linesize = 0;
+    if (readback.MapLatest(&video_data, &video_linesize)) {
+        publish_mapped_frame(frames, readback, request, video_data, video_linesize, schedule.staged_ns);
+        readback.Unmap();
+    }
+}
+
+static void stage_view(ViewSchedule& schedule, GpuReadback& readback, FrameExchange& frames,
+                       const FrameRequest& request, gs_texture_t* texture, uint64_t now) {
+    if (schedule.map_countdown > 0) {
+        // Due again before the last frame was mapped; show that one first.
+        schedule.map_countdown = 1;
+        publish_staged_view(schedule, readback, frames, request);
+    }
+    if (!readback.Stage(texture)) return;
+    schedule.map_countdown = readback.latency();
+    schedule.staged_ns = now;
+}
+
+// Republishes another view's newest frame, e.g. a preview showing the scene
+// that is already on program. Identical content is deduplicated by Publish.
+static void mirror_published_frame(FrameExchange& frames, FrameExchange& source, uint64_t now) {
+    FrameSlab* src = source.AcquirePublished();
+    if (!src) return;
+
+    if (src->size == 0) {
+        frames.PublishEmpty(now);
+    } else if (FrameSlab* slab = frames.BeginWrite(src->size)) {
+        TITAN_PROFILE_SCOPE("render.frame_mirror_copy");
+        memcpy(slab->data, src->data, src->size);
+        slab->width = src->width;
+        slab->height = src->height;
+        slab->stride = src->stride;
+        slab->format = src->format;
+        slab->colorspace = src->colorspace;
+        slab->range = src->range;
+        frames.Publish(now, src->content_hash);
+    }
+    FrameExchange::Release(src);
+}
+
+static void render_preview(uint32_t base_width, uint32_t base_height, uint64_t now) {
+    ViewSchedule& schedule = g_view_schedules[FRAME_VIEW_PREVIEW];
+    const FrameRequest& request = g_frame_requests[FRAME_VIEW_PREVIEW];
+    obs_source_t* preview_scene = g_preview_scene.load(std::memory_order_acquire);
+    if (!preview_scene) {
+        g_preview_readback.Reset();
+        schedule.map_countdown = 0;
+        g_preview_frames.PublishEmpty(now);
+        return;
+    }
+    if (!schedule.active.load(std::memory_order_relaxed)) {
+        schedule.skipped_inactive.fetch_add(1, std::memory_order_relaxed);
+        g_preview_readback.Reset();
+        schedule.map_countdown = 0;
+        return;
+    }
+    bool stage_ahead = view_stages_ahead(schedule, g_preview_readback);
+    if (stage_ahead) {
+        publish_staged_view(schedule, g_preview_readback, g_preview_frames, request);
+    } else {
+        schedule.map_countdown = 0;
+    }
+    if (!view_due(schedule, now)) return;
+
+    // The preview scene is often the one already on air; the program frame
+    // is then the same picture, so don't render the scene a second time.
+    obs_source_t* program_source = obs_transition_get_source(g_main_transition, OBS_TRANSITION_SOURCE_A);
+    bool same_as_program = program_source == preview_scene;
+    obs_source_release(program_source);
+    if (same_as_program && g_view_schedules[FRAME_VIEW_PROGRAM].active.load(std::memory_order_relaxed)) {
+        schedule.skipped_same_as_program.fetch_add(1, std::memory_order_relaxed);
+        g_preview_readback.Reset();
+        schedule.map_countdown = 0;
+        mirror_published_frame(g_preview_frames, g_program_frames, now);
+        return;
+    }
+
+    // Render straight at the size the UI asked for instead of rendering at
+    // output resolution and scaling down after the readback.
+    uint32_t width, height;
+    FitWithin(base_width, base_height,
+              request.max_width.load(std::memory_order_relaxed),
+              request.max_height.load(std::memory_order_relaxed), &width, &height);
+    schedule.render_width.store(width, std::memory_order_relaxed);
+    schedule.render_height.store(height, std::memory_order_relaxed);
+
+    {
+        TITAN_PROFILE_SCOPE("render.preview_texrender");
+        gs_texrender_reset(g_preview_texrender);
+        if (!gs_texrender_begin(g_preview_texrender, width, height)) return;
+
+        struct vec4 clear_color;
+        vec4_zero(&clear_color);
+        gs_clear(GS_CLEAR_COLOR, &clear_color, 0.0f, 0);
+        gs_ortho(0.0f, (float)base_width, 0.0f, (float)base_height, -100.0f, 100.0f);
+        obs_source_video_render(preview_scene);
+        gs_texrender_end(g_preview_texrender);
+    }
+
+    uint8_t *video_data = nullptr;
+    uint32_t video_linesize = 0;
+    gs_texture_t* preview_tex = gs_texrender_get_texture(g_preview_texrender);
+    if (preview_tex && stage_ahead) {
+        TITAN_PROFILE_SCOPE("render.preview_stage");
+        stage_view(schedule, g_preview_readback, g_preview_frames, request, preview_tex, now);
+        return;
+    }
+    bool mapped = false;
+    if (preview_tex) {
+        TITAN_PROFILE_SCOPE("render.preview_map");
+        mapped = g_preview_readback.StageAndMap(preview_tex, &video_data, &video_linesize);
+    }
+    if (mapped) {
+        publish_mapped_frame(g_preview_frames, g_preview_readback, request, video_data, video_linesize, now);
+        g_preview_readback.Unmap();
+    }
+}
+
 void main_render_callback(void *param, uint32_t cx, uint32_t cy) {
+    TITAN_PROFILE_THREAD("graphics");
+    TITAN_PROFILE_SCOPE("render.main_callback");
     gs_texture_t *program_tex = obs_get_main_texture();
     if (!program_tex) return;
 
+    if (g_startup.awaiting_first_frame.load(std::memory_order_relaxed)) {
+        g_startup.first_frame_ns.store(os_gettime_ns(), std::memory_order_relaxed);
+        g_startup.awaiting_first_frame.store(false, std::memory_order_relaxed);
+    }
+
     uint32_t width = gs_texture_get_width(program_tex);
     uint32_t height = gs_texture_get_height(program_tex);
     if (width == 0 || height == 0) return;
 
-    uint8_t *video_data = nullptr;
-    uint32_t video_linesize = 0;
+    uint64_t now = os_gettime_ns();
 
     // --- Render Program Texture ---
-    if (gs_texture_map(program_tex, &video_data, &video_linesize)) {
-        std::lock_guard<std::mutex> lock(g_frame_mutex);
-        g_frame_width = width;
-        g_frame_height = height;
-        size_t data_size = width * height * 4;
-        if (g_program_frame_data.size() != data_size) {
-            g_program_frame_data.resize(data_size);
+    // Frames come out of the readback ring a configurable number of frames
+    // late, so the map never waits for the GPU to finish the copy.
+    ViewSchedule& program = g_view_schedules[FRAME_VIEW_PROGRAM];
+    const FrameRequest& program_request = g_frame_requests[FRAME_VIEW_PROGRAM];
+    program.render_width.store(width, std::memory_order_relaxed);
+    program.render_height.store(height, std::memory_order_relaxed);
+    // The shared-memory ring takes every output frame, at full size,
+    // whatever the view is doing.
+    bool program_active = program.active.load(std::memory_order_relaxed);
+    bool shm_active = g_frame_shm.active();
+    if (!program_active) program.skipped_inactive.fetch_add(1, std::memory_order_relaxed);
+    if (!program_active && !shm_active) {
+        g_program_readback.Reset();
+        program.map_countdown = 0;
+    } else if (!shm_active && view_stages_ahead(program, g_program_readback)) {
+        // Capped and nothing else needs every frame: stage only when due.
+        publish_staged_view(program, g_program_readback, g_program_frames, program_request);
+        if (view_due(program, now)) {
+            TITAN_PROFILE_SCOPE("render.program_stage");
+            stage_view(program, g_program_readback, g_program_frames, program_request, program_tex, now);
+        }
+    } else {
+        program.map_countdown = 0;
+        bool view_frame = program_active && view_due(program, now);
+        uint8_t *video_data = nullptr;
+        uint32_t video_linesize = 0;
+        bool mapped = false;
+        if (view_frame || shm_active) {
+            TITAN_PROFILE_SCOPE("render.program_map");
+            mapped = g_program_readback.StageAndMap(program_tex, &video_data, &video_linesize);
         }
-        for (uint32_t i = 0; i < height; i++) {
-            memcpy(g_program_frame_data.data() + (i * width * 4), video_data + (i * video_linesize), width * 4);
+        if (mapped) {
+            if (view_frame) {
+                publish_mapped_frame(g_program_frames, g_program_readback, program_request, video_data,
+                                     video_linesize, now);
+            }
+            if (shm_active) publish_shm_frame(g_program_readback, video_data, video_linesize, now);
+            g_program_readback.Unmap();
         }
-        gs_texture_unmap(program_tex);
     }
 
     // --- Render Preview Texture ---
-    if (g_preview_scene) {
-        if (gs_texrender_begin(g_preview_texrender, width, height)) {
-            obs_source_video_render(g_preview_scene);
-            gs_texrender_end(g_preview_texrender);
-
-            gs_texture_t* preview_tex = gs_texrender_get_texture(g_preview_texrender);
-            if (preview_tex && gs_texture_map(preview_tex, &video_data, &video_linesize)) {
-                std::lock_guard<std::mutex> lock(g_frame_mutex);
-                size_t data_size = width * height * 4;
-                if (g_preview_frame_data.size() != data_size) {
-                    g_preview_frame_data.resize(data_size);
-                }
-                for (uint32_t i = 0; i < height; i++) {
-                    memcpy(g_preview_frame_data.data() + (i * width * 4), video_data + (i * video_linesize), width * 4);
-                }
-                gs_texture_unmap(preview_tex);
-            }
+    render_preview(width, height, now);
+
+    // --- Render Scene Thumbnails ---
+    g_scene_thumbnails.Render(width, height, now);
+
+    notify_frame_subscribers(now);
+}
+
+// --- Audio Meter Stream ---
+
+static void deliver_audio_meters_js(Napi::Env env, Napi::Function callback,
+                                    std::shared_ptr<AudioMeterSubscription>* data) {
+    std::shared_ptr<AudioMeterSubscription> subscription = std::move(*data);
+    delete data;
+    subscription->in_flight.store(false, std::memory_order_release);
+    if (env == nullptr || callback == nullptr) return;
+
+    AudioMeterSubscription& sub = *subscription;
+    bool layout_changed = false;
+    uint64_t version = g_audio_meters.layout_version();
+    if (version != sub.layout_version) {
+        sub.entries = g_audio_meters.Entries();
+        sub.layout_version = version;
+        layout_changed = true;
+    }
+
+    // Slot indices are stable, so the index dimension spans up to the
+    // highest slot in use; the channel dimension spans the widest source.
+    uint32_t sources = sub.entries.empty() ? 0 : sub.entries.back().first + 1;
+    uint32_t channels = 0;
+    sub.readings.resize(sub.entries.size());
+    for (size_t i = 0; i < sub.entries.size(); i++) {
+        if (!g_audio_meters.Read(sub.entries[i].first, &sub.readings[i])) {
+            sub.readings[i].channels = 0;
         }
-    } else {
-        std::lock_guard<std::mutex> lock(g_frame_mutex);
-        if (!g_preview_frame_data.empty()) {
-            g_preview_frame_data.clear();
+        channels = std::max(channels, sub.readings[i].channels);
+    }
+    if (sources != sub.sources || channels != sub.channels) {
+        sub.sources = sources;
+        sub.channels = channels;
+        layout_changed = true;
+    }
+
+    size_t length = (size_t)sources * channels * 3;
+    Napi::Float32Array meters;
+    if (!sub.buffer.IsEmpty()) meters = sub.buffer.Value().As<Napi::Float32Array>();
+    if (sub.buffer.IsEmpty() || meters.ElementLength() != length) {
+        meters = Napi::Float32Array::New(env, length);
+        sub.buffer = Napi::Persistent(meters.As<Napi::Object>());
+    }
+
+    float* out = meters.Data();
+    std::fill(out, out + length, -INFINITY);
+    for (size_t i = 0; i < sub.entries.size(); i++) {
+        const AudioMeterReading& reading = sub.readings[i];
+        float* source_out = out + (size_t)sub.entries[i].first * channels * 3;
+        for (uint32_t ch = 0; ch < reading.channels; ch++) {
+            source_out[ch * 3 + 0] = reading.magnitude[ch];
+            source_out[ch * 3 + 1] = reading.peak[ch];
+            source_out[ch * 3 + 2] = reading.input_peak[ch];
         }
     }
+
+    Napi::Value layout = env.Undefined();
+    if (layout_changed) {
+        Napi::Object layout_obj = Napi::Object::New(env);
+        Napi::Array names = Napi::Array::New(env, sources);
+        for (uint32_t i = 0; i < sources; i++) names.Set(i, env.Null());
+        for (auto const& [index, name] : sub.entries) names.Set(index, name);
+        layout_obj.Set("version", Napi::Number::New(env, (double)version));
+        layout_obj.Set("sources", sources);
+        layout_obj.Set("channels", channels);
+        layout_obj.Set("names", names);
+        layout = layout_obj;
+    }
+    callback.Call({meters, layout});
+}
+
+static void audio_meter_timer(AudioMeterSubscription* subscription) {
+    using clock = std::chrono::steady_clock;
+    const auto interval = std::chrono::nanoseconds(subscription->interval_ns);
+    auto next = clock::now();
+
+    std::unique_lock<std::mutex> lock(subscription->mutex);
+    while (!subscription->stopping) {
+        next += interval;
+        if (subscription->wake.wait_until(lock, next, [subscription] { return subscription->stopping; })) break;
+        if (clock::now() > next + interval) next = clock::now(); // Don't burst after a stall
+
+        // Skip the tick while JS has not consumed the previous one.
+        if (subscription->in_flight.exchange(true, std::memory_order_acq_rel)) continue;
+        auto* data = new std::shared_ptr<AudioMeterSubscription>(subscription->shared_from_this());
+        if (subscription->tsfn.NonBlockingCall(data, deliver_audio_meters_js) != napi_ok) {
+            subscription->in_flight.store(false, std::memory_order_relaxed);
+            delete data;
+        }
+    }
+}
+
+// JS thread. Deliveries already queued still run and find the subscription
+// alive through the shared_ptr they carry.
+static void StopAudioMeterSubscription(AudioMeterSubscription& subscription) {
+    {
+        std::lock_guard<std::mutex> lock(subscription.mutex);
+        subscription.stopping = true;
+    }
+    subscription.wake.notify_one();
+    if (subscription.timer.joinable()) subscription.timer.join();
+    subscription.tsfn.Release();
+}
+
+// --- Performance Stats Stream ---
+
+static Napi::Object PerfSampleToNapi(Napi::Env env, const PerfSample& sample) {
+    Napi::Object obj = Napi::Object::New(env);
+    obj.Set("seq", (double)sample.seq);
+    obj.Set("time", (double)sample.time_ms);
+    obj.Set("fps", sample.fps);
+    obj.Set("averageFrameTimeMs", sample.average_frame_time_ms);
+    obj.Set("renderedFrames", sample.rendered_frames);
+    obj.Set("laggedFrames", sample.lagged_frames);
+    obj.Set("laggedFramesDelta", sample.lagged_frames_delta);
+    obj.Set("outputFrames", sample.output_frames);
+    obj.Set("skippedFrames", sample.skipped_frames);
+    obj.Set("skippedFramesDelta", sample.skipped_frames_delta);
+    Napi::Array outputs = Napi::Array::New(env, sample.outputs.size());
+    for (size_t i = 0; i < sample.outputs.size(); i++) {
+        const PerfOutputSample& output = sample.outputs[i];
+        Napi::Object out = Napi::Object::New(env);
+        out.Set("name", output.name);
+        out.Set("active", output.active);
+        out.Set("totalBytes", (double)output.total_bytes);
+        out.Set("kbps", output.kbps);
+        out.Set("totalFrames", output.total_frames);
+        out.Set("framesDropped", output.frames_dropped);
+        out.Set("framesDroppedDelta", output.frames_dropped_delta);
+        out.Set("congestion", output.congestion);
+        out.Set("videoBitrate", output.video_bitrate);
+        out.Set("encoderSkipped", output.encoder_skipped);
+        out.Set("encoderSkippedDelta", output.encoder_skipped_delta);
+        outputs.Set((uint32_t)i, out);
+    }
+    obj.Set("outputs", outputs);
+    return obj;
+}
+
+static void deliver_perf_sample_js(Napi::Env env, Napi::Function callback, PerfSample* data) {
+    std::unique_ptr<PerfSample> sample(data);
+    if (env == nullptr || callback == nullptr) return;
+    callback.Call({PerfSampleToNapi(env, *sample)});
+}
+
+// Sampling thread. A subscriber that falls behind by a few samples misses
+// the next ones rather than queueing without bound; getPerfStats() still
+// has them.
+static void publish_perf_sample(const PerfSample& sample) {
+    g_adaptive_bitrate.OnSample(sample);
+
+    std::lock_guard<std::mutex> lock(g_perf_stats_subscriptions_mutex);
+    for (auto& subscription : g_perf_stats_subscriptions) {
+        auto* data = new PerfSample(sample);
+        if (subscription.tsfn.NonBlockingCall(data, deliver_perf_sample_js) != napi_ok) delete data;
+    }
 }
 
 // --- N-API Functions ---
@@ -110,9 +783,19 @@ Napi::Value StartupOBS(const Napi::CallbackInfo& info) {
     Napi::Env env = info.Env();
     if (obs_is_running) return env.Undefined();
 
+    g_startup.startup_ns = os_gettime_ns();
     if (!obs_startup("en-US", nullptr, nullptr)) {
         throw Napi::Error::New(env, "obs_startup failed");
     }
+    g_startup.obs_ready_ns = os_gettime_ns();
+
+    g_sources.Connect();
+    g_scene_tracker.Connect();
+    g_property_cache.Connect();
+    g_audio_meters.Connect();
+    g_loudness.Connect();
+    g_perf_stats.Start(&g_outputs, publish_perf_sample);
+    g_replay_buffer.RegisterOutput();
 
     // Create the main transition that will be our output source
     g_main_transition = obs_source_create("cut_transition", "Main Transition", nullptr, nullptr);
@@ -130,157 +813,670 @@ Napi::Value ShutdownOBS(const Napi::CallbackInfo& info) {
     if (!obs_is_running) return env.Undefined();
 
     obs_remove_main_render_callback(main_render_callback, nullptr);
+    g_frame_shm.Stop();
+    g_perf_stats.Stop();
+    {
+        std::lock_guard<std::mutex> lock(g_perf_stats_subscriptions_mutex);
+        for (auto& subscription : g_perf_stats_subscriptions) subscription.tsfn.Release();
+        g_perf_stats_subscriptions.clear();
+    }
+    g_outputs.StopAll();
+    g_scenes.StopBackground();
+
+    {
+        std::lock_guard<std::mutex> lock(g_frame_subscriptions_mutex);
+        for (auto& subscription : g_frame_subscriptions) {
+            subscription->tsfn.Release();
+        }
+        g_frame_subscriptions.clear();
+    }
+
+    obs_enter_graphics();
+    g_program_readback.Destroy();
+    g_preview_readback.Destroy();
     gs_texrender_destroy(g_preview_texrender);
+    g_scene_thumbnails.Destroy();
+    obs_leave_graphics();
+    for (auto& subscription : g_audio_meter_subscriptions) {
+        StopAudioMeterSubscription(*subscription);
+    }
+    g_audio_meter_subscriptions.clear();
+    g_audio_meters.Disconnect();
+    g_loudness.Disconnect();
+    g_preview_scene.store(nullptr, std::memory_order_release);
+    g_scenes.Clear();
     obs_source_release(g_main_transition);
+    g_property_cache.Disconnect();
+    g_scene_tracker.Disconnect();
+    g_sources.Disconnect();
     obs_shutdown();
     obs_is_running = false;
     return env.Undefined();
 }
 
-Napi::Value GetLatestFrame(const Napi::CallbackInfo& info) {
-    Napi::Env env = info.Env();
-    std::lock_guard<std::mutex> lock(g_frame_mutex);
+static FrameView ParseFrameView(Napi::Env env, Napi::Value value) {
+    std::string view_name = value.As<Napi::String>();
+    if (view_name == "program") return FRAME_VIEW_PROGRAM;
+    if (view_name == "preview") return FRAME_VIEW_PREVIEW;
+    throw Napi::TypeError::New(env, "Unknown view: " + view_name);
+}
 
-    Napi::Object result = Napi::Object::New(env);
+// Options: { view: 'program' | 'preview', maxWidth, maxHeight,
+// format: 'rgba' | 'bgra' | 'nv12' | 'i420', colorspace: 'bt709' | 'bt601',
+// range: 'limited' | 'full' }. Each view keeps its own settings; without a
+// view they apply to both (onFrame passes its subscription's view). Frames
+// are scaled to fit within maxWidth x maxHeight (aspect preserved, never
+// upscaled); the new settings apply from the next rendered frame on.
+static void ApplyFrameRequest(Napi::Env env, Napi::Object options, const FrameView* only_view = nullptr) {
+    FrameView view = FRAME_VIEW_PROGRAM;
+    bool one_view = only_view != nullptr;
+    if (only_view) {
+        view = *only_view;
+    } else if (options.Has("view")) {
+        view = ParseFrameView(env, options.Get("view"));
+        one_view = true;
+    }
 
-    if (!g_program_frame_data.empty()) {
-        Napi::Buffer<uint8_t> buffer = Napi::Buffer<uint8_t>::Copy(env, g_program_frame_data.data(), g_program_frame_data.size());
-        result.Set("programFrame", buffer);
+    // Everything is validated before any view changes.
+    FrameFormat format = FrameFormat::RGBA;
+    YuvColorspace colorspace = YuvColorspace::BT709;
+    YuvRange range = YuvRange::Limited;
+    if (options.Has("format")) {
+        std::string format_name = options.Get("format").As<Napi::String>();
+        if (!ParseFrameFormat(format_name.c_str(), &format)) {
+            throw Napi::TypeError::New(env, "Unknown frame format: " + format_name);
+        }
+    }
+    if (options.Has("colorspace")) {
+        std::string colorspace_name = options.Get("colorspace").As<Napi::String>();
+        if (!ParseYuvColorspace(colorspace_name.c_str(), &colorspace)) {
+            throw Napi::TypeError::New(env, "Unknown colorspace: " + colorspace_name);
+        }
+    }
+    if (options.Has("range")) {
+        std::string range_name = options.Get("range").As<Napi::String>();
+        if (!ParseYuvRange(range_name.c_str(), &range)) {
+            throw Napi::TypeError::New(env, "Unknown range: " + range_name);
+        }
     }
-    if (!g_preview_frame_data.empty()) {
-        Napi::Buffer<uint8_t> buffer = Napi::Buffer<uint8_t>::Copy(env, g_preview_frame_data.data(), g_preview_frame_data.size());
-        result.Set("previewFrame", buffer);
+
+    for (uint32_t i = 0; i < 2; i++) {
+        if (one_view && i != view) continue;
+        FrameRequest& request = g_frame_requests[i];
+        if (options.Has("maxWidth")) {
+            request.max_width.store(options.Get("maxWidth").As<Napi::Number>().Uint32Value(), std::memory_order_relaxed);
+        }
+        if (options.Has("maxHeight")) {
+            request.max_height.store(options.Get("maxHeight").As<Napi::Number>().Uint32Value(), std::memory_order_relaxed);
+        }
+        if (options.Has("format")) request.format.store((uint32_t)format, std::memory_order_relaxed);
+        if (options.Has("colorspace")) request.colorspace.store((uint32_t)colorspace, std::memory_order_relaxed);
+        if (options.Has("range")) request.range.store((uint32_t)range, std::memory_order_relaxed);
     }
+}
 
-    result.Set("width", Napi::Number::New(env, g_frame_width));
-    result.Set("height", Napi::Number::New(env, g_frame_height));
-    return result;
+static uint64_t OptionalSequence(Napi::Object options, const char* key) {
+    if (!options.Has(key) || !options.Get(key).IsNumber()) return 0;
+    return (uint64_t)options.Get(key).As<Napi::Number>().Int64Value();
 }
 
-Napi::Value CreateScene(const Napi::CallbackInfo& info) {
+// Extra options: { programSince, previewSince } - a view whose newest frame
+// has a sequence number <= the given one is left out of the result, so
+// polling callers only pay for frames they have not drawn yet.
+Napi::Value GetLatestFrame(const Napi::CallbackInfo& info) {
     Napi::Env env = info.Env();
-    if (info.Length() < 1) throw Napi::Error::New(env, "Scene name is required.");
+    uint64_t program_since = 0;
+    uint64_t preview_since = 0;
+    if (info.Length() > 0 && info[0].IsObject()) {
+        Napi::Object options = info[0].As<Napi::Object>();
+        ApplyFrameRequest(env, options);
+        program_since = OptionalSequence(options, "programSince");
+        preview_since = OptionalSequence(options, "previewSince");
+    }
 
-    std::string scene_name = info[0].As<Napi::String>();
-    obs_scene_t *scene = obs_scene_create(scene_name.c_str());
-    if (!scene) throw Napi::Error::New(env, "Failed to create scene.");
+    Napi::Object result = Napi::Object::New(env);
 
-    // If this is the first scene, set it to program view
-    if (obs_transition_get_source(g_main_transition, OBS_TRANSITION_SOURCE_A) == nullptr) {
-        obs_transition_set(g_main_transition, (obs_source_t*)scene);
+    FrameSlab* program = g_program_frames.AcquireLatest();
+    if (program) {
+        result.Set("programSequence", Napi::Number::New(env, (double)program->sequence));
+        result.Set("programTimestamp", Napi::Number::New(env, program->timestamp_ns / 1000000.0));
+        if (program->sequence > program_since) {
+            result.Set("programFrame", WrapFrameSlab(env, program));
+            result.Set("width", Napi::Number::New(env, program->width));
+            result.Set("height", Napi::Number::New(env, program->height));
+            SetFrameLayout(env, result, program, "");
+        } else {
+            FrameExchange::Release(program);
+            program = nullptr;
+        }
+    }
+    FrameSlab* preview = g_preview_frames.AcquireLatest();
+    if (preview) {
+        result.Set("previewSequence", Napi::Number::New(env, (double)preview->sequence));
+        result.Set("previewTimestamp", Napi::Number::New(env, preview->timestamp_ns / 1000000.0));
+        if (preview->sequence > preview_since) {
+            result.Set("previewFrame", WrapFrameSlab(env, preview));
+            result.Set("previewWidth", Napi::Number::New(env, preview->width));
+            result.Set("previewHeight", Napi::Number::New(env, preview->height));
+            SetFrameLayout(env, result, preview, "preview");
+        } else {
+            FrameExchange::Release(preview);
+        }
     }
+    return result;
+}
 
-    obs_scene_release(scene);
+Napi::Value SetFrameOptions(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    if (info.Length() < 1 || !info[0].IsObject()) throw Napi::Error::New(env, "Requires 1 argument: options");
+    ApplyFrameRequest(env, info[0].As<Napi::Object>());
     return env.Undefined();
 }
 
-// --- Studio Mode Functions ---
-
-Napi::Value SetPreviewScene(const Napi::CallbackInfo& info) {
+// onFrame(callback, { view: 'program' | 'preview', maxFps, ...frame options })
+// Calls back on the JS thread only when the view produced a frame with new
+// content, at most maxFps times per second. Returns a subscription id.
+Napi::Value OnFrame(const Napi::CallbackInfo& info) {
     Napi::Env env = info.Env();
-    if (info.Length() < 1) throw Napi::Error::New(env, "Scene name is required.");
-
-    std::string scene_name = info[0].As<Napi::String>();
-    obs_source_t *source = obs_get_source_by_name(scene_name.c_str());
-    if (!source) throw Napi::Error::New(env, "Scene not found.");
+    if (info.Length() < 1 || !info[0].IsFunction()) throw Napi::Error::New(env, "Requires 1 argument: callback");
+
+    FrameView view = FRAME_VIEW_PROGRAM;
+    double max_fps = 0.0;
+    if (info.Length() > 1 && info[1].IsObject()) {
+        Napi::Object options = info[1].As<Napi::Object>();
+        if (options.Has("view")) {
+            view = ParseFrameView(env, options.Get("view"));
+        }
+        if (options.Has("maxFps")) {
+            max_fps = options.Get("maxFps").As<Napi::Number>().DoubleValue();
+        }
+        ApplyFrameRequest(env, options, &view);
+    }
 
-    // With a simple transition like "cut", setting source B is not how it works.
-    // We set it as the *next* source for the main transition.
-    obs_transition_set(g_main_transition, source);
-    g_preview_scene = source; // Keep a reference for manual rendering
+    auto subscription = std::make_shared<FrameSubscription>();
+    subscription->view = view;
+    subscription->min_interval_ns = max_fps > 0.0 ? (uint64_t)(1000000000.0 / max_fps) : 0;
+    subscription->tsfn = Napi::ThreadSafeFunction::New(env, info[0].As<Napi::Function>(), "titan_frame_subscription", 0, 1);
+    subscription->tsfn.Unref(env); // Never keep the process alive on its own
 
-    obs_source_release(source);
-    return env.Undefined();
+    TITAN_PROFILE_LOCK(lock, g_frame_subscriptions_mutex, "js.frame_subscriptions_lock");
+    subscription->id = g_next_frame_subscription_id++;
+    g_frame_subscriptions.push_back(subscription);
+    return Napi::Number::New(env, subscription->id);
 }
 
-Napi::Value ExecuteTransition(const Napi::CallbackInfo& info) {
+Napi::Value OffFrame(const Napi::CallbackInfo& info) {
     Napi::Env env = info.Env();
-    obs_transition_start(g_main_transition, OBS_TRANSITION_MODE_AUTO, 0, nullptr);
-    g_preview_scene = nullptr; // Preview becomes program, clear preview scene
+    if (info.Length() < 1 || !info[0].IsNumber()) throw Napi::Error::New(env, "Requires 1 argument: subscriptionId");
+    uint32_t id = info[0].As<Napi::Number>().Uint32Value();
+
+    TITAN_PROFILE_LOCK(lock, g_frame_subscriptions_mutex, "js.frame_subscriptions_lock");
+    for (auto it = g_frame_subscriptions.begin(); it != g_frame_subscriptions.end(); ++it) {
+        if ((*it)->id == id) {
+            (*it)->tsfn.Release();
+            g_frame_subscriptions.erase(it);
+            break;
+        }
+    }
     return env.Undefined();
 }
 
-Napi::Value GetProgramSceneName(const Napi::CallbackInfo& info) {
+Napi::Value SetReadbackLatency(const Napi::CallbackInfo& info) {
     Napi::Env env = info.Env();
-    obs_source_t* program_source = obs_transition_get_source(g_main_transition, OBS_TRANSITION_SOURCE_A);
-    if (program_source) {
-        return Napi::String::New(env, obs_source_get_name(program_source));
+    if (info.Length() < 1 || !info[0].IsNumber()) throw Napi::Error::New(env, "Requires 1 argument: frames");
+
+    int32_t frames = info[0].As<Napi::Number>().Int32Value();
+    if (frames < 0 || frames > (int32_t)GpuReadback::kMaxLatency) {
+        throw Napi::RangeError::New(env, "Readback latency must be between 0 and " +
+                                         std::to_string(GpuReadback::kMaxLatency) + " frames");
     }
-    return env.Null();
+
+    g_program_readback.SetLatency((uint32_t)frames);
+    g_preview_readback.SetLatency((uint32_t)frames);
+    return env.Undefined();
 }
 
-bool enum_scenes_callback(void *param, obs_source_t *source) {
-    if (obs_source_get_type(source) == OBS_SOURCE_TYPE_SCENE) {
-        auto scene_names = static_cast<std::vector<std::string>*>(param);
-        scene_names->push_back(obs_source_get_name(source));
-    }
-    return true; // Continue enumeration
+static Napi::Object ReadbackStatsToNapiObject(Napi::Env env, const GpuReadback& readback) {
+    GpuReadbackStats stats = readback.GetStats();
+    Napi::Object obj = Napi::Object::New(env);
+    obj.Set("latency", stats.latency);
+    obj.Set("framesStaged", (double)stats.frames_staged);
+    obj.Set("framesMapped", (double)stats.frames_mapped);
+    obj.Set("stallsAvoided", (double)stats.stalls_avoided);
+    obj.Set("syncMaps", (double)stats.sync_maps);
+    obj.Set("mapFailures", (double)stats.map_failures);
+    return obj;
 }
 
-Napi::Value GetSceneList(const Napi::CallbackInfo& info) {
+Napi::Value GetReadbackStats(const Napi::CallbackInfo& info) {
     Napi::Env env = info.Env();
-    std::vector<std::string> scene_names;
-    obs_enum_sources(enum_scenes_callback, &scene_names);
-
-    Napi::Array napi_array = Napi::Array::New(env, scene_names.size());
-    for (size_t i = 0; i < scene_names.size(); ++i) {
-        napi_array[i] = Napi::String::New(env, scene_names[i]);
-    }
-    return napi_array;
+    Napi::Object result = Napi::Object::New(env);
+    result.Set("program", ReadbackStatsToNapiObject(env, g_program_readback));
+    result.Set("preview", ReadbackStatsToNapiObject(env, g_preview_readback));
+    return result;
 }
 
-struct SceneSourcesCallbackData {
-    Napi::Env env;
-    Napi::Array array;
-};
-
-bool enum_scene_sources_callback(obs_scene_t *scene, obs_sceneitem_t *item, void *param) {
-    auto data = static_cast<SceneSourcesCallbackData*>(param);
-    obs_source_t *source = obs_sceneitem_get_source(item);
-    if (source) {
-        const char *name = obs_source_get_name(source);
-        Napi::Object source_info = Napi::Object::New(data->env);
-        source_info.Set("name", Napi::String::New(data->env, name));
+// --- View Scheduling Functions ---
 
-        uint32_t flags = obs_source_get_output_flags(source);
-        bool has_audio = (flags & OBS_SOURCE_AUDIO) != 0;
-        source_info.Set("hasAudio", Napi::Boolean::New(data->env, has_audio));
+// setViewActive(view, active): inactive views cost no GPU time at all; they
+// keep their last frame and pick up again on the next output frame.
+Napi::Value SetViewActive(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    if (info.Length() < 2) throw Napi::Error::New(env, "Requires 2 arguments: view, active");
 
-        data->array[data->array.Length()] = source_info;
-    }
-    return true;
+    FrameView view = ParseFrameView(env, info[0]);
+    g_view_schedules[view].active.store(info[1].ToBoolean().Value(), std::memory_order_relaxed);
+    return env.Undefined();
 }
 
-Napi::Value GetSceneSources(const Napi::CallbackInfo& info) {
+// setViewFps(view, fps): caps how often the view is rendered and read back;
+// 0 renders it on every output frame.
+Napi::Value SetViewFps(const Napi::CallbackInfo& info) {
     Napi::Env env = info.Env();
-    if (info.Length() < 1) throw Napi::Error::New(env, "Scene name is required.");
-
-    std::string scene_name = info[0].As<Napi::String>();
-    obs_source_t *scene_source = obs_get_source_by_name(scene_name.c_str());
-    if (!scene_source) throw Napi::Error::New(env, "Scene not found.");
-
-    obs_scene_t *scene = obs_scene_from_source(scene_source);
+    if (info.Length() < 2 || !info[1].IsNumber()) throw Napi::Error::New(env, "Requires 2 arguments: view, fps");
 
-    SceneSourcesCallbackData data = {env, Napi::Array::New(env)};
-    obs_scene_enum_items(scene, enum_scene_sources_callback, &data);
+    FrameView view = ParseFrameView(env, info[0]);
+    double fps = info[1].As<Napi::Number>().DoubleValue();
+    if (!(fps >= 0.0) || fps > 1000.0) throw Napi::RangeError::New(env, "fps must be between 0 and 1000");
+    g_view_schedules[view].fps.store((uint32_t)fps, std::memory_order_relaxed);
+    return env.Undefined();
+}
 
-    obs_source_release(scene_source);
-    return data.array;
+static Napi::Object ViewStatsToNapiObject(Napi::Env env, const ViewSchedule& schedule) {
+    Napi::Object obj = Napi::Object::New(env);
+    obj.Set("active", schedule.active.load(std::memory_order_relaxed));
+    obj.Set("fps", schedule.fps.load(std::memory_order_relaxed));
+    obj.Set("framesRendered", (double)schedule.frames_rendered.load(std::memory_order_relaxed));
+    obj.Set("skippedInactive", (double)schedule.skipped_inactive.load(std::memory_order_relaxed));
+    obj.Set("skippedRate", (double)schedule.skipped_rate.load(std::memory_order_relaxed));
+    obj.Set("skippedSameAsProgram", (double)schedule.skipped_same_as_program.load(std::memory_order_relaxed));
+    obj.Set("renderWidth", schedule.render_width.load(std::memory_order_relaxed));
+    obj.Set("renderHeight", schedule.render_height.load(std::memory_order_relaxed));
+    return obj;
 }
 
-Napi::Value AddSource(const Napi::CallbackInfo& info) {
+// setSceneThumbnails({ enabled, fps = 2, tileWidth = 320, columns = 0,
+// scenes }). scenes lists the scenes to show, in tile order; missing or
+// empty means every scene. Missing keys keep their current value.
+Napi::Value SetSceneThumbnails(const Napi::CallbackInfo& info) {
     Napi::Env env = info.Env();
-    if (info.Length() < 3) {
-        throw Napi::Error::New(env, "Requires 3 arguments: sceneName, sourceId, sourceName");
+    if (info.Length() < 1 || !info[0].IsObject()) throw Napi::Error::New(env, "Requires 1 argument: options");
+    Napi::Object options = info[0].As<Napi::Object>();
+
+    SceneThumbnailsConfig config = g_scene_thumbnails.config();
+    if (options.Get("enabled").IsBoolean()) config.enabled = options.Get("enabled").As<Napi::Boolean>();
+    if (options.Get("fps").IsNumber()) {
+        config.fps = options.Get("fps").As<Napi::Number>().DoubleValue();
+        if (!(config.fps >= 0.1 && config.fps <= 30.0)) {
+            throw Napi::RangeError::New(env, "fps must be between 0.1 and 30");
+        }
     }
+    if (options.Get("tileWidth").IsNumber()) {
+        config.tile_width = options.Get("tileWidth").As<Napi::Number>().Uint32Value();
+        if (config.tile_width < 16 || config.tile_width > SceneThumbnails::kMaxAtlasSize) {
+            throw Napi::RangeError::New(env, "tileWidth must be between 16 and 4096");
+        }
+    }
+    if (options.Get("columns").IsNumber()) config.columns = options.Get("columns").As<Napi::Number>().Uint32Value();
+    if (options.Has("scenes")) {
+        config.scenes.clear();
+        Napi::Value scenes = options.Get("scenes");
+        if (scenes.IsArray()) {
+            Napi::Array list = scenes.As<Napi::Array>();
+            for (uint32_t i = 0; i < list.Length(); i++) {
+                if (!list.Get(i).IsString()) throw Napi::TypeError::New(env, "scenes must be an array of names");
+                config.scenes.push_back(list.Get(i).As<Napi::String>());
+            }
+        } else if (!scenes.IsNull() && !scenes.IsUndefined()) {
+            throw Napi::TypeError::New(env, "scenes must be an array of names");
+        }
+    }
+    g_scene_thumbnails.Configure(config);
+    return env.Undefined();
+}
+
+// getSceneThumbnails({ since }) -> { sequence, timestamp, frame, width,
+// height, format, planes, tileWidth, tileHeight, columns, rows, tiles:
+// [{ scene, x, y, width, height, rendered }], stats }. frame is the RGBA
+// atlas (null while there are no tiles) and is left out, along with the
+// layout, when its sequence is not newer than `since`.
+Napi::Value GetSceneThumbnails(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    uint64_t since = 0;
+    if (info.Length() > 0 && info[0].IsObject()) since = OptionalSequence(info[0].As<Napi::Object>(), "since");
+
+    Napi::Object result = Napi::Object::New(env);
+    SceneThumbnailsStats stats = g_scene_thumbnails.GetStats();
+    Napi::Object stats_obj = Napi::Object::New(env);
+    stats_obj.Set("refreshes", (double)stats.refreshes);
+    stats_obj.Set("published", (double)stats.published);
+    stats_obj.Set("dropped", (double)stats.dropped);
+    stats_obj.Set("scenes", stats.scenes);
+    result.Set("stats", stats_obj);
+
+    FrameSlab* atlas = g_scene_thumbnails.frames().AcquireLatest();
+    if (!atlas) return result;
+    result.Set("sequence", (double)atlas->sequence);
+    result.Set("timestamp", atlas->timestamp_ns / 1000000.0);
+    ThumbnailLayout layout;
+    if (atlas->sequence <= since || !g_scene_thumbnails.LayoutFor(atlas->sequence, &layout)) {
+        FrameExchange::Release(atlas);
+        return result;
+    }
+
+    Napi::Array tiles = Napi::Array::New(env, layout.tiles.size());
+    for (size_t i = 0; i < layout.tiles.size(); i++) {
+        const ThumbnailTile& tile = layout.tiles[i];
+        Napi::Object entry = Napi::Object::New(env);
+        entry.Set("scene", tile.scene);
+        entry.Set("x", tile.x);
+        entry.Set("y", tile.y);
+        entry.Set("width", layout.tile_width);
+        entry.Set("height", layout.tile_height);
+        entry.Set("rendered", tile.rendered);
+        tiles.Set((uint32_t)i, entry);
+    }
+    result.Set("tileWidth", layout.tile_width);
+    result.Set("tileHeight", layout.tile_height);
+    result.Set("columns", layout.columns);
+    result.Set("rows", layout.rows);
+    result.Set("tiles", tiles);
+
+    if (atlas->size > 0) {
+        result.Set("width", atlas->width);
+        result.Set("height", atlas->height);
+        SetFrameLayout(env, result, atlas, "");
+        result.Set("frame", WrapFrameSlab(env, atlas));
+    } else {
+        result.Set("frame", env.Null());
+        FrameExchange::Release(atlas);
+    }
+    return result;
+}
+
+Napi::Value GetViewStats(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    Napi::Object result = Napi::Object::New(env);
+    result.Set("program", ViewStatsToNapiObject(env, g_view_schedules[FRAME_VIEW_PROGRAM]));
+    result.Set("preview", ViewStatsToNapiObject(env, g_view_schedules[FRAME_VIEW_PREVIEW]));
+    return result;
+}
+
+// startFrameShm({ name = '/titan-program', slots = 4, maxWidth, maxHeight })
+// -> { name, slots, slotCapacity }. Publishes every program frame, RGBA or
+// BGRA at canvas size, into a POSIX shared-memory ring that local processes
+// read in place (src/reader). Slots are sized for maxWidth x maxHeight,
+// the canvas (base) resolution by default; larger frames are dropped and
+// counted.
+Napi::Value StartFrameShm(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    if (!obs_is_running) throw Napi::Error::New(env, "OBS is not running.");
+
+    std::string name = kFrameShmDefaultName;
+    uint32_t slots = FrameShmPublisher::kDefaultSlots;
+    uint32_t max_width = 0, max_height = 0;
+    struct obs_video_info ovi;
+    if (obs_get_video_info(&ovi)) {
+        // The program readback is obs_get_main_texture(), which is at base
+        // resolution whatever the output is scaled to.
+        max_width = ovi.base_width;
+        max_height = ovi.base_height;
+    }
+    if (info.Length() > 0 && info[0].IsObject()) {
+        Napi::Object options = info[0].As<Napi::Object>();
+        if (options.Get("name").IsString()) name = options.Get("name").As<Napi::String>().Utf8Value();
+        if (options.Get("slots").IsNumber()) {
+            slots = options.Get("slots").As<Napi::Number>().Uint32Value();
+            if (slots < 2 || slots > FrameShmPublisher::kMaxSlots) {
+                throw Napi::RangeError::New(env, "slots must be between 2 and " +
+                                                 std::to_string(FrameShmPublisher::kMaxSlots));
+            }
+        }
+        if (options.Get("maxWidth").IsNumber()) max_width = options.Get("maxWidth").As<Napi::Number>().Uint32Value();
+        if (options.Get("maxHeight").IsNumber()) {
+            max_height = options.Get("maxHeight").As<Napi::Number>().Uint32Value();
+        }
+    }
+    if (max_width == 0 || max_height == 0 || max_width > 16384 || max_height > 16384) {
+        throw Napi::RangeError::New(env, "maxWidth and maxHeight must be between 1 and 16384");
+    }
+
+    std::string error = g_frame_shm.Start(name, slots, (size_t)max_width * max_height * 4);
+    if (!error.empty()) throw Napi::Error::New(env, error);
+    FrameShmStats stats = g_frame_shm.GetStats();
+    Napi::Object result = Napi::Object::New(env);
+    result.Set("name", stats.name);
+    result.Set("slots", stats.slots);
+    result.Set("slotCapacity", (double)stats.slot_capacity);
+    return result;
+}
+
+Napi::Value StopFrameShm(const Napi::CallbackInfo& info) {
+    g_frame_shm.Stop();
+    return info.Env().Undefined();
+}
+
+// getFrameShmStats() -> { active, name, slots, slotCapacity, published,
+// dropped, waiters }
+Napi::Value GetFrameShmStats(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    FrameShmStats stats = g_frame_shm.GetStats();
+    Napi::Object result = Napi::Object::New(env);
+    result.Set("active", stats.active);
+    if (!stats.active) return result;
+    result.Set("name", stats.name);
+    result.Set("slots", stats.slots);
+    result.Set("slotCapacity", (double)stats.slot_capacity);
+    result.Set("published", (double)stats.published);
+    result.Set("dropped", (double)stats.dropped);
+    result.Set("waiters", stats.waiters);
+    return result;
+}
+
+Napi::Value CreateScene(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    if (info.Length() < 1) throw Napi::Error::New(env, "Scene name is required.");
+
+    std::string scene_name = info[0].As<Napi::String>();
+    obs_scene_t *scene = obs_scene_create(scene_name.c_str());
+    if (!scene) throw Napi::Error::New(env, "Failed to create scene.");
+
+    // If this is the first scene, set it to program view
+    if (obs_transition_get_source(g_main_transition, OBS_TRANSITION_SOURCE_A) == nullptr) {
+        obs_transition_set(g_main_transition, obs_scene_get_source(scene));
+    }
+
+    g_scenes.Adopt(obs_scene_get_source(scene));
+    obs_scene_release(scene);
+    return env.Undefined();
+}
+
+// --- Source Lookup ---
+
+// Source arguments are either a handle from the registry or a source name.
+// Returns a strong reference or nullptr; neither form walks libobs' source
+// list unless the name is unknown to the registry.
+static obs_source_t* AcquireSourceArg(const Napi::Value& value) {
+    if (value.IsNumber()) {
+        return g_sources.Acquire(value.As<Napi::Number>().Uint32Value());
+    }
+    std::string name = value.As<Napi::String>();
+    obs_source_t* source = g_sources.AcquireByName(name);
+    return source ? source : obs_get_source_by_name(name.c_str());
+}
+
+// Like AcquireSourceArg, but a scene name that the library still holds as a
+// descriptor is created first.
+static obs_source_t* AcquireSceneArg(const Napi::Value& value) {
+    obs_source_t* source = AcquireSourceArg(value);
+    if (!source && value.IsString()) source = g_scenes.Acquire(value.As<Napi::String>());
+    return source;
+}
+
+static std::string SourceArgToString(const Napi::Value& value) {
+    if (value.IsNumber()) return "#" + std::to_string(value.As<Napi::Number>().Uint32Value());
+    return value.As<Napi::String>();
+}
+
+static Napi::Value SourceHandleToNapi(Napi::Env env, SourceRegistry::Handle handle) {
+    return handle == SourceRegistry::kInvalidHandle ? env.Null() : Napi::Number::New(env, handle);
+}
+
+Napi::Value GetSourceHandle(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    if (info.Length() < 1) throw Napi::Error::New(env, "Requires 1 argument: sourceName");
+
+    std::string source_name = info[0].As<Napi::String>();
+    SourceRegistry::Handle handle = g_sources.Find(source_name);
+    if (handle == SourceRegistry::kInvalidHandle) {
+        obs_source_t* source = obs_get_source_by_name(source_name.c_str());
+        handle = g_sources.Register(source);
+        obs_source_release(source);
+    }
+    return SourceHandleToNapi(env, handle);
+}
+
+Napi::Value GetSourceName(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    if (info.Length() < 1 || !info[0].IsNumber()) throw Napi::Error::New(env, "Requires 1 argument: handle");
+
+    obs_source_t* source = g_sources.Acquire(info[0].As<Napi::Number>().Uint32Value());
+    if (!source) return env.Null();
+    Napi::String name = Napi::String::New(env, obs_source_get_name(source));
+    obs_source_release(source);
+    return name;
+}
+
+// [{ handle, name }] for every source libobs currently knows about.
+Napi::Value GetSourceHandles(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    auto entries = g_sources.Entries();
+    Napi::Array result = Napi::Array::New(env, entries.size());
+    for (size_t i = 0; i < entries.size(); i++) {
+        Napi::Object entry = Napi::Object::New(env);
+        entry.Set("handle", entries[i].first);
+        entry.Set("name", entries[i].second);
+        result.Set((uint32_t)i, entry);
+    }
+    return result;
+}
+
+// --- Studio Mode Functions ---
+
+Napi::Value SetPreviewScene(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    if (info.Length() < 1) throw Napi::Error::New(env, "Scene name is required.");
+
+    obs_source_t *source = AcquireSceneArg(info[0]);
+    if (!source) throw Napi::Error::New(env, "Scene not found.");
+
+    // With a simple transition like "cut", setting source B is not how it works.
+    // We set it as the *next* source for the main transition.
+    obs_transition_set(g_main_transition, source);
+    g_preview_scene.store(source, std::memory_order_release); // Kept for manual rendering
+
+    obs_source_release(source);
+    return env.Undefined();
+}
+
+Napi::Value ExecuteTransition(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    obs_transition_start(g_main_transition, OBS_TRANSITION_MODE_AUTO, 0, nullptr);
+    g_preview_scene.store(nullptr, std::memory_order_release); // Preview becomes program
+    return env.Undefined();
+}
+
+Napi::Value GetProgramSceneName(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    obs_source_t* program_source = obs_transition_get_source(g_main_transition, OBS_TRANSITION_SOURCE_A);
+    if (program_source) {
+        return Napi::String::New(env, obs_source_get_name(program_source));
+    }
+    return env.Null();
+}
+
+bool enum_scenes_callback(void *param, obs_source_t *source) {
+    if (obs_source_get_type(source) == OBS_SOURCE_TYPE_SCENE) {
+        auto scene_names = static_cast<std::vector<std::string>*>(param);
+        scene_names->push_back(obs_source_get_name(source));
+    }
+    return true; // Continue enumeration
+}
+
+// Includes scenes the library has not created yet, in collection order.
+Napi::Value GetSceneList(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    std::vector<std::string> live_names;
+    // obs_enum_sources skips scenes.
+    obs_enum_scenes(enum_scenes_callback, &live_names);
+    std::vector<std::string> scene_names = g_scenes.Order(live_names);
 
-    std::string scene_name = info[0].As<Napi::String>();
-    std::string source_id = info[1].As<Napi::String>();
-    std::string source_name = info[2].As<Napi::String>();
-
-    obs_source_t* scene_source = obs_get_source_by_name(scene_name.c_str());
+    Napi::Array napi_array = Napi::Array::New(env, scene_names.size());
+    for (size_t i = 0; i < scene_names.size(); ++i) {
+        napi_array[i] = Napi::String::New(env, scene_names[i]);
+    }
+    return napi_array;
+}
+
+struct SceneSourcesCallbackData {
+    Napi::Env env;
+    Napi::Array array;
+};
+
+bool enum_scene_sources_callback(obs_scene_t *scene, obs_sceneitem_t *item, void *param) {
+    auto data = static_cast<SceneSourcesCallbackData*>(param);
+    obs_source_t *source = obs_sceneitem_get_source(item);
+    if (source) {
+        const char *name = obs_source_get_name(source);
+        Napi::Object source_info = Napi::Object::New(data->env);
+        source_info.Set("name", Napi::String::New(data->env, name));
+        source_info.Set("handle", Napi::Number::New(data->env, g_sources.Register(source)));
+
+        uint32_t flags = obs_source_get_output_flags(source);
+        bool has_audio = (flags & OBS_SOURCE_AUDIO) != 0;
+        source_info.Set("hasAudio", Napi::Boolean::New(data->env, has_audio));
+
+        data->array[data->array.Length()] = source_info;
+    }
+    return true;
+}
+
+Napi::Value GetSceneSources(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    if (info.Length() < 1) throw Napi::Error::New(env, "Scene name is required.");
+
+    obs_source_t *scene_source = AcquireSceneArg(info[0]);
+    if (!scene_source) throw Napi::Error::New(env, "Scene not found.");
+
+    obs_scene_t *scene = obs_scene_from_source(scene_source);
+
+    SceneSourcesCallbackData data = {env, Napi::Array::New(env)};
+    obs_scene_enum_items(scene, enum_scene_sources_callback, &data);
+
+    obs_source_release(scene_source);
+    return data.array;
+}
+
+// Gives audio sources a slot in the meter table; returns the slot index or
+// AudioMeterTable::kInvalidIndex.
+static uint32_t AttachAudioMeter(obs_source_t* source) {
+    if ((obs_source_get_output_flags(source) & OBS_SOURCE_AUDIO) == 0) return AudioMeterTable::kInvalidIndex;
+    if (g_loudness_all_sources.load(std::memory_order_relaxed)) g_loudness.AttachSource(source);
+    return g_audio_meters.Attach(source);
+}
+
+Napi::Value AddSource(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    if (info.Length() < 3) {
+        throw Napi::Error::New(env, "Requires 3 arguments: sceneName, sourceId, sourceName");
+    }
+
+    std::string source_id = info[1].As<Napi::String>();
+    std::string source_name = info[2].As<Napi::String>();
+
+    obs_source_t* scene_source = AcquireSourceArg(info[0]);
     if (!scene_source) {
-        throw Napi::Error::New(env, "Scene not found: " + scene_name);
+        throw Napi::Error::New(env, "Scene not found: " + SourceArgToString(info[0]));
     }
 
     obs_scene_t* scene = obs_scene_from_source(scene_source);
@@ -293,512 +1489,2191 @@ Napi::Value AddSource(const Napi::CallbackInfo& info) {
 
     obs_scene_add(scene, new_source);
 
-    // --- Volmeter Management ---
-    uint32_t flags = obs_source_get_output_flags(new_source);
-    if ((flags & OBS_SOURCE_AUDIO) != 0) {
-        std::lock_guard<std::mutex> lock(g_audio_mutex);
-        obs_volmeter_t* volmeter = obs_volmeter_create(OBS_FADER_LOG);
-        std::string* name_ptr = new std::string(source_name);
+    AttachAudioMeter(new_source);
+    SourceRegistry::Handle handle = g_sources.Register(new_source);
+
+    obs_source_release(new_source);
+    obs_source_release(scene_source);
 
-        obs_volmeter_add_callback(volmeter, volmeter_callback, name_ptr);
+    return SourceHandleToNapi(env, handle);
+}
 
-        if (obs_volmeter_attach_source(volmeter, new_source)) {
-            g_volmeters[source_name] = {volmeter, name_ptr};
-        } else {
-            obs_volmeter_destroy(volmeter);
-            delete name_ptr;
+Napi::Value RemoveSource(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    if (info.Length() < 2) throw Napi::Error::New(env, "Requires 2 arguments: sceneName, sourceName");
+
+    obs_source_t* scene_source = AcquireSourceArg(info[0]);
+    if (!scene_source) throw Napi::Error::New(env, "Scene not found: " + SourceArgToString(info[0]));
+
+    obs_scene_t* scene = obs_scene_from_source(scene_source);
+    obs_sceneitem_t* scene_item = nullptr;
+    if (info[1].IsNumber()) {
+        obs_source_t* source = g_sources.Acquire(info[1].As<Napi::Number>().Uint32Value());
+        if (source) {
+            scene_item = obs_scene_sceneitem_from_source(scene, source);
+            obs_source_release(source);
         }
+    } else {
+        std::string source_name = info[1].As<Napi::String>();
+        // Unlike obs_scene_sceneitem_from_source, this lookup returns no
+        // reference of its own; take one so both paths release alike.
+        scene_item = obs_scene_find_source_recursive(scene, source_name.c_str());
+        if (scene_item) obs_sceneitem_addref(scene_item);
+    }
+
+    // Meters stay with the source, which may still be in other scenes;
+    // they are freed when the source is removed or destroyed.
+    if (scene_item) {
+        obs_sceneitem_remove(scene_item);
+        obs_sceneitem_release(scene_item);
     }
-    // --- End Volmeter Management ---
 
-    obs_source_release(new_source);
     obs_source_release(scene_source);
+    return env.Undefined();
+}
+
+Napi::Value SetSourceMuted(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    if (info.Length() < 2) throw Napi::Error::New(env, "Requires 2 arguments: sourceName, muted");
+
+    bool muted = info[1].As<Napi::Boolean>();
+
+    obs_source_t* source = AcquireSourceArg(info[0]);
+    if (source) {
+        obs_source_set_muted(source, muted);
+        obs_source_release(source);
+    }
+    return env.Undefined();
+}
+
+Napi::Value IsSourceMuted(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    if (info.Length() < 1) throw Napi::Error::New(env, "Requires 1 argument: sourceName");
+
+    bool muted = false;
+
+    obs_source_t* source = AcquireSourceArg(info[0]);
+    if (source) {
+        muted = obs_source_muted(source);
+        obs_source_release(source);
+    }
+    return Napi::Boolean::New(env, muted);
+}
+
+// { sourceName: peak dB } with decay applied, loudest channel.
+Napi::Value GetAudioLevels(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    Napi::Object levels = Napi::Object::New(env);
+
+    AudioMeterReading reading;
+    for (auto const& [index, name] : g_audio_meters.Entries()) {
+        if (!g_audio_meters.Read(index, &reading)) continue;
+        float peak = -INFINITY;
+        for (uint32_t ch = 0; ch < reading.channels; ch++) {
+            peak = std::max(peak, reading.peak[ch]);
+        }
+        levels.Set(name, Napi::Number::New(env, peak));
+    }
+
+    return levels;
+}
+
+static Napi::Array ChannelLevelsToNapi(Napi::Env env, const float* levels, uint32_t channels) {
+    Napi::Array array = Napi::Array::New(env, channels);
+    for (uint32_t ch = 0; ch < channels; ch++) {
+        array.Set(ch, Napi::Number::New(env, levels[ch]));
+    }
+    return array;
+}
+
+// [{ index, name, channels, magnitude[], peak[], inputPeak[], peakHold[] }]
+// with one entry per channel, all in dBFS.
+Napi::Value GetAudioMeters(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    Napi::Array meters = Napi::Array::New(env);
+    uint32_t meter_idx = 0;
+
+    AudioMeterReading reading;
+    for (auto const& [index, name] : g_audio_meters.Entries()) {
+        if (!g_audio_meters.Read(index, &reading)) continue;
+        Napi::Object meter = Napi::Object::New(env);
+        meter.Set("index", index);
+        meter.Set("name", name);
+        meter.Set("channels", reading.channels);
+        meter.Set("magnitude", ChannelLevelsToNapi(env, reading.magnitude, reading.channels));
+        meter.Set("peak", ChannelLevelsToNapi(env, reading.peak, reading.channels));
+        meter.Set("inputPeak", ChannelLevelsToNapi(env, reading.input_peak, reading.channels));
+        meter.Set("peakHold", ChannelLevelsToNapi(env, reading.peak_hold, reading.channels));
+        meters.Set(meter_idx++, meter);
+    }
+    return meters;
+}
+
+// setAudioMeterOptions({ decayRate: dB per second, peakHold: seconds })
+Napi::Value SetAudioMeterOptions(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    if (info.Length() < 1 || !info[0].IsObject()) throw Napi::Error::New(env, "Requires 1 argument: options");
+    Napi::Object options = info[0].As<Napi::Object>();
+
+    float decay_rate = AudioMeterTable::kDefaultDecayRate;
+    float peak_hold = AudioMeterTable::kDefaultPeakHoldSeconds;
+    if (options.Has("decayRate")) decay_rate = options.Get("decayRate").As<Napi::Number>().FloatValue();
+    if (options.Has("peakHold")) peak_hold = options.Get("peakHold").As<Napi::Number>().FloatValue();
+    g_audio_meters.SetBallistics(decay_rate, peak_hold);
+    return env.Undefined();
+}
+
+
+// onAudioMeters(callback, { rate }) calls back `rate` times per second
+// (default 30) with callback(meters, layout). `meters` is a Float32Array laid
+// out as [sourceIndex][channel][magnitude, peak, inputPeak] in dBFS; it is
+// reused and overwritten on the next delivery. `layout` ({ version, sources,
+// channels, names }) is only passed when sources or channel counts changed,
+// and undefined otherwise. Returns a subscription id.
+Napi::Value OnAudioMeters(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    if (info.Length() < 1 || !info[0].IsFunction()) throw Napi::Error::New(env, "Requires 1 argument: callback");
+
+    double rate = 30.0;
+    if (info.Length() > 1 && info[1].IsObject()) {
+        Napi::Object options = info[1].As<Napi::Object>();
+        if (options.Has("rate")) rate = options.Get("rate").As<Napi::Number>().DoubleValue();
+    }
+    if (!(rate >= 1.0 && rate <= 240.0)) throw Napi::RangeError::New(env, "rate must be between 1 and 240");
+
+    auto subscription = std::make_shared<AudioMeterSubscription>();
+    subscription->id = g_next_audio_meter_subscription_id++;
+    subscription->interval_ns = (uint64_t)(1000000000.0 / rate);
+    subscription->tsfn = Napi::ThreadSafeFunction::New(env, info[0].As<Napi::Function>(), "titan_audio_meters", 0, 1);
+    subscription->tsfn.Unref(env); // Never keep the process alive on its own
+    subscription->timer = std::thread(audio_meter_timer, subscription.get());
+
+    g_audio_meter_subscriptions.push_back(subscription);
+    return Napi::Number::New(env, subscription->id);
+}
+
+Napi::Value OffAudioMeters(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    if (info.Length() < 1 || !info[0].IsNumber()) throw Napi::Error::New(env, "Requires 1 argument: subscriptionId");
+    uint32_t id = info[0].As<Napi::Number>().Uint32Value();
+
+    for (auto it = g_audio_meter_subscriptions.begin(); it != g_audio_meter_subscriptions.end(); ++it) {
+        if ((*it)->id == id) {
+            StopAudioMeterSubscription(**it);
+            g_audio_meter_subscriptions.erase(it);
+            break;
+        }
+    }
+    return env.Undefined();
+}
+
+// --- Loudness Functions ---
+
+// Loudness targets are a source (name or handle) or { mix } for output mix
+// 0-5. Returns true and sets `mix` for the latter.
+static bool LoudnessMixArg(Napi::Env env, const Napi::Value& value, uint32_t* mix) {
+    const char* usage = "Loudness target must be a source name, handle or { mix }";
+    if (!value.IsObject()) {
+        if (!value.IsString() && !value.IsNumber()) throw Napi::TypeError::New(env, usage);
+        return false;
+    }
+    Napi::Value mix_value = value.As<Napi::Object>().Get("mix");
+    if (!mix_value.IsNumber()) throw Napi::TypeError::New(env, usage);
+    int32_t index = mix_value.As<Napi::Number>().Int32Value();
+    if (index < 0 || index >= MAX_AUDIO_MIXES) {
+        throw Napi::RangeError::New(env, "mix must be between 0 and " + std::to_string(MAX_AUDIO_MIXES - 1));
+    }
+    *mix = (uint32_t)index;
+    return true;
+}
+
+// attachLoudness(target) -> meter index. Attaching a target twice keeps
+// its meter and measurement.
+Napi::Value AttachLoudness(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    if (info.Length() < 1) throw Napi::Error::New(env, "Requires 1 argument: target");
+
+    uint32_t mix;
+    uint32_t index;
+    if (LoudnessMixArg(env, info[0], &mix)) {
+        index = g_loudness.AttachMix(mix);
+    } else {
+        obs_source_t* source = AcquireSourceArg(info[0]);
+        if (!source) throw Napi::Error::New(env, "Source not found: " + SourceArgToString(info[0]));
+        bool audio = (obs_source_get_output_flags(source) & OBS_SOURCE_AUDIO) != 0;
+        index = audio ? g_loudness.AttachSource(source) : LoudnessTable::kInvalidIndex;
+        obs_source_release(source);
+        if (!audio) throw Napi::Error::New(env, "Source has no audio: " + SourceArgToString(info[0]));
+    }
+    if (index == LoudnessTable::kInvalidIndex) {
+        throw Napi::Error::New(env, "Could not attach a loudness meter (table full or audio not started).");
+    }
+    return Napi::Number::New(env, index);
+}
+
+Napi::Value DetachLoudness(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    if (info.Length() < 1) throw Napi::Error::New(env, "Requires 1 argument: target");
+
+    uint32_t mix;
+    if (LoudnessMixArg(env, info[0], &mix)) {
+        g_loudness.DetachMix(mix);
+    } else if (obs_source_t* source = AcquireSourceArg(info[0])) {
+        g_loudness.DetachSource(source);
+        obs_source_release(source);
+    }
+    return env.Undefined();
+}
+
+// resetLoudness(target?) restarts integrated loudness, range, maxima and
+// true peak for one meter, or for all of them without a target.
+Napi::Value ResetLoudness(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    if (info.Length() < 1 || info[0].IsUndefined() || info[0].IsNull()) {
+        g_loudness.ResetAll();
+        return env.Undefined();
+    }
+
+    uint32_t mix;
+    uint32_t index = LoudnessTable::kInvalidIndex;
+    if (LoudnessMixArg(env, info[0], &mix)) {
+        index = g_loudness.FindMix(mix);
+    } else if (obs_source_t* source = AcquireSourceArg(info[0])) {
+        index = g_loudness.FindSource(source);
+        obs_source_release(source);
+    }
+    if (index != LoudnessTable::kInvalidIndex) g_loudness.Reset(index);
+    return env.Undefined();
+}
+
+// setLoudnessOptions({ allSources }): with allSources, every audio source,
+// existing and future, gets a loudness meter; turning it off detaches all
+// source meters (mix meters stay).
+Napi::Value SetLoudnessOptions(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    if (info.Length() < 1 || !info[0].IsObject()) throw Napi::Error::New(env, "Requires 1 argument: options");
+    Napi::Object options = info[0].As<Napi::Object>();
+
+    if (options.Get("allSources").IsBoolean()) {
+        bool all = options.Get("allSources").As<Napi::Boolean>();
+        g_loudness_all_sources.store(all, std::memory_order_relaxed);
+        if (all) {
+            obs_enum_sources(
+                [](void*, obs_source_t* source) {
+                    if (obs_source_get_output_flags(source) & OBS_SOURCE_AUDIO) g_loudness.AttachSource(source);
+                    return true;
+                },
+                nullptr);
+        } else {
+            g_loudness.DetachAllSources();
+        }
+    }
+    return env.Undefined();
+}
+
+// [{ index, name, mix, channels, duration, momentary, shortTerm, integrated,
+// range, momentaryMax, shortTermMax, truePeak, truePeakChannels[] }].
+// Loudness is in LUFS (-Infinity until measured), range in LU, true peak
+// in dBTP; mix is null for sources and duration is the seconds measured
+// since the last reset. Values change every 100 ms.
+Napi::Value GetLoudness(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    Napi::Array meters = Napi::Array::New(env);
+    uint32_t meter_idx = 0;
+
+    LoudnessReading reading;
+    for (const LoudnessEntry& entry : g_loudness.Entries()) {
+        if (!g_loudness.Read(entry.index, &reading)) continue;
+        Napi::Object meter = Napi::Object::New(env);
+        meter.Set("index", entry.index);
+        meter.Set("name", entry.name);
+        meter.Set("mix", entry.mix >= 0 ? Napi::Number::New(env, entry.mix) : env.Null());
+        meter.Set("channels", reading.channels);
+        meter.Set("duration", reading.measured_seconds);
+        meter.Set("momentary", reading.momentary);
+        meter.Set("shortTerm", reading.short_term);
+        meter.Set("integrated", reading.integrated);
+        meter.Set("range", reading.range);
+        meter.Set("momentaryMax", reading.momentary_max);
+        meter.Set("shortTermMax", reading.short_term_max);
+        meter.Set("truePeak", reading.true_peak);
+        meter.Set("truePeakChannels", ChannelLevelsToNapi(env, reading.channel_true_peak, reading.channels));
+        meters.Set(meter_idx++, meter);
+    }
+    return meters;
+}
+
+// --- Source Properties ---
+
+Napi::Object ObsDataToNapiObject(Napi::Env env, obs_data_t* data, bool include_defaults = false);
+obs_data_t* NapiObjectToObsData(Napi::Env env, Napi::Object obj);
+
+static const char* PropertyTypeName(obs_property_type type) {
+    switch (type) {
+        case OBS_PROPERTY_BOOL: return "bool";
+        case OBS_PROPERTY_INT: return "int";
+        case OBS_PROPERTY_FLOAT: return "float";
+        case OBS_PROPERTY_TEXT: return "text";
+        case OBS_PROPERTY_PATH: return "path";
+        case OBS_PROPERTY_LIST: return "list";
+        case OBS_PROPERTY_COLOR: return "color";
+        case OBS_PROPERTY_BUTTON: return "button";
+        case OBS_PROPERTY_FONT: return "font";
+        case OBS_PROPERTY_EDITABLE_LIST: return "editableList";
+        case OBS_PROPERTY_FRAME_RATE: return "frameRate";
+        case OBS_PROPERTY_GROUP: return "group";
+        case OBS_PROPERTY_COLOR_ALPHA: return "colorAlpha";
+        default: return "invalid";
+    }
+}
+
+static const char* ListFormatName(obs_combo_format format) {
+    switch (format) {
+        case OBS_COMBO_FORMAT_INT: return "int";
+        case OBS_COMBO_FORMAT_FLOAT: return "float";
+        case OBS_COMBO_FORMAT_STRING: return "string";
+        case OBS_COMBO_FORMAT_BOOL: return "bool";
+        default: return "invalid";
+    }
+}
+
+static Napi::Object PropertySchemaToNapi(Napi::Env env, const PropertySchema& prop) {
+    Napi::Object obj = Napi::Object::New(env);
+    obj.Set("name", prop.name);
+    obj.Set("description", prop.description);
+    if (!prop.long_description.empty()) obj.Set("longDescription", prop.long_description);
+    obj.Set("type", (int)prop.type);
+    obj.Set("typeName", PropertyTypeName(prop.type));
+    obj.Set("enabled", prop.enabled);
+    obj.Set("visible", prop.visible);
+
+    switch (prop.type) {
+        case OBS_PROPERTY_INT:
+        case OBS_PROPERTY_FLOAT:
+            obj.Set("min", prop.min);
+            obj.Set("max", prop.max);
+            obj.Set("step", prop.step);
+            obj.Set("kind", prop.number_type == OBS_NUMBER_SLIDER ? "slider" : "scroller");
+            if (!prop.suffix.empty()) obj.Set("suffix", prop.suffix);
+            break;
+        case OBS_PROPERTY_TEXT:
+            obj.Set("textType", prop.text_type == OBS_TEXT_PASSWORD    ? "password"
+                                : prop.text_type == OBS_TEXT_MULTILINE ? "multiline"
+                                : prop.text_type == OBS_TEXT_INFO      ? "info"
+                                                                       : "default");
+            break;
+        case OBS_PROPERTY_PATH:
+            obj.Set("pathType", prop.path_type == OBS_PATH_FILE_SAVE ? "save"
+                                : prop.path_type == OBS_PATH_DIRECTORY ? "directory"
+                                                                       : "file");
+            obj.Set("filter", prop.filter);
+            obj.Set("defaultPath", prop.default_path);
+            break;
+        case OBS_PROPERTY_EDITABLE_LIST:
+            obj.Set("listType", prop.editable_list_type == OBS_EDITABLE_LIST_TYPE_FILES       ? "files"
+                                : prop.editable_list_type == OBS_EDITABLE_LIST_TYPE_FILES_AND_URLS ? "filesAndUrls"
+                                                                                                 : "strings");
+            obj.Set("filter", prop.filter);
+            obj.Set("defaultPath", prop.default_path);
+            break;
+        case OBS_PROPERTY_LIST: {
+            obj.Set("listType", prop.list_type == OBS_COMBO_TYPE_EDITABLE ? "editable"
+                                : prop.list_type == OBS_COMBO_TYPE_RADIO  ? "radio"
+                                                                          : "list");
+            obj.Set("format", ListFormatName(prop.list_format));
+            Napi::Array options = Napi::Array::New(env, prop.items.size());
+            for (size_t i = 0; i < prop.items.size(); i++) {
+                const PropertyListItem& item = prop.items[i];
+                Napi::Object option = Napi::Object::New(env);
+                option.Set("name", item.name);
+                switch (prop.list_format) {
+                    case OBS_COMBO_FORMAT_INT: option.Set("value", (double)item.int_value); break;
+                    case OBS_COMBO_FORMAT_FLOAT: option.Set("value", item.float_value); break;
+                    case OBS_COMBO_FORMAT_BOOL: option.Set("value", item.bool_value); break;
+                    default: option.Set("value", item.string_value); break;
+                }
+                option.Set("disabled", item.disabled);
+                options.Set((uint32_t)i, option);
+            }
+            obj.Set("options", options);
+            break;
+        }
+        case OBS_PROPERTY_GROUP: {
+            obj.Set("checkable", prop.group_type == OBS_GROUP_CHECKABLE);
+            Napi::Array children = Napi::Array::New(env, prop.children.size());
+            for (size_t i = 0; i < prop.children.size(); i++) {
+                children.Set((uint32_t)i, PropertySchemaToNapi(env, *prop.children[i]));
+            }
+            obj.Set("children", children);
+            break;
+        }
+        default:
+            break;
+    }
+    return obj;
+}
+
+// { properties, revision }. Not an array with a revision property: the
+// contextBridge copy drops non-index properties of arrays.
+static Napi::Object PropertySchemaSetToNapi(Napi::Env env, const PropertySchemaSet& schema) {
+    Napi::Array properties = Napi::Array::New(env, schema.properties.size());
+    for (size_t i = 0; i < schema.properties.size(); i++) {
+        properties.Set((uint32_t)i, PropertySchemaToNapi(env, *schema.properties[i]));
+    }
+    Napi::Object result = Napi::Object::New(env);
+    result.Set("properties", properties);
+    // Lets the UI skip rebuilding a form whose schema did not change.
+    result.Set("revision", (double)schema.revision);
+    return result;
+}
+
+// Returns the property schema of a source, from the property cache, as
+// { properties, revision }. Each property carries `type` (the
+// obs_property_type value) and `typeName`, plus the attributes of its type:
+// min/max/step/kind for numbers, typed `options` and `format` for lists,
+// `children` for groups.
+Napi::Value GetSourceProperties(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    if (info.Length() < 1) {
+        throw Napi::Error::New(env, "Requires 1 argument: sourceName");
+    }
+    obs_source_t* source = AcquireSourceArg(info[0]);
+    if (!source) {
+        return env.Null(); // Return null if source not found
+    }
+
+    PropertyCache::SchemaPtr schema = g_property_cache.Get(source);
+    obs_source_release(source); // Release the source reference
+
+    if (!schema) {
+        return env.Null(); // No properties available
+    }
+    return PropertySchemaSetToNapi(env, *schema);
+}
+
+// Schema of a source type by id, without creating a source.
+Napi::Value GetSourceTypeProperties(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    if (info.Length() < 1 || !info[0].IsString()) {
+        throw Napi::TypeError::New(env, "Requires 1 argument: sourceId");
+    }
+    PropertyCache::SchemaPtr schema = g_property_cache.GetType(info[0].As<Napi::String>().Utf8Value());
+    if (!schema) return env.Null();
+    return PropertySchemaSetToNapi(env, *schema);
+}
+
+// Current values of a source's settings, defaults included, without
+// building its properties. Returns { values, revision } where revision is
+// that of the cached schema, or 0 if none is cached.
+Napi::Value GetSourcePropertyValues(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    if (info.Length() < 1) {
+        throw Napi::Error::New(env, "Requires 1 argument: sourceName");
+    }
+    obs_source_t* source = AcquireSourceArg(info[0]);
+    if (!source) return env.Null();
+
+    obs_data_t* settings = obs_source_get_settings(source);
+    Napi::Object result = Napi::Object::New(env);
+    result.Set("values", ObsDataToNapiObject(env, settings, true));
+    obs_data_release(settings);
+    result.Set("revision", (double)g_property_cache.Revision(source));
+    obs_source_release(source);
+    return result;
+}
+
+// Applies settings and runs the modified callbacks of the changed keys.
+// Returns true if that changed the source's schema (e.g. a device list
+// that depends on another setting), so the UI knows to re-fetch it.
+Napi::Value UpdateSourceProperties(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    if (info.Length() < 2 || !info[1].IsObject()) {
+        throw Napi::Error::New(env, "Requires 2 arguments: sourceName, propertiesObject");
+    }
+    Napi::Object props_obj = info[1].As<Napi::Object>();
+
+    obs_source_t* source = AcquireSourceArg(info[0]);
+    if (!source) {
+        throw Napi::Error::New(env, "Source not found: " + SourceArgToString(info[0]));
+    }
+
+    obs_data_t* settings = NapiObjectToObsData(env, props_obj);
+    bool schema_changed = g_property_cache.UpdateSettings(source, settings);
+
+    obs_data_release(settings);
+    obs_source_release(source);
+
+    return Napi::Boolean::New(env, schema_changed);
+}
+
+// Drops the cached schema of one source, or of everything with no argument.
+Napi::Value InvalidatePropertyCache(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    if (info.Length() < 1 || info[0].IsUndefined() || info[0].IsNull()) {
+        g_property_cache.InvalidateAll();
+        return env.Undefined();
+    }
+    obs_source_t* source = AcquireSourceArg(info[0]);
+    if (source) {
+        g_property_cache.Invalidate(source);
+        obs_source_release(source);
+    }
+    return env.Undefined();
+}
+
+Napi::Value GetPropertyCacheStats(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    PropertyCacheStats stats = g_property_cache.stats();
+    Napi::Object result = Napi::Object::New(env);
+    result.Set("hits", (double)stats.hits);
+    result.Set("builds", (double)stats.builds);
+    result.Set("refreshes", (double)stats.refreshes);
+    result.Set("invalidations", (double)stats.invalidations);
+    result.Set("typeEntries", (double)stats.type_entries);
+    result.Set("instanceEntries", (double)stats.instance_entries);
+    return result;
+}
+
+// --- Output Functions ---
+
+using OutputPhaseFn = std::function<void(const char* phase)>;
+
+// Spec and settings `name` starts with: its preset if it has one, else
+// `default_type` with the default encoder config. The settings are a copy
+// the caller releases.
+static OutputSpec OutputSpecFor(const std::string& name, const char* default_type, obs_data_t** settings) {
+    TITAN_PROFILE_LOCK(lock, g_output_mutex, "output.config_lock");
+    OutputSpec spec;
+    spec.type = default_type;
+    spec.video = g_encoder_config;
+    *settings = obs_data_create();
+    auto it = g_output_presets.find(name);
+    if (it != g_output_presets.end()) {
+        const OutputPreset& preset = it->second;
+        if (!preset.type.empty()) spec.type = preset.type;
+        if (preset.video) spec.video = *preset.video;
+        spec.audio_bitrate = preset.audio_bitrate;
+        if (preset.settings) obs_data_apply(*settings, preset.settings.get());
+    }
+    return spec;
+}
+
+// Starts `name` through g_outputs. Safe off the JS thread; returns an error
+// message, or "" on success or when it is already running.
+static std::string StartNamedOutput(const std::string& name, const char* default_type,
+                                    const std::function<void(obs_data_t*)>& configure, const OutputPhaseFn& phase) {
+    // g_outputs.Start() refuses while the encoder benchmark runs.
+    phase("encoders");
+    obs_data_t* settings;
+    OutputSpec spec = OutputSpecFor(name, default_type, &settings);
+    // Adaptive bitrate retunes the encoder live, which it can't do to one
+    // shared with record or replay (they default to the same config).
+    AdaptiveBitrateConfig adaptive = g_adaptive_bitrate.config();
+    spec.own_video_encoder = adaptive.enabled && adaptive.output == name;
+
+    phase("output");
+    if (configure) configure(settings);
+
+    phase("start");
+    std::string error = g_outputs.Start(name, spec, settings);
+    obs_data_release(settings);
+    return error;
+}
+
+static std::string StartStreamOutput(const std::string& server, const std::string& key, const OutputPhaseFn& phase) {
+    return StartNamedOutput("stream", "rtmp_output", [&](obs_data_t* settings) {
+        obs_data_set_string(settings, "server", server.c_str());
+        obs_data_set_string(settings, "key", key.c_str());
+    }, phase);
+}
+
+// The path and anything else the muxer needs come from the "record" preset.
+static std::string StartRecordOutput(const OutputPhaseFn& phase) {
+    return StartNamedOutput("record", "ffmpeg_muxer", nullptr, phase);
+}
+
+// Takes the packets of whatever encoders the "replay" spec resolves to; with
+// the same video config as stream or record those are shared, not doubled.
+static std::string StartReplayOutput(uint32_t max_memory_mb, const OutputPhaseFn& phase) {
+    return StartNamedOutput("replay", REPLAY_BUFFER_OUTPUT_ID, [&](obs_data_t* settings) {
+        obs_data_set_int(settings, "max_memory_mb", max_memory_mb);
+    }, phase);
+}
+
+static void ignore_output_phase(const char*) {}
+
+Napi::Value StartStreaming(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    if (info.Length() < 2) throw Napi::Error::New(env, "Requires 2 arguments: server, key");
+
+    std::string server = info[0].As<Napi::String>();
+    std::string key = info[1].As<Napi::String>();
+
+    std::string error = StartStreamOutput(server, key, ignore_output_phase);
+    if (!error.empty()) throw Napi::Error::New(env, error);
+    return env.Undefined();
+}
+
+// Only the stream's own encoders are released; recording keeps running.
+Napi::Value StopStreaming(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    g_outputs.Stop("stream");
+    return env.Undefined();
+}
+
+// An output still being started on a worker thread does not count as
+// active yet.
+Napi::Value IsStreaming(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    return Napi::Boolean::New(env, g_outputs.IsActive("stream"));
+}
+
+Napi::Value StartRecording(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    std::string error = StartRecordOutput(ignore_output_phase);
+    if (!error.empty()) throw Napi::Error::New(env, error);
+    return env.Undefined();
+}
+
+Napi::Value StopRecording(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    g_outputs.Stop("record");
+    return env.Undefined();
+}
+
+Napi::Value IsRecording(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    return Napi::Boolean::New(env, g_outputs.IsActive("record"));
+}
+
+// --- Encoder Configuration ---
+// JS shape: { encoderId, preset, width, height, bitrate, frameRateDivisor,
+// threads }. preset is x264's; width/height 0 mean the canvas size; threads
+// is x264's, 0 for a share of the thread budget.
+
+static Napi::Object EncoderConfigToNapi(Napi::Env env, const EncoderConfig& config) {
+    Napi::Object obj = Napi::Object::New(env);
+    obj.Set("encoderId", config.encoder_id);
+    obj.Set("preset", config.preset);
+    obj.Set("width", config.width);
+    obj.Set("height", config.height);
+    obj.Set("bitrate", config.bitrate);
+    obj.Set("frameRateDivisor", config.frame_rate_divisor);
+    obj.Set("threads", config.threads);
+    return obj;
+}
+
+static EncoderConfig NapiToEncoderConfig(Napi::Env env, Napi::Object obj) {
+    EncoderConfig config;
+    if (!obj.Get("encoderId").IsString()) throw Napi::TypeError::New(env, "encoderId must be a string");
+    config.encoder_id = obj.Get("encoderId").As<Napi::String>().Utf8Value();
+    if (obj.Get("preset").IsString()) config.preset = obj.Get("preset").As<Napi::String>().Utf8Value();
+    if (obj.Get("width").IsNumber()) config.width = obj.Get("width").As<Napi::Number>().Uint32Value();
+    if (obj.Get("height").IsNumber()) config.height = obj.Get("height").As<Napi::Number>().Uint32Value();
+    if (obj.Get("bitrate").IsNumber()) config.bitrate = obj.Get("bitrate").As<Napi::Number>().Uint32Value();
+    if (obj.Get("frameRateDivisor").IsNumber()) {
+        config.frame_rate_divisor = std::max(1u, obj.Get("frameRateDivisor").As<Napi::Number>().Uint32Value());
+    }
+    if (obj.Get("threads").IsNumber()) config.threads = obj.Get("threads").As<Napi::Number>().Uint32Value();
+    if ((config.width == 0) != (config.height == 0)) {
+        throw Napi::RangeError::New(env, "width and height must both be set or both be 0");
+    }
+    if (config.bitrate == 0) throw Napi::RangeError::New(env, "bitrate must be positive");
+    return config;
+}
+
+static Napi::Object EncoderBenchResultToNapi(Napi::Env env, const EncoderBenchResult& result) {
+    Napi::Object obj = Napi::Object::New(env);
+    obj.Set("config", EncoderConfigToNapi(env, result.config));
+    obj.Set("fps", result.fps);
+    obj.Set("framesExpected", (double)result.frames_expected);
+    obj.Set("framesEncoded", (double)result.frames_encoded);
+    obj.Set("framesSkipped", (double)result.frames_skipped);
+    obj.Set("framesLagged", (double)result.frames_lagged);
+    obj.Set("encodeMsAvg", result.encode_ms_avg);
+    obj.Set("encodeMsP95", result.encode_ms_p95);
+    obj.Set("encodeMsMax", result.encode_ms_max);
+    obj.Set("cpuPercent", result.cpu_percent);
+    obj.Set("bytesPerFrame", result.bytes_per_frame);
+    obj.Set("qualityRank", result.quality_rank);
+    obj.Set("holdsFps", result.holds_fps);
+    if (!result.error.empty()) obj.Set("error", result.error);
+    return obj;
+}
+
+// Default video encoder for outputs started from now on; running outputs
+// keep their encoders. Returns false, leaving the config as it was, if the
+// encoder is not available (e.g. a saved config from before a driver
+// change).
+Napi::Value SetEncoderConfig(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    if (info.Length() < 1 || !info[0].IsObject()) throw Napi::Error::New(env, "Requires 1 argument: config");
+    EncoderConfig config = NapiToEncoderConfig(env, info[0].As<Napi::Object>());
+    if (!obs_get_encoder_display_name(config.encoder_id.c_str())) return Napi::Boolean::New(env, false);
+
+    std::lock_guard<std::mutex> lock(g_output_mutex);
+    g_encoder_config = config;
+    return Napi::Boolean::New(env, true);
+}
+
+Napi::Value GetEncoderConfig(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    std::lock_guard<std::mutex> lock(g_output_mutex);
+    return EncoderConfigToNapi(env, g_encoder_config);
+}
+
+// --- Named Outputs ---
+
+// setOutputConfig(name, { type, video, audioBitrate, settings }) stores what
+// `name` starts with next time: a libobs output type (rtmp_output,
+// ffmpeg_muxer, replay_buffer, ...), its own encoder config (scaled size
+// included), and the output's settings (e.g. { path } for a recording).
+// Outputs with equal video configs share one encoder. null removes the
+// preset.
+Napi::Value SetOutputConfig(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    if (info.Length() < 2 || !info[0].IsString()) throw Napi::Error::New(env, "Requires 2 arguments: name, config");
+    std::string name = info[0].As<Napi::String>();
+    if (info[1].IsNull() || info[1].IsUndefined()) {
+        std::lock_guard<std::mutex> lock(g_output_mutex);
+        g_output_presets.erase(name);
+        return env.Undefined();
+    }
+    if (!info[1].IsObject()) throw Napi::TypeError::New(env, "config must be an object");
+    Napi::Object obj = info[1].As<Napi::Object>();
+
+    OutputPreset preset;
+    if (obj.Get("type").IsString()) preset.type = obj.Get("type").As<Napi::String>().Utf8Value();
+    if (obj.Get("video").IsObject()) {
+        preset.video = NapiToEncoderConfig(env, obj.Get("video").As<Napi::Object>());
+        if (!obs_get_encoder_display_name(preset.video->encoder_id.c_str())) {
+            throw Napi::Error::New(env, "Encoder not available: " + preset.video->encoder_id);
+        }
+    }
+    if (obj.Get("audioBitrate").IsNumber()) {
+        preset.audio_bitrate = obj.Get("audioBitrate").As<Napi::Number>().Uint32Value();
+        if (preset.audio_bitrate == 0) throw Napi::RangeError::New(env, "audioBitrate must be positive");
+    }
+    if (obj.Get("settings").IsObject()) {
+        preset.settings.reset(NapiObjectToObsData(env, obj.Get("settings").As<Napi::Object>()));
+    }
+
+    std::lock_guard<std::mutex> lock(g_output_mutex);
+    g_output_presets[name] = std::move(preset);
+    return env.Undefined();
+}
+
+Napi::Value StopOutput(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    if (info.Length() < 1 || !info[0].IsString()) throw Napi::Error::New(env, "Requires 1 argument: name");
+    g_outputs.Stop(info[0].As<Napi::String>());
+    return env.Undefined();
+}
+
+Napi::Value IsOutputActive(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    if (info.Length() < 1 || !info[0].IsString()) throw Napi::Error::New(env, "Requires 1 argument: name");
+    return Napi::Boolean::New(env, g_outputs.IsActive(info[0].As<Napi::String>()));
+}
+
+// -> { outputs: [{ name, type, video, starting, active, sharedVideo,
+// totalBytes, framesDropped, totalFrames, congestion, encoderSkipped,
+// encoderFrames }], threadBudget, threadsInUse }.
+// video.threads is what the thread budget granted.
+Napi::Value GetOutputs(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    std::vector<OutputInfo> list = g_outputs.List();
+    Napi::Array outputs = Napi::Array::New(env, list.size());
+    for (size_t i = 0; i < list.size(); i++) {
+        const OutputInfo& output = list[i];
+        Napi::Object obj = Napi::Object::New(env);
+        obj.Set("name", output.name);
+        obj.Set("type", output.type);
+        obj.Set("video", EncoderConfigToNapi(env, output.video));
+        obj.Set("starting", output.starting);
+        obj.Set("active", output.active);
+        obj.Set("sharedVideo", output.shared_video);
+        obj.Set("totalBytes", (double)output.total_bytes);
+        obj.Set("framesDropped", output.frames_dropped);
+        obj.Set("totalFrames", output.total_frames);
+        obj.Set("congestion", output.congestion);
+        obj.Set("encoderSkipped", output.encoder_skipped);
+        obj.Set("encoderFrames", output.encoder_frames);
+        outputs.Set((uint32_t)i, obj);
+    }
+    Napi::Object result = Napi::Object::New(env);
+    result.Set("outputs", outputs);
+    result.Set("threadBudget", g_outputs.thread_budget());
+    result.Set("threadsInUse", g_outputs.threads_in_use());
+    return result;
+}
+
+// Total threads x264 encoders may use across outputs; 0 means the core
+// count. Applies to encoders created from now on.
+Napi::Value SetOutputThreadBudget(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    if (info.Length() < 1 || !info[0].IsNumber()) throw Napi::Error::New(env, "Requires 1 argument: threads");
+    g_outputs.SetThreadBudget(info[0].As<Napi::Number>().Uint32Value());
+    return env.Undefined();
+}
+
+// --- Performance Stats Functions ---
+
+// getPerfStats({ seconds }) -> { intervalMs, capacity, latest, samples }.
+// samples are the last `seconds` per-second samples, oldest first (all of
+// the history when omitted); latest is null before the first sample.
+// Counters are cumulative since startup, *Delta fields per interval.
+Napi::Value GetPerfStats(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    size_t count = 0;
+    if (info.Length() > 0 && info[0].IsObject()) {
+        Napi::Value seconds = info[0].As<Napi::Object>().Get("seconds");
+        if (seconds.IsNumber()) {
+            double value = seconds.As<Napi::Number>().DoubleValue();
+            if (!(value >= 1.0)) throw Napi::RangeError::New(env, "seconds must be at least 1");
+            count = (size_t)std::ceil(value * 1000.0 / g_perf_stats.interval_ms());
+        }
+    }
+
+    std::vector<PerfSample> recent = g_perf_stats.Recent(count);
+    Napi::Array samples = Napi::Array::New(env, recent.size());
+    for (size_t i = 0; i < recent.size(); i++) samples.Set((uint32_t)i, PerfSampleToNapi(env, recent[i]));
+
+    Napi::Object result = Napi::Object::New(env);
+    result.Set("intervalMs", (double)g_perf_stats.interval_ms());
+    result.Set("capacity", (double)g_perf_stats.capacity());
+    PerfSample latest;
+    if (g_perf_stats.Latest(&latest)) {
+        result.Set("latest", PerfSampleToNapi(env, latest));
+    } else {
+        result.Set("latest", env.Null());
+    }
+    result.Set("samples", samples);
+    return result;
+}
+
+// How many seconds of samples to keep (default 600). Keeps the newest
+// samples when shrinking.
+Napi::Value SetPerfStatsHistory(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    if (info.Length() < 1 || !info[0].IsNumber()) throw Napi::Error::New(env, "Requires 1 argument: seconds");
+    double seconds = info[0].As<Napi::Number>().DoubleValue();
+    if (!(seconds >= 1.0 && seconds <= 86400.0)) {
+        throw Napi::RangeError::New(env, "seconds must be between 1 and 86400");
+    }
+    g_perf_stats.SetCapacity((size_t)std::ceil(seconds * 1000.0 / g_perf_stats.interval_ms()));
+    return env.Undefined();
+}
+
+// onPerfStats(callback) -> subscriptionId. callback(sample) runs once per
+// sample with the same shape as getPerfStats().latest.
+Napi::Value OnPerfStats(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    if (info.Length() < 1 || !info[0].IsFunction()) throw Napi::Error::New(env, "Requires 1 argument: callback");
+
+    PerfStatsSubscription subscription;
+    subscription.id = g_next_perf_stats_subscription_id++;
+    subscription.tsfn = Napi::ThreadSafeFunction::New(env, info[0].As<Napi::Function>(), "titan_perf_stats", 4, 1);
+    subscription.tsfn.Unref(env); // Never keep the process alive on its own
+
+    std::lock_guard<std::mutex> lock(g_perf_stats_subscriptions_mutex);
+    g_perf_stats_subscriptions.push_back(subscription);
+    return Napi::Number::New(env, subscription.id);
+}
+
+Napi::Value OffPerfStats(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    if (info.Length() < 1 || !info[0].IsNumber()) throw Napi::Error::New(env, "Requires 1 argument: subscriptionId");
+    uint32_t id = info[0].As<Napi::Number>().Uint32Value();
+
+    std::lock_guard<std::mutex> lock(g_perf_stats_subscriptions_mutex);
+    for (auto it = g_perf_stats_subscriptions.begin(); it != g_perf_stats_subscriptions.end(); ++it) {
+        if (it->id == id) {
+            it->tsfn.Release();
+            g_perf_stats_subscriptions.erase(it);
+            break;
+        }
+    }
+    return env.Undefined();
+}
+
+// setAdaptiveBitrate({ enabled, output = "stream", minKbps, maxKbps,
+// congestionHigh, congestionLow, dropRatio, downTicks, upTicks, downFactor,
+// upStep }). Missing keys keep their current value. maxKbps 0 caps at the
+// bitrate the output started with. Adjusts once per perf-stats sample;
+// disabling restores the starting bitrate. While enabled, the output gets a
+// video encoder of its own when it starts; one started before and sharing
+// its encoder with another output can't be adjusted until it restarts.
+Napi::Value SetAdaptiveBitrate(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    if (info.Length() < 1 || !info[0].IsObject()) throw Napi::Error::New(env, "Requires 1 argument: config");
+    Napi::Object obj = info[0].As<Napi::Object>();
+
+    AdaptiveBitrateConfig config = g_adaptive_bitrate.config();
+    auto number = [&](const char* key, double min, double max, auto* field) {
+        if (!obj.Get(key).IsNumber()) return;
+        double value = obj.Get(key).As<Napi::Number>().DoubleValue();
+        if (!(value >= min && value <= max)) {
+            throw Napi::RangeError::New(env, std::string(key) + " must be between " + std::to_string((int64_t)min) +
+                                                 " and " + std::to_string((int64_t)max));
+        }
+        *field = (std::remove_pointer_t<decltype(field)>)value;
+    };
+    if (obj.Get("enabled").IsBoolean()) config.enabled = obj.Get("enabled").As<Napi::Boolean>();
+    if (obj.Get("output").IsString()) config.output = obj.Get("output").As<Napi::String>().Utf8Value();
+    number("minKbps", 100, 500000, &config.min_kbps);
+    number("maxKbps", 0, 500000, &config.max_kbps);
+    number("congestionHigh", 0, 1, &config.congestion_high);
+    number("congestionLow", 0, 1, &config.congestion_low);
+    number("dropRatio", 0, 1, &config.drop_ratio_high);
+    number("downTicks", 1, 600, &config.down_ticks);
+    number("upTicks", 1, 600, &config.up_ticks);
+    number("downFactor", 0, 1, &config.down_factor);
+    number("upStep", 0, 1, &config.up_step);
+    if (config.max_kbps && config.max_kbps < config.min_kbps) {
+        throw Napi::RangeError::New(env, "maxKbps must be 0 or at least minKbps");
+    }
+    if (config.congestion_low >= config.congestion_high) {
+        throw Napi::RangeError::New(env, "congestionLow must be below congestionHigh");
+    }
+    if (config.down_factor <= 0.0 || config.down_factor >= 1.0 || config.up_step <= 0.0) {
+        throw Napi::RangeError::New(env, "downFactor must be between 0 and 1 exclusive, upStep above 0");
+    }
+    g_adaptive_bitrate.Configure(config);
+    return env.Undefined();
+}
+
+// -> { enabled, output, minKbps, maxKbps, ..., tracking, startKbps,
+// currentKbps, badTicks, goodTicks, lastError, adjustments: [{ time,
+// fromKbps, toKbps, reason, congestion, framesDropped, error }] }.
+// reason is congestion, dropped_frames, recovered, limits or disabled.
+Napi::Value GetAdaptiveBitrate(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    AdaptiveBitrateStatus status = g_adaptive_bitrate.Status();
+    const AdaptiveBitrateConfig& config = status.config;
+    Napi::Object result = Napi::Object::New(env);
+    result.Set("enabled", config.enabled);
+    result.Set("output", config.output);
+    result.Set("minKbps", config.min_kbps);
+    result.Set("maxKbps", config.max_kbps);
+    result.Set("congestionHigh", config.congestion_high);
+    result.Set("congestionLow", config.congestion_low);
+    result.Set("dropRatio", config.drop_ratio_high);
+    result.Set("downTicks", config.down_ticks);
+    result.Set("upTicks", config.up_ticks);
+    result.Set("downFactor", config.down_factor);
+    result.Set("upStep", config.up_step);
+    result.Set("tracking", status.tracking);
+    result.Set("startKbps", status.start_kbps);
+    result.Set("currentKbps", status.current_kbps);
+    result.Set("badTicks", status.bad_ticks);
+    result.Set("goodTicks", status.good_ticks);
+    result.Set("lastError", status.last_error.empty() ? env.Null() : Napi::String::New(env, status.last_error));
+    Napi::Array adjustments = Napi::Array::New(env, status.adjustments.size());
+    for (size_t i = 0; i < status.adjustments.size(); i++) {
+        const BitrateAdjustment& adjustment = status.adjustments[i];
+        Napi::Object entry = Napi::Object::New(env);
+        entry.Set("time", (double)adjustment.time_ms);
+        entry.Set("fromKbps", adjustment.from_kbps);
+        entry.Set("toKbps", adjustment.to_kbps);
+        entry.Set("reason", adjustment.reason);
+        entry.Set("congestion", adjustment.congestion);
+        entry.Set("framesDropped", adjustment.frames_dropped);
+        entry.Set("error", adjustment.error.empty() ? env.Null() : Napi::String::New(env, adjustment.error));
+        adjustments.Set((uint32_t)i, entry);
+    }
+    result.Set("adjustments", adjustments);
+    return result;
+}
+
+// --- Serialization / Deserialization ---
+
+static std::optional<float> OptionalFloat(Napi::Object obj, const char* key) {
+    if (!obj.Has(key) || !obj.Get(key).IsNumber()) return std::nullopt;
+    return obj.Get(key).As<Napi::Number>().FloatValue();
+}
+
+static std::optional<int> OptionalInt(Napi::Object obj, const char* key) {
+    if (!obj.Has(key) || !obj.Get(key).IsNumber()) return std::nullopt;
+    return obj.Get(key).As<Napi::Number>().Int32Value();
+}
+
+// Same keys as the transform objects in getFullSceneData().
+static TransformPatch ParseTransformPatch(Napi::Object obj) {
+    TransformPatch patch;
+    patch.pos_x = OptionalFloat(obj, "posX");
+    patch.pos_y = OptionalFloat(obj, "posY");
+    patch.rot = OptionalFloat(obj, "rot");
+    patch.scale_x = OptionalFloat(obj, "scaleX");
+    patch.scale_y = OptionalFloat(obj, "scaleY");
+    patch.crop_top = OptionalInt(obj, "cropTop");
+    patch.crop_bottom = OptionalInt(obj, "cropBottom");
+    patch.crop_left = OptionalInt(obj, "cropLeft");
+    patch.crop_right = OptionalInt(obj, "cropRight");
+    return patch;
+}
+
+static Napi::Array ObsDataArrayToNapiArray(Napi::Env env, obs_data_array_t* array, bool include_defaults);
+
+// Mirrors obs_data_get_json: user values only, with doubles, nested objects
+// and arrays. With include_defaults, keys that only have a default are
+// included as well, i.e. the values a source actually runs with.
+Napi::Object ObsDataToNapiObject(Napi::Env env, obs_data_t* data, bool include_defaults) {
+    Napi::Object obj = Napi::Object::New(env);
+    if (!data) return obj;
+
+    for (obs_data_item_t* item = obs_data_first(data); item; obs_data_item_next(&item)) {
+        bool has_value = obs_data_item_has_user_value(item) ||
+                         (include_defaults && obs_data_item_has_default_value(item));
+        if (!has_value) continue;
+        const char* key = obs_data_item_get_name(item);
+
+        switch (obs_data_item_get_type(item)) {
+            case OBS_DATA_STRING:
+                obj.Set(key, obs_data_item_get_string(item));
+                break;
+            case OBS_DATA_NUMBER:
+                if (obs_data_item_numtype(item) == OBS_DATA_NUM_DOUBLE) {
+                    obj.Set(key, obs_data_item_get_double(item));
+                } else {
+                    obj.Set(key, (double)obs_data_item_get_int(item));
+                }
+                break;
+            case OBS_DATA_BOOLEAN:
+                obj.Set(key, obs_data_item_get_bool(item));
+                break;
+            case OBS_DATA_OBJECT: {
+                obs_data_t* child = obs_data_item_get_obj(item);
+                obj.Set(key, ObsDataToNapiObject(env, child, include_defaults));
+                obs_data_release(child);
+                break;
+            }
+            case OBS_DATA_ARRAY: {
+                obs_data_array_t* array = obs_data_item_get_array(item);
+                obj.Set(key, ObsDataArrayToNapiArray(env, array, include_defaults));
+                obs_data_array_release(array);
+                break;
+            }
+            case OBS_DATA_NULL:
+                break;
+        }
+    }
+    return obj;
+}
+
+static Napi::Array ObsDataArrayToNapiArray(Napi::Env env, obs_data_array_t* array, bool include_defaults) {
+    size_t count = array ? obs_data_array_count(array) : 0;
+    Napi::Array result = Napi::Array::New(env, count);
+    for (size_t i = 0; i < count; i++) {
+        obs_data_t* item = obs_data_array_item(array, i);
+        result.Set((uint32_t)i, ObsDataToNapiObject(env, item, include_defaults));
+        obs_data_release(item);
+    }
+    return result;
+}
+
+obs_data_t* NapiObjectToObsData(Napi::Env env, Napi::Object obj) {
+    obs_data_t* data = obs_data_create();
+    Napi::Array keys = obj.GetPropertyNames();
+
+    for (uint32_t i = 0; i < keys.Length(); i++) {
+        Napi::Value key_val = keys.Get(i);
+        std::string key = key_val.As<Napi::String>();
+        Napi::Value val = obj.Get(key);
+
+        if (val.IsString()) {
+            obs_data_set_string(data, key.c_str(), val.As<Napi::String>().Utf8Value().c_str());
+        } else if (val.IsNumber()) {
+            // JS has one number type; integral values within int64 stay ints
+            // so plugins reading them with obs_data_get_int see the same value.
+            double number = val.As<Napi::Number>().DoubleValue();
+            if (std::trunc(number) == number && std::fabs(number) < 9007199254740992.0) {
+                obs_data_set_int(data, key.c_str(), (long long)number);
+            } else {
+                obs_data_set_double(data, key.c_str(), number);
+            }
+        } else if (val.IsBoolean()) {
+            obs_data_set_bool(data, key.c_str(), val.As<Napi::Boolean>().Value());
+        } else if (val.IsArray()) {
+            // obs_data arrays only hold objects; other elements are dropped.
+            Napi::Array elements = val.As<Napi::Array>();
+            obs_data_array_t* array = obs_data_array_create();
+            for (uint32_t j = 0; j < elements.Length(); j++) {
+                Napi::Value element = elements.Get(j);
+                if (!element.IsObject() || element.IsArray()) continue;
+                obs_data_t* child = NapiObjectToObsData(env, element.As<Napi::Object>());
+                obs_data_array_push_back(array, child);
+                obs_data_release(child);
+            }
+            obs_data_set_array(data, key.c_str(), array);
+            obs_data_array_release(array);
+        } else if (val.IsObject()) {
+            obs_data_t* child = NapiObjectToObsData(env, val.As<Napi::Object>());
+            obs_data_set_obj(data, key.c_str(), child);
+            obs_data_release(child);
+        }
+    }
+    return data;
+}
+
+
+// JS shape: { program, preview, scenes: [{ name, sources: [{ name, id,
+// settings, transform: { posX, posY, rot, scaleX, scaleY, cropTop,
+// cropBottom, cropLeft, cropRight } }] }] }. program and preview are scene
+// names and may be absent.
+
+static Napi::Object SceneCollectionToNapi(Napi::Env env, const SceneCollection& collection) {
+    Napi::Array scenes_array = Napi::Array::New(env, collection.scenes.size());
+    for (size_t i = 0; i < collection.scenes.size(); i++) {
+        const SceneState& scene = collection.scenes[i];
+        Napi::Array sources_array = Napi::Array::New(env, scene.items.size());
+        for (size_t j = 0; j < scene.items.size(); j++) {
+            const SceneItemState& item = scene.items[j];
+            Napi::Object source_obj = Napi::Object::New(env);
+            source_obj.Set("name", item.name);
+            source_obj.Set("id", item.id);
+            source_obj.Set("settings", ObsDataToNapiObject(env, item.settings.get()));
+
+            Napi::Object transform_obj = Napi::Object::New(env);
+            transform_obj.Set("posX", item.pos_x);
+            transform_obj.Set("posY", item.pos_y);
+            transform_obj.Set("rot", item.rot);
+            transform_obj.Set("scaleX", item.scale_x);
+            transform_obj.Set("scaleY", item.scale_y);
+            transform_obj.Set("cropTop", item.crop_top);
+            transform_obj.Set("cropBottom", item.crop_bottom);
+            transform_obj.Set("cropLeft", item.crop_left);
+            transform_obj.Set("cropRight", item.crop_right);
+            source_obj.Set("transform", transform_obj);
+
+            sources_array.Set((uint32_t)j, source_obj);
+        }
+
+        Napi::Object scene_obj = Napi::Object::New(env);
+        scene_obj.Set("name", scene.name);
+        scene_obj.Set("sources", sources_array);
+        scenes_array.Set((uint32_t)i, scene_obj);
+    }
+
+    Napi::Object result = Napi::Object::New(env);
+    if (!collection.program_scene.empty()) result.Set("program", collection.program_scene);
+    if (!collection.preview_scene.empty()) result.Set("preview", collection.preview_scene);
+    result.Set("scenes", scenes_array);
+    return result;
+}
+
+static void NapiToSceneCollection(Napi::Env env, Napi::Object data, SceneCollection* collection) {
+    if (!data.Get("scenes").IsArray()) throw Napi::Error::New(env, "Scene data has no scenes array");
+    Napi::Array scenes_array = data.Get("scenes").As<Napi::Array>();
+    if (data.Get("program").IsString()) collection->program_scene = data.Get("program").As<Napi::String>();
+    if (data.Get("preview").IsString()) collection->preview_scene = data.Get("preview").As<Napi::String>();
+
+    collection->scenes.resize(scenes_array.Length());
+    for (uint32_t i = 0; i < scenes_array.Length(); i++) {
+        Napi::Object scene_obj = scenes_array.Get(i).As<Napi::Object>();
+        SceneState& scene = collection->scenes[i];
+        scene.name = scene_obj.Get("name").As<Napi::String>().Utf8Value();
+
+        if (!scene_obj.Get("sources").IsArray()) continue;
+        Napi::Array sources_array = scene_obj.Get("sources").As<Napi::Array>();
+        scene.items.resize(sources_array.Length());
+        for (uint32_t j = 0; j < sources_array.Length(); j++) {
+            Napi::Object source_obj = sources_array.Get(j).As<Napi::Object>();
+            SceneItemState& item = scene.items[j];
+            item.name = source_obj.Get("name").As<Napi::String>().Utf8Value();
+            item.id = source_obj.Get("id").As<Napi::String>().Utf8Value();
+            if (source_obj.Get("settings").IsObject()) {
+                item.settings.reset(NapiObjectToObsData(env, source_obj.Get("settings").As<Napi::Object>()));
+            }
+
+            if (!source_obj.Get("transform").IsObject()) continue;
+            TransformPatch transform = ParseTransformPatch(source_obj.Get("transform").As<Napi::Object>());
+            item.pos_x = transform.pos_x.value_or(item.pos_x);
+            item.pos_y = transform.pos_y.value_or(item.pos_y);
+            item.rot = transform.rot.value_or(item.rot);
+            item.scale_x = transform.scale_x.value_or(item.scale_x);
+            item.scale_y = transform.scale_y.value_or(item.scale_y);
+            item.crop_top = transform.crop_top.value_or(item.crop_top);
+            item.crop_bottom = transform.crop_bottom.value_or(item.crop_bottom);
+            item.crop_left = transform.crop_left.value_or(item.crop_left);
+            item.crop_right = transform.crop_right.value_or(item.crop_right);
+        }
+    }
+}
 
-    return env.Undefined();
+// Scene data arrives either as the getFullSceneData() object or as its JSON
+// text; the text is parsed natively, without building JS objects.
+static bool IsSceneDataArg(const Napi::Value& value) {
+    return value.IsString() || value.IsObject();
 }
 
-Napi::Value RemoveSource(const Napi::CallbackInfo& info) {
-    Napi::Env env = info.Env();
-    if (info.Length() < 2) throw Napi::Error::New(env, "Requires 2 arguments: sceneName, sourceName");
+static void ParseSceneJson(Napi::Env env, const std::string& json, SceneCollection* collection) {
+    std::string error;
+    if (!ParseSceneCollection(json.data(), json.size(), collection, &error)) {
+        throw Napi::Error::New(env, "Invalid scene JSON: " + error);
+    }
+}
 
-    std::string scene_name = info[0].As<Napi::String>();
-    std::string source_name = info[1].As<Napi::String>();
+// Loads the collection into the scene library and puts its program scene
+// (the first scene if none was saved) on program. With `lazy`, only the
+// program and preview scenes are created here; the rest follow on the
+// library's background thread or on first use.
+static SceneLoadStats LoadSceneCollection(SceneCollection&& collection, unsigned parallelism, bool lazy,
+                                          const SceneProgressFn& progress) {
+    g_startup.load_start_ns = os_gettime_ns();
+    SceneLoadOptions options;
+    options.parallelism = parallelism;
+    options.on_source_created = [](obs_source_t* source) { AttachAudioMeter(source); };
+
+    std::string program = collection.program_scene;
+    if (program.empty() && !collection.scenes.empty()) program = collection.scenes.front().name;
+    std::string preview = collection.preview_scene != program ? collection.preview_scene : std::string();
+
+    std::vector<std::string> eager;
+    if (lazy) {
+        if (!program.empty()) eager.push_back(program);
+        if (!preview.empty()) eager.push_back(preview);
+    }
+    SceneLoadStats stats = g_scenes.Load(std::move(collection), eager, options, progress);
 
-    obs_source_t* scene_source = obs_get_source_by_name(scene_name.c_str());
-    if (!scene_source) throw Napi::Error::New(env, "Scene not found: " + scene_name);
+    obs_source_t* program_source = program.empty() ? nullptr : g_scenes.Acquire(program);
+    if (program_source) {
+        obs_transition_set(g_main_transition, program_source);
+        obs_source_release(program_source);
+    }
+    if (!preview.empty()) {
+        obs_source_t* preview_source = g_scenes.Acquire(preview);
+        // The library keeps the scene alive. This runs on the load worker
+        // while render_preview reads the pointer on the graphics thread.
+        g_preview_scene.store(preview_source, std::memory_order_release);
+        obs_source_release(preview_source);
+    }
+    g_startup.load_done_ns = os_gettime_ns();
+    g_startup.awaiting_first_frame = true;
 
-    obs_scene_t* scene = obs_scene_from_source(scene_source);
-    obs_sceneitem_t* scene_item = obs_scene_find_source_recursive(scene, source_name.c_str());
+    if (lazy) g_scenes.StartBackground();
+    return stats;
+}
 
-    if (scene_item) {
-        obs_sceneitem_remove(scene_item);
-        obs_sceneitem_release(scene_item);
-    }
+static Napi::Object SceneLoadStatsToNapi(Napi::Env env, const SceneLoadStats& stats) {
+    Napi::Object obj = Napi::Object::New(env);
+    obj.Set("scenes", (double)stats.scenes);
+    obj.Set("sources", (double)stats.sources);
+    obj.Set("items", (double)stats.items);
+    obj.Set("failedSources", (double)stats.failed_sources);
+    obj.Set("pendingScenes", (double)g_scenes.stats().pending_scenes);
+    obj.Set("durationMs", Napi::Number::New(env, stats.duration_ns / 1000000.0));
+    return obj;
+}
 
-    // --- Volmeter Management ---
-    {
-        std::lock_guard<std::mutex> lock(g_audio_mutex);
-        auto it = g_volmeters.find(source_name);
-        if (it != g_volmeters.end()) {
-            obs_volmeter_destroy(it->second.volmeter);
-            delete it->second.name_ptr;
-            g_volmeters.erase(it);
-            g_peak_levels.erase(source_name);
-        }
+static void CaptureProgramAndPreview(SceneCollection* collection) {
+    obs_source_t* program = obs_transition_get_source(g_main_transition, OBS_TRANSITION_SOURCE_A);
+    if (program) {
+        collection->program_scene = obs_source_get_name(program);
+        obs_source_release(program);
     }
-    // --- End Volmeter Management ---
+    obs_source_t* preview = g_preview_scene.load(std::memory_order_acquire);
+    if (preview) collection->preview_scene = obs_source_get_name(preview);
+}
 
-    obs_source_release(scene_source);
-    return env.Undefined();
+// Captures every scene, including those the library has not created yet,
+// plus the program and preview scene names. Safe from any thread.
+static void CaptureSceneCollection(SceneCollection* collection, const SceneProgressFn& progress) {
+    collection->Capture(progress);
+    g_scenes.Complete(collection);
+    CaptureProgramAndPreview(collection);
 }
 
-Napi::Value SetSourceMuted(const Napi::CallbackInfo& info) {
+Napi::Value GetFullSceneData(const Napi::CallbackInfo& info) {
     Napi::Env env = info.Env();
-    if (info.Length() < 2) throw Napi::Error::New(env, "Requires 2 arguments: sourceName, muted");
+    SceneCollection collection;
+    CaptureSceneCollection(&collection, nullptr);
+    return SceneCollectionToNapi(env, collection);
+}
 
-    std::string source_name = info[0].As<Napi::String>();
-    bool muted = info[1].As<Napi::Boolean>();
+// Same document as JSON.stringify(getFullSceneData()), written natively.
+Napi::Value GetFullSceneJson(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    SceneCollection collection;
+    CaptureSceneCollection(&collection, nullptr);
+    return Napi::String::New(env, SerializeSceneCollection(collection));
+}
 
-    obs_source_t* source = obs_get_source_by_name(source_name.c_str());
-    if (source) {
-        obs_source_set_muted(source, muted);
-        obs_source_release(source);
+Napi::Value LoadFullSceneData(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    if (info.Length() < 1 || !IsSceneDataArg(info[0])) {
+        throw Napi::Error::New(env, "Requires one argument: a scene data object or JSON string");
     }
+    SceneCollection collection;
+    if (info[0].IsString()) {
+        uint64_t start = os_gettime_ns();
+        ParseSceneJson(env, info[0].As<Napi::String>().Utf8Value(), &collection);
+        g_startup.parse_ns = os_gettime_ns() - start;
+    } else {
+        NapiToSceneCollection(env, info[0].As<Napi::Object>(), &collection);
+    }
+    LoadSceneCollection(std::move(collection), 1, false, nullptr);
     return env.Undefined();
 }
 
-Napi::Value IsSourceMuted(const Napi::CallbackInfo& info) {
+// Returns { version, full, scenes, removed, order }: `scenes` holds only the
+// scenes changed after `sinceVersion`, in the same shape as getFullSceneData;
+// `removed` and `order` are scene names. Pass the returned version to the
+// next call. With full set (first call, or a version too old to diff from)
+// `scenes` holds every scene. With { format: 'json' } the result is
+// { version, full, changed, removed, json }, where changed/removed are counts
+// and json is the delta document written natively.
+Napi::Value GetSceneDelta(const Napi::CallbackInfo& info) {
     Napi::Env env = info.Env();
-    if (info.Length() < 1) throw Napi::Error::New(env, "Requires 1 argument: sourceName");
+    uint64_t since = 0;
+    if (info.Length() > 0 && !info[0].IsUndefined() && !info[0].IsNull()) {
+        if (!info[0].IsNumber()) throw Napi::TypeError::New(env, "sinceVersion must be a number");
+        double value = info[0].As<Napi::Number>().DoubleValue();
+        if (value < 0) throw Napi::RangeError::New(env, "sinceVersion must not be negative");
+        since = (uint64_t)value;
+    }
 
-    std::string source_name = info[0].As<Napi::String>();
-    bool muted = false;
+    bool json = info.Length() > 1 && info[1].IsObject() &&
+                info[1].As<Napi::Object>().Get("format").ToString().Utf8Value() == "json";
 
-    obs_source_t* source = obs_get_source_by_name(source_name.c_str());
-    if (source) {
-        muted = obs_source_muted(source);
-        obs_source_release(source);
+    SceneDelta delta = g_scene_tracker.Collect(since);
+    SceneCollection collection;
+    if (delta.full) {
+        CaptureSceneCollection(&collection, nullptr);
+    } else {
+        collection.CaptureScenes(delta.changed);
+        CaptureProgramAndPreview(&collection);
+    }
+    // Scenes the library has not created yet keep their place.
+    delta.order = g_scenes.Order(delta.order);
+
+    if (json) {
+        Napi::Object result = Napi::Object::New(env);
+        result.Set("version", (double)delta.version);
+        result.Set("full", delta.full);
+        result.Set("changed", (double)collection.scenes.size());
+        result.Set("removed", (double)delta.removed.size());
+        result.Set("json", SerializeSceneDelta(delta, collection));
+        return result;
     }
-    return Napi::Boolean::New(env, muted);
-}
 
-Napi::Value GetAudioLevels(const Napi::CallbackInfo& info) {
-    Napi::Env env = info.Env();
-    Napi::Object levels = Napi::Object::New(env);
-    std::lock_guard<std::mutex> lock(g_audio_mutex);
+    auto names_to_napi = [env](const std::vector<std::string>& names) {
+        Napi::Array array = Napi::Array::New(env, names.size());
+        for (size_t i = 0; i < names.size(); i++) array.Set((uint32_t)i, names[i]);
+        return array;
+    };
 
-    for (auto const& [name, peak] : g_peak_levels) {
-        levels.Set(name, Napi::Number::New(env, peak));
-    }
+    Napi::Object result = SceneCollectionToNapi(env, collection);
+    result.Set("version", (double)delta.version);
+    result.Set("full", delta.full);
+    result.Set("removed", names_to_napi(delta.removed));
+    result.Set("order", names_to_napi(delta.order));
+    return result;
+}
 
-    return levels;
+Napi::Value GetSceneVersion(const Napi::CallbackInfo& info) {
+    return Napi::Number::New(info.Env(), (double)g_scene_tracker.version());
 }
 
+// Span between two StartupTimings stamps in ms, or null until both exist.
+static Napi::Value StartupSpanToNapi(Napi::Env env, uint64_t from_ns, uint64_t to_ns) {
+    if (!from_ns || !to_ns || to_ns < from_ns) return env.Null();
+    return Napi::Number::New(env, (to_ns - from_ns) / 1000000.0);
+}
 
-Napi::Value GetSourceProperties(const Napi::CallbackInfo& info) {
+// { obsStartupMs, parseMs, loadMs, firstFrameMs, eagerScenes, eagerLoadMs,
+// backgroundScenes, onDemandScenes, pendingScenes, backgroundMs,
+// backgroundRunning }. loadMs and firstFrameMs count from startup();
+// phases that have not happened yet are null.
+Napi::Value GetStartupTimings(const Napi::CallbackInfo& info) {
     Napi::Env env = info.Env();
-    if (info.Length() < 1) {
-        throw Napi::Error::New(env, "Requires 1 argument: sourceName");
+    uint64_t startup = g_startup.startup_ns;
+    SceneLibraryStats library = g_scenes.stats();
+
+    Napi::Object result = Napi::Object::New(env);
+    result.Set("obsStartupMs", StartupSpanToNapi(env, startup, g_startup.obs_ready_ns));
+    uint64_t parse_ns = g_startup.parse_ns;
+    result.Set("parseMs", parse_ns ? Napi::Number::New(env, parse_ns / 1000000.0) : env.Null());
+    result.Set("loadMs", StartupSpanToNapi(env, startup, g_startup.load_done_ns));
+    result.Set("firstFrameMs", StartupSpanToNapi(env, startup, g_startup.first_frame_ns));
+    result.Set("eagerScenes", (double)library.eager_scenes);
+    result.Set("eagerLoadMs", Napi::Number::New(env, library.eager_ns / 1000000.0));
+    result.Set("backgroundScenes", (double)library.background_scenes);
+    result.Set("onDemandScenes", (double)library.on_demand_scenes);
+    result.Set("pendingScenes", (double)library.pending_scenes);
+    result.Set("backgroundMs", library.background_ns ? Napi::Number::New(env, library.background_ns / 1000000.0)
+                                                     : env.Null());
+    result.Set("backgroundRunning", library.background_running);
+    return result;
+}
+
+// --- Async Workers ---
+// Promise-returning variants that do the libobs work on a worker thread.
+// Options take an optional onProgress({ phase, done, total }) callback.
+
+struct WorkProgress {
+    const char* phase;
+    size_t done;
+    size_t total;
+};
+
+class PromiseProgressWorker : public Napi::AsyncProgressQueueWorker<WorkProgress> {
+public:
+    PromiseProgressWorker(Napi::Env env, Napi::Value options)
+        : Napi::AsyncProgressQueueWorker<WorkProgress>(env), deferred_(Napi::Promise::Deferred::New(env)) {
+        if (options.IsObject() && options.As<Napi::Object>().Get("onProgress").IsFunction()) {
+            on_progress_ = Napi::Persistent(options.As<Napi::Object>().Get("onProgress").As<Napi::Function>());
+        }
     }
-    std::string source_name = info[0].As<Napi::String>();
 
-    obs_source_t* source = obs_get_source_by_name(source_name.c_str());
-    if (!source) {
-        return env.Null(); // Return null if source not found
+    Napi::Promise Promise() const { return deferred_.Promise(); }
+
+protected:
+    // Thread-safe. Progress is coalesced to ~20 updates per second, but
+    // every phase change and the end of a phase always get through.
+    void Report(const ExecutionProgress& progress, const char* phase, size_t done, size_t total) {
+        if (on_progress_.IsEmpty()) return;
+        std::lock_guard<std::mutex> lock(progress_mutex_);
+        uint64_t now = os_gettime_ns();
+        if (phase == last_phase_ && done != total && now - last_report_ns_ < 50000000) return;
+        last_phase_ = phase;
+        last_report_ns_ = now;
+        WorkProgress update{phase, done, total};
+        progress.Send(&update, 1);
     }
 
-    obs_properties_t* properties = obs_source_properties(source);
-    obs_source_release(source); // Release the source reference
+    void OnProgress(const WorkProgress* updates, size_t count) override {
+        Napi::Env env = Env();
+        for (size_t i = 0; i < count; i++) {
+            Napi::Object event = Napi::Object::New(env);
+            event.Set("phase", updates[i].phase);
+            event.Set("done", (double)updates[i].done);
+            event.Set("total", (double)updates[i].total);
+            on_progress_.Call({event});
+        }
+    }
 
-    if (!properties) {
-        return env.Null(); // No properties available
+    void OnError(const Napi::Error& error) override {
+        deferred_.Reject(error.Value());
     }
 
-    Napi::Array result = Napi::Array::New(env);
-    obs_property_t* prop = obs_properties_first(properties);
+    Napi::Promise::Deferred deferred_;
+
+private:
+    Napi::FunctionReference on_progress_;
+    std::mutex progress_mutex_;
+    const char* last_phase_ = nullptr;
+    uint64_t last_report_ns_ = 0;
+};
 
-    while (prop) {
-        Napi::Object prop_obj = Napi::Object::New(env);
-        prop_obj.Set("name", obs_property_name(prop));
-        prop_obj.Set("description", obs_property_description(prop));
+class LoadSceneDataWorker : public PromiseProgressWorker {
+public:
+    LoadSceneDataWorker(Napi::Env env, Napi::Value options, SceneCollection&& collection, unsigned parallelism,
+                        bool lazy)
+        : PromiseProgressWorker(env, options), collection_(std::move(collection)), parallelism_(parallelism),
+          lazy_(lazy) {}
+    // Parses `json` on the worker thread before loading.
+    LoadSceneDataWorker(Napi::Env env, Napi::Value options, std::string&& json, unsigned parallelism, bool lazy)
+        : PromiseProgressWorker(env, options), json_(std::move(json)), from_json_(true), parallelism_(parallelism),
+          lazy_(lazy) {}
+
+protected:
+    void Execute(const ExecutionProgress& progress) override {
+        // An empty string is unparsable JSON like any other, not "no JSON".
+        if (from_json_) {
+            Report(progress, "parse", 0, 1);
+            uint64_t start = os_gettime_ns();
+            std::string error;
+            if (!ParseSceneCollection(json_.data(), json_.size(), &collection_, &error)) {
+                SetError("Invalid scene JSON: " + error);
+                return;
+            }
+            g_startup.parse_ns = os_gettime_ns() - start;
+            std::string().swap(json_);
+            Report(progress, "parse", 1, 1);
+        }
+        stats_ = LoadSceneCollection(std::move(collection_), parallelism_, lazy_,
+                                     [&](const char* phase, size_t done, size_t total) {
+                                         Report(progress, phase, done, total);
+                                     });
+    }
 
-        obs_property_type type = obs_property_get_type(prop);
-        prop_obj.Set("type", (int)type);
+    void OnOK() override {
+        deferred_.Resolve(SceneLoadStatsToNapi(Env(), stats_));
+    }
 
-        if (type == OBS_PROPERTY_LIST) {
-            Napi::Array options = Napi::Array::New(env);
-            size_t count = obs_property_list_item_count(prop);
-            for (size_t i = 0; i < count; ++i) {
-                const char* name = obs_property_list_item_name(prop, i);
-                // Assuming string values for simplicity now
-                const char* val_str_const = obs_property_list_item_string(prop, i);
-                std::string val_str = val_str_const ? val_str_const : "";
+private:
+    SceneCollection collection_;
+    std::string json_;
+    bool from_json_ = false;
+    unsigned parallelism_;
+    bool lazy_;
+    SceneLoadStats stats_;
+};
 
-                Napi::Object option = Napi::Object::New(env);
-                option.Set("name", name);
-                option.Set("value", val_str);
-                options[i] = option;
-            }
-            prop_obj.Set("options", options);
+class GetSceneDataWorker : public PromiseProgressWorker {
+public:
+    GetSceneDataWorker(Napi::Env env, Napi::Value options, bool json)
+        : PromiseProgressWorker(env, options), json_(json) {}
+
+protected:
+    void Execute(const ExecutionProgress& progress) override {
+        CaptureSceneCollection(&collection_, [&](const char* phase, size_t done, size_t total) {
+            Report(progress, phase, done, total);
+        });
+        if (json_) {
+            text_ = SerializeSceneCollection(collection_);
+            collection_.scenes.clear();
         }
+    }
 
-        result[result.Length()] = prop_obj;
-        obs_property_next(&prop);
+    // Building the JS objects has to happen on the JS thread; JSON text is
+    // produced on the worker and only copied into a JS string here.
+    void OnOK() override {
+        if (json_) {
+            deferred_.Resolve(Napi::String::New(Env(), text_));
+        } else {
+            deferred_.Resolve(SceneCollectionToNapi(Env(), collection_));
+        }
     }
 
-    obs_properties_destroy(properties);
-    return result;
-}
+private:
+    SceneCollection collection_;
+    bool json_;
+    std::string text_;
+};
 
-Napi::Value UpdateSourceProperties(const Napi::CallbackInfo& info) {
-    Napi::Env env = info.Env();
-    if (info.Length() < 2) {
-        throw Napi::Error::New(env, "Requires 2 arguments: sourceName, propertiesObject");
+class StartOutputWorker : public PromiseProgressWorker {
+public:
+    using StartFn = std::function<std::string(const OutputPhaseFn& phase)>;
+
+    StartOutputWorker(Napi::Env env, Napi::Value options, StartFn start)
+        : PromiseProgressWorker(env, options), start_(std::move(start)) {}
+
+protected:
+    void Execute(const ExecutionProgress& progress) override {
+        size_t step = 0;
+        auto phase = [&](const char* name) { Report(progress, name, step++, 3); };
+        std::string error = start_(phase);
+        if (!error.empty()) SetError(error);
     }
-    std::string source_name = info[0].As<Napi::String>();
-    Napi::Object props_obj = info[1].As<Napi::Object>();
 
-    obs_source_t* source = obs_get_source_by_name(source_name.c_str());
-    if (!source) {
-        throw Napi::Error::New(env, "Source not found: " + source_name);
+    void OnOK() override {
+        deferred_.Resolve(Env().Undefined());
     }
 
-    obs_data_t* settings = obs_data_create();
-    Napi::Array prop_names = props_obj.GetPropertyNames();
-    for (uint32_t i = 0; i < prop_names.Length(); ++i) {
-        Napi::Value key_val = prop_names.Get(i);
-        std::string key = key_val.As<Napi::String>();
-        Napi::Value val = props_obj.Get(key);
+private:
+    StartFn start_;
+};
 
-        if (val.IsString()) {
-            obs_data_set_string(settings, key.c_str(), val.As<Napi::String>().Utf8Value().c_str());
-        } else if (val.IsBoolean()) {
-            obs_data_set_bool(settings, key.c_str(), val.As<Napi::Boolean>().Value());
-        } else if (val.IsNumber()) {
-            obs_data_set_int(settings, key.c_str(), val.As<Napi::Number>().Int64Value());
+class BenchmarkEncodersWorker : public PromiseProgressWorker {
+public:
+    BenchmarkEncodersWorker(Napi::Env env, Napi::Value options, EncoderBenchOptions bench, bool apply)
+        : PromiseProgressWorker(env, options), bench_(std::move(bench)), apply_(apply) {}
+
+protected:
+    void Execute(const ExecutionProgress& progress) override {
+        results_ = BenchmarkEncoders(bench_, [&](const char* phase, size_t done, size_t total) {
+            Report(progress, phase, done, total);
+        });
+        recommended_ = RecommendEncoderConfig(results_);
+        if (recommended_ >= 0) {
+            // Only the encoder and preset carry over: the benchmark's own
+            // bitrate and size are for measuring, not for the stream.
+            std::lock_guard<std::mutex> lock(g_output_mutex);
+            config_ = g_encoder_config;
+            config_.encoder_id = results_[recommended_].config.encoder_id;
+            config_.preset = results_[recommended_].config.preset;
+            if (apply_) g_encoder_config = config_;
         }
+        g_outputs.Unblock();
+        g_encoder_benchmark_running = false;
+        if (results_.empty()) SetError("Nothing to benchmark: no video output or no H.264 encoder.");
     }
 
-    obs_source_update(source, settings);
-
-    obs_data_release(settings);
-    obs_source_release(source);
+    void OnOK() override {
+        Napi::Env env = Env();
+        Napi::Object result = Napi::Object::New(env);
+        Napi::Array runs = Napi::Array::New(env, results_.size());
+        for (size_t i = 0; i < results_.size(); i++) {
+            runs.Set((uint32_t)i, EncoderBenchResultToNapi(env, results_[i]));
+        }
+        result.Set("results", runs);
+        result.Set("recommended", recommended_ >= 0 ? Napi::Number::New(env, recommended_) : env.Null());
+        result.Set("config", recommended_ >= 0 ? (Napi::Value)EncoderConfigToNapi(env, config_) : env.Null());
+        result.Set("applied", apply_ && recommended_ >= 0);
+        result.Set("obsVersion", obs_get_version_string());
+
+        struct obs_video_info ovi;
+        if (obs_get_video_info(&ovi)) {
+            Napi::Object canvas = Napi::Object::New(env);
+            canvas.Set("width", ovi.output_width);
+            canvas.Set("height", ovi.output_height);
+            canvas.Set("fpsNum", ovi.fps_num);
+            canvas.Set("fpsDen", ovi.fps_den);
+            result.Set("canvas", canvas);
+        }
+        deferred_.Resolve(result);
+    }
 
-    return env.Undefined();
-}
+private:
+    EncoderBenchOptions bench_;
+    bool apply_;
+    std::vector<EncoderBenchResult> results_;
+    int recommended_ = -1;
+    EncoderConfig config_; // The encoder config with the recommended encoder and preset
+};
 
-// --- Output Functions ---
+// loadFullSceneDataAsync(data, { onProgress, parallelism, lazy }) -> Promise
+// of { scenes, sources, items, failedSources, pendingScenes, durationMs }. A
+// JS object is converted up front, JSON text is parsed on the worker; scenes
+// and sources are created on worker threads. With lazy, the promise resolves
+// once the program and preview scenes exist and the rest is created in the
+// background (see getStartupTimings()).
+Napi::Value LoadFullSceneDataAsync(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    if (info.Length() < 1 || !IsSceneDataArg(info[0])) {
+        throw Napi::Error::New(env, "Requires one argument: a scene data object or JSON string");
+    }
+    Napi::Value options = info.Length() > 1 ? info[1] : env.Undefined();
 
-void SetupEncoders() {
-    // For simplicity, using x264 for video and AAC for audio
-    g_video_encoder = obs_video_encoder_create("obs_x264", "simple_h264_stream", nullptr, nullptr);
-    // Note: fdk_aac might not be available on all builds, ffmpeg_aac is a safer default
-    g_audio_encoder = obs_audio_encoder_create("ffmpeg_aac", "simple_aac", nullptr, 0, nullptr);
+    unsigned parallelism = DefaultSceneLoadParallelism();
+    if (options.IsObject() && options.As<Napi::Object>().Get("parallelism").IsNumber()) {
+        parallelism = std::max(1u, options.As<Napi::Object>().Get("parallelism").As<Napi::Number>().Uint32Value());
+    }
+    bool lazy = options.IsObject() && options.As<Napi::Object>().Get("lazy").ToBoolean().Value();
 
-    // Video encoder settings
-    obs_data_t* video_settings = obs_data_create();
-    obs_data_set_int(video_settings, "bitrate", 2500);
-    obs_data_set_string(video_settings, "rate_control", "CBR");
-    obs_encoder_update(g_video_encoder, video_settings);
-    obs_data_release(video_settings);
+    LoadSceneDataWorker* worker;
+    if (info[0].IsString()) {
+        worker = new LoadSceneDataWorker(env, options, info[0].As<Napi::String>().Utf8Value(), parallelism, lazy);
+    } else {
+        SceneCollection collection;
+        NapiToSceneCollection(env, info[0].As<Napi::Object>(), &collection);
+        worker = new LoadSceneDataWorker(env, options, std::move(collection), parallelism, lazy);
+    }
+    worker->Queue();
+    return worker->Promise();
+}
 
-    // Audio encoder settings
-    obs_data_t* audio_settings = obs_data_create();
-    obs_data_set_int(audio_settings, "bitrate", 160);
-    obs_encoder_update(g_audio_encoder, audio_settings);
-    obs_data_release(audio_settings);
+// getFullSceneDataAsync({ onProgress, format }) -> Promise of the
+// getFullSceneData() shape, or of its JSON text with format: 'json'.
+Napi::Value GetFullSceneDataAsync(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    Napi::Value options = info.Length() > 0 ? info[0] : env.Undefined();
+    bool json = options.IsObject() && options.As<Napi::Object>().Get("format").ToString().Utf8Value() == "json";
+    auto* worker = new GetSceneDataWorker(env, options, json);
+    worker->Queue();
+    return worker->Promise();
 }
 
-Napi::Value StartStreaming(const Napi::CallbackInfo& info) {
+// startStreamingAsync(server, key, { onProgress }) -> Promise
+Napi::Value StartStreamingAsync(const Napi::CallbackInfo& info) {
     Napi::Env env = info.Env();
     if (info.Length() < 2) throw Napi::Error::New(env, "Requires 2 arguments: server, key");
 
     std::string server = info[0].As<Napi::String>();
     std::string key = info[1].As<Napi::String>();
+    if (server.empty()) throw Napi::Error::New(env, "Server is required");
+
+    auto* worker = new StartOutputWorker(env, info.Length() > 2 ? info[2] : env.Undefined(),
+                                         [server, key](const OutputPhaseFn& phase) {
+                                             return StartStreamOutput(server, key, phase);
+                                         });
+    worker->Queue();
+    return worker->Promise();
+}
 
-    if (g_stream_output) return env.Undefined(); // Already streaming
-
-    SetupEncoders(); // Make sure encoders are ready
-
-    obs_data_t* settings = obs_data_create();
-    obs_data_set_string(settings, "server", server.c_str());
-    obs_data_set_string(settings, "key", key.c_str());
-
-    g_stream_output = obs_output_create("rtmp_output", "simple_rtmp_stream", settings, nullptr);
-    obs_data_release(settings);
-
-    if (!g_stream_output) throw Napi::Error::New(env, "Failed to create stream output.");
-
-    obs_encoder_set_video(g_video_encoder, obs_get_video());
-    obs_encoder_set_audio(g_audio_encoder, obs_get_audio());
-    obs_output_set_video_encoder(g_stream_output, g_video_encoder);
-    obs_output_set_audio_encoder(g_stream_output, g_audio_encoder, 0);
+// startRecordingAsync({ onProgress }) -> Promise
+Napi::Value StartRecordingAsync(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    auto* worker = new StartOutputWorker(env, info.Length() > 0 ? info[0] : env.Undefined(), StartRecordOutput);
+    worker->Queue();
+    return worker->Promise();
+}
 
-    if (!obs_output_start(g_stream_output)) {
-        throw Napi::Error::New(env, "Failed to start stream output.");
+// startOutputAsync(name, { onProgress }) -> Promise. Starts an output
+// configured with setOutputConfig(); it needs at least a type.
+Napi::Value StartOutputAsync(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    if (info.Length() < 1 || !info[0].IsString()) throw Napi::Error::New(env, "Requires 1 argument: name");
+    std::string name = info[0].As<Napi::String>();
+    {
+        std::lock_guard<std::mutex> lock(g_output_mutex);
+        auto it = g_output_presets.find(name);
+        if (it == g_output_presets.end() || it->second.type.empty()) {
+            throw Napi::Error::New(env, "No output type configured for " + name + "; call setOutputConfig first");
+        }
     }
-
-    return env.Undefined();
+    auto* worker = new StartOutputWorker(env, info.Length() > 1 ? info[1] : env.Undefined(),
+                                         [name](const OutputPhaseFn& phase) {
+                                             return StartNamedOutput(name, "", nullptr, phase);
+                                         });
+    worker->Queue();
+    return worker->Promise();
 }
 
-Napi::Value StopStreaming(const Napi::CallbackInfo& info) {
+// startReplayBufferAsync({ maxMemoryMb = 512, onProgress }) -> Promise.
+// Starts the "replay" output, which keeps as many seconds of encoded
+// packets as fit in maxMemoryMb. A running save keeps the blocks it reads
+// beyond that until it finishes, so peak use is up to twice maxMemoryMb.
+Napi::Value StartReplayBufferAsync(const Napi::CallbackInfo& info) {
     Napi::Env env = info.Env();
-    if (g_stream_output) {
-        obs_output_stop(g_stream_output);
-        obs_output_release(g_stream_output);
-        obs_encoder_release(g_video_encoder);
-        obs_encoder_release(g_audio_encoder);
-        g_stream_output = nullptr;
-        g_video_encoder = nullptr;
-        g_audio_encoder = nullptr;
+    Napi::Value options = info.Length() > 0 ? info[0] : env.Undefined();
+    uint32_t max_memory_mb = (uint32_t)(ReplayBuffer::kDefaultMemoryCap >> 20);
+    if (options.IsObject() && options.As<Napi::Object>().Get("maxMemoryMb").IsNumber()) {
+        double value = options.As<Napi::Object>().Get("maxMemoryMb").As<Napi::Number>().DoubleValue();
+        if (!(value >= 16.0 && value <= 65536.0)) {
+            throw Napi::RangeError::New(env, "maxMemoryMb must be between 16 and 65536");
+        }
+        max_memory_mb = (uint32_t)value;
     }
-    return env.Undefined();
+    auto* worker = new StartOutputWorker(env, options, [max_memory_mb](const OutputPhaseFn& phase) {
+        return StartReplayOutput(max_memory_mb, phase);
+    });
+    worker->Queue();
+    return worker->Promise();
 }
 
-Napi::Value IsStreaming(const Napi::CallbackInfo& info) {
-    Napi::Env env = info.Env();
-    bool active = g_stream_output && obs_output_active(g_stream_output);
-    return Napi::Boolean::New(env, active);
+// Stops the "replay" output and frees the buffered packets.
+Napi::Value StopReplayBuffer(const Napi::CallbackInfo& info) {
+    g_outputs.Stop("replay");
+    return info.Env().Undefined();
 }
 
-Napi::Value StartRecording(const Napi::CallbackInfo& info) {
-    Napi::Env env = info.Env();
-    if (g_record_output) return env.Undefined(); // Already recording
+static Napi::Object ReplaySaveToNapi(Napi::Env env, const ReplaySaveResult& save) {
+    Napi::Object result = Napi::Object::New(env);
+    result.Set("path", save.path);
+    result.Set("seconds", save.seconds);
+    result.Set("bytes", (double)save.bytes);
+    result.Set("packets", (double)save.packets);
+    result.Set("snapshotMs", save.snapshot_ms);
+    result.Set("muxMs", save.mux_ms);
+    result.Set("totalMs", save.total_ms);
+    return result;
+}
 
-    // Use separate encoders for recording if not already streaming
-    if (!g_video_encoder || !g_audio_encoder) {
-        SetupEncoders();
+class SaveReplayWorker : public PromiseProgressWorker {
+public:
+    SaveReplayWorker(Napi::Env env, Napi::Value options, std::string path, double seconds)
+        : PromiseProgressWorker(env, options), path_(std::move(path)), seconds_(seconds) {}
+
+protected:
+    void Execute(const ExecutionProgress& progress) override {
+        Report(progress, "mux", 0, 1);
+        result_ = g_replay_buffer.Save(path_, seconds_);
+        if (!result_.error.empty()) {
+            SetError(result_.error);
+            return;
+        }
+        Report(progress, "mux", 1, 1);
     }
 
-    // For simplicity, hardcoding path. A real app would get this from settings.
-    g_record_output = obs_output_create("ffmpeg_muxer", "simple_ffmpeg_muxer", nullptr, nullptr);
-    if (!g_record_output) throw Napi::Error::New(env, "Failed to create record output.");
-
-    obs_output_set_video_encoder(g_record_output, g_video_encoder);
-    obs_output_set_audio_encoder(g_record_output, g_audio_encoder, 0);
-
-    if (!obs_output_start(g_record_output)) {
-        throw Napi::Error::New(env, "Failed to start record output.");
+    void OnOK() override {
+        deferred_.Resolve(ReplaySaveToNapi(Env(), result_));
     }
 
-    return env.Undefined();
-}
+private:
+    std::string path_;
+    double seconds_;
+    ReplaySaveResult result_;
+};
 
-Napi::Value StopRecording(const Napi::CallbackInfo& info) {
+// saveReplay(path, seconds = 0, { onProgress }) -> Promise of { path,
+// seconds, bytes, packets, snapshotMs, muxMs, totalMs }. Writes the last
+// `seconds` of the replay buffer (all of it for 0) to `path` as FLV,
+// starting on the keyframe at or before the cut. Muxes on a worker thread;
+// the buffer keeps recording meanwhile.
+Napi::Value SaveReplay(const Napi::CallbackInfo& info) {
     Napi::Env env = info.Env();
-    if (g_record_output) {
-        obs_output_stop(g_record_output);
-        obs_output_release(g_record_output);
-        g_record_output = nullptr;
-
-        // If we are not streaming, release the encoders too
-        if (!g_stream_output) {
-            obs_encoder_release(g_video_encoder);
-            obs_encoder_release(g_audio_encoder);
-            g_video_encoder = nullptr;
-            g_audio_encoder = nullptr;
-        }
+    if (info.Length() < 1 || !info[0].IsString()) throw Napi::Error::New(env, "Requires 1 argument: path");
+    double seconds = 0.0;
+    if (info.Length() > 1 && info[1].IsNumber()) {
+        seconds = info[1].As<Napi::Number>().DoubleValue();
+        if (!(seconds >= 0.0)) throw Napi::RangeError::New(env, "seconds must not be negative");
     }
-    return env.Undefined();
+    auto* worker = new SaveReplayWorker(env, info.Length() > 2 ? info[2] : env.Undefined(),
+                                        info[0].As<Napi::String>(), seconds);
+    worker->Queue();
+    return worker->Promise();
 }
 
-Napi::Value IsRecording(const Napi::CallbackInfo& info) {
+// -> { active, memoryCapBytes, memoryUsedBytes, memoryPooledBytes,
+// memoryPinnedBytes, payloadBytes, bufferedSeconds, videoPackets,
+// audioPackets, keyframes, evictedPackets, savesInProgress, lastSave }.
+// Used is what the ring holds, pooled what it keeps for reuse (both count
+// against the cap); pinned is evicted memory a running save still reads.
+// lastSave is the last successful saveReplay() result, or null.
+Napi::Value GetReplayBufferStats(const Napi::CallbackInfo& info) {
     Napi::Env env = info.Env();
-    bool active = g_record_output && obs_output_active(g_record_output);
-    return Napi::Boolean::New(env, active);
+    ReplayBufferStats stats = g_replay_buffer.GetStats();
+    Napi::Object result = Napi::Object::New(env);
+    result.Set("active", stats.active);
+    result.Set("memoryCapBytes", (double)stats.memory_cap_bytes);
+    result.Set("memoryUsedBytes", (double)stats.memory_used_bytes);
+    result.Set("memoryPooledBytes", (double)stats.memory_pooled_bytes);
+    result.Set("memoryPinnedBytes", (double)stats.memory_pinned_bytes);
+    result.Set("payloadBytes", (double)stats.payload_bytes);
+    result.Set("bufferedSeconds", stats.buffered_seconds);
+    result.Set("videoPackets", (double)stats.video_packets);
+    result.Set("audioPackets", (double)stats.audio_packets);
+    result.Set("keyframes", (double)stats.keyframes);
+    result.Set("evictedPackets", (double)stats.evicted_packets);
+    result.Set("savesInProgress", stats.saves_in_progress);
+    result.Set("lastSave", stats.has_last_save ? (Napi::Value)ReplaySaveToNapi(env, stats.last_save) : env.Null());
+    return result;
 }
 
-// --- Serialization / Deserialization ---
+// benchmarkEncoders({ durationSec, resolutions: [{ width, height }], fps,
+// apply, onProgress }) -> Promise of { results, recommended, config,
+// applied, obsVersion, canvas }. Runs each H.264 encoder (x264 per preset)
+// at each resolution for durationSec through a null output. `config` is the
+// current encoder config switched to the best encoder and preset that held
+// fps, or null; its bitrate and size stay the user's, since the benchmark's
+// bitrate (DefaultBitrate) can exceed what an ingest accepts. With apply it
+// becomes the encoder config right away. Refused while streaming or
+// recording.
+Napi::Value BenchmarkEncodersAsync(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    Napi::Value options = info.Length() > 0 ? info[0] : env.Undefined();
+
+    EncoderBenchOptions bench;
+    bool apply = false;
+    if (options.IsObject()) {
+        Napi::Object obj = options.As<Napi::Object>();
+        if (obj.Get("durationSec").IsNumber()) {
+            bench.duration_sec = obj.Get("durationSec").As<Napi::Number>().DoubleValue();
+        }
+        if (obj.Get("fps").IsNumber()) bench.fps = obj.Get("fps").As<Napi::Number>().Uint32Value();
+        if (obj.Get("resolutions").IsArray()) {
+            Napi::Array resolutions = obj.Get("resolutions").As<Napi::Array>();
+            for (uint32_t i = 0; i < resolutions.Length(); i++) {
+                Napi::Value entry = resolutions.Get(i);
+                if (!entry.IsObject()) {
+                    throw Napi::TypeError::New(env, "resolutions must be { width, height } objects");
+                }
+                uint32_t width = entry.As<Napi::Object>().Get("width").ToNumber().Uint32Value();
+                uint32_t height = entry.As<Napi::Object>().Get("height").ToNumber().Uint32Value();
+                if (!width || !height) {
+                    throw Napi::RangeError::New(env, "Resolution width and height must be positive");
+                }
+                bench.resolutions.push_back({width, height});
+            }
+        }
+        apply = obj.Get("apply").ToBoolean().Value();
+    }
+    if (!(bench.duration_sec > 0.0) || bench.duration_sec > 600.0) {
+        throw Napi::RangeError::New(env, "durationSec must be between 0 and 600");
+    }
 
-Napi::Object ObsDataToNapiObject(Napi::Env env, obs_data_t* data) {
-    Napi::Object obj = Napi::Object::New(env);
-    if (!data) return obj;
+    if (g_encoder_benchmark_running.exchange(true)) {
+        throw Napi::Error::New(env, "An encoder benchmark is already running.");
+    }
+    // Checks for outputs and keeps new ones from starting in one step.
+    if (!g_outputs.Block(kEncoderBenchmarkRunning).empty()) {
+        g_encoder_benchmark_running = false;
+        throw Napi::Error::New(env, "Stop all outputs before benchmarking encoders.");
+    }
 
-    obs_data_item_t* item = obs_data_first(data);
-    while (item) {
-        const char* key = obs_data_item_get_name(item);
-        auto type = obs_data_item_get_type(item);
+    auto* worker = new BenchmarkEncodersWorker(env, options, std::move(bench), apply);
+    worker->Queue();
+    return worker->Promise();
+}
 
-        switch (type) {
-            case OBS_DATA_STRING:
-                obj.Set(key, obs_data_item_get_string(item));
-                break;
-            case OBS_DATA_NUMBER:
-                obj.Set(key, obs_data_item_get_int(item));
-                break;
-            case OBS_DATA_BOOLEAN:
-                obj.Set(key, obs_data_item_get_bool(item));
-                break;
-            // Skipping other types for now for simplicity
+// --- Batch Commands ---
+
+// A source in a batch op is a handle, the name of an existing source, or the
+// name of a source added by an earlier op of the same batch.
+static std::string ResolveBatchSource(Napi::Object obj, const char* key, const std::vector<BatchOp>& ops, BatchOp& op) {
+    if (!obj.Has(key)) return std::string("Missing '") + key + "'";
+    Napi::Value value = obj.Get(key);
+    if (!value.IsNumber() && !value.IsString()) return std::string("'") + key + "' must be a handle or a name";
+
+    if (value.IsString()) {
+        std::string name = value.As<Napi::String>();
+        for (size_t i = 0; i < ops.size(); i++) {
+            if (ops[i].type == BatchOpType::AddSource && ops[i].name == name) {
+                op.source_op = (int)i;
+                return "";
+            }
         }
-
-        obs_data_item_next(&item);
     }
-    obs_data_item_release(&item);
-    return obj;
+    op.source = AcquireSourceArg(value);
+    if (!op.source) return "Source not found: " + SourceArgToString(value);
+    return "";
 }
 
-obs_data_t* NapiObjectToObsData(Napi::Env env, Napi::Object obj) {
-    obs_data_t* data = obs_data_create();
-    Napi::Array keys = obj.GetPropertyNames();
+static std::string ResolveBatchScene(Napi::Object obj, BatchOp& op) {
+    if (!obj.Has("scene")) return "Missing 'scene'";
+    Napi::Value value = obj.Get("scene");
+    if (!value.IsNumber() && !value.IsString()) return "'scene' must be a handle or a name";
 
-    for (uint32_t i = 0; i < keys.Length(); i++) {
-        Napi::Value key_val = keys.Get(i);
-        std::string key = key_val.As<Napi::String>();
-        Napi::Value val = obj.Get(key);
+    op.scene = AcquireSceneArg(value);
+    if (!op.scene) return "Scene not found: " + SourceArgToString(value);
+    if (!obs_scene_from_source(op.scene)) return "Not a scene: " + SourceArgToString(value);
+    return "";
+}
 
-        if (val.IsString()) {
-            obs_data_set_string(data, key.c_str(), val.As<Napi::String>().Utf8Value().c_str());
-        } else if (val.IsNumber()) {
-            obs_data_set_int(data, key.c_str(), val.As<Napi::Number>().Int64Value());
-        } else if (val.IsBoolean()) {
-            obs_data_set_bool(data, key.c_str(), val.As<Napi::Boolean>().Value());
+// Validates one op and fills in `op`; returns an error message or "".
+static std::string ParseBatchOp(Napi::Env env, Napi::Value value, const std::vector<BatchOp>& ops, BatchOp& op) {
+    if (!value.IsObject()) return "Operation must be an object";
+    Napi::Object obj = value.As<Napi::Object>();
+    if (!obj.Get("op").IsString()) return "Missing 'op'";
+    std::string type = obj.Get("op").As<Napi::String>();
+
+    std::string error;
+    if (type == "addSource") {
+        op.type = BatchOpType::AddSource;
+        if (!obj.Get("id").IsString() || !obj.Get("name").IsString()) return "addSource requires 'id' and 'name'";
+        op.source_id = obj.Get("id").As<Napi::String>().Utf8Value();
+        op.name = obj.Get("name").As<Napi::String>().Utf8Value();
+        if ((error = ResolveBatchScene(obj, op)) != "") return error;
+        if (g_sources.Find(op.name) != SourceRegistry::kInvalidHandle) return "Source already exists: " + op.name;
+        for (auto const& other : ops) {
+            if (other.type == BatchOpType::AddSource && other.name == op.name) return "Source added twice: " + op.name;
         }
+        if (obj.Get("settings").IsObject()) op.settings = NapiObjectToObsData(env, obj.Get("settings").As<Napi::Object>());
+        if (obj.Get("transform").IsObject()) op.transform = ParseTransformPatch(obj.Get("transform").As<Napi::Object>());
+        op.flag = !obj.Has("visible") || obj.Get("visible").ToBoolean().Value();
+    } else if (type == "removeSource") {
+        op.type = BatchOpType::RemoveSource;
+        if ((error = ResolveBatchScene(obj, op)) != "") return error;
+        if ((error = ResolveBatchSource(obj, "source", ops, op)) != "") return error;
+    } else if (type == "updateProperties") {
+        op.type = BatchOpType::UpdateProperties;
+        if ((error = ResolveBatchSource(obj, "source", ops, op)) != "") return error;
+        if (!obj.Get("settings").IsObject()) return "updateProperties requires 'settings'";
+        op.settings = NapiObjectToObsData(env, obj.Get("settings").As<Napi::Object>());
+    } else if (type == "setTransform") {
+        op.type = BatchOpType::SetTransform;
+        if ((error = ResolveBatchScene(obj, op)) != "") return error;
+        if ((error = ResolveBatchSource(obj, "source", ops, op)) != "") return error;
+        if (!obj.Get("transform").IsObject()) return "setTransform requires 'transform'";
+        op.transform = ParseTransformPatch(obj.Get("transform").As<Napi::Object>());
+        if (op.transform.empty()) return "Empty transform";
+    } else if (type == "setVisible") {
+        op.type = BatchOpType::SetVisible;
+        if ((error = ResolveBatchScene(obj, op)) != "") return error;
+        if ((error = ResolveBatchSource(obj, "source", ops, op)) != "") return error;
+        if (!obj.Get("visible").IsBoolean()) return "setVisible requires 'visible'";
+        op.flag = obj.Get("visible").As<Napi::Boolean>();
+    } else if (type == "setMuted") {
+        op.type = BatchOpType::SetMuted;
+        if ((error = ResolveBatchSource(obj, "source", ops, op)) != "") return error;
+        if (!obj.Get("muted").IsBoolean()) return "setMuted requires 'muted'";
+        op.flag = obj.Get("muted").As<Napi::Boolean>();
+    } else {
+        return "Unknown op: " + type;
     }
-    return data;
+    return "";
 }
 
-
-Napi::Value GetFullSceneData(const Napi::CallbackInfo& info) {
+// applyBatch(ops) validates every op first and applies nothing if any is
+// invalid. Ops:
+//   { op: 'addSource', scene, id, name, settings?, transform?, visible? }
+//   { op: 'removeSource', scene, source }
+//   { op: 'updateProperties', source, settings }
+//   { op: 'setTransform', scene, source, transform }
+//   { op: 'setVisible', scene, source, visible }
+//   { op: 'setMuted', source, muted }
+// Scenes and sources are handles or names; a name may refer to a source
+// added earlier in the same batch. Returns { applied, results: [{ ok, error?,
+// handle?, durationMs }], timing: { validateMs, applyMs, totalMs } }.
+Napi::Value ApplyBatch(const Napi::CallbackInfo& info) {
     Napi::Env env = info.Env();
-    Napi::Object result = Napi::Object::New(env);
-    Napi::Array scenes_array = Napi::Array::New(env);
-    uint32_t scene_idx = 0;
-
-    auto enum_scenes = [](void *param, obs_source_t *scene_source) {
-        if (obs_source_get_type(scene_source) != OBS_SOURCE_TYPE_SCENE) {
-            return true; // continue
+    if (info.Length() < 1 || !info[0].IsArray()) throw Napi::Error::New(env, "Requires 1 argument: ops");
+    Napi::Array ops_array = info[0].As<Napi::Array>();
+
+    uint64_t start = os_gettime_ns();
+    SceneBatch batch;
+    auto& ops = batch.ops();
+    ops.reserve(ops_array.Length());
+
+    bool valid = true;
+    for (uint32_t i = 0; i < ops_array.Length(); i++) {
+        BatchOp op;
+        op.error = ParseBatchOp(env, ops_array.Get(i), ops, op);
+        valid = valid && op.error.empty();
+        ops.push_back(std::move(op));
+    }
+    uint64_t validated = os_gettime_ns();
+
+    if (valid) {
+        batch.Apply();
+        for (auto& op : ops) {
+            // Meters of removed items stay with their source until it is
+            // removed or destroyed.
+            if (op.ok && op.type == BatchOpType::AddSource) AttachAudioMeter(op.source);
         }
+    }
+    uint64_t applied = os_gettime_ns();
+
+    Napi::Array results = Napi::Array::New(env, ops.size());
+    for (size_t i = 0; i < ops.size(); i++) {
+        const BatchOp& op = ops[i];
+        Napi::Object result = Napi::Object::New(env);
+        result.Set("ok", op.ok);
+        if (!op.error.empty()) {
+            result.Set("error", op.error);
+        } else if (!valid) {
+            result.Set("skipped", true);
+        }
+        if (op.type == BatchOpType::AddSource && op.ok) {
+            result.Set("handle", SourceHandleToNapi(env, g_sources.Register(op.source)));
+        }
+        result.Set("durationMs", Napi::Number::New(env, op.duration_ns / 1000000.0));
+        results.Set((uint32_t)i, result);
+    }
 
-        auto* data = static_cast<std::tuple<Napi::Env, Napi::Array&>*>(param);
-        Napi::Env env = std::get<0>(*data);
-        Napi::Array& scenes_array = std::get<1>(*data);
-
-        Napi::Object scene_obj = Napi::Object::New(env);
-        scene_obj.Set("name", obs_source_get_name(scene_source));
-
-        Napi::Array sources_array = Napi::Array::New(env);
-        uint32_t source_idx = 0;
-
-        obs_scene_t *scene = obs_scene_from_source(scene_source);
-        auto enum_items = [](obs_scene_t*, obs_sceneitem_t *item, void *p) {
-            auto* item_data = static_cast<std::tuple<Napi::Env, Napi::Array&>*>(p);
-            Napi::Env item_env = std::get<0>(*item_data);
-            Napi::Array& item_array = std::get<1>(*item_data);
-            uint32_t& idx = *static_cast<uint32_t*>(item_data->operator[](2));
-
-            obs_source_t* source = obs_sceneitem_get_source(item);
-            if (!source) return true;
-
-            Napi::Object source_obj = Napi::Object::New(item_env);
-            source_obj.Set("name", obs_source_get_name(source));
-            source_obj.Set("id", obs_source_get_id(source));
-
-            obs_data_t* settings = obs_source_get_settings(source);
-            source_obj.Set("settings", ObsDataToNapiObject(item_env, settings));
-            obs_data_release(settings);
-
-            // Get transform
-            obs_transform_info transform_info;
-            obs_sceneitem_get_info(item, &transform_info);
-            Napi::Object transform_obj = Napi::Object::New(item_env);
-            transform_obj.Set("posX", transform_info.pos.x);
-            transform_obj.Set("posY", transform_info.pos.y);
-            transform_obj.Set("rot", transform_info.rot);
-            transform_obj.Set("scaleX", transform_info.scale.x);
-            transform_obj.Set("scaleY", transform_info.scale.y);
-            transform_obj.Set("cropTop", transform_info.crop.top);
-            transform_obj.Set("cropBottom", transform_info.crop.bottom);
-            transform_obj.Set("cropLeft", transform_info.crop.left);
-            transform_obj.Set("cropRight", transform_info.crop.right);
-            source_obj.Set("transform", transform_obj);
-
-            item_array.Set(idx++, source_obj);
-            return true;
-        };
-
-        uint32_t s_idx = 0;
-        std::tuple<Napi::Env, Napi::Array&, uint32_t*> item_data = {env, sources_array, &s_idx};
-        obs_scene_enum_items(scene, enum_items, &item_data);
-
-        scene_obj.Set("sources", sources_array);
-        uint32_t& scene_idx_ref = *static_cast<uint32_t*>(data->operator[](2));
-        scenes_array.Set(scene_idx_ref++, scene_obj);
-
-        return true;
-    };
-
-    std::tuple<Napi::Env, Napi::Array&, uint32_t*> scene_data = {env, scenes_array, &scene_idx};
-    obs_enum_sources(enum_scenes, &scene_data);
+    Napi::Object timing = Napi::Object::New(env);
+    timing.Set("validateMs", Napi::Number::New(env, (validated - start) / 1000000.0));
+    timing.Set("applyMs", Napi::Number::New(env, (applied - validated) / 1000000.0));
+    timing.Set("totalMs", Napi::Number::New(env, (os_gettime_ns() - start) / 1000000.0));
 
-    result.Set("scenes", scenes_array);
+    Napi::Object result = Napi::Object::New(env);
+    result.Set("applied", valid);
+    result.Set("results", results);
+    result.Set("timing", timing);
     return result;
 }
 
-Napi::Value LoadFullSceneData(const Napi::CallbackInfo& info) {
-    Napi::Env env = info.Env();
-    if (info.Length() < 1 || !info[0].IsObject()) {
-        throw Napi::Error::New(env, "Requires one argument: a scene data object");
-    }
-    Napi::Object data = info[0].As<Napi::Object>();
-    Napi::Array scenes_array = data.Get("scenes").As<Napi::Array>();
 
-    for (uint32_t i = 0; i < scenes_array.Length(); i++) {
-        Napi::Object scene_obj = scenes_array.Get(i).As<Napi::Object>();
-        std::string scene_name = scene_obj.Get("name").As<Napi::String>();
+// --- Profiling ---
+// Scoped timers from profiler.h; they only record in builds configured with
+// -DTITAN_ENABLE_PROFILING=ON.
 
-        obs_scene_t* scene = obs_scene_create(scene_name.c_str());
-        obs_source_t* scene_source = (obs_source_t*)scene;
+static Napi::Object ProbeTimingsToNapi(Napi::Env env, const ProbeTimings& timing) {
+    Napi::Object obj = Napi::Object::New(env);
+    obj.Set("name", timing.name);
+    obj.Set("count", (double)timing.count);
+    obj.Set("totalMs", timing.total_ms);
+    obj.Set("meanUs", timing.mean_us);
+    obj.Set("p50Us", timing.p50_us);
+    obj.Set("p90Us", timing.p90_us);
+    obj.Set("p99Us", timing.p99_us);
+    obj.Set("p999Us", timing.p999_us);
+    obj.Set("maxUs", timing.max_us);
+    return obj;
+}
 
-        Napi::Array sources_array = scene_obj.Get("sources").As<Napi::Array>();
-        for (uint32_t j = 0; j < sources_array.Length(); j++) {
-            Napi::Object source_obj = sources_array.Get(j).As<Napi::Object>();
-            std::string source_name = source_obj.Get("name").As<Napi::String>();
-            std::string source_id = source_obj.Get("id").As<Napi::String>();
+// -> { enabled, probes: [{ name, count, totalMs, meanUs, p50Us, p90Us,
+// p99Us, p999Us, maxUs }] } since the last resetTimings(), most total time
+// first. Percentiles are within ~6% of the true value.
+Napi::Value GetTimings(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    std::vector<ProbeTimings> timings = ProfileTimings();
+    std::sort(timings.begin(), timings.end(),
+              [](const ProbeTimings& a, const ProbeTimings& b) { return a.total_ms > b.total_ms; });
+    Napi::Array probes = Napi::Array::New(env, timings.size());
+    for (size_t i = 0; i < timings.size(); i++) probes.Set((uint32_t)i, ProbeTimingsToNapi(env, timings[i]));
 
-            Napi::Object settings_obj = source_obj.Get("settings").As<Napi::Object>();
-            obs_data_t* settings = NapiObjectToObsData(env, settings_obj);
+    Napi::Object result = Napi::Object::New(env);
+    result.Set("enabled", ProfilingCompiledIn());
+    result.Set("probes", probes);
+    return result;
+}
 
-            obs_source_t* new_source = obs_source_create(source_id.c_str(), source_name.c_str(), settings, nullptr);
-            obs_data_release(settings);
+Napi::Value ResetTimings(const Napi::CallbackInfo& info) {
+    ProfileResetTimings();
+    return info.Env().Undefined();
+}
 
-            if (!new_source) continue;
+class CaptureTraceWorker : public PromiseProgressWorker {
+public:
+    CaptureTraceWorker(Napi::Env env, Napi::Value options, std::string path, uint32_t duration_ms)
+        : PromiseProgressWorker(env, options), path_(std::move(path)), duration_ms_(duration_ms) {}
+
+protected:
+    void Execute(const ExecutionProgress& progress) override {
+        Report(progress, "capture", 0, 1);
+        std::this_thread::sleep_for(std::chrono::milliseconds(duration_ms_));
+        Report(progress, "capture", 1, 1);
+        std::string error = ProfileEndCapture(path_, &result_);
+        if (!error.empty()) SetError(error);
+    }
 
-            obs_sceneitem_t* scene_item = obs_scene_add(scene, new_source);
+    void OnOK() override {
+        Napi::Env env = Env();
+        Napi::Object result = Napi::Object::New(env);
+        result.Set("path", result_.path);
+        result.Set("events", (double)result_.events);
+        result.Set("dropped", (double)result_.dropped);
+        result.Set("threads", result_.threads);
+        result.Set("durationMs", duration_ms_);
+        deferred_.Resolve(result);
+    }
 
-            // Apply transform
-            Napi::Object transform_obj = source_obj.Get("transform").As<Napi::Object>();
-            obs_transform_info transform_info;
-            transform_info.pos.x = transform_obj.Get("posX").As<Napi::Number>().FloatValue();
-            transform_info.pos.y = transform_obj.Get("posY").As<Napi::Number>().FloatValue();
-            transform_info.rot = transform_obj.Get("rot").As<Napi::Number>().FloatValue();
-            transform_info.scale.x = transform_obj.Get("scaleX").As<Napi::Number>().FloatValue();
-            transform_info.scale.y = transform_obj.Get("scaleY").As<Napi::Number>().FloatValue();
-            transform_info.crop.top = transform_obj.Get("cropTop").As<Napi::Number>().Int32Value();
-            transform_info.crop.bottom = transform_obj.Get("cropBottom").As<Napi::Number>().Int32Value();
-            transform_info.crop.left = transform_obj.Get("cropLeft").As<Napi::Number>().Int32Value();
-            transform_info.crop.right = transform_obj.Get("cropRight").As<Napi::Number>().Int32Value();
-            obs_sceneitem_set_info(scene_item, &transform_info);
+private:
+    std::string path_;
+    uint32_t duration_ms_;
+    TraceCaptureResult result_;
+};
 
-            obs_source_release(new_source);
+// captureTrace(path, { durationMs = 5000, onProgress }) -> Promise of
+// { path, events, dropped, threads, durationMs }. Records every timed scope
+// for the window and writes Chrome trace JSON (about://tracing, Perfetto)
+// to `path`. One capture at a time.
+Napi::Value CaptureTrace(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    if (info.Length() < 1 || !info[0].IsString()) throw Napi::Error::New(env, "Requires 1 argument: path");
+    if (!ProfilingCompiledIn()) throw Napi::Error::New(env, "Built without TITAN_ENABLE_PROFILING");
+    Napi::Value options = info.Length() > 1 ? info[1] : env.Undefined();
+
+    uint32_t duration_ms = 5000;
+    if (options.IsObject() && options.As<Napi::Object>().Get("durationMs").IsNumber()) {
+        double value = options.As<Napi::Object>().Get("durationMs").As<Napi::Number>().DoubleValue();
+        if (!(value >= 1.0 && value <= 60000.0)) {
+            throw Napi::RangeError::New(env, "durationMs must be between 1 and 60000");
         }
+        duration_ms = (uint32_t)value;
+    }
+    if (!ProfileBeginCapture()) throw Napi::Error::New(env, "A trace capture is already running");
 
-        // Set the first scene as the program scene
-        if (i == 0) {
-             obs_transition_set(g_main_transition, scene_source);
-        }
+    auto* worker = new CaptureTraceWorker(env, options, info[0].As<Napi::String>(), duration_ms);
+    Napi::Promise promise = worker->Promise();
+    worker->Queue();
+    return promise;
+}
 
-        obs_scene_release(scene);
+#ifdef TITAN_ENABLE_PROFILING
+// Times every exported function under "napi.<name>". Profiling builds only:
+// each call then takes one extra hop through a native wrapper.
+static void ProfileExports(Napi::Env env, Napi::Object exports) {
+    Napi::Array names = exports.GetPropertyNames();
+    for (uint32_t i = 0; i < names.Length(); i++) {
+        std::string name = names.Get(i).As<Napi::String>();
+        Napi::Value value = exports.Get(name);
+        if (!value.IsFunction()) continue;
+        auto target = std::make_shared<Napi::FunctionReference>(Napi::Persistent(value.As<Napi::Function>()));
+        uint32_t probe = ProfileRegisterProbe("napi." + name);
+        auto wrapper = [target, probe](const Napi::CallbackInfo& info) -> Napi::Value {
+            ProfileScope scope(probe);
+            std::vector<napi_value> args(info.Length());
+            for (size_t arg = 0; arg < args.size(); arg++) args[arg] = info[arg];
+            return target->Value().Call(info.This(), args);
+        };
+        exports.Set(name, Napi::Function::New(env, wrapper, name.c_str()));
     }
-    return env.Undefined();
 }
-
+#endif
 
 // --- Module Initialization ---
 Napi::Object Init(Napi::Env env, Napi::Object exports) {
   exports.Set("startup", Napi::Function::New(env, StartupOBS));
   exports.Set("shutdown", Napi::Function::New(env, ShutdownOBS));
   exports.Set("getLatestFrame", Napi::Function::New(env, GetLatestFrame));
+  exports.Set("setFrameOptions", Napi::Function::New(env, SetFrameOptions));
+  exports.Set("onFrame", Napi::Function::New(env, OnFrame));
+  exports.Set("offFrame", Napi::Function::New(env, OffFrame));
+  exports.Set("setReadbackLatency", Napi::Function::New(env, SetReadbackLatency));
+  exports.Set("getReadbackStats", Napi::Function::New(env, GetReadbackStats));
+  exports.Set("setViewActive", Napi::Function::New(env, SetViewActive));
+  exports.Set("setViewFps", Napi::Function::New(env, SetViewFps));
+  exports.Set("getViewStats", Napi::Function::New(env, GetViewStats));
+  exports.Set("setSceneThumbnails", Napi::Function::New(env, SetSceneThumbnails));
+  exports.Set("getSceneThumbnails", Napi::Function::New(env, GetSceneThumbnails));
+  exports.Set("startFrameShm", Napi::Function::New(env, StartFrameShm));
+  exports.Set("stopFrameShm", Napi::Function::New(env, StopFrameShm));
+  exports.Set("getFrameShmStats", Napi::Function::New(env, GetFrameShmStats));
   exports.Set("createScene", Napi::Function::New(env, CreateScene));
   exports.Set("getSceneList", Napi::Function::New(env, GetSceneList));
 
@@ -807,13 +3682,31 @@ Napi::Object Init(Napi::Env env, Napi::Object exports) {
   exports.Set("executeTransition", Napi::Function::New(env, ExecuteTransition));
   exports.Set("getProgramSceneName", Napi::Function::New(env, GetProgramSceneName));
   exports.Set("getSceneSources", Napi::Function::New(env, GetSceneSources));
+  exports.Set("getSourceHandle", Napi::Function::New(env, GetSourceHandle));
+  exports.Set("getSourceName", Napi::Function::New(env, GetSourceName));
+  exports.Set("getSourceHandles", Napi::Function::New(env, GetSourceHandles));
   exports.Set("addSource", Napi::Function::New(env, AddSource));
   exports.Set("removeSource", Napi::Function::New(env, RemoveSource));
   exports.Set("getSourceProperties", Napi::Function::New(env, GetSourceProperties));
   exports.Set("updateSourceProperties", Napi::Function::New(env, UpdateSourceProperties));
+  exports.Set("getSourceTypeProperties", Napi::Function::New(env, GetSourceTypeProperties));
+  exports.Set("getSourcePropertyValues", Napi::Function::New(env, GetSourcePropertyValues));
+  exports.Set("invalidatePropertyCache", Napi::Function::New(env, InvalidatePropertyCache));
+  exports.Set("getPropertyCacheStats", Napi::Function::New(env, GetPropertyCacheStats));
   exports.Set("setSourceMuted", Napi::Function::New(env, SetSourceMuted));
   exports.Set("isSourceMuted", Napi::Function::New(env, IsSourceMuted));
   exports.Set("getAudioLevels", Napi::Function::New(env, GetAudioLevels));
+  exports.Set("getAudioMeters", Napi::Function::New(env, GetAudioMeters));
+  exports.Set("setAudioMeterOptions", Napi::Function::New(env, SetAudioMeterOptions));
+  exports.Set("onAudioMeters", Napi::Function::New(env, OnAudioMeters));
+  exports.Set("offAudioMeters", Napi::Function::New(env, OffAudioMeters));
+
+  // Loudness Functions
+  exports.Set("attachLoudness", Napi::Function::New(env, AttachLoudness));
+  exports.Set("detachLoudness", Napi::Function::New(env, DetachLoudness));
+  exports.Set("resetLoudness", Napi::Function::New(env, ResetLoudness));
+  exports.Set("setLoudnessOptions", Napi::Function::New(env, SetLoudnessOptions));
+  exports.Set("getLoudness", Napi::Function::New(env, GetLoudness));
 
   // Output Functions
   exports.Set("startStreaming", Napi::Function::New(env, StartStreaming));
@@ -822,10 +3715,54 @@ Napi::Object Init(Napi::Env env, Napi::Object exports) {
   exports.Set("startRecording", Napi::Function::New(env, StartRecording));
   exports.Set("stopRecording", Napi::Function::New(env, StopRecording));
   exports.Set("isRecording", Napi::Function::New(env, IsRecording));
+  exports.Set("startStreamingAsync", Napi::Function::New(env, StartStreamingAsync));
+  exports.Set("startRecordingAsync", Napi::Function::New(env, StartRecordingAsync));
+  exports.Set("benchmarkEncoders", Napi::Function::New(env, BenchmarkEncodersAsync));
+  exports.Set("setEncoderConfig", Napi::Function::New(env, SetEncoderConfig));
+  exports.Set("getEncoderConfig", Napi::Function::New(env, GetEncoderConfig));
+  exports.Set("setOutputConfig", Napi::Function::New(env, SetOutputConfig));
+  exports.Set("startOutputAsync", Napi::Function::New(env, StartOutputAsync));
+  exports.Set("stopOutput", Napi::Function::New(env, StopOutput));
+  exports.Set("isOutputActive", Napi::Function::New(env, IsOutputActive));
+  exports.Set("getOutputs", Napi::Function::New(env, GetOutputs));
+  exports.Set("setOutputThreadBudget", Napi::Function::New(env, SetOutputThreadBudget));
+
+  // Replay Buffer Functions
+  exports.Set("startReplayBufferAsync", Napi::Function::New(env, StartReplayBufferAsync));
+  exports.Set("stopReplayBuffer", Napi::Function::New(env, StopReplayBuffer));
+  exports.Set("saveReplay", Napi::Function::New(env, SaveReplay));
+  exports.Set("getReplayBufferStats", Napi::Function::New(env, GetReplayBufferStats));
+
+  // Performance Stats Functions
+  exports.Set("getPerfStats", Napi::Function::New(env, GetPerfStats));
+  exports.Set("setPerfStatsHistory", Napi::Function::New(env, SetPerfStatsHistory));
+  exports.Set("onPerfStats", Napi::Function::New(env, OnPerfStats));
+  exports.Set("offPerfStats", Napi::Function::New(env, OffPerfStats));
+  exports.Set("setAdaptiveBitrate", Napi::Function::New(env, SetAdaptiveBitrate));
+  exports.Set("getAdaptiveBitrate", Napi::Function::New(env, GetAdaptiveBitrate));
 
   // Serialization Functions
   exports.Set("getFullSceneData", Napi::Function::New(env, GetFullSceneData));
+  exports.Set("getFullSceneJson", Napi::Function::New(env, GetFullSceneJson));
   exports.Set("loadFullSceneData", Napi::Function::New(env, LoadFullSceneData));
+  exports.Set("getFullSceneDataAsync", Napi::Function::New(env, GetFullSceneDataAsync));
+  exports.Set("loadFullSceneDataAsync", Napi::Function::New(env, LoadFullSceneDataAsync));
+  exports.Set("getSceneDelta", Napi::Function::New(env, GetSceneDelta));
+  exports.Set("getSceneVersion", Napi::Function::New(env, GetSceneVersion));
+  exports.Set("getStartupTimings", Napi::Function::New(env, GetStartupTimings));
+
+  // Batch Commands
+  exports.Set("applyBatch", Napi::Function::New(env, ApplyBatch));
+
+  // Profiling Functions
+  exports.Set("getTimings", Napi::Function::New(env, GetTimings));
+  exports.Set("resetTimings", Napi::Function::New(env, ResetTimings));
+  exports.Set("captureTrace", Napi::Function::New(env, CaptureTrace));
+
+#ifdef TITAN_ENABLE_PROFILING
+  TITAN_PROFILE_THREAD("js");
+  ProfileExports(env, exports);
+#endif
 
   return exports;
 }
@@ -0,0 +1,272 @@
+#include "output-manager.h"
+#include "profiler.h"
+
+#include <algorithm>
+#include <thread>
+
+static std::string video_key(const EncoderConfig& config) {
+    return "video:" + config.encoder_id + "|" + config.preset + "|" + std::to_string(config.width) + "x" +
+           std::to_string(config.height) + "|" + std::to_string(config.bitrate) + "|" +
+           std::to_string(config.frame_rate_divisor) + "|" + std::to_string(config.threads);
+}
+
+OutputManager::~OutputManager() {
+    StopAll();
+}
+
+uint32_t OutputManager::BudgetLocked() const {
+    if (thread_budget_) return thread_budget_;
+    return std::max(1u, std::thread::hardware_concurrency());
+}
+
+obs_encoder_t* OutputManager::AcquireVideo(const EncoderConfig& config, const std::string& owner, std::string* key,
+                                           std::string* error) {
+    *key = video_key(config);
+    if (!owner.empty()) *key += "|" + owner;
+    auto it = encoders_.find(*key);
+    if (it != encoders_.end()) {
+        it->second.refs++;
+        return it->second.encoder;
+    }
+
+    EncoderConfig granted = config;
+    uint32_t threads = 0;
+    if (config.encoder_id == "obs_x264") {
+        uint32_t budget = BudgetLocked();
+        uint32_t left = budget > threads_in_use_ ? budget - threads_in_use_ : 0;
+        uint32_t wanted = config.threads ? config.threads : left / 2;
+        threads = std::max(1u, std::min(wanted, left));
+        granted.threads = threads;
+    }
+
+    std::string name = "titan_video_" + std::to_string(next_encoder_id_++);
+    obs_encoder_t* encoder = CreateVideoEncoder(granted, name.c_str());
+    if (!encoder) {
+        *error = "Failed to create video encoder " + config.encoder_id + ".";
+        return nullptr;
+    }
+    threads_in_use_ += threads;
+    encoders_[*key] = {encoder, 1, threads};
+    return encoder;
+}
+
+obs_encoder_t* OutputManager::AcquireAudio(uint32_t bitrate, std::string* key, std::string* error) {
+    *key = "audio:" + std::to_string(bitrate);
+    auto it = encoders_.find(*key);
+    if (it != encoders_.end()) {
+        it->second.refs++;
+        return it->second.encoder;
+    }
+
+    obs_data_t* settings = obs_data_create();
+    obs_data_set_int(settings, "bitrate", bitrate);
+    std::string name = "titan_audio_" + std::to_string(next_encoder_id_++);
+    // Note: fdk_aac might not be available on all builds, ffmpeg_aac is a safer default
+    obs_encoder_t* encoder = obs_audio_encoder_create("ffmpeg_aac", name.c_str(), settings, 0, nullptr);
+    obs_data_release(settings);
+    if (!encoder) {
+        *error = "Failed to create audio encoder.";
+        return nullptr;
+    }
+    obs_encoder_set_audio(encoder, obs_get_audio());
+    encoders_[*key] = {encoder, 1, 0};
+    return encoder;
+}
+
+void OutputManager::ReleaseEncoder(const std::string& key) {
+    auto it = encoders_.find(key);
+    if (it == encoders_.end() || --it->second.refs > 0) return;
+    obs_encoder_release(it->second.encoder);
+    threads_in_use_ -= it->second.threads;
+    encoders_.erase(it);
+}
+
+void OutputManager::DestroyLocked(Output& entry, bool started) {
+    // libobs keeps the encoders alive until the output has let go of them.
+    if (started) obs_output_stop(entry.output);
+    obs_output_release(entry.output);
+    ReleaseEncoder(entry.video_key);
+    ReleaseEncoder(entry.audio_key);
+}
+
+std::string OutputManager::Start(const std::string& name, const OutputSpec& spec, obs_data_t* settings) {
+    obs_output_t* output;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (outputs_.count(name)) return ""; // Already running or starting
+        if (!blocked_.empty()) return blocked_;
+
+        Output entry;
+        entry.spec = spec;
+        std::string error;
+        obs_encoder_t* video = AcquireVideo(spec.video, spec.own_video_encoder ? name : std::string(),
+                                            &entry.video_key, &error);
+        if (!video) return error;
+        obs_encoder_t* audio = AcquireAudio(spec.audio_bitrate, &entry.audio_key, &error);
+        if (!audio) {
+            ReleaseEncoder(entry.video_key);
+            return error;
+        }
+
+        std::string output_name = "titan_" + name;
+        entry.output = obs_output_create(spec.type.c_str(), output_name.c_str(), settings, nullptr);
+        if (!entry.output) {
+            ReleaseEncoder(entry.video_key);
+            ReleaseEncoder(entry.audio_key);
+            return "Failed to create " + name + " output.";
+        }
+        obs_output_set_video_encoder(entry.output, video);
+        obs_output_set_audio_encoder(entry.output, audio, 0);
+        entry.starting = true;
+        output = entry.output;
+        outputs_.emplace(name, std::move(entry));
+    }
+
+    // Connecting can take a while; other outputs stay usable meanwhile.
+    bool started = obs_output_start(output);
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    // StopAll() may be waiting for this start to finish.
+    start_done_.notify_all();
+    auto it = outputs_.find(name);
+    if (started && !it->second.stop_requested) {
+        it->second.starting = false;
+        return "";
+    }
+    std::string error;
+    if (!started) {
+        const char* last_error = obs_output_get_last_error(output);
+        error = "Failed to start " + name + " output" + (last_error ? std::string(": ") + last_error : ".");
+    }
+    DestroyLocked(it->second, started);
+    outputs_.erase(it);
+    return error;
+}
+
+void OutputManager::Stop(const std::string& name) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = outputs_.find(name);
+    if (it == outputs_.end()) return;
+    if (it->second.starting) {
+        it->second.stop_requested = true; // Start() stops it once obs_output_start returns
+        return;
+    }
+    DestroyLocked(it->second, true);
+    outputs_.erase(it);
+}
+
+void OutputManager::StopAll() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    // Outputs still inside obs_output_start are destroyed by their Start()
+    // once it returns; wait for that, so nothing touches libobs after this.
+    for (auto& [name, output] : outputs_) {
+        if (output.starting) output.stop_requested = true;
+    }
+    start_done_.wait(lock, [this] {
+        return std::none_of(outputs_.begin(), outputs_.end(),
+                            [](auto const& entry) { return entry.second.starting; });
+    });
+    for (auto& [name, output] : outputs_) DestroyLocked(output, true);
+    outputs_.clear();
+}
+
+std::string OutputManager::Block(const std::string& reason) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!blocked_.empty()) return blocked_;
+    if (!outputs_.empty()) return "Stop all outputs first.";
+    blocked_ = reason;
+    return "";
+}
+
+void OutputManager::Unblock() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    blocked_.clear();
+}
+
+bool OutputManager::IsActive(const std::string& name) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = outputs_.find(name);
+    return it != outputs_.end() && !it->second.starting && obs_output_active(it->second.output);
+}
+
+bool OutputManager::Exists(const std::string& name) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return outputs_.count(name) > 0;
+}
+
+std::vector<OutputInfo> OutputManager::List() const {
+    TITAN_PROFILE_LOCK(lock, mutex_, "outputs.lock");
+    std::vector<OutputInfo> list;
+    list.reserve(outputs_.size());
+    for (auto const& [name, output] : outputs_) {
+        OutputInfo info;
+        info.name = name;
+        info.type = output.spec.type;
+        info.video = output.spec.video;
+        auto encoder = encoders_.find(output.video_key);
+        if (encoder != encoders_.end()) {
+            info.video.threads = encoder->second.threads;
+            info.shared_video = encoder->second.refs > 1;
+        }
+        info.starting = output.starting;
+        info.active = !output.starting && obs_output_active(output.output);
+        info.total_bytes = obs_output_get_total_bytes(output.output);
+        info.frames_dropped = obs_output_get_frames_dropped(output.output);
+        info.total_frames = obs_output_get_total_frames(output.output);
+        info.congestion = obs_output_get_congestion(output.output);
+        obs_encoder_t* video_encoder = obs_output_get_video_encoder(output.output);
+        video_t* video = video_encoder ? obs_encoder_video(video_encoder) : nullptr;
+        if (video) {
+            info.encoder_skipped = video_output_get_skipped_frames(video);
+            info.encoder_frames = video_output_get_total_frames(video);
+        }
+        list.push_back(std::move(info));
+    }
+    return list;
+}
+
+std::string OutputManager::SetVideoBitrate(const std::string& name, uint32_t kbps) {
+    obs_encoder_t* encoder;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = outputs_.find(name);
+        if (it == outputs_.end() || it->second.starting) return name + " is not running.";
+        Output& output = it->second;
+        auto shared = encoders_.find(output.video_key);
+        if (shared == encoders_.end()) return name + " has no video encoder.";
+        if (shared->second.refs > 1) return name + "'s video encoder is shared with another output.";
+
+        // Re-key it under the output's name, as an own_video_encoder output
+        // is keyed, so AcquireVideo() never hands it to an output asking
+        // for either bitrate.
+        output.spec.video.bitrate = kbps;
+        std::string key = video_key(output.spec.video) + "|" + name;
+        SharedEncoder entry = shared->second;
+        encoders_.erase(shared);
+        encoders_[key] = entry;
+        output.video_key = key;
+        encoder = obs_encoder_get_ref(entry.encoder);
+    }
+
+    obs_data_t* settings = obs_data_create();
+    obs_data_set_int(settings, "bitrate", kbps);
+    obs_encoder_update(encoder, settings);
+    obs_data_release(settings);
+    obs_encoder_release(encoder);
+    return "";
+}
+
+void OutputManager::SetThreadBudget(uint32_t threads) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    thread_budget_ = threads;
+}
+
+uint32_t OutputManager::thread_budget() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return BudgetLocked();
+}
+
+uint32_t OutputManager::threads_in_use() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return threads_in_use_;
+}
@@ -0,0 +1,122 @@
+#pragma once
+
+#include "encoder-bench.h"
+
+#include <obs.h>
+#include <condition_variable>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// What a named output encodes with. Outputs whose configs are equal share
+// their encoders.
+struct OutputSpec {
+    std::string type;            // libobs output id: rtmp_output, ffmpeg_muxer, ...
+    EncoderConfig video;
+    uint32_t audio_bitrate = 160;
+    bool own_video_encoder = false; // Never share the video encoder, e.g. for live bitrate changes
+};
+
+struct OutputInfo {
+    std::string name;
+    std::string type;
+    EncoderConfig video;         // threads is what the budget granted
+    bool starting = false;       // obs_output_start still running
+    bool active = false;
+    bool shared_video = false;   // Video encoder also used by another output
+    uint64_t total_bytes = 0;
+    int frames_dropped = 0;      // Dropped by the output (network)
+    int total_frames = 0;
+    float congestion = 0.0f;     // 0..1, outputs that report it
+    uint32_t encoder_skipped = 0; // Skipped because the video encoder lagged
+    uint32_t encoder_frames = 0;  // Frames the video encoder's video produced
+};
+
+// Named outputs (stream, record, replay, ...) from the one program mix,
+// each with its own encoder settings and output size. Encoders are
+// refcounted: outputs asking for the same settings share one encoder, and
+// an encoder is released only once the last output using it stops, so
+// starting or stopping one output never disturbs another.
+//
+// x264 encoders draw their threads from a budget shared by all outputs; a
+// config asking for 0 threads gets half of what is left, and every encoder
+// gets at least one. Hardware encoders don't count against it.
+class OutputManager {
+public:
+    OutputManager() = default;
+    ~OutputManager();
+
+    OutputManager(const OutputManager&) = delete;
+    OutputManager& operator=(const OutputManager&) = delete;
+
+    // Creates and starts `name`. `settings` are the output's own settings
+    // (server and key, path, ...). Returns an error message, or "" on
+    // success or if `name` is already running. Safe off the JS thread; the
+    // lock is not held while obs_output_start connects.
+    std::string Start(const std::string& name, const OutputSpec& spec, obs_data_t* settings);
+    // Stops `name` and releases the encoders only it was using. An output
+    // still starting is stopped as soon as its start returns.
+    void Stop(const std::string& name);
+    // Stops every output, waiting for those still starting, so no start is
+    // in flight once it returns.
+    void StopAll();
+
+    // False while the output is still starting.
+    bool IsActive(const std::string& name) const;
+    bool Exists(const std::string& name) const;
+    std::vector<OutputInfo> List() const;
+
+    // Changes the video bitrate of a running output without restarting it.
+    // Fails if the encoder is shared with another output; outputs started
+    // with own_video_encoder never share it. From then on the encoder is
+    // never shared, since it no longer matches its config.
+    std::string SetVideoBitrate(const std::string& name, uint32_t kbps);
+
+    // Makes Start() fail with `reason` until Unblock(), e.g. while the
+    // encoder benchmark owns the encoders. Checks and blocks under one lock,
+    // so no output can start in between; returns an error, leaving nothing
+    // blocked, if an output is running or starting or a block is in place.
+    std::string Block(const std::string& reason);
+    void Unblock();
+
+    // Threads x264 encoders may use in total; 0 means the core count.
+    // Applies to encoders created from now on.
+    void SetThreadBudget(uint32_t threads);
+    uint32_t thread_budget() const;
+    uint32_t threads_in_use() const;
+
+private:
+    struct SharedEncoder {
+        obs_encoder_t* encoder = nullptr;
+        uint32_t refs = 0;
+        uint32_t threads = 0; // Granted from the budget
+    };
+    struct Output {
+        obs_output_t* output = nullptr;
+        OutputSpec spec;
+        std::string video_key;
+        std::string audio_key;
+        bool starting = false;
+        bool stop_requested = false;
+    };
+
+    // Require mutex_.
+    // A non-empty `owner` keys the encoder under that output alone.
+    obs_encoder_t* AcquireVideo(const EncoderConfig& config, const std::string& owner, std::string* key,
+                                std::string* error);
+    obs_encoder_t* AcquireAudio(uint32_t bitrate, std::string* key, std::string* error);
+    void ReleaseEncoder(const std::string& key);
+    void DestroyLocked(Output& entry, bool started);
+    uint32_t BudgetLocked() const;
+
+    mutable std::mutex mutex_;
+    std::condition_variable start_done_; // Signalled whenever a Start() finishes
+    std::map<std::string, Output> outputs_;
+    std::map<std::string, SharedEncoder> encoders_;
+    std::string blocked_;          // Block() reason; empty when outputs may start
+    uint32_t thread_budget_ = 0;
+    uint32_t threads_in_use_ = 0;
+    uint32_t next_encoder_id_ = 0; // libobs names for the encoders
+};
@@ -0,0 +1,153 @@
+#include "perf-stats.h"
+
+#include <algorithm>
+#include <chrono>
+#include <util/platform.h>
+
+// Ten minutes of one-second samples.
+static const size_t kDefaultCapacity = 600;
+
+PerfStatsRecorder::PerfStatsRecorder() : ring_(kDefaultCapacity) {}
+
+PerfStatsRecorder::~PerfStatsRecorder() {
+    Stop();
+}
+
+void PerfStatsRecorder::Start(const OutputManager* outputs, SampleFn on_sample) {
+    if (thread_.joinable()) return;
+    outputs_ = outputs;
+    on_sample_ = std::move(on_sample);
+    {
+        std::lock_guard<std::mutex> lock(wake_mutex_);
+        stopping_ = false;
+    }
+    thread_ = std::thread(&PerfStatsRecorder::Loop, this);
+}
+
+void PerfStatsRecorder::Stop() {
+    if (!thread_.joinable()) return;
+    {
+        std::lock_guard<std::mutex> lock(wake_mutex_);
+        stopping_ = true;
+    }
+    wake_.notify_one();
+    thread_.join();
+}
+
+static uint32_t delta(uint32_t now, uint32_t before) {
+    return now >= before ? now - before : 0;
+}
+
+PerfSample PerfStatsRecorder::Take(const PerfSample* previous) const {
+    PerfSample sample;
+    sample.time_ms = (uint64_t)std::chrono::duration_cast<std::chrono::milliseconds>(
+                         std::chrono::system_clock::now().time_since_epoch())
+                         .count();
+    sample.fps = obs_get_active_fps();
+    sample.average_frame_time_ms = obs_get_average_frame_time_ns() / 1e6;
+    sample.rendered_frames = obs_get_total_frames();
+    sample.lagged_frames = obs_get_lagged_frames();
+    video_t* video = obs_get_video();
+    if (video) {
+        sample.output_frames = video_output_get_total_frames(video);
+        sample.skipped_frames = video_output_get_skipped_frames(video);
+    }
+    if (previous) {
+        sample.lagged_frames_delta = delta(sample.lagged_frames, previous->lagged_frames);
+        sample.skipped_frames_delta = delta(sample.skipped_frames, previous->skipped_frames);
+    }
+
+    double elapsed_sec = previous && sample.time_ms > previous->time_ms
+                             ? (sample.time_ms - previous->time_ms) / 1000.0
+                             : interval_ms_ / 1000.0;
+    for (const OutputInfo& info : outputs_->List()) {
+        PerfOutputSample output;
+        output.name = info.name;
+        output.active = info.active;
+        output.total_bytes = info.total_bytes;
+        output.total_frames = info.total_frames;
+        output.frames_dropped = info.frames_dropped;
+        output.congestion = info.congestion;
+        output.video_bitrate = info.video.bitrate;
+        output.encoder_skipped = info.encoder_skipped;
+
+        const PerfOutputSample* before = nullptr;
+        if (previous) {
+            for (auto const& candidate : previous->outputs) {
+                if (candidate.name == info.name) before = &candidate;
+            }
+        }
+        // A restarted output starts its counters over; treat it as new.
+        if (before && before->total_bytes <= output.total_bytes) {
+            output.kbps = (output.total_bytes - before->total_bytes) * 8 / 1000.0 / elapsed_sec;
+            output.frames_dropped_delta = std::max(0, output.frames_dropped - before->frames_dropped);
+            output.encoder_skipped_delta = delta(output.encoder_skipped, before->encoder_skipped);
+        }
+        sample.outputs.push_back(std::move(output));
+    }
+    return sample;
+}
+
+void PerfStatsRecorder::Loop() {
+    using clock = std::chrono::steady_clock;
+    const auto interval = std::chrono::milliseconds(interval_ms_);
+    auto next = clock::now();
+    PerfSample previous;
+    bool has_previous = false;
+
+    std::unique_lock<std::mutex> wake_lock(wake_mutex_);
+    while (!stopping_) {
+        next += interval;
+        if (wake_.wait_until(wake_lock, next, [this] { return stopping_; })) break;
+        if (clock::now() > next + interval) next = clock::now(); // Don't burst after a stall
+
+        PerfSample sample = Take(has_previous ? &previous : nullptr);
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            sample.seq = next_seq_++;
+            ring_[head_] = sample;
+            head_ = (head_ + 1) % ring_.size();
+            count_ = std::min(count_ + 1, ring_.size());
+        }
+        if (on_sample_) on_sample_(sample);
+        previous = std::move(sample);
+        has_previous = true;
+    }
+}
+
+void PerfStatsRecorder::SetCapacity(size_t samples) {
+    samples = std::max<size_t>(1, samples);
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (samples == ring_.size()) return;
+    std::vector<PerfSample> ring(samples);
+    size_t keep = std::min(count_, samples);
+    for (size_t i = 0; i < keep; i++) {
+        ring[i] = std::move(ring_[(head_ + ring_.size() - keep + i) % ring_.size()]);
+    }
+    ring_ = std::move(ring);
+    count_ = keep;
+    head_ = keep % samples;
+}
+
+size_t PerfStatsRecorder::capacity() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return ring_.size();
+}
+
+std::vector<PerfSample> PerfStatsRecorder::Recent(size_t count) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (count == 0 || count > count_) count = count_;
+    std::vector<PerfSample> samples;
+    samples.reserve(count);
+    for (size_t i = 0; i < count; i++) {
+        samples.push_back(ring_[(head_ + ring_.size() - count + i) % ring_.size()]);
+    }
+    return samples;
+}
+
+bool PerfStatsRecorder::Latest(PerfSample* sample) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (count_ == 0) return false;
+    *sample = ring_[(head_ + ring_.size() - 1) % ring_.size()];
+    return true;
+}
@@ -0,0 +1,94 @@
+#pragma once
+
+#include "output-manager.h"
+
+#include <obs.h>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+struct PerfOutputSample {
+    std::string name;
+    bool active = false;
+    uint64_t total_bytes = 0;
+    double kbps = 0.0;               // Over the last interval
+    int total_frames = 0;
+    int frames_dropped = 0;
+    int frames_dropped_delta = 0;
+    float congestion = 0.0f;
+    uint32_t video_bitrate = 0;      // kbps the video encoder is set to
+    uint32_t encoder_skipped = 0;    // Frames skipped because the encoder lagged
+    uint32_t encoder_skipped_delta = 0;
+};
+
+// One sample of the libobs counters. Counters are cumulative since
+// obs_startup; *_delta fields are the increase since the previous sample.
+struct PerfSample {
+    uint64_t seq = 0;
+    uint64_t time_ms = 0;            // Wall clock, ms since the epoch
+    double fps = 0.0;                // obs_get_active_fps
+    double average_frame_time_ms = 0.0;
+    uint32_t rendered_frames = 0;    // obs_get_total_frames
+    uint32_t lagged_frames = 0;      // Missed because rendering lagged
+    uint32_t lagged_frames_delta = 0;
+    uint32_t output_frames = 0;      // Frames the main video output produced
+    uint32_t skipped_frames = 0;     // Skipped on the main video output (encoding lag)
+    uint32_t skipped_frames_delta = 0;
+    std::vector<PerfOutputSample> outputs;
+};
+
+// Samples libobs render and output counters once per interval on its own
+// thread into a fixed-size ring, so the last N minutes can be read at once
+// instead of polling every counter. Readers copy out under a mutex held
+// only for the copy; the sampler never blocks on them.
+class PerfStatsRecorder {
+public:
+    using SampleFn = std::function<void(const PerfSample& sample)>;
+
+    PerfStatsRecorder();
+    ~PerfStatsRecorder();
+
+    PerfStatsRecorder(const PerfStatsRecorder&) = delete;
+    PerfStatsRecorder& operator=(const PerfStatsRecorder&) = delete;
+
+    // Starts sampling `outputs` along with the global counters. Call after
+    // obs_startup. `on_sample` runs on the sampling thread after each
+    // sample is stored.
+    void Start(const OutputManager* outputs, SampleFn on_sample);
+    // Call before obs_shutdown. Keeps the recorded history.
+    void Stop();
+
+    // Number of samples kept; older ones are overwritten. Keeps the newest
+    // samples when shrinking.
+    void SetCapacity(size_t samples);
+    size_t capacity() const;
+    uint64_t interval_ms() const { return interval_ms_; }
+
+    // The newest `count` samples, oldest first; 0 means all of them.
+    std::vector<PerfSample> Recent(size_t count) const;
+    // False until the first sample.
+    bool Latest(PerfSample* sample) const;
+
+private:
+    void Loop();
+    PerfSample Take(const PerfSample* previous) const;
+
+    const OutputManager* outputs_ = nullptr;
+    SampleFn on_sample_;
+    const uint64_t interval_ms_ = 1000;
+
+    mutable std::mutex mutex_;
+    std::vector<PerfSample> ring_;
+    size_t head_ = 0;   // Next slot to write
+    size_t count_ = 0;
+    uint64_t next_seq_ = 1;
+
+    std::thread thread_;
+    std::mutex wake_mutex_;
+    std::condition_variable wake_;
+    bool stopping_ = false;
+};
@@ -0,0 +1,537 @@
+#include "pixel-convert.h"
+
+#include <cstring>
+
+#ifndef TITAN_DISABLE_SIMD
+#define SIMDE_ENABLE_NATIVE_ALIASES
+#include <simde/x86/avx2.h>
+#endif
+
+const char* FrameFormatName(FrameFormat format) {
+    switch (format) {
+        case FrameFormat::RGBA: return "rgba";
+        case FrameFormat::BGRA: return "bgra";
+        case FrameFormat::NV12: return "nv12";
+        case FrameFormat::I420: return "i420";
+    }
+    return "unknown";
+}
+
+bool ParseFrameFormat(const char* name, FrameFormat* format) {
+    if (strcmp(name, "rgba") == 0) {
+        *format = FrameFormat::RGBA;
+    } else if (strcmp(name, "bgra") == 0) {
+        *format = FrameFormat::BGRA;
+    } else if (strcmp(name, "nv12") == 0) {
+        *format = FrameFormat::NV12;
+    } else if (strcmp(name, "i420") == 0) {
+        *format = FrameFormat::I420;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+const char* YuvColorspaceName(YuvColorspace colorspace) {
+    return colorspace == YuvColorspace::BT601 ? "bt601" : "bt709";
+}
+
+bool ParseYuvColorspace(const char* name, YuvColorspace* colorspace) {
+    if (strcmp(name, "bt709") == 0) {
+        *colorspace = YuvColorspace::BT709;
+    } else if (strcmp(name, "bt601") == 0) {
+        *colorspace = YuvColorspace::BT601;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+const char* YuvRangeName(YuvRange range) {
+    return range == YuvRange::Full ? "full" : "limited";
+}
+
+bool ParseYuvRange(const char* name, YuvRange* range) {
+    if (strcmp(name, "limited") == 0) {
+        *range = YuvRange::Limited;
+    } else if (strcmp(name, "full") == 0) {
+        *range = YuvRange::Full;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+uint32_t GetFramePlanes(FrameFormat format, uint32_t width, uint32_t height,
+                        FramePlane planes[3], size_t* total_size) {
+    uint32_t chroma_width = width / 2;
+    uint32_t chroma_height = height / 2;
+    size_t luma_size = (size_t)width * height;
+
+    switch (format) {
+        case FrameFormat::NV12:
+            planes[0] = {0, width, width, height};
+            planes[1] = {luma_size, chroma_width * 2, chroma_width, chroma_height};
+            *total_size = luma_size + (size_t)chroma_width * 2 * chroma_height;
+            return 2;
+        case FrameFormat::I420: {
+            size_t chroma_size = (size_t)chroma_width * chroma_height;
+            planes[0] = {0, width, width, height};
+            planes[1] = {luma_size, chroma_width, chroma_width, chroma_height};
+            planes[2] = {luma_size + chroma_size, chroma_width, chroma_width, chroma_height};
+            *total_size = luma_size + chroma_size * 2;
+            return 3;
+        }
+        default:
+            planes[0] = {0, width * 4, width, height};
+            *total_size = luma_size * 4;
+            return 1;
+    }
+}
+
+void FitWithin(uint32_t width, uint32_t height, uint32_t max_width, uint32_t max_height,
+               uint32_t* out_width, uint32_t* out_height) {
+    *out_width = width;
+    *out_height = height;
+    if (width == 0 || height == 0) return;
+
+    // Compare width/max_width against height/max_height without dividing.
+    bool width_bound = max_width && width > max_width &&
+                       (!max_height || (uint64_t)width * max_height >= (uint64_t)height * max_width);
+    bool height_bound = max_height && height > max_height && !width_bound;
+
+    if (width_bound) {
+        *out_width = max_width;
+        *out_height = (uint32_t)(((uint64_t)height * max_width + width / 2) / width);
+    } else if (height_bound) {
+        *out_height = max_height;
+        *out_width = (uint32_t)(((uint64_t)width * max_height + height / 2) / height);
+    }
+    if (*out_width == 0) *out_width = 1;
+    if (*out_height == 0) *out_height = 1;
+}
+
+// --- Swizzle / copy ---
+
+static void copy_row_swap_rb_scalar(const uint8_t* src, uint8_t* dst, uint32_t pixels) {
+    for (uint32_t x = 0; x < pixels; x++) {
+        uint8_t r = src[x * 4 + 0];
+        dst[x * 4 + 0] = src[x * 4 + 2];
+        dst[x * 4 + 1] = src[x * 4 + 1];
+        dst[x * 4 + 2] = r;
+        dst[x * 4 + 3] = src[x * 4 + 3];
+    }
+}
+
+static void copy_row_swap_rb(const uint8_t* src, uint8_t* dst, uint32_t pixels) {
+    uint32_t x = 0;
+#ifndef TITAN_DISABLE_SIMD
+#if defined(SIMDE_X86_AVX2_NATIVE)
+    const __m256i mask256 = _mm256_setr_epi8(2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15,
+                                             2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15);
+    for (; x + 8 <= pixels; x += 8) {
+        __m256i v = _mm256_loadu_si256((const __m256i*)(src + x * 4));
+        _mm256_storeu_si256((__m256i*)(dst + x * 4), _mm256_shuffle_epi8(v, mask256));
+    }
+#endif
+    const __m128i mask = _mm_setr_epi8(2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15);
+    for (; x + 4 <= pixels; x += 4) {
+        __m128i v = _mm_loadu_si128((const __m128i*)(src + x * 4));
+        _mm_storeu_si128((__m128i*)(dst + x * 4), _mm_shuffle_epi8(v, mask));
+    }
+#endif
+    copy_row_swap_rb_scalar(src + x * 4, dst + x * 4, pixels - x);
+}
+
+void CopyPixels(const uint8_t* src, uint32_t src_stride, uint8_t* dst, uint32_t dst_stride,
+                uint32_t width, uint32_t height, bool swap_rb) {
+    for (uint32_t y = 0; y < height; y++) {
+        const uint8_t* src_row = src + (size_t)y * src_stride;
+        uint8_t* dst_row = dst + (size_t)y * dst_stride;
+        if (swap_rb) {
+            copy_row_swap_rb(src_row, dst_row, width);
+        } else {
+            memcpy(dst_row, src_row, (size_t)width * 4);
+        }
+    }
+}
+
+// --- 2x box ---
+
+static void downscale2x_row_scalar(const uint8_t* row0, const uint8_t* row1, uint8_t* dst, uint32_t pixels) {
+    for (uint32_t x = 0; x < pixels; x++) {
+        const uint8_t* a = row0 + x * 8;
+        const uint8_t* b = row1 + x * 8;
+        for (int c = 0; c < 4; c++) {
+            dst[x * 4 + c] = (uint8_t)((a[c] + a[c + 4] + b[c] + b[c + 4] + 2) >> 2);
+        }
+    }
+}
+
+void Downscale2x(const uint8_t* src, uint32_t src_stride, uint32_t width, uint32_t height,
+                 uint8_t* dst, uint32_t dst_stride) {
+    uint32_t dst_width = width / 2;
+    uint32_t dst_height = height / 2;
+
+    for (uint32_t y = 0; y < dst_height; y++) {
+        const uint8_t* row0 = src + (size_t)(y * 2) * src_stride;
+        const uint8_t* row1 = row0 + src_stride;
+        uint8_t* out = dst + (size_t)y * dst_stride;
+        uint32_t x = 0;
+#ifndef TITAN_DISABLE_SIMD
+        // 8 source pixels per row -> 4 output pixels. Average vertically,
+        // then split even/odd pixels and average those.
+        for (; x + 4 <= dst_width; x += 4) {
+            __m128i a0 = _mm_loadu_si128((const __m128i*)(row0 + x * 8));
+            __m128i a1 = _mm_loadu_si128((const __m128i*)(row0 + x * 8 + 16));
+            __m128i b0 = _mm_loadu_si128((const __m128i*)(row1 + x * 8));
+            __m128i b1 = _mm_loadu_si128((const __m128i*)(row1 + x * 8 + 16));
+            __m128 v0 = _mm_castsi128_ps(_mm_avg_epu8(a0, b0));
+            __m128 v1 = _mm_castsi128_ps(_mm_avg_epu8(a1, b1));
+            __m128i even = _mm_castps_si128(_mm_shuffle_ps(v0, v1, _MM_SHUFFLE(2, 0, 2, 0)));
+            __m128i odd = _mm_castps_si128(_mm_shuffle_ps(v0, v1, _MM_SHUFFLE(3, 1, 3, 1)));
+            _mm_storeu_si128((__m128i*)(out + x * 4), _mm_avg_epu8(even, odd));
+        }
+#endif
+        downscale2x_row_scalar(row0 + x * 8, row1 + x * 8, out + x * 4, dst_width - x);
+    }
+}
+
+// --- Bilinear ---
+
+// Maps destination coordinate i to a source position with 7-bit fraction,
+// clamped so that pos and pos + 1 are both valid.
+static void bilinear_coord(uint32_t i, uint32_t src_size, uint32_t dst_size, uint32_t* pos, uint32_t* frac) {
+    if (src_size < 2) {
+        *pos = 0;
+        *frac = 0;
+        return;
+    }
+    // Pixel centers: s = (i + 0.5) * src / dst - 0.5, in 1/128 steps.
+    int64_t s = ((int64_t)(2 * i + 1) * src_size * 128) / (2 * (int64_t)dst_size) - 64;
+    if (s < 0) s = 0;
+    int64_t max = (int64_t)(src_size - 1) * 128;
+    if (s > max) s = max;
+    uint32_t p = (uint32_t)(s >> 7);
+    uint32_t f = (uint32_t)(s & 127);
+    if (p >= src_size - 1) {
+        p = src_size - 2;
+        f = 128;
+    }
+    *pos = p;
+    *frac = f;
+}
+
+static inline void lerp_pixel_scalar(const uint8_t* r0, const uint8_t* r1, uint32_t fx, uint32_t fy, uint8_t* out) {
+    for (int c = 0; c < 4; c++) {
+        int top = r0[c] * 128 + (r0[c + 4] - r0[c]) * (int)fx;
+        int bottom = r1[c] * 128 + (r1[c + 4] - r1[c]) * (int)fx;
+        int value = top * 128 + (bottom - top) * (int)fy;
+        out[c] = (uint8_t)((value + (1 << 13)) >> 14);
+    }
+}
+
+void ResizeBilinear(const uint8_t* src, uint32_t src_stride, uint32_t src_width, uint32_t src_height,
+                    uint8_t* dst, uint32_t dst_stride, uint32_t dst_width, uint32_t dst_height) {
+    std::vector<uint32_t> xpos(dst_width);
+    std::vector<uint32_t> xfrac(dst_width);
+    for (uint32_t x = 0; x < dst_width; x++) {
+        bilinear_coord(x, src_width, dst_width, &xpos[x], &xfrac[x]);
+    }
+    // Single-column sources have no right neighbour to read.
+    uint32_t right = src_width > 1 ? 4 : 0;
+
+    for (uint32_t y = 0; y < dst_height; y++) {
+        uint32_t sy, fy;
+        bilinear_coord(y, src_height, dst_height, &sy, &fy);
+        const uint8_t* row0 = src + (size_t)sy * src_stride;
+        const uint8_t* row1 = src_height > 1 ? row0 + src_stride : row0;
+        uint8_t* out = dst + (size_t)y * dst_stride;
+
+#ifndef TITAN_DISABLE_SIMD
+        if (right) {
+            const __m128i zero = _mm_setzero_si128();
+            const __m128i vfy = _mm_set1_epi16((short)fy);
+            const __m128i round = _mm_set1_epi16(64);
+            for (uint32_t x = 0; x < dst_width; x++) {
+                // [p00 p01] and [p10 p11] widened to 16 bits per channel.
+                __m128i top = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i*)(row0 + xpos[x] * 4)), zero);
+                __m128i bottom = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i*)(row1 + xpos[x] * 4)), zero);
+                // Vertical: top + (bottom - top) * fy / 128, both pixels at once.
+                __m128i diff = _mm_mullo_epi16(_mm_sub_epi16(bottom, top), vfy);
+                __m128i v = _mm_add_epi16(_mm_slli_epi16(top, 7), diff);
+                // Horizontal: left + (right - left) * fx / 128, at 7 extra bits.
+                __m128i left = _mm_srai_epi16(_mm_add_epi16(v, round), 7);
+                __m128i rightpx = _mm_unpackhi_epi64(left, left);
+                __m128i hdiff = _mm_mullo_epi16(_mm_sub_epi16(rightpx, left), _mm_set1_epi16((short)xfrac[x]));
+                __m128i h = _mm_add_epi16(_mm_slli_epi16(left, 7), hdiff);
+                h = _mm_srai_epi16(_mm_add_epi16(h, round), 7);
+                __m128i packed = _mm_packus_epi16(h, h);
+                *(int32_t*)(out + x * 4) = _mm_cvtsi128_si32(packed);
+            }
+            continue;
+        }
+#endif
+        for (uint32_t x = 0; x < dst_width; x++) {
+            const uint8_t* p0 = row0 + xpos[x] * 4;
+            const uint8_t* p1 = row1 + xpos[x] * 4;
+            uint8_t px0[8], px1[8];
+            memcpy(px0, p0, 4);
+            memcpy(px0 + 4, p0 + right, 4);
+            memcpy(px1, p1, 4);
+            memcpy(px1 + 4, p1 + right, 4);
+            lerp_pixel_scalar(px0, px1, xfrac[x], fy, out + x * 4);
+        }
+    }
+}
+
+// --- RGB -> YUV ---
+
+// Fixed-point (Q14) matrix rows, in memory channel order (RGBA or BGRA), with
+// the alpha weight left at 0 so _mm_madd_epi16 can work on whole pixels.
+struct YuvMatrix {
+    int16_t y[4];
+    int16_t u[4];
+    int16_t v[4];
+    int32_t y_offset; // Q14, includes the rounding bias
+    int32_t c_offset;
+};
+
+static YuvMatrix make_yuv_matrix(FrameFormat src_format, YuvColorspace colorspace, YuvRange range) {
+    double kr = colorspace == YuvColorspace::BT601 ? 0.299 : 0.2126;
+    double kb = colorspace == YuvColorspace::BT601 ? 0.114 : 0.0722;
+    double kg = 1.0 - kr - kb;
+    double y_scale = range == YuvRange::Full ? 1.0 : 219.0 / 255.0;
+    double c_scale = range == YuvRange::Full ? 1.0 : 224.0 / 255.0;
+    double y_base = range == YuvRange::Full ? 0.0 : 16.0;
+
+    double rgb_y[3] = {kr * y_scale, kg * y_scale, kb * y_scale};
+    double rgb_u[3] = {-kr / (2.0 * (1.0 - kb)) * c_scale, -kg / (2.0 * (1.0 - kb)) * c_scale, 0.5 * c_scale};
+    double rgb_v[3] = {0.5 * c_scale, -kg / (2.0 * (1.0 - kr)) * c_scale, -kb / (2.0 * (1.0 - kr)) * c_scale};
+
+    // Memory index of R, G, B.
+    int order[3] = {0, 1, 2};
+    if (src_format == FrameFormat::BGRA) {
+        order[0] = 2;
+        order[2] = 0;
+    }
+
+    YuvMatrix m = {};
+    for (int c = 0; c < 3; c++) {
+        m.y[order[c]] = (int16_t)(rgb_y[c] * 16384.0 + (rgb_y[c] >= 0 ? 0.5 : -0.5));
+        m.u[order[c]] = (int16_t)(rgb_u[c] * 16384.0 + (rgb_u[c] >= 0 ? 0.5 : -0.5));
+        m.v[order[c]] = (int16_t)(rgb_v[c] * 16384.0 + (rgb_v[c] >= 0 ? 0.5 : -0.5));
+    }
+    m.y_offset = (int32_t)(y_base * 16384.0) + 8192;
+    m.c_offset = 128 * 16384 + 8192;
+    return m;
+}
+
+static inline uint8_t clamp_u8(int32_t v) {
+    return (uint8_t)(v < 0 ? 0 : (v > 255 ? 255 : v));
+}
+
+static inline uint8_t dot_q14(const int16_t k[4], const uint8_t* px, int32_t offset) {
+    return clamp_u8((k[0] * px[0] + k[1] * px[1] + k[2] * px[2] + offset) >> 14);
+}
+
+// Two source rows, `pairs` 2x2 blocks starting at column pair 0.
+static void yuv_rows_scalar(const YuvMatrix& m, const uint8_t* row0, const uint8_t* row1, uint32_t pairs,
+                            uint8_t* y0, uint8_t* y1, uint8_t* u, uint8_t* v, bool nv12) {
+    for (uint32_t i = 0; i < pairs; i++) {
+        const uint8_t* a = row0 + i * 8;
+        const uint8_t* b = row1 + i * 8;
+        y0[i * 2] = dot_q14(m.y, a, m.y_offset);
+        y0[i * 2 + 1] = dot_q14(m.y, a + 4, m.y_offset);
+        y1[i * 2] = dot_q14(m.y, b, m.y_offset);
+        y1[i * 2 + 1] = dot_q14(m.y, b + 4, m.y_offset);
+
+        uint8_t avg[4];
+        for (int c = 0; c < 4; c++) {
+            avg[c] = (uint8_t)((a[c] + a[c + 4] + b[c] + b[c + 4] + 2) >> 2);
+        }
+        if (nv12) {
+            u[i * 2] = dot_q14(m.u, avg, m.c_offset);
+            u[i * 2 + 1] = dot_q14(m.v, avg, m.c_offset);
+        } else {
+            u[i] = dot_q14(m.u, avg, m.c_offset);
+            v[i] = dot_q14(m.v, avg, m.c_offset);
+        }
+    }
+}
+
+#ifndef TITAN_DISABLE_SIMD
+// Four pixels -> four Q14 dot products (int32), offset added, shifted.
+static inline __m128i dot4_q14(__m128i px, __m128i k, __m128i offset) {
+    const __m128i zero = _mm_setzero_si128();
+    __m128i lo = _mm_madd_epi16(_mm_unpacklo_epi8(px, zero), k);
+    __m128i hi = _mm_madd_epi16(_mm_unpackhi_epi8(px, zero), k);
+    return _mm_srai_epi32(_mm_add_epi32(_mm_hadd_epi32(lo, hi), offset), 14);
+}
+
+static inline __m128i luma8(__m128i px0, __m128i px1, __m128i k, __m128i offset) {
+    __m128i y16 = _mm_packs_epi32(dot4_q14(px0, k, offset), dot4_q14(px1, k, offset));
+    return _mm_packus_epi16(y16, y16);
+}
+#endif
+
+void ConvertToYuv(const uint8_t* src, uint32_t src_stride, uint32_t width, uint32_t height,
+                  FrameFormat src_format, FrameFormat dst_format, YuvColorspace colorspace, YuvRange range,
+                  uint8_t* y, uint32_t y_stride, uint8_t* u, uint8_t* v, uint32_t chroma_stride) {
+    YuvMatrix m = make_yuv_matrix(src_format, colorspace, range);
+    bool nv12 = dst_format == FrameFormat::NV12;
+    uint32_t pairs = width / 2;
+
+#ifndef TITAN_DISABLE_SIMD
+    const __m128i ky = _mm_setr_epi16(m.y[0], m.y[1], m.y[2], m.y[3], m.y[0], m.y[1], m.y[2], m.y[3]);
+    const __m128i ku = _mm_setr_epi16(m.u[0], m.u[1], m.u[2], m.u[3], m.u[0], m.u[1], m.u[2], m.u[3]);
+    const __m128i kv = _mm_setr_epi16(m.v[0], m.v[1], m.v[2], m.v[3], m.v[0], m.v[1], m.v[2], m.v[3]);
+    const __m128i y_offset = _mm_set1_epi32(m.y_offset);
+    const __m128i c_offset = _mm_set1_epi32(m.c_offset);
+#endif
+
+    for (uint32_t row = 0; row + 1 < height; row += 2) {
+        const uint8_t* row0 = src + (size_t)row * src_stride;
+        const uint8_t* row1 = row0 + src_stride;
+        uint8_t* y0 = y + (size_t)row * y_stride;
+        uint8_t* y1 = y0 + y_stride;
+        uint8_t* u_row = u + (size_t)(row / 2) * chroma_stride;
+        uint8_t* v_row = nv12 ? nullptr : v + (size_t)(row / 2) * chroma_stride;
+        uint32_t i = 0;
+
+#ifndef TITAN_DISABLE_SIMD
+        // 8 pixels x 2 rows per iteration -> 16 luma + 4 chroma samples.
+        for (; i + 4 <= pairs; i += 4) {
+            __m128i a0 = _mm_loadu_si128((const __m128i*)(row0 + i * 8));
+            __m128i a1 = _mm_loadu_si128((const __m128i*)(row0 + i * 8 + 16));
+            __m128i b0 = _mm_loadu_si128((const __m128i*)(row1 + i * 8));
+            __m128i b1 = _mm_loadu_si128((const __m128i*)(row1 + i * 8 + 16));
+
+            _mm_storel_epi64((__m128i*)(y0 + i * 2), luma8(a0, a1, ky, y_offset));
+            _mm_storel_epi64((__m128i*)(y1 + i * 2), luma8(b0, b1, ky, y_offset));
+
+            __m128 v0 = _mm_castsi128_ps(_mm_avg_epu8(a0, b0));
+            __m128 v1 = _mm_castsi128_ps(_mm_avg_epu8(a1, b1));
+            __m128i even = _mm_castps_si128(_mm_shuffle_ps(v0, v1, _MM_SHUFFLE(2, 0, 2, 0)));
+            __m128i odd = _mm_castps_si128(_mm_shuffle_ps(v0, v1, _MM_SHUFFLE(3, 1, 3, 1)));
+            __m128i avg = _mm_avg_epu8(even, odd);
+
+            __m128i u16 = _mm_packs_epi32(dot4_q14(avg, ku, c_offset), _mm_setzero_si128());
+            __m128i v16 = _mm_packs_epi32(dot4_q14(avg, kv, c_offset), _mm_setzero_si128());
+            if (nv12) {
+                __m128i uv = _mm_unpacklo_epi16(u16, v16);
+                _mm_storel_epi64((__m128i*)(u_row + i * 2), _mm_packus_epi16(uv, uv));
+            } else {
+                int32_t u4 = _mm_cvtsi128_si32(_mm_packus_epi16(u16, u16));
+                int32_t v4 = _mm_cvtsi128_si32(_mm_packus_epi16(v16, v16));
+                memcpy(u_row + i, &u4, 4);
+                memcpy(v_row + i, &v4, 4);
+            }
+        }
+#endif
+        yuv_rows_scalar(m, row0 + i * 8, row1 + i * 8, pairs - i, y0 + i * 2, y1 + i * 2,
+                        u_row + (nv12 ? i * 2 : i), nv12 ? nullptr : v_row + i, nv12);
+    }
+}
+
+// --- Hash ---
+
+// Four independent xxHash64-style lanes over 32-byte blocks; the lanes keep
+// the multiplies pipelined so this runs at close to memory bandwidth.
+static constexpr uint64_t kPrime1 = 0x9E3779B185EBCA87ULL;
+static constexpr uint64_t kPrime2 = 0xC2B2AE3D27D4EB4FULL;
+
+static inline uint64_t rotl64(uint64_t x, int r) {
+    return (x << r) | (x >> (64 - r));
+}
+
+static inline uint64_t hash_round(uint64_t acc, uint64_t input) {
+    return rotl64(acc + input * kPrime2, 31) * kPrime1;
+}
+
+uint64_t HashPixels(const uint8_t* data, size_t size) {
+    uint64_t lanes[4] = {kPrime1 + kPrime2, kPrime2, 0, 0 - kPrime1};
+    size_t i = 0;
+    for (; i + 32 <= size; i += 32) {
+        for (int k = 0; k < 4; k++) {
+            uint64_t word;
+            memcpy(&word, data + i + k * 8, 8);
+            lanes[k] = hash_round(lanes[k], word);
+        }
+    }
+
+    uint64_t h = rotl64(lanes[0], 1) + rotl64(lanes[1], 7) + rotl64(lanes[2], 12) + rotl64(lanes[3], 18);
+    h += size;
+    for (; i < size; i++) {
+        h = rotl64(h ^ (data[i] * kPrime1), 11) * kPrime2;
+    }
+    h ^= h >> 33;
+    h *= kPrime2;
+    h ^= h >> 29;
+    return h;
+}
+
+// --- Pipeline ---
+
+void FrameScaler::Scale(const uint8_t* src, uint32_t src_stride, uint32_t src_width, uint32_t src_height,
+                        FrameFormat src_format, uint8_t* dst, uint32_t dst_stride, uint32_t dst_width,
+                        uint32_t dst_height, FrameFormat dst_format) {
+    bool swap_rb = src_format != dst_format;
+
+    if (dst_width == src_width && dst_height == src_height) {
+        CopyPixels(src, src_stride, dst, dst_stride, dst_width, dst_height, swap_rb);
+        return;
+    }
+
+    // Halve with the box filter while we are still at least 2x too big.
+    const uint8_t* cur = src;
+    uint32_t cur_stride = src_stride;
+    uint32_t cur_width = src_width;
+    uint32_t cur_height = src_height;
+    int which = 0;
+    while (cur_width >= dst_width * 2 && cur_height >= dst_height * 2) {
+        uint32_t half_width = cur_width / 2;
+        uint32_t half_height = cur_height / 2;
+        std::vector<uint8_t>& buf = scratch_[which];
+        buf.resize((size_t)half_width * half_height * 4);
+        Downscale2x(cur, cur_stride, cur_width, cur_height, buf.data(), half_width * 4);
+        cur = buf.data();
+        cur_stride = half_width * 4;
+        cur_width = half_width;
+        cur_height = half_height;
+        which ^= 1;
+    }
+
+    if (cur_width == dst_width && cur_height == dst_height) {
+        CopyPixels(cur, cur_stride, dst, dst_stride, dst_width, dst_height, swap_rb);
+        return;
+    }
+
+    ResizeBilinear(cur, cur_stride, cur_width, cur_height, dst, dst_stride, dst_width, dst_height);
+    if (swap_rb) {
+        // The output is small by now, so swizzling in place is cheap.
+        CopyPixels(dst, dst_stride, dst, dst_stride, dst_width, dst_height, true);
+    }
+}
+
+void FrameScaler::ScaleToYuv(const uint8_t* src, uint32_t src_stride, uint32_t src_width, uint32_t src_height,
+                             FrameFormat src_format, uint8_t* dst, uint32_t dst_width, uint32_t dst_height,
+                             FrameFormat dst_format, YuvColorspace colorspace, YuvRange range) {
+    const uint8_t* rgba = src;
+    uint32_t rgba_stride = src_stride;
+    if (dst_width != src_width || dst_height != src_height) {
+        // Scale in the source channel order; the converter handles both.
+        rgba_.resize((size_t)dst_width * dst_height * 4);
+        Scale(src, src_stride, src_width, src_height, src_format, rgba_.data(), dst_width * 4,
+              dst_width, dst_height, src_format);
+        rgba = rgba_.data();
+        rgba_stride = dst_width * 4;
+    }
+
+    FramePlane planes[3];
+    size_t total_size;
+    GetFramePlanes(dst_format, dst_width, dst_height, planes, &total_size);
+    ConvertToYuv(rgba, rgba_stride, dst_width, dst_height, src_format, dst_format, colorspace, range,
+                 dst + planes[0].offset, planes[0].stride, dst + planes[1].offset,
+                 dst_format == FrameFormat::I420 ? dst + planes[2].offset : nullptr, planes[1].stride);
+}
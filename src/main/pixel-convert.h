@@ -0,0 +1,100 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Pixel layouts the frame pipeline can hand to JS.
+enum class FrameFormat : uint32_t {
+    RGBA = 0,
+    BGRA = 1,
+    NV12 = 2, // Y plane + interleaved UV plane at half resolution
+    I420 = 3, // Y, U and V planes, chroma at half resolution
+};
+
+enum class YuvColorspace : uint32_t {
+    BT709 = 0,
+    BT601 = 1,
+};
+
+enum class YuvRange : uint32_t {
+    Limited = 0,
+    Full = 1,
+};
+
+const char* FrameFormatName(FrameFormat format);
+bool ParseFrameFormat(const char* name, FrameFormat* format);
+const char* YuvColorspaceName(YuvColorspace colorspace);
+bool ParseYuvColorspace(const char* name, YuvColorspace* colorspace);
+const char* YuvRangeName(YuvRange range);
+bool ParseYuvRange(const char* name, YuvRange* range);
+
+inline bool IsYuvFormat(FrameFormat format) {
+    return format == FrameFormat::NV12 || format == FrameFormat::I420;
+}
+
+struct FramePlane {
+    size_t offset;
+    uint32_t stride;
+    uint32_t width;
+    uint32_t height;
+};
+
+// Tightly packed plane layout of a width x height frame, planes stored back
+// to back. Returns the number of planes and the total size.
+uint32_t GetFramePlanes(FrameFormat format, uint32_t width, uint32_t height,
+                        FramePlane planes[3], size_t* total_size);
+
+// Largest size within max_width x max_height that keeps the aspect ratio of
+// width x height, never upscaling. A max of 0 leaves that axis unbounded.
+void FitWithin(uint32_t width, uint32_t height, uint32_t max_width, uint32_t max_height,
+               uint32_t* out_width, uint32_t* out_height);
+
+// --- Kernels ---
+// All kernels work on 4-byte pixels. They use SSE/AVX2 through SIMDE, which
+// maps to NEON on ARM and to portable scalar code elsewhere; defining
+// TITAN_DISABLE_SIMD forces the plain C++ fallback.
+
+// Row-by-row copy, optionally swapping the R and B channels.
+void CopyPixels(const uint8_t* src, uint32_t src_stride, uint8_t* dst, uint32_t dst_stride,
+                uint32_t width, uint32_t height, bool swap_rb);
+
+// 2x2 box filter: dst is (width / 2) x (height / 2).
+void Downscale2x(const uint8_t* src, uint32_t src_stride, uint32_t width, uint32_t height,
+                 uint8_t* dst, uint32_t dst_stride);
+
+// Bilinear resample of src into a dst_width x dst_height image.
+void ResizeBilinear(const uint8_t* src, uint32_t src_stride, uint32_t src_width, uint32_t src_height,
+                    uint8_t* dst, uint32_t dst_stride, uint32_t dst_width, uint32_t dst_height);
+
+// RGBA/BGRA -> NV12 or I420 with 2x2 averaged chroma. width and height
+// must be even. For NV12 `u` receives the interleaved UV plane and `v` is
+// ignored.
+void ConvertToYuv(const uint8_t* src, uint32_t src_stride, uint32_t width, uint32_t height,
+                  FrameFormat src_format, FrameFormat dst_format, YuvColorspace colorspace, YuvRange range,
+                  uint8_t* y, uint32_t y_stride, uint8_t* u, uint8_t* v, uint32_t chroma_stride);
+
+// Fast non-cryptographic hash of a frame, used to tell whether a newly
+// rendered frame differs from the last published one.
+uint64_t HashPixels(const uint8_t* data, size_t size);
+
+// Downscale + swizzle pipeline for one view. Large reductions are done with
+// repeated 2x box passes (cheap and alias-free) and finished with a single
+// bilinear pass. Keeps its scratch buffers between frames, so it must only
+// be used from one thread.
+class FrameScaler {
+public:
+    void Scale(const uint8_t* src, uint32_t src_stride, uint32_t src_width, uint32_t src_height,
+               FrameFormat src_format, uint8_t* dst, uint32_t dst_stride, uint32_t dst_width,
+               uint32_t dst_height, FrameFormat dst_format);
+
+    // Scales like Scale() and converts into the planes of a packed YUV
+    // frame laid out as GetFramePlanes describes.
+    void ScaleToYuv(const uint8_t* src, uint32_t src_stride, uint32_t src_width, uint32_t src_height,
+                    FrameFormat src_format, uint8_t* dst, uint32_t dst_width, uint32_t dst_height,
+                    FrameFormat dst_format, YuvColorspace colorspace, YuvRange range);
+
+private:
+    std::vector<uint8_t> scratch_[2];
+    std::vector<uint8_t> rgba_;
+};
@@ -0,0 +1,333 @@
+#include "profiler.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdio>
+#include <deque>
+#include <map>
+#include <util/platform.h>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+static const uint32_t kMaxProbes = 256;
+static const uint32_t kOverflowProbe = kMaxProbes - 1;
+
+// 16 sub-buckets per power of two; durations up to 2^36 ns (~69 s), longer
+// ones land in the last bucket.
+static const uint32_t kSubBucketBits = 4;
+static const uint32_t kSubBuckets = 1u << kSubBucketBits;
+static const uint32_t kMaxMagnitude = 36;
+static const uint32_t kBuckets = (kMaxMagnitude - kSubBucketBits + 2) * kSubBuckets;
+
+// Per thread and capture; 1.5 MB, allocated on the first capture.
+static const uint64_t kTraceEventsPerThread = 1 << 16;
+
+static inline uint32_t highest_bit(uint64_t value) {
+#ifdef _MSC_VER
+    unsigned long index;
+    _BitScanReverse64(&index, value);
+    return (uint32_t)index;
+#else
+    return 63 - (uint32_t)__builtin_clzll(value);
+#endif
+}
+
+static uint32_t bucket_index(uint64_t ns) {
+    if (ns < kSubBuckets) return (uint32_t)ns;
+    uint64_t max_ns = (2ull << kMaxMagnitude) - 1;
+    if (ns > max_ns) ns = max_ns;
+    uint32_t magnitude = highest_bit(ns);
+    uint32_t sub = (uint32_t)(ns >> (magnitude - kSubBucketBits)) & (kSubBuckets - 1);
+    return (magnitude - kSubBucketBits + 1) * kSubBuckets + sub;
+}
+
+static uint64_t bucket_lower(uint32_t index) {
+    if (index < kSubBuckets) return index;
+    return (uint64_t)(kSubBuckets + index % kSubBuckets) << (index / kSubBuckets - 1);
+}
+
+static uint64_t bucket_width(uint32_t index) {
+    return index < kSubBuckets ? 1 : 1ull << (index / kSubBuckets - 1);
+}
+
+// Only the owning thread writes, so a load and a store replace the
+// read-modify-write; readers may see a count one update behind.
+static inline void bump(std::atomic<uint64_t>& counter, uint64_t amount) {
+    counter.store(counter.load(std::memory_order_relaxed) + amount, std::memory_order_relaxed);
+}
+
+struct Histogram {
+    std::atomic<uint64_t> counts[kBuckets];
+    std::atomic<uint64_t> total_ns{0};
+
+    Histogram() {
+        for (auto& count : counts) count.store(0, std::memory_order_relaxed);
+    }
+};
+
+struct TraceEvent {
+    uint32_t probe;
+    uint64_t start_ns;
+    uint64_t duration_ns;
+};
+
+struct ThreadProfile {
+    uint32_t id = 0;
+    std::string name; // g_registry_mutex
+    std::atomic<Histogram*> histograms[kMaxProbes];
+
+    // Trace buffer for capture `trace_generation`, reset by the owner when
+    // it first records into a newer capture.
+    TraceEvent* events = nullptr;
+    std::atomic<uint32_t> trace_generation{0};
+    std::atomic<uint64_t> event_count{0};
+    std::atomic<uint64_t> dropped{0};
+
+    ThreadProfile() {
+        for (auto& histogram : histograms) histogram.store(nullptr, std::memory_order_relaxed);
+    }
+};
+
+struct ProbeBaseline {
+    std::vector<uint64_t> counts;
+    uint64_t total_ns = 0;
+};
+
+static std::mutex g_registry_mutex;
+static std::deque<std::string> g_probe_names;
+static std::map<std::string, uint32_t> g_probe_ids;
+// Never freed: a thread's numbers outlive it until the next reset reads them.
+static std::vector<ThreadProfile*> g_threads;
+static std::map<uint32_t, ProbeBaseline> g_baselines;
+
+static std::atomic<bool> g_capture_busy{false};
+static std::atomic<bool> g_capturing{false};
+static std::atomic<uint32_t> g_capture_generation{0};
+static std::atomic<uint64_t> g_capture_start_ns{0};
+
+static thread_local ThreadProfile* t_profile = nullptr;
+
+static ThreadProfile* this_thread_profile() {
+    if (!t_profile) {
+        auto* profile = new ThreadProfile();
+        std::lock_guard<std::mutex> lock(g_registry_mutex);
+        profile->id = (uint32_t)g_threads.size() + 1;
+        g_threads.push_back(profile);
+        t_profile = profile;
+    }
+    return t_profile;
+}
+
+bool ProfilingCompiledIn() {
+#ifdef TITAN_ENABLE_PROFILING
+    return true;
+#else
+    return false;
+#endif
+}
+
+uint32_t ProfileRegisterProbe(const std::string& name) {
+    std::lock_guard<std::mutex> lock(g_registry_mutex);
+    auto it = g_probe_ids.find(name);
+    if (it != g_probe_ids.end()) return it->second;
+    if (g_probe_names.size() >= kOverflowProbe) {
+        if (g_probe_names.size() == kOverflowProbe) g_probe_names.push_back("(overflow)");
+        return kOverflowProbe;
+    }
+    uint32_t id = (uint32_t)g_probe_names.size();
+    g_probe_names.push_back(name);
+    g_probe_ids[name] = id;
+    return id;
+}
+
+void ProfileRecord(uint32_t probe, uint64_t start_ns, uint64_t end_ns) {
+    if (probe >= kMaxProbes) return;
+    ThreadProfile* thread = this_thread_profile();
+    uint64_t duration = end_ns > start_ns ? end_ns - start_ns : 0;
+
+    Histogram* histogram = thread->histograms[probe].load(std::memory_order_relaxed);
+    if (!histogram) {
+        histogram = new Histogram();
+        thread->histograms[probe].store(histogram, std::memory_order_release);
+    }
+    bump(histogram->counts[bucket_index(duration)], 1);
+    bump(histogram->total_ns, duration);
+
+    if (!g_capturing.load(std::memory_order_relaxed)) return;
+    uint32_t generation = g_capture_generation.load(std::memory_order_acquire);
+    if (thread->trace_generation.load(std::memory_order_relaxed) != generation) {
+        if (!thread->events) thread->events = new TraceEvent[kTraceEventsPerThread];
+        thread->event_count.store(0, std::memory_order_relaxed);
+        thread->dropped.store(0, std::memory_order_relaxed);
+        thread->trace_generation.store(generation, std::memory_order_release);
+    }
+    uint64_t count = thread->event_count.load(std::memory_order_relaxed);
+    if (count >= kTraceEventsPerThread) {
+        bump(thread->dropped, 1);
+        return;
+    }
+    thread->events[count] = {probe, start_ns, duration};
+    thread->event_count.store(count + 1, std::memory_order_release);
+}
+
+void ProfileSetThreadName(const char* name) {
+    ThreadProfile* thread = this_thread_profile();
+    if (thread->name == name) return; // Only this thread writes it; cheap enough to call per frame
+    std::lock_guard<std::mutex> lock(g_registry_mutex);
+    thread->name = name;
+}
+
+// Requires g_registry_mutex.
+static void sum_probe(uint32_t probe, std::vector<uint64_t>* counts, uint64_t* total_ns) {
+    counts->assign(kBuckets, 0);
+    *total_ns = 0;
+    for (ThreadProfile* thread : g_threads) {
+        Histogram* histogram = thread->histograms[probe].load(std::memory_order_acquire);
+        if (!histogram) continue;
+        for (uint32_t i = 0; i < kBuckets; i++) {
+            (*counts)[i] += histogram->counts[i].load(std::memory_order_relaxed);
+        }
+        *total_ns += histogram->total_ns.load(std::memory_order_relaxed);
+    }
+}
+
+static double percentile_us(const std::vector<uint64_t>& counts, uint64_t total, double fraction) {
+    uint64_t target = std::max<uint64_t>(1, (uint64_t)std::ceil(fraction * total));
+    uint64_t seen = 0;
+    for (uint32_t i = 0; i < kBuckets; i++) {
+        seen += counts[i];
+        if (seen >= target) return (bucket_lower(i) + (bucket_width(i) - 1) / 2.0) / 1000.0;
+    }
+    return 0.0;
+}
+
+std::vector<ProbeTimings> ProfileTimings() {
+    std::vector<ProbeTimings> timings;
+    std::lock_guard<std::mutex> lock(g_registry_mutex);
+    std::vector<uint64_t> counts;
+    for (uint32_t probe = 0; probe < g_probe_names.size(); probe++) {
+        uint64_t total_ns;
+        sum_probe(probe, &counts, &total_ns);
+        auto baseline = g_baselines.find(probe);
+        if (baseline != g_baselines.end()) {
+            for (uint32_t i = 0; i < kBuckets; i++) {
+                counts[i] -= std::min(counts[i], baseline->second.counts[i]);
+            }
+            total_ns -= std::min(total_ns, baseline->second.total_ns);
+        }
+
+        uint64_t count = 0;
+        uint32_t highest = 0;
+        for (uint32_t i = 0; i < kBuckets; i++) {
+            count += counts[i];
+            if (counts[i]) highest = i;
+        }
+        if (count == 0) continue;
+
+        ProbeTimings timing;
+        timing.name = g_probe_names[probe];
+        timing.count = count;
+        timing.total_ms = total_ns / 1e6;
+        timing.mean_us = total_ns / 1000.0 / count;
+        timing.p50_us = percentile_us(counts, count, 0.50);
+        timing.p90_us = percentile_us(counts, count, 0.90);
+        timing.p99_us = percentile_us(counts, count, 0.99);
+        timing.p999_us = percentile_us(counts, count, 0.999);
+        timing.max_us = (bucket_lower(highest) + bucket_width(highest) - 1) / 1000.0;
+        timings.push_back(std::move(timing));
+    }
+    return timings;
+}
+
+void ProfileResetTimings() {
+    // Histograms belong to their threads, so a reset moves the baseline
+    // instead of clearing them.
+    std::lock_guard<std::mutex> lock(g_registry_mutex);
+    for (uint32_t probe = 0; probe < g_probe_names.size(); probe++) {
+        ProbeBaseline& baseline = g_baselines[probe];
+        sum_probe(probe, &baseline.counts, &baseline.total_ns);
+    }
+}
+
+bool ProfileBeginCapture() {
+    if (g_capture_busy.exchange(true, std::memory_order_acq_rel)) return false;
+    g_capture_start_ns.store(os_gettime_ns(), std::memory_order_relaxed);
+    g_capture_generation.fetch_add(1, std::memory_order_release);
+    g_capturing.store(true, std::memory_order_release);
+    return true;
+}
+
+static void append_json_string(std::string& out, const std::string& value) {
+    out += '"';
+    for (char c : value) {
+        if (c == '"' || c == '\\') {
+            out += '\\';
+            out += c;
+        } else if ((unsigned char)c < 0x20) {
+            char escaped[8];
+            snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+            out += escaped;
+        } else {
+            out += c;
+        }
+    }
+    out += '"';
+}
+
+std::string ProfileEndCapture(const std::string& path, TraceCaptureResult* result) {
+    if (!g_capture_busy.load(std::memory_order_acquire)) return "No trace capture is running.";
+    g_capturing.store(false, std::memory_order_release);
+    uint32_t generation = g_capture_generation.load(std::memory_order_relaxed);
+    uint64_t start_ns = g_capture_start_ns.load(std::memory_order_relaxed);
+
+    *result = TraceCaptureResult();
+    result->path = path;
+    std::string json = "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+    bool first = true;
+    char number[96];
+    {
+        std::lock_guard<std::mutex> lock(g_registry_mutex);
+        for (ThreadProfile* thread : g_threads) {
+            if (thread->trace_generation.load(std::memory_order_acquire) != generation) continue;
+            uint64_t count = thread->event_count.load(std::memory_order_acquire);
+            result->dropped += thread->dropped.load(std::memory_order_relaxed);
+            result->threads++;
+
+            std::string name = thread->name.empty() ? "thread " + std::to_string(thread->id) : thread->name;
+            json += first ? "" : ",";
+            first = false;
+            snprintf(number, sizeof(number), "{\"ph\":\"M\",\"pid\":1,\"tid\":%u,", thread->id);
+            json += number;
+            json += "\"name\":\"thread_name\",\"args\":{\"name\":";
+            append_json_string(json, name);
+            json += "}}";
+
+            for (uint64_t i = 0; i < count; i++) {
+                const TraceEvent& event = thread->events[i];
+                if (event.start_ns < start_ns) continue; // Scope began before the capture
+                json += ",{\"ph\":\"X\",\"cat\":\"titan\",\"pid\":1,\"name\":";
+                append_json_string(json, g_probe_names[event.probe]);
+                snprintf(number, sizeof(number), ",\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f}", thread->id,
+                         (event.start_ns - start_ns) / 1000.0, event.duration_ns / 1000.0);
+                json += number;
+                result->events++;
+            }
+        }
+    }
+    json += "]}";
+    g_capture_busy.store(false, std::memory_order_release);
+
+    if (!os_quick_write_utf8_file(path.c_str(), json.c_str(), json.size(), false)) {
+        return "Failed to write trace to " + path + ".";
+    }
+    return "";
+}
+
+ProfileScope::ProfileScope(uint32_t probe) : probe_(probe), start_ns_(os_gettime_ns()) {}
+
+ProfileScope::~ProfileScope() {
+    ProfileRecord(probe_, start_ns_, os_gettime_ns());
+}
@@ -0,0 +1,97 @@
+#pragma once
+
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Scoped timers for hot paths. Each thread records into its own histograms
+// (HDR-style: 16 linear sub-buckets per power of two, so any recorded
+// duration is within ~6% of its bucket), written only by that thread with
+// relaxed atomics and summed up on read, so recording never takes a lock.
+// While a trace capture is running, every scope is also appended to a
+// per-thread event buffer and written out as Chrome trace JSON at the end.
+//
+// The TITAN_PROFILE_* macros only exist in builds configured with
+// -DTITAN_ENABLE_PROFILING=ON; otherwise they expand to nothing (locks to
+// a plain unique_lock) and the functions below just report no data.
+
+struct ProbeTimings {
+    std::string name;
+    uint64_t count = 0;
+    double total_ms = 0.0;
+    double mean_us = 0.0;
+    double p50_us = 0.0;
+    double p90_us = 0.0;
+    double p99_us = 0.0;
+    double p999_us = 0.0;
+    double max_us = 0.0;   // Upper bound of the highest bucket hit
+};
+
+struct TraceCaptureResult {
+    std::string path;
+    uint64_t events = 0;
+    uint64_t dropped = 0;  // Events that did not fit a thread's buffer
+    uint32_t threads = 0;
+};
+
+// Whether this build has the instrumentation compiled in.
+bool ProfilingCompiledIn();
+
+// Returns the id for `name`, registering it on first use. Ids are stable
+// for the life of the process; at most kMaxProbes names, later ones all
+// map to an "(overflow)" probe.
+uint32_t ProfileRegisterProbe(const std::string& name);
+// Records one duration for the calling thread. Lock-free.
+void ProfileRecord(uint32_t probe, uint64_t start_ns, uint64_t end_ns);
+// Names the calling thread in traces ("graphics", "js", ...).
+void ProfileSetThreadName(const char* name);
+
+// Percentiles per probe since the last reset, summed over all threads.
+// Probes that recorded nothing are left out.
+std::vector<ProbeTimings> ProfileTimings();
+void ProfileResetTimings();
+
+// Starts recording trace events. False if a capture is already running.
+bool ProfileBeginCapture();
+// Stops recording and writes everything captured since Begin to `path`.
+// Returns an error message, or "" on success.
+std::string ProfileEndCapture(const std::string& path, TraceCaptureResult* result);
+
+class ProfileScope {
+public:
+    explicit ProfileScope(uint32_t probe);
+    ~ProfileScope();
+
+    ProfileScope(const ProfileScope&) = delete;
+    ProfileScope& operator=(const ProfileScope&) = delete;
+
+private:
+    uint32_t probe_;
+    uint64_t start_ns_;
+};
+
+#define TITAN_PROFILE_CONCAT2(a, b) a##b
+#define TITAN_PROFILE_CONCAT(a, b) TITAN_PROFILE_CONCAT2(a, b)
+#define TITAN_PROFILE_PROBE TITAN_PROFILE_CONCAT(titan_probe_, __LINE__)
+#define TITAN_PROFILE_SCOPE_VAR TITAN_PROFILE_CONCAT(titan_scope_, __LINE__)
+
+#ifdef TITAN_ENABLE_PROFILING
+// Times the rest of the enclosing block under `name`.
+#define TITAN_PROFILE_SCOPE(name)                                           \
+    static const uint32_t TITAN_PROFILE_PROBE = ProfileRegisterProbe(name); \
+    ProfileScope TITAN_PROFILE_SCOPE_VAR(TITAN_PROFILE_PROBE)
+// Declares std::unique_lock `var` on `m`, timing the wait under `name`.
+#define TITAN_PROFILE_LOCK(var, m, name)                                    \
+    static const uint32_t TITAN_PROFILE_PROBE = ProfileRegisterProbe(name); \
+    std::unique_lock<std::mutex> var(m, std::defer_lock);                   \
+    {                                                                       \
+        ProfileScope TITAN_PROFILE_SCOPE_VAR(TITAN_PROFILE_PROBE);          \
+        var.lock();                                                         \
+    }
+#define TITAN_PROFILE_THREAD(name) ProfileSetThreadName(name)
+#else
+#define TITAN_PROFILE_SCOPE(name) ((void)0)
+#define TITAN_PROFILE_LOCK(var, m, name) std::unique_lock<std::mutex> var(m)
+#define TITAN_PROFILE_THREAD(name) ((void)0)
+#endif
@@ -0,0 +1,314 @@
+#include "property-cache.h"
+
+bool PropertyListItem::operator==(const PropertyListItem& other) const {
+    return name == other.name && string_value == other.string_value && int_value == other.int_value &&
+           float_value == other.float_value && bool_value == other.bool_value && disabled == other.disabled;
+}
+
+bool PropertySchema::operator==(const PropertySchema& other) const {
+    if (children.size() != other.children.size()) return false;
+    for (size_t i = 0; i < children.size(); i++) {
+        if (children[i] != other.children[i] && !(*children[i] == *other.children[i])) return false;
+    }
+    return name == other.name && description == other.description && long_description == other.long_description &&
+           type == other.type && enabled == other.enabled && visible == other.visible && min == other.min &&
+           max == other.max && step == other.step && number_type == other.number_type && suffix == other.suffix &&
+           text_type == other.text_type && path_type == other.path_type &&
+           editable_list_type == other.editable_list_type && filter == other.filter &&
+           default_path == other.default_path && list_type == other.list_type && list_format == other.list_format &&
+           items == other.items && group_type == other.group_type;
+}
+
+static std::string to_string(const char* value) {
+    return value ? value : "";
+}
+
+static std::shared_ptr<PropertySchema> snapshot_property(obs_property_t* prop) {
+    auto schema = std::make_shared<PropertySchema>();
+    schema->name = to_string(obs_property_name(prop));
+    schema->description = to_string(obs_property_description(prop));
+    schema->long_description = to_string(obs_property_long_description(prop));
+    schema->type = obs_property_get_type(prop);
+    schema->enabled = obs_property_enabled(prop);
+    schema->visible = obs_property_visible(prop);
+
+    switch (schema->type) {
+        case OBS_PROPERTY_INT:
+            schema->min = obs_property_int_min(prop);
+            schema->max = obs_property_int_max(prop);
+            schema->step = obs_property_int_step(prop);
+            schema->number_type = obs_property_int_type(prop);
+            schema->suffix = to_string(obs_property_int_suffix(prop));
+            break;
+        case OBS_PROPERTY_FLOAT:
+            schema->min = obs_property_float_min(prop);
+            schema->max = obs_property_float_max(prop);
+            schema->step = obs_property_float_step(prop);
+            schema->number_type = obs_property_float_type(prop);
+            schema->suffix = to_string(obs_property_float_suffix(prop));
+            break;
+        case OBS_PROPERTY_TEXT:
+            schema->text_type = obs_property_text_type(prop);
+            break;
+        case OBS_PROPERTY_PATH:
+            schema->path_type = obs_property_path_type(prop);
+            schema->filter = to_string(obs_property_path_filter(prop));
+            schema->default_path = to_string(obs_property_path_default_path(prop));
+            break;
+        case OBS_PROPERTY_EDITABLE_LIST:
+            schema->editable_list_type = obs_property_editable_list_type(prop);
+            schema->filter = to_string(obs_property_editable_list_filter(prop));
+            schema->default_path = to_string(obs_property_editable_list_default_path(prop));
+            break;
+        case OBS_PROPERTY_LIST: {
+            schema->list_type = obs_property_list_type(prop);
+            schema->list_format = obs_property_list_format(prop);
+            size_t count = obs_property_list_item_count(prop);
+            schema->items.resize(count);
+            for (size_t i = 0; i < count; i++) {
+                PropertyListItem& item = schema->items[i];
+                item.name = to_string(obs_property_list_item_name(prop, i));
+                item.disabled = obs_property_list_item_disabled(prop, i);
+                switch (schema->list_format) {
+                    case OBS_COMBO_FORMAT_INT: item.int_value = obs_property_list_item_int(prop, i); break;
+                    case OBS_COMBO_FORMAT_FLOAT: item.float_value = obs_property_list_item_float(prop, i); break;
+                    case OBS_COMBO_FORMAT_BOOL: item.bool_value = obs_property_list_item_bool(prop, i); break;
+                    case OBS_COMBO_FORMAT_STRING:
+                        item.string_value = to_string(obs_property_list_item_string(prop, i));
+                        break;
+                    default: break;
+                }
+            }
+            break;
+        }
+        case OBS_PROPERTY_GROUP: {
+            schema->group_type = obs_property_group_type(prop);
+            obs_properties_t* content = obs_property_group_content(prop);
+            for (obs_property_t* child = content ? obs_properties_first(content) : nullptr; child;
+                 obs_property_next(&child)) {
+                schema->children.push_back(snapshot_property(child));
+            }
+            break;
+        }
+        default:
+            break;
+    }
+    return schema;
+}
+
+PropertyCache::~PropertyCache() {
+    for (auto& [source, entry] : instances_) obs_properties_destroy(entry.properties);
+}
+
+void PropertyCache::Connect() {
+    if (connected_) return;
+    signal_handler_connect(obs_get_signal_handler(), "source_destroy", OnSourceDestroy, this);
+    connected_ = true;
+}
+
+void PropertyCache::Disconnect() {
+    if (!connected_) return;
+    signal_handler_disconnect(obs_get_signal_handler(), "source_destroy", OnSourceDestroy, this);
+    connected_ = false;
+
+    std::unordered_map<obs_source_t*, InstanceEntry> instances;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        instances.swap(instances_);
+        types_.clear();
+        self_updates_.clear();
+    }
+    for (auto& [source, entry] : instances) {
+        signal_handler_disconnect(obs_source_get_signal_handler(source), "update", OnSourceUpdate, this);
+        obs_properties_destroy(entry.properties);
+    }
+}
+
+PropertyCache::SchemaPtr PropertyCache::Snapshot(obs_properties_t* properties, const SchemaPtr& type_schema) {
+    std::unordered_map<std::string, std::shared_ptr<const PropertySchema>> shared;
+    if (type_schema) {
+        for (auto const& prop : type_schema->properties) shared.emplace(prop->name, prop);
+    }
+
+    auto set = std::make_shared<PropertySchemaSet>();
+    for (obs_property_t* prop = properties ? obs_properties_first(properties) : nullptr; prop;
+         obs_property_next(&prop)) {
+        std::shared_ptr<const PropertySchema> schema = snapshot_property(prop);
+        auto type_prop = shared.find(schema->name);
+        if (type_prop != shared.end() && *type_prop->second == *schema) schema = type_prop->second;
+        set->properties.push_back(std::move(schema));
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    set->revision = next_revision_++;
+    return set;
+}
+
+PropertyCache::SchemaPtr PropertyCache::GetType(const std::string& id) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = types_.find(id);
+        if (it != types_.end()) {
+            stats_.hits++;
+            return it->second;
+        }
+    }
+
+    obs_properties_t* properties = obs_get_source_properties(id.c_str());
+    if (!properties) return nullptr;
+    SchemaPtr schema = Snapshot(properties, nullptr);
+    obs_properties_destroy(properties);
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    stats_.builds++;
+    return types_.emplace(id, schema).first->second;
+}
+
+PropertyCache::SchemaPtr PropertyCache::Get(obs_source_t* source) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = instances_.find(source);
+        if (it != instances_.end()) {
+            stats_.hits++;
+            return it->second.schema;
+        }
+    }
+
+    // Built without the lock: obs_source_properties runs plugin code, which
+    // may emit signals that end up in our handlers.
+    std::string id = to_string(obs_source_get_id(source));
+    SchemaPtr type_schema = GetType(id);
+    obs_properties_t* properties = obs_source_properties(source);
+    if (!properties) return nullptr;
+    SchemaPtr schema = Snapshot(properties, type_schema);
+    // Connecting twice is a no-op in libobs.
+    signal_handler_connect(obs_source_get_signal_handler(source), "update", OnSourceUpdate, this);
+
+    obs_properties_t* unused = nullptr;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stats_.builds++;
+        auto [it, inserted] = instances_.try_emplace(source);
+        if (inserted) {
+            it->second = {properties, schema, id};
+        } else {
+            unused = properties; // Another thread got there first
+            schema = it->second.schema;
+        }
+    }
+    obs_properties_destroy(unused);
+    return schema;
+}
+
+uint64_t PropertyCache::Revision(obs_source_t* source) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = instances_.find(source);
+    return it != instances_.end() ? it->second.schema->revision : 0;
+}
+
+bool PropertyCache::UpdateSettings(obs_source_t* source, obs_data_t* settings) {
+    // Video sources apply the update, and signal it, on the graphics thread
+    // at their next tick, so the mark outlives this call until the signal
+    // consumes it. Updates issued before that tick arrive as one signal.
+    // Connected here too so the mark is consumed even without an entry.
+    signal_handler_connect(obs_source_get_signal_handler(source), "update", OnSourceUpdate, this);
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        self_updates_.insert(source);
+    }
+    obs_source_update(source, settings);
+
+    // The entry is taken out while plugin callbacks run on its properties.
+    InstanceEntry entry;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = instances_.find(source);
+        if (it == instances_.end()) return false;
+        entry = it->second;
+        instances_.erase(it);
+    }
+
+    obs_data_t* current = obs_source_get_settings(source);
+    bool changed = false;
+    for (obs_data_item_t* item = obs_data_first(settings); item; obs_data_item_next(&item)) {
+        obs_property_t* prop = obs_properties_get(entry.properties, obs_data_item_get_name(item));
+        if (prop && obs_property_modified(prop, current)) changed = true;
+    }
+    obs_data_release(current);
+
+    if (changed) {
+        SchemaPtr type_schema;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            auto type = types_.find(entry.id);
+            if (type != types_.end()) type_schema = type->second;
+        }
+        entry.schema = Snapshot(entry.properties, type_schema);
+    }
+
+    obs_properties_t* unused = nullptr;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (changed) stats_.refreshes++;
+        auto [it, inserted] = instances_.try_emplace(source);
+        if (inserted) {
+            it->second = entry;
+        } else {
+            unused = entry.properties;
+        }
+    }
+    obs_properties_destroy(unused);
+    return changed;
+}
+
+void PropertyCache::EraseLocked(obs_source_t* source) {
+    auto it = instances_.find(source);
+    if (it == instances_.end()) return;
+    obs_properties_destroy(it->second.properties);
+    instances_.erase(it);
+    stats_.invalidations++;
+}
+
+void PropertyCache::Invalidate(obs_source_t* source) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    EraseLocked(source);
+}
+
+void PropertyCache::InvalidateAll() {
+    std::unordered_map<obs_source_t*, InstanceEntry> instances;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        instances.swap(instances_);
+        stats_.invalidations += instances.size() + types_.size();
+        types_.clear();
+    }
+    for (auto& [source, entry] : instances) obs_properties_destroy(entry.properties);
+}
+
+PropertyCacheStats PropertyCache::stats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    PropertyCacheStats stats = stats_;
+    stats.type_entries = types_.size();
+    stats.instance_entries = instances_.size();
+    return stats;
+}
+
+// Signal handlers run on whichever thread updated or destroyed the source.
+
+void PropertyCache::OnSourceUpdate(void* data, calldata_t* cd) {
+    auto* cache = static_cast<PropertyCache*>(data);
+    obs_source_t* source = static_cast<obs_source_t*>(calldata_ptr(cd, "source"));
+    if (!source) return;
+    std::lock_guard<std::mutex> lock(cache->mutex_);
+    if (cache->self_updates_.erase(source)) return;
+    cache->EraseLocked(source);
+}
+
+void PropertyCache::OnSourceDestroy(void* data, calldata_t* cd) {
+    auto* cache = static_cast<PropertyCache*>(data);
+    obs_source_t* source = static_cast<obs_source_t*>(calldata_ptr(cd, "source"));
+    if (!source) return;
+    std::lock_guard<std::mutex> lock(cache->mutex_);
+    cache->self_updates_.erase(source);
+    cache->EraseLocked(source);
+}
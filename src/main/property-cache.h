@@ -0,0 +1,134 @@
+#pragma once
+
+#include <obs.h>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+// One entry of a list property, with its value in the list's format.
+struct PropertyListItem {
+    std::string name;
+    std::string string_value;
+    long long int_value = 0;
+    double float_value = 0.0;
+    bool bool_value = false;
+    bool disabled = false;
+
+    bool operator==(const PropertyListItem& other) const;
+};
+
+// Plain copy of an obs_property_t with every type-specific attribute libobs
+// exposes, so it can outlive the obs_properties_t it came from.
+struct PropertySchema {
+    std::string name;
+    std::string description;
+    std::string long_description;
+    obs_property_type type = OBS_PROPERTY_INVALID;
+    bool enabled = true;
+    bool visible = true;
+
+    // OBS_PROPERTY_INT / OBS_PROPERTY_FLOAT
+    double min = 0.0, max = 0.0, step = 0.0;
+    obs_number_type number_type = OBS_NUMBER_SCROLLER;
+    std::string suffix;
+    // OBS_PROPERTY_TEXT
+    obs_text_type text_type = OBS_TEXT_DEFAULT;
+    // OBS_PROPERTY_PATH / OBS_PROPERTY_EDITABLE_LIST
+    obs_path_type path_type = OBS_PATH_FILE;
+    obs_editable_list_type editable_list_type = OBS_EDITABLE_LIST_TYPE_STRINGS;
+    std::string filter;
+    std::string default_path;
+    // OBS_PROPERTY_LIST
+    obs_combo_type list_type = OBS_COMBO_TYPE_INVALID;
+    obs_combo_format list_format = OBS_COMBO_FORMAT_INVALID;
+    std::vector<PropertyListItem> items;
+    // OBS_PROPERTY_GROUP
+    obs_group_type group_type = OBS_GROUP_NORMAL;
+    std::vector<std::shared_ptr<const PropertySchema>> children;
+
+    bool operator==(const PropertySchema& other) const;
+};
+
+struct PropertySchemaSet {
+    std::vector<std::shared_ptr<const PropertySchema>> properties;
+    // Changes whenever the schema seen for a source changes, so callers can
+    // tell whether a schema they hold is still current.
+    uint64_t revision = 0;
+};
+
+struct PropertyCacheStats {
+    uint64_t hits = 0;
+    uint64_t builds = 0;        // obs_source_properties / obs_get_source_properties calls
+    uint64_t refreshes = 0;     // Schema re-read after a modified callback asked for it
+    uint64_t invalidations = 0;
+    size_t type_entries = 0;
+    size_t instance_entries = 0;
+};
+
+// Property schemas, cached per source type and per source. A source's
+// schema is read once with obs_source_properties and kept together with the
+// obs_properties_t, so modified callbacks can be run on it later without
+// rebuilding it. Properties equal to the type-level schema share its
+// storage; only what differs per instance (typically device or file lists)
+// is stored per source. A source's entry is dropped on its "update" signal
+// (unless the update came from UpdateSettings, which runs the modified
+// callbacks instead) and when it is destroyed.
+class PropertyCache {
+public:
+    using SchemaPtr = std::shared_ptr<const PropertySchemaSet>;
+
+    PropertyCache() = default;
+    ~PropertyCache();
+
+    PropertyCache(const PropertyCache&) = delete;
+    PropertyCache& operator=(const PropertyCache&) = delete;
+
+    // Hooks up source_destroy. Call after obs_startup.
+    void Connect();
+    // Drops every entry. Call before obs_shutdown.
+    void Disconnect();
+
+    // Schema of a source; built on first use.
+    SchemaPtr Get(obs_source_t* source);
+    // Schema of a source type, without an instance; nullptr for unknown ids.
+    SchemaPtr GetType(const std::string& id);
+    // Revision of the cached schema of a source; 0 if none is cached.
+    uint64_t Revision(obs_source_t* source) const;
+
+    // Applies `settings` with obs_source_update, then runs the modified
+    // callbacks of the changed keys on the cached properties. Returns true
+    // if the schema changed as a result.
+    bool UpdateSettings(obs_source_t* source, obs_data_t* settings);
+
+    void Invalidate(obs_source_t* source);
+    void InvalidateAll();
+
+    PropertyCacheStats stats() const;
+
+private:
+    struct InstanceEntry {
+        obs_properties_t* properties = nullptr;
+        SchemaPtr schema;
+        std::string id;
+    };
+
+    static void OnSourceUpdate(void* data, calldata_t* cd);
+    static void OnSourceDestroy(void* data, calldata_t* cd);
+
+    SchemaPtr Snapshot(obs_properties_t* properties, const SchemaPtr& type_schema);
+    void EraseLocked(obs_source_t* source);
+
+    mutable std::mutex mutex_;
+    std::unordered_map<std::string, SchemaPtr> types_;
+    std::unordered_map<obs_source_t*, InstanceEntry> instances_;
+    // Sources with an UpdateSettings update whose "update" signal is still
+    // due; that signal is consumed instead of dropping the entry.
+    std::unordered_set<obs_source_t*> self_updates_;
+    PropertyCacheStats stats_;
+    uint64_t next_revision_ = 1;
+    bool connected_ = false;
+};
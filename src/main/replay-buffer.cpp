@@ -0,0 +1,552 @@
+#include "replay-buffer.h"
+
+#include <obs-avc.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <util/platform.h>
+
+// Buffered writes while muxing; one fwrite per this many bytes.
+static const size_t kWriteChunk = 4 << 20;
+
+struct ReplayOutput {
+    ReplayBuffer* buffer = nullptr;
+    obs_output_t* output = nullptr;
+    uint64_t memory_cap = ReplayBuffer::kDefaultMemoryCap;
+};
+
+static double elapsed_ms(std::chrono::steady_clock::time_point since) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - since).count();
+}
+
+static int64_t packet_ms(int64_t ts, int32_t num, int32_t den) {
+    return den ? ts * num * 1000 / den : 0;
+}
+
+// --- Output type ---
+
+void ReplayBuffer::RegisterOutput() {
+    struct obs_output_info info = {};
+    info.id = REPLAY_BUFFER_OUTPUT_ID;
+    info.flags = OBS_OUTPUT_AV | OBS_OUTPUT_ENCODED;
+    info.encoded_video_codecs = "h264";
+    info.encoded_audio_codecs = "aac";
+    info.get_name = OutputName;
+    info.create = OutputCreate;
+    info.destroy = OutputDestroy;
+    info.start = OutputStart;
+    info.stop = OutputStop;
+    info.encoded_packet = OutputPacket;
+    info.get_total_bytes = OutputTotalBytes;
+    info.get_defaults = OutputDefaults;
+    info.type_data = this;
+    obs_register_output(&info);
+}
+
+const char* ReplayBuffer::OutputName(void*) {
+    return "Titan Replay Buffer";
+}
+
+void ReplayBuffer::OutputDefaults(obs_data_t* settings) {
+    obs_data_set_default_int(settings, "max_memory_mb", (long long)(kDefaultMemoryCap >> 20));
+}
+
+void* ReplayBuffer::OutputCreate(obs_data_t* settings, obs_output_t* output) {
+    auto* buffer = static_cast<ReplayBuffer*>(obs_output_get_type_data(output));
+    if (buffer->output_exists_.exchange(true)) {
+        blog(LOG_WARNING, "A replay buffer output already exists");
+        return nullptr;
+    }
+    auto* data = new ReplayOutput();
+    data->buffer = buffer;
+    data->output = output;
+    long long mb = obs_data_get_int(settings, "max_memory_mb");
+    if (mb > 0) data->memory_cap = (uint64_t)mb << 20;
+    return data;
+}
+
+void ReplayBuffer::OutputDestroy(void* data) {
+    auto* replay = static_cast<ReplayOutput*>(data);
+    replay->buffer->End();
+    replay->buffer->output_exists_ = false;
+    delete replay;
+}
+
+bool ReplayBuffer::OutputStart(void* data) {
+    auto* replay = static_cast<ReplayOutput*>(data);
+    if (!obs_output_can_begin_data_capture(replay->output, 0)) return false;
+    if (!obs_output_initialize_encoders(replay->output, 0)) return false;
+
+    // Encoder headers only exist once the encoders are initialized.
+    Format format;
+    obs_encoder_t* video = obs_output_get_video_encoder(replay->output);
+    if (video) {
+        format.video_codec = obs_encoder_get_codec(video);
+        format.width = obs_encoder_get_width(video);
+        format.height = obs_encoder_get_height(video);
+        uint8_t* extra = nullptr;
+        size_t size = 0;
+        if (obs_encoder_get_extra_data(video, &extra, &size)) format.video_header.assign(extra, extra + size);
+    }
+    obs_encoder_t* audio = obs_output_get_audio_encoder(replay->output, 0);
+    if (audio) {
+        format.audio_codec = obs_encoder_get_codec(audio);
+        format.sample_rate = obs_encoder_get_sample_rate(audio);
+        format.channels = (uint32_t)audio_output_get_channels(obs_encoder_audio(audio));
+        uint8_t* extra = nullptr;
+        size_t size = 0;
+        if (obs_encoder_get_extra_data(audio, &extra, &size)) format.audio_header.assign(extra, extra + size);
+    }
+
+    replay->buffer->Begin(replay->memory_cap, std::move(format));
+    obs_output_begin_data_capture(replay->output, 0);
+    return true;
+}
+
+void ReplayBuffer::OutputStop(void* data, uint64_t) {
+    auto* replay = static_cast<ReplayOutput*>(data);
+    obs_output_end_data_capture(replay->output);
+    replay->buffer->End();
+}
+
+void ReplayBuffer::OutputPacket(void* data, struct encoder_packet* packet) {
+    auto* replay = static_cast<ReplayOutput*>(data);
+    if (!packet) {
+        // The encoder failed; nothing more will arrive.
+        obs_output_signal_stop(replay->output, OBS_OUTPUT_ENCODE_ERROR);
+        return;
+    }
+    replay->buffer->Append(packet);
+}
+
+uint64_t ReplayBuffer::OutputTotalBytes(void* data) {
+    return static_cast<ReplayOutput*>(data)->buffer->TotalBytes();
+}
+
+// --- Ring ---
+
+void ReplayBuffer::Begin(uint64_t memory_cap, Format format) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    ClearLocked();
+    pool_.clear();
+    memory_cap_ = memory_cap;
+    format_ = std::move(format);
+    evicted_packets_ = 0;
+    total_bytes_ = 0;
+    active_ = true;
+}
+
+void ReplayBuffer::End() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!active_) return;
+    active_ = false;
+    // Saves still running hold on to the blocks they need.
+    ClearLocked();
+    pool_.clear();
+}
+
+uint64_t ReplayBuffer::TotalBytes() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return total_bytes_;
+}
+
+void ReplayBuffer::Append(const struct encoder_packet* packet) {
+    bool video = packet->type == OBS_ENCODER_VIDEO;
+    bool keyframe = video && packet->keyframe;
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!active_) return;
+    // The ring starts on a keyframe; anything before it is undecodable.
+    if (waiting_for_keyframe_ && !keyframe) return;
+
+    std::shared_ptr<Block> block = BlockFor(packet->size);
+    // Making room may have evicted the GOP this packet belongs to.
+    if (waiting_for_keyframe_ && !keyframe) return;
+    waiting_for_keyframe_ = false;
+
+    Packet entry;
+    entry.block = block;
+    entry.offset = block->used;
+    entry.size = packet->size;
+    entry.pts = packet->pts;
+    entry.dts = packet->dts;
+    entry.timebase_num = packet->timebase_num;
+    entry.timebase_den = packet->timebase_den;
+    entry.video = video;
+    entry.keyframe = keyframe;
+    memcpy(block->data.get() + block->used, packet->data, packet->size);
+    block->used += packet->size;
+
+    packets_.push_back(std::move(entry));
+    payload_bytes_ += packet->size;
+    total_bytes_ += packet->size;
+    if (video) video_packets_++;
+    if (keyframe) keyframes_++;
+}
+
+// What the cap applies to; blocks pinned by running saves are left out (see
+// the class comment).
+uint64_t ReplayBuffer::CommittedLocked() const {
+    return ring_bytes_ + pool_.size() * kBlockSize;
+}
+
+std::shared_ptr<ReplayBuffer::Block> ReplayBuffer::BlockFor(size_t size) {
+    if (!blocks_.empty()) {
+        const std::shared_ptr<Block>& back = blocks_.back();
+        if (back->capacity - back->used >= size) return back;
+    }
+
+    size_t capacity = std::max(size, kBlockSize);
+    std::shared_ptr<Block> block;
+    for (;;) {
+        if (capacity == kBlockSize && !pool_.empty()) {
+            block = std::move(pool_.back());
+            pool_.pop_back();
+            block->used = 0;
+            break;
+        }
+        if (CommittedLocked() + capacity <= memory_cap_) break;
+        if (!pool_.empty()) {
+            // Room for an oversized packet: free pooled blocks first.
+            pool_.pop_back();
+            continue;
+        }
+        // With nothing left to evict a single GOP may exceed the cap.
+        if (!EvictGopLocked()) break;
+    }
+    if (!block) {
+        block = std::make_shared<Block>();
+        block->data.reset(new uint8_t[capacity]);
+        block->capacity = capacity;
+    }
+    blocks_.push_back(block);
+    ring_bytes_ += block->capacity;
+    return block;
+}
+
+bool ReplayBuffer::EvictGopLocked() {
+    if (packets_.empty()) return false;
+
+    size_t count = packets_.size();
+    for (size_t i = 1; i < packets_.size(); i++) {
+        if (packets_[i].keyframe) {
+            count = i;
+            break;
+        }
+    }
+    if (count == packets_.size()) waiting_for_keyframe_ = true;  // Only the current GOP was left
+
+    for (size_t i = 0; i < count; i++) {
+        const Packet& packet = packets_.front();
+        payload_bytes_ -= packet.size;
+        if (packet.video) video_packets_--;
+        if (packet.keyframe) keyframes_--;
+        packets_.pop_front();
+    }
+    evicted_packets_ += count;
+    ReleaseBlocksLocked();
+    return true;
+}
+
+void ReplayBuffer::ReleaseBlocksLocked() {
+    // Blocks are filled in order, so everything before the oldest packet's
+    // block is no longer in the ring.
+    while (!blocks_.empty() && (packets_.empty() || blocks_.front() != packets_.front().block)) {
+        std::shared_ptr<Block> block = std::move(blocks_.front());
+        blocks_.pop_front();
+        ring_bytes_ -= block->capacity;
+        if (block.use_count() > 1) {
+            // A save is still reading it; it is freed when the save is done.
+            pinned_.push_back(block);
+        } else if (block->capacity == kBlockSize) {
+            pool_.push_back(std::move(block));
+        }
+    }
+    pinned_.erase(std::remove_if(pinned_.begin(), pinned_.end(),
+                                 [](const std::weak_ptr<Block>& block) { return block.expired(); }),
+                  pinned_.end());
+}
+
+void ReplayBuffer::ClearLocked() {
+    packets_.clear();
+    ReleaseBlocksLocked();
+    payload_bytes_ = 0;
+    video_packets_ = 0;
+    keyframes_ = 0;
+    waiting_for_keyframe_ = true;
+}
+
+ReplayBufferStats ReplayBuffer::GetStats() const {
+    ReplayBufferStats stats;
+    std::lock_guard<std::mutex> lock(mutex_);
+    stats.active = active_;
+    stats.memory_cap_bytes = memory_cap_;
+    stats.memory_used_bytes = ring_bytes_;
+    stats.memory_pooled_bytes = pool_.size() * kBlockSize;
+    for (const auto& weak : pinned_) {
+        if (auto block = weak.lock()) stats.memory_pinned_bytes += block->capacity;
+    }
+    stats.payload_bytes = payload_bytes_;
+    if (!packets_.empty()) {
+        const Packet& first = packets_.front();
+        const Packet& last = packets_.back();
+        int64_t span = packet_ms(last.dts, last.timebase_num, last.timebase_den) -
+                       packet_ms(first.dts, first.timebase_num, first.timebase_den);
+        stats.buffered_seconds = std::max<int64_t>(span, 0) / 1000.0;
+    }
+    stats.video_packets = video_packets_;
+    stats.audio_packets = packets_.size() - video_packets_;
+    stats.keyframes = keyframes_;
+    stats.evicted_packets = evicted_packets_;
+    stats.saves_in_progress = saves_in_progress_.load();
+    stats.has_last_save = has_last_save_;
+    stats.last_save = last_save_;
+    return stats;
+}
+
+// --- FLV muxing ---
+
+namespace {
+
+class FlvWriter {
+public:
+    explicit FlvWriter(FILE* file) : file_(file) { buffer_.reserve(kWriteChunk + kWriteChunk / 4); }
+
+    void Header(bool video, bool audio) {
+        const uint8_t header[] = {'F', 'L', 'V', 1, (uint8_t)((audio ? 0x04 : 0) | (video ? 0x01 : 0)),
+                                  0, 0, 0, 9,
+                                  0, 0, 0, 0};  // PreviousTagSize0
+        Bytes(header, sizeof(header));
+    }
+
+    // Tag header, body, trailing PreviousTagSize.
+    void Tag(uint8_t type, int64_t ms, const uint8_t* body, size_t size) {
+        uint32_t ts = (uint32_t)std::max<int64_t>(ms, 0);
+        U8(type);
+        U24((uint32_t)size);
+        U24(ts & 0xFFFFFF);
+        U8((uint8_t)(ts >> 24));
+        U24(0);  // Stream id
+        Bytes(body, size);
+        U32((uint32_t)(size + 11));
+        if (buffer_.size() >= kWriteChunk) Flush();
+    }
+
+    bool Flush() {
+        if (!buffer_.empty() && fwrite(buffer_.data(), 1, buffer_.size(), file_) != buffer_.size()) failed_ = true;
+        written_ += buffer_.size();
+        buffer_.clear();
+        return !failed_;
+    }
+
+    uint64_t written() const { return written_; }
+
+private:
+    void U8(uint8_t v) { buffer_.push_back(v); }
+    void U24(uint32_t v) {
+        U8((uint8_t)(v >> 16));
+        U8((uint8_t)(v >> 8));
+        U8((uint8_t)v);
+    }
+    void U32(uint32_t v) {
+        U8((uint8_t)(v >> 24));
+        U24(v & 0xFFFFFF);
+    }
+    void Bytes(const uint8_t* data, size_t size) { buffer_.insert(buffer_.end(), data, data + size); }
+
+    FILE* file_;
+    std::vector<uint8_t> buffer_;
+    uint64_t written_ = 0;
+    bool failed_ = false;
+};
+
+// AMF0 onMetaData body.
+class AmfBuilder {
+public:
+    void String(const char* s) {
+        bytes.push_back(0x02);
+        Key(s);
+    }
+    void BeginEcmaArray(uint32_t count) {
+        bytes.push_back(0x08);
+        for (int shift = 24; shift >= 0; shift -= 8) bytes.push_back((uint8_t)(count >> shift));
+    }
+    void Number(const char* key, double value) {
+        Key(key);
+        bytes.push_back(0x00);
+        uint64_t bits;
+        memcpy(&bits, &value, sizeof(bits));
+        for (int shift = 56; shift >= 0; shift -= 8) bytes.push_back((uint8_t)(bits >> shift));
+    }
+    void Bool(const char* key, bool value) {
+        Key(key);
+        bytes.push_back(0x01);
+        bytes.push_back(value ? 1 : 0);
+    }
+    void EndObject() {
+        const uint8_t end[] = {0, 0, 9};
+        bytes.insert(bytes.end(), end, end + sizeof(end));
+    }
+
+    std::vector<uint8_t> bytes;
+
+private:
+    void Key(const char* s) {
+        size_t len = strlen(s);
+        bytes.push_back((uint8_t)(len >> 8));
+        bytes.push_back((uint8_t)len);
+        bytes.insert(bytes.end(), s, s + len);
+    }
+};
+
+} // namespace
+
+ReplaySaveResult ReplayBuffer::Save(const std::string& path, double seconds) {
+    auto start = std::chrono::steady_clock::now();
+    saves_in_progress_++;
+    struct Done {
+        std::atomic<uint32_t>& count;
+        ~Done() { count--; }
+    } done{saves_in_progress_};
+
+    ReplaySaveResult result;
+    result.path = path;
+
+    // Snapshot: the packet list and references to its blocks, no data copy.
+    std::vector<Packet> clip;
+    Format format;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!active_) {
+            result.error = "Replay buffer is not running.";
+            return result;
+        }
+        if (packets_.empty()) {
+            result.error = "Replay buffer is empty.";
+            return result;
+        }
+        size_t first = 0;
+        if (seconds > 0.0) {
+            const Packet& last = packets_.back();
+            int64_t cut = packet_ms(last.dts, last.timebase_num, last.timebase_den) - (int64_t)(seconds * 1000.0);
+            for (size_t i = packets_.size(); i-- > 0;) {
+                const Packet& p = packets_[i];
+                if (p.keyframe && packet_ms(p.dts, p.timebase_num, p.timebase_den) <= cut) {
+                    first = i;
+                    break;
+                }
+            }
+        }
+        clip.assign(packets_.begin() + first, packets_.end());
+        format = format_;
+    }
+    result.snapshot_ms = elapsed_ms(start);
+
+    if (format.video_codec != "h264") {
+        result.error = "Replay buffer saves need H.264 video, not '" + format.video_codec + "'.";
+        return result;
+    }
+    if (format.video_header.empty()) {
+        result.error = "The video encoder has no stream header.";
+        return result;
+    }
+    bool has_audio = !format.audio_codec.empty();
+    if (has_audio && format.audio_codec != "aac") {
+        result.error = "Replay buffer saves need AAC audio, not '" + format.audio_codec + "'.";
+        return result;
+    }
+
+    auto mux_start = std::chrono::steady_clock::now();
+    const Packet& head = clip.front();
+    int64_t base_ms = packet_ms(head.dts, head.timebase_num, head.timebase_den);
+    const Packet& tail = clip.back();
+    int64_t duration_ms = packet_ms(tail.dts, tail.timebase_num, tail.timebase_den) - base_ms;
+
+    FILE* file = os_fopen(path.c_str(), "wb");
+    if (!file) {
+        result.error = "Failed to open '" + path + "' for writing.";
+        return result;
+    }
+    FlvWriter flv(file);
+    flv.Header(true, has_audio);
+
+    AmfBuilder meta;
+    meta.String("onMetaData");
+    meta.BeginEcmaArray(has_audio ? 8 : 4);
+    meta.Number("duration", duration_ms / 1000.0);
+    meta.Number("width", format.width);
+    meta.Number("height", format.height);
+    meta.Number("videocodecid", 7);  // AVC
+    if (has_audio) {
+        meta.Number("audiocodecid", 10);  // AAC
+        meta.Number("audiosamplerate", format.sample_rate);
+        meta.Number("audiosamplesize", 16);
+        meta.Bool("stereo", format.channels >= 2);
+    }
+    meta.EndObject();
+    flv.Tag(18, 0, meta.bytes.data(), meta.bytes.size());
+
+    // Sequence headers: AVCDecoderConfigurationRecord and AudioSpecificConfig.
+    std::vector<uint8_t> body;
+    uint8_t* avc_header = nullptr;
+    size_t avc_size = obs_parse_avc_header(&avc_header, format.video_header.data(), format.video_header.size());
+    body = {0x17, 0x00, 0, 0, 0};
+    body.insert(body.end(), avc_header, avc_header + avc_size);
+    bfree(avc_header);
+    flv.Tag(9, 0, body.data(), body.size());
+    if (has_audio) {
+        body = {0xAF, 0x00};
+        body.insert(body.end(), format.audio_header.begin(), format.audio_header.end());
+        flv.Tag(8, 0, body.data(), body.size());
+    }
+
+    for (const Packet& packet : clip) {
+        if (!packet.video && !has_audio) continue;
+        int64_t ms = packet_ms(packet.dts, packet.timebase_num, packet.timebase_den) - base_ms;
+        const uint8_t* data = packet.block->data.get() + packet.offset;
+        if (packet.video) {
+            // Encoders hand out Annex B; FLV wants length-prefixed NAL units.
+            struct encoder_packet src = {};
+            src.data = const_cast<uint8_t*>(data);
+            src.size = packet.size;
+            src.pts = packet.pts;
+            src.dts = packet.dts;
+            src.timebase_num = packet.timebase_num;
+            src.timebase_den = packet.timebase_den;
+            src.type = OBS_ENCODER_VIDEO;
+            src.keyframe = packet.keyframe;
+            struct encoder_packet avc = {};
+            obs_parse_avc_packet(&avc, &src);
+            int32_t cts = (int32_t)packet_ms(packet.pts - packet.dts, packet.timebase_num, packet.timebase_den);
+            body = {(uint8_t)(packet.keyframe ? 0x17 : 0x27), 0x01, (uint8_t)(cts >> 16), (uint8_t)(cts >> 8),
+                    (uint8_t)cts};
+            body.insert(body.end(), avc.data, avc.data + avc.size);
+            obs_encoder_packet_release(&avc);
+            flv.Tag(9, ms, body.data(), body.size());
+        } else {
+            body = {0xAF, 0x01};
+            body.insert(body.end(), data, data + packet.size);
+            flv.Tag(8, ms, body.data(), body.size());
+        }
+        result.packets++;
+    }
+
+    bool ok = flv.Flush();
+    if (fclose(file) != 0) ok = false;
+    clip.clear();  // Unpin the blocks before reporting
+
+    if (!ok) {
+        result.error = "Failed to write '" + path + "'.";
+        return result;
+    }
+    result.seconds = std::max<int64_t>(duration_ms, 0) / 1000.0;
+    result.bytes = flv.written();
+    result.mux_ms = elapsed_ms(mux_start);
+    result.total_ms = elapsed_ms(start);
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    has_last_save_ = true;
+    last_save_ = result;
+    return result;
+}
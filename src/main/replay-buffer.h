@@ -0,0 +1,149 @@
+#pragma once
+
+#include <obs.h>
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// libobs output id of the replay buffer; start it like any named output.
+// Settings: { max_memory_mb }.
+#define REPLAY_BUFFER_OUTPUT_ID "titan_replay_buffer"
+
+struct ReplaySaveResult {
+    std::string path;
+    double seconds = 0.0;        // Duration of the saved clip
+    uint64_t bytes = 0;          // File size
+    uint64_t packets = 0;
+    double snapshot_ms = 0.0;    // Time the ring was locked
+    double mux_ms = 0.0;
+    double total_ms = 0.0;
+    std::string error;
+};
+
+struct ReplayBufferStats {
+    bool active = false;
+    uint64_t memory_cap_bytes = 0;    // Bounds used + pooled; pinned comes on top
+    uint64_t memory_used_bytes = 0;   // Blocks in the ring
+    uint64_t memory_pooled_bytes = 0; // Free blocks kept for reuse
+    uint64_t memory_pinned_bytes = 0; // Evicted blocks a save still reads
+    uint64_t payload_bytes = 0;       // Packet data in the ring
+    double buffered_seconds = 0.0;
+    uint64_t video_packets = 0;
+    uint64_t audio_packets = 0;
+    uint64_t keyframes = 0;
+    uint64_t evicted_packets = 0;     // Since the buffer started
+    uint32_t saves_in_progress = 0;
+    bool has_last_save = false;
+    ReplaySaveResult last_save;
+};
+
+// Encoded packets of the last N seconds, bounded by memory rather than time.
+// Packet data is copied into pooled fixed-size blocks; when the cap is hit,
+// whole GOPs are evicted from the front so the ring always starts on a
+// video keyframe, and evicted blocks are reused for new packets.
+//
+// Save() pins the blocks the clip needs under the lock (a copy of the
+// packet list, no packet data) and muxes without it, so the output thread
+// appending packets never waits on a save. Clips are written as FLV, which
+// takes H.264 and AAC as the encoders produce them.
+//
+// The memory cap covers the ring and the pool, not blocks pinned by saves
+// in flight: those come on top, up to one more cap's worth for a save of
+// the whole buffer, until the save finishes (memory_pinned_bytes). Counting
+// them would make the ring evict the footage after the cut while a save
+// runs, and pinned blocks can't be freed early anyway.
+class ReplayBuffer {
+public:
+    static constexpr size_t kBlockSize = 1 << 20;
+    static constexpr uint64_t kDefaultMemoryCap = 512ull << 20;
+
+    ReplayBuffer() = default;
+    ~ReplayBuffer() = default;
+
+    ReplayBuffer(const ReplayBuffer&) = delete;
+    ReplayBuffer& operator=(const ReplayBuffer&) = delete;
+
+    // Registers the REPLAY_BUFFER_OUTPUT_ID output type feeding this buffer.
+    // Call once after obs_startup. Only one such output runs at a time.
+    void RegisterOutput();
+
+    // Muxes the last `seconds` (all of it for 0), starting on the keyframe
+    // at or before the cut, into `path`. Blocking; call off the JS thread.
+    ReplaySaveResult Save(const std::string& path, double seconds);
+    ReplayBufferStats GetStats() const;
+
+private:
+    struct Block {
+        std::unique_ptr<uint8_t[]> data;
+        size_t capacity = 0;
+        size_t used = 0;
+    };
+    struct Packet {
+        std::shared_ptr<Block> block;  // Keeps the data alive for saves
+        size_t offset = 0;
+        size_t size = 0;
+        int64_t pts = 0;
+        int64_t dts = 0;
+        int32_t timebase_num = 1;
+        int32_t timebase_den = 1;
+        bool video = false;
+        bool keyframe = false;
+    };
+    struct Format {
+        std::string video_codec;
+        std::string audio_codec;
+        std::vector<uint8_t> video_header;  // Encoder extra data (Annex B SPS/PPS for H.264)
+        std::vector<uint8_t> audio_header;  // AudioSpecificConfig for AAC
+        uint32_t width = 0;
+        uint32_t height = 0;
+        uint32_t sample_rate = 0;
+        uint32_t channels = 0;
+    };
+
+    // Output callbacks, on libobs' threads.
+    static const char* OutputName(void* type_data);
+    static void* OutputCreate(obs_data_t* settings, obs_output_t* output);
+    static void OutputDestroy(void* data);
+    static bool OutputStart(void* data);
+    static void OutputStop(void* data, uint64_t ts);
+    static void OutputPacket(void* data, struct encoder_packet* packet);
+    static uint64_t OutputTotalBytes(void* data);
+    static void OutputDefaults(obs_data_t* settings);
+
+    void Begin(uint64_t memory_cap, Format format);
+    void End();
+    void Append(const struct encoder_packet* packet);
+    uint64_t TotalBytes() const;
+
+    // Require mutex_.
+    uint64_t CommittedLocked() const;
+    std::shared_ptr<Block> BlockFor(size_t size);
+    bool EvictGopLocked();
+    void ReleaseBlocksLocked();
+    void ClearLocked();
+
+    mutable std::mutex mutex_;
+    bool active_ = false;
+    uint64_t memory_cap_ = kDefaultMemoryCap;
+    Format format_;
+    std::deque<Packet> packets_;
+    std::deque<std::shared_ptr<Block>> blocks_;  // Oldest first; back() takes new packets
+    std::vector<std::shared_ptr<Block>> pool_;
+    uint64_t ring_bytes_ = 0;
+    uint64_t payload_bytes_ = 0;
+    uint64_t video_packets_ = 0;
+    uint64_t keyframes_ = 0;
+    uint64_t evicted_packets_ = 0;
+    uint64_t total_bytes_ = 0;
+    bool waiting_for_keyframe_ = true;
+    std::vector<std::weak_ptr<Block>> pinned_;  // Evicted while a save held them
+    bool has_last_save_ = false;
+    ReplaySaveResult last_save_;
+
+    std::atomic<bool> output_exists_{false};
+    std::atomic<uint32_t> saves_in_progress_{0};
+};
@@ -0,0 +1,146 @@
+#include "scene-batch.h"
+
+#include <util/platform.h>
+
+bool TransformPatch::empty() const {
+    return !pos_x && !pos_y && !rot && !scale_x && !scale_y &&
+           !crop_top && !crop_bottom && !crop_left && !crop_right;
+}
+
+void TransformPatch::ApplyTo(obs_sceneitem_t* item) const {
+    if (pos_x || pos_y || rot || scale_x || scale_y) {
+        obs_transform_info info;
+        obs_sceneitem_get_info2(item, &info);
+        if (pos_x) info.pos.x = *pos_x;
+        if (pos_y) info.pos.y = *pos_y;
+        if (rot) info.rot = *rot;
+        if (scale_x) info.scale.x = *scale_x;
+        if (scale_y) info.scale.y = *scale_y;
+        obs_sceneitem_set_info2(item, &info);
+    }
+    if (crop_top || crop_bottom || crop_left || crop_right) {
+        obs_sceneitem_crop crop;
+        obs_sceneitem_get_crop(item, &crop);
+        if (crop_top) crop.top = *crop_top;
+        if (crop_bottom) crop.bottom = *crop_bottom;
+        if (crop_left) crop.left = *crop_left;
+        if (crop_right) crop.right = *crop_right;
+        obs_sceneitem_set_crop(item, &crop);
+    }
+}
+
+SceneBatch::~SceneBatch() {
+    for (auto& op : ops_) {
+        obs_source_release(op.scene);
+        obs_source_release(op.source);
+        obs_data_release(op.settings);
+    }
+}
+
+obs_source_t* SceneBatch::SourceOf(const BatchOp& op) const {
+    return op.source_op >= 0 ? ops_[op.source_op].source : op.source;
+}
+
+void SceneBatch::Apply() {
+    // Sources are created outside the scene locks; creating e.g. a browser
+    // source can take a while and must not stall the compositor.
+    for (auto& op : ops_) {
+        uint64_t start = os_gettime_ns();
+        switch (op.type) {
+            case BatchOpType::AddSource:
+                op.source = obs_source_create(op.source_id.c_str(), op.name.c_str(), op.settings, nullptr);
+                if (!op.source) op.error = "Failed to create source with id: " + op.source_id;
+                break;
+            case BatchOpType::UpdateProperties:
+            case BatchOpType::SetMuted: {
+                obs_source_t* source = SourceOf(op);
+                if (!source) {
+                    op.error = "Source was not created";
+                } else if (op.type == BatchOpType::UpdateProperties) {
+                    obs_source_update(source, op.settings);
+                    op.ok = true;
+                } else {
+                    obs_source_set_muted(source, op.flag);
+                    op.ok = true;
+                }
+                break;
+            }
+            default:
+                break;
+        }
+        op.duration_ns = os_gettime_ns() - start;
+    }
+
+    // Group scene item edits by scene, keeping their order within a scene.
+    std::vector<obs_source_t*> scenes;
+    std::vector<SceneUpdate> updates;
+    for (size_t i = 0; i < ops_.size(); i++) {
+        BatchOp& op = ops_[i];
+        bool scene_op = op.type == BatchOpType::AddSource || op.type == BatchOpType::RemoveSource ||
+                        op.type == BatchOpType::SetTransform || op.type == BatchOpType::SetVisible;
+        if (!scene_op || !op.error.empty()) continue;
+
+        size_t s = 0;
+        while (s < scenes.size() && scenes[s] != op.scene) s++;
+        if (s == scenes.size()) {
+            scenes.push_back(op.scene);
+            updates.push_back({this, {}});
+        }
+        updates[s].ops.push_back(i);
+    }
+
+    for (size_t s = 0; s < scenes.size(); s++) {
+        obs_scene_atomic_update(obs_scene_from_source(scenes[s]), ApplySceneUpdate, &updates[s]);
+    }
+}
+
+void SceneBatch::ApplySceneUpdate(void* data, obs_scene_t* scene) {
+    auto* update = static_cast<SceneUpdate*>(data);
+    for (size_t index : update->ops) {
+        BatchOp& op = update->batch->ops_[index];
+        uint64_t start = os_gettime_ns();
+        update->batch->ApplySceneOp(op, scene);
+        op.duration_ns += os_gettime_ns() - start;
+    }
+}
+
+void SceneBatch::ApplySceneOp(BatchOp& op, obs_scene_t* scene) {
+    obs_source_t* source = SourceOf(op);
+    if (!source) {
+        op.error = "Source was not created";
+        return;
+    }
+
+    if (op.type == BatchOpType::AddSource) {
+        obs_sceneitem_t* item = obs_scene_add(scene, source);
+        if (!item) {
+            op.error = "Failed to add source to scene";
+            return;
+        }
+        op.transform.ApplyTo(item);
+        if (!op.flag) obs_sceneitem_set_visible(item, false);
+        op.ok = true;
+        return;
+    }
+
+    obs_sceneitem_t* item = obs_scene_sceneitem_from_source(scene, source);
+    if (!item) {
+        op.error = std::string("Source is not in scene: ") + obs_source_get_name(source);
+        return;
+    }
+    switch (op.type) {
+        case BatchOpType::RemoveSource:
+            obs_sceneitem_remove(item);
+            break;
+        case BatchOpType::SetTransform:
+            op.transform.ApplyTo(item);
+            break;
+        case BatchOpType::SetVisible:
+            obs_sceneitem_set_visible(item, op.flag);
+            break;
+        default:
+            break;
+    }
+    obs_sceneitem_release(item);
+    op.ok = true;
+}
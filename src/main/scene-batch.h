@@ -0,0 +1,78 @@
+#pragma once
+
+#include <obs.h>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+
+// Partial scene item transform; fields left empty keep their current value.
+struct TransformPatch {
+    std::optional<float> pos_x, pos_y;
+    std::optional<float> rot;
+    std::optional<float> scale_x, scale_y;
+    std::optional<int> crop_top, crop_bottom, crop_left, crop_right;
+
+    bool empty() const;
+    void ApplyTo(obs_sceneitem_t* item) const;
+};
+
+enum class BatchOpType {
+    AddSource,
+    RemoveSource,
+    UpdateProperties,
+    SetTransform,
+    SetVisible,
+    SetMuted,
+};
+
+// One validated operation. References are strong and owned by the batch.
+struct BatchOp {
+    BatchOpType type;
+    obs_source_t* scene = nullptr;
+    obs_source_t* source = nullptr;
+    // Index of an earlier AddSource op in the same batch whose source this op
+    // refers to, or -1.
+    int source_op = -1;
+    std::string source_id; // AddSource
+    std::string name;      // AddSource
+    obs_data_t* settings = nullptr;
+    TransformPatch transform;
+    bool flag = false;     // SetVisible / SetMuted; AddSource: hidden when false
+
+    // Results
+    bool ok = false;
+    std::string error;
+    uint64_t duration_ns = 0;
+};
+
+// A list of scene edits applied in one pass. New sources are created and
+// property updates applied first; then every scene's item changes land
+// inside a single obs_scene_atomic_update, so the compositor never renders a
+// half-applied scene.
+class SceneBatch {
+public:
+    SceneBatch() = default;
+    ~SceneBatch();
+
+    SceneBatch(const SceneBatch&) = delete;
+    SceneBatch& operator=(const SceneBatch&) = delete;
+
+    std::vector<BatchOp>& ops() { return ops_; }
+    const std::vector<BatchOp>& ops() const { return ops_; }
+
+    // Sets ok/error/duration on every op.
+    void Apply();
+
+private:
+    struct SceneUpdate {
+        SceneBatch* batch;
+        std::vector<size_t> ops;
+    };
+
+    obs_source_t* SourceOf(const BatchOp& op) const;
+    void ApplySceneOp(BatchOp& op, obs_scene_t* scene);
+    static void ApplySceneUpdate(void* data, obs_scene_t* scene);
+
+    std::vector<BatchOp> ops_;
+};
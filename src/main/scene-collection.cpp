@@ -0,0 +1,248 @@
+#include "scene-collection.h"
+
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <unordered_map>
+#include <util/platform.h>
+
+unsigned DefaultSceneLoadParallelism() {
+    unsigned cores = std::thread::hardware_concurrency();
+    return std::clamp(cores, 1u, 4u);
+}
+
+SceneState CopySceneState(const SceneState& scene) {
+    SceneState copy;
+    copy.name = scene.name;
+    copy.items.reserve(scene.items.size());
+    for (auto const& item : scene.items) {
+        SceneItemState& item_copy = copy.items.emplace_back();
+        item_copy.name = item.name;
+        item_copy.id = item.id;
+        if (item.settings) {
+            obs_data_addref(item.settings.get());
+            item_copy.settings.reset(item.settings.get());
+        }
+        item_copy.pos_x = item.pos_x;
+        item_copy.pos_y = item.pos_y;
+        item_copy.rot = item.rot;
+        item_copy.scale_x = item.scale_x;
+        item_copy.scale_y = item.scale_y;
+        item_copy.crop_top = item.crop_top;
+        item_copy.crop_bottom = item.crop_bottom;
+        item_copy.crop_left = item.crop_left;
+        item_copy.crop_right = item.crop_right;
+    }
+    return copy;
+}
+
+// --- Capture ---
+
+static bool capture_scene_item(obs_scene_t*, obs_sceneitem_t* item, void* param) {
+    auto* items = static_cast<std::vector<SceneItemState>*>(param);
+    obs_source_t* source = obs_sceneitem_get_source(item);
+    if (!source) return true;
+
+    SceneItemState state;
+    state.name = obs_source_get_name(source);
+    state.id = obs_source_get_id(source);
+    state.settings.reset(obs_source_get_settings(source));
+
+    obs_transform_info info;
+    obs_sceneitem_get_info2(item, &info);
+    state.pos_x = info.pos.x;
+    state.pos_y = info.pos.y;
+    state.rot = info.rot;
+    state.scale_x = info.scale.x;
+    state.scale_y = info.scale.y;
+
+    obs_sceneitem_crop crop;
+    obs_sceneitem_get_crop(item, &crop);
+    state.crop_top = crop.top;
+    state.crop_bottom = crop.bottom;
+    state.crop_left = crop.left;
+    state.crop_right = crop.right;
+
+    items->push_back(std::move(state));
+    return true;
+}
+
+static SceneState capture_scene(obs_source_t* scene_source) {
+    SceneState state;
+    state.name = obs_source_get_name(scene_source);
+    obs_scene_enum_items(obs_scene_from_source(scene_source), capture_scene_item, &state.items);
+    return state;
+}
+
+void SceneCollection::Capture(const SceneProgressFn& progress) {
+    std::vector<obs_source_t*> scene_sources;
+    obs_enum_scenes([](void* param, obs_source_t* source) {
+        static_cast<std::vector<obs_source_t*>*>(param)->push_back(obs_source_get_ref(source));
+        return true;
+    }, &scene_sources);
+
+    scenes.clear();
+    scenes.reserve(scene_sources.size());
+    for (size_t i = 0; i < scene_sources.size(); i++) {
+        if (scene_sources[i]) {
+            scenes.push_back(capture_scene(scene_sources[i]));
+            obs_source_release(scene_sources[i]);
+        }
+        if (progress) progress("scenes", i + 1, scene_sources.size());
+    }
+}
+
+void SceneCollection::CaptureScenes(const std::vector<std::string>& names) {
+    scenes.clear();
+    scenes.reserve(names.size());
+    for (auto const& name : names) {
+        obs_scene_t* scene = obs_get_scene_by_name(name.c_str());
+        if (!scene) continue;
+        scenes.push_back(capture_scene(obs_scene_get_source(scene)));
+        obs_scene_release(scene);
+    }
+}
+
+// --- Load ---
+
+static void apply_item_state(obs_sceneitem_t* item, const SceneItemState& state) {
+    obs_transform_info info;
+    obs_sceneitem_get_info2(item, &info);
+    info.pos.x = state.pos_x;
+    info.pos.y = state.pos_y;
+    info.rot = state.rot;
+    info.scale.x = state.scale_x;
+    info.scale.y = state.scale_y;
+    obs_sceneitem_set_info2(item, &info);
+
+    obs_sceneitem_crop crop;
+    crop.top = state.crop_top;
+    crop.bottom = state.crop_bottom;
+    crop.left = state.crop_left;
+    crop.right = state.crop_right;
+    obs_sceneitem_set_crop(item, &crop);
+}
+
+// Runs `work(i)` for every i in [0, count) on up to `threads` threads,
+// including the calling one.
+template <typename Work>
+static void parallel_for(size_t count, unsigned threads, Work work) {
+    std::atomic<size_t> next{0};
+    auto run = [&] {
+        for (size_t i; (i = next.fetch_add(1, std::memory_order_relaxed)) < count;) work(i);
+    };
+    threads = (unsigned)std::min<size_t>(std::max(threads, 1u), std::max<size_t>(count, 1));
+    std::vector<std::thread> pool;
+    for (unsigned t = 1; t < threads; t++) pool.emplace_back(run);
+    run();
+    for (auto& thread : pool) thread.join();
+}
+
+std::vector<obs_source_t*> SceneCollection::Load(const SceneLoadOptions& options, const SceneProgressFn& progress,
+                                                 SceneLoadStats* stats) const {
+    uint64_t start = os_gettime_ns();
+    SceneLoadStats local_stats;
+
+    // Scenes first, so items can refer to other scenes of the collection. A
+    // scene that already exists is reused as it is, like an existing source,
+    // rather than created again under the same name and filled twice.
+    std::vector<obs_scene_t*> created_scenes(scenes.size(), nullptr);
+    std::vector<bool> existing_scenes(scenes.size(), false);
+    std::unordered_map<std::string, obs_source_t*> scene_sources;
+    for (size_t i = 0; i < scenes.size(); i++) {
+        created_scenes[i] = obs_get_scene_by_name(scenes[i].name.c_str());
+        existing_scenes[i] = created_scenes[i] != nullptr;
+        if (!created_scenes[i]) {
+            created_scenes[i] = obs_scene_create(scenes[i].name.c_str());
+            if (created_scenes[i]) local_stats.scenes++;
+        }
+        if (created_scenes[i]) scene_sources[scenes[i].name] = obs_scene_get_source(created_scenes[i]);
+        if (progress) progress("scenes", i + 1, scenes.size());
+    }
+
+    // One source per name; items with the same name in several scenes share
+    // it, like they do in libobs.
+    struct PendingSource {
+        const SceneItemState* state;
+        obs_source_t* source = nullptr;
+        bool existing = false;
+    };
+    std::vector<PendingSource> pending;
+    std::unordered_map<std::string, size_t> pending_index;
+    // Scenes nesting other scenes of the collection are filled after the
+    // independent ones, on a single thread.
+    std::vector<size_t> independent, nesting;
+    for (size_t i = 0; i < scenes.size(); i++) {
+        if (!created_scenes[i] || existing_scenes[i]) continue;
+        bool nests = false;
+        for (auto const& item : scenes[i].items) {
+            if (scene_sources.count(item.name)) {
+                nests = true;
+            } else if (pending_index.emplace(item.name, pending.size()).second) {
+                PendingSource source{&item};
+                source.source = obs_get_source_by_name(item.name.c_str());
+                source.existing = source.source != nullptr;
+                pending.push_back(source);
+            }
+        }
+        (nests ? nesting : independent).push_back(i);
+    }
+
+    std::atomic<size_t> done{0};
+    std::atomic<size_t> failed{0};
+    parallel_for(pending.size(), options.parallelism, [&](size_t i) {
+        const SceneItemState& state = *pending[i].state;
+        if (pending[i].existing) {
+            if (progress) progress("sources", done.fetch_add(1, std::memory_order_relaxed) + 1, pending.size());
+            return;
+        }
+        pending[i].source = obs_source_create(state.id.c_str(), state.name.c_str(), state.settings.get(), nullptr);
+        if (!pending[i].source) {
+            failed.fetch_add(1, std::memory_order_relaxed);
+            blog(LOG_WARNING, "Failed to create source '%s' (%s)", state.name.c_str(), state.id.c_str());
+        } else if (options.on_source_created) {
+            options.on_source_created(pending[i].source);
+        }
+        if (progress) progress("sources", done.fetch_add(1, std::memory_order_relaxed) + 1, pending.size());
+    });
+    size_t reused = std::count_if(pending.begin(), pending.end(), [](const PendingSource& source) {
+        return source.existing;
+    });
+    local_stats.sources = pending.size() - reused - failed.load();
+    local_stats.failed_sources = failed.load();
+
+    std::atomic<size_t> items{0};
+    std::atomic<size_t> filled{0};
+    size_t scene_count = independent.size() + nesting.size();
+    auto fill_scene = [&](size_t scene_index) {
+        obs_scene_t* scene = created_scenes[scene_index];
+        for (auto const& item : scenes[scene_index].items) {
+            auto nested = scene_sources.find(item.name);
+            obs_source_t* source = nested != scene_sources.end() ? nested->second
+                                                                 : pending[pending_index.at(item.name)].source;
+            if (!source) continue;
+            obs_sceneitem_t* scene_item = obs_scene_add(scene, source);
+            if (!scene_item) continue;
+            apply_item_state(scene_item, item);
+            items.fetch_add(1, std::memory_order_relaxed);
+        }
+        if (progress) progress("items", filled.fetch_add(1, std::memory_order_relaxed) + 1, scene_count);
+    };
+    parallel_for(independent.size(), options.parallelism, [&](size_t i) { fill_scene(independent[i]); });
+    for (size_t scene_index : nesting) fill_scene(scene_index);
+    local_stats.items = items.load();
+
+    for (auto& source : pending) obs_source_release(source.source);
+
+    std::vector<obs_source_t*> result;
+    result.reserve(created_scenes.size());
+    for (obs_scene_t* scene : created_scenes) {
+        // The scene's own (or the lookup's) reference is handed over as the
+        // source reference.
+        if (scene) result.push_back(obs_scene_get_source(scene));
+    }
+
+    local_stats.duration_ns = os_gettime_ns() - start;
+    if (stats) *stats = local_stats;
+    return result;
+}
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <obs.h>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+struct ObsDataDeleter {
+    void operator()(obs_data_t* data) const { obs_data_release(data); }
+};
+using ObsDataPtr = std::unique_ptr<obs_data_t, ObsDataDeleter>;
+
+struct SceneItemState {
+    std::string name;
+    std::string id;
+    ObsDataPtr settings;
+    float pos_x = 0.0f, pos_y = 0.0f;
+    float rot = 0.0f;
+    float scale_x = 1.0f, scale_y = 1.0f;
+    int crop_top = 0, crop_bottom = 0, crop_left = 0, crop_right = 0;
+};
+
+struct SceneState {
+    std::string name;
+    std::vector<SceneItemState> items;
+};
+
+// Deep enough copy for snapshots: settings are shared by reference.
+SceneState CopySceneState(const SceneState& scene);
+
+struct SceneLoadOptions {
+    // Worker threads used to create sources; 1 creates them on the calling
+    // thread.
+    unsigned parallelism = 1;
+    // Called from the worker threads for every source that was created.
+    std::function<void(obs_source_t*)> on_source_created;
+};
+
+struct SceneLoadStats {
+    size_t scenes = 0;
+    size_t sources = 0;
+    size_t items = 0;
+    size_t failed_sources = 0;
+    uint64_t duration_ns = 0;
+};
+
+// (phase, done, total); may be called from several threads at once.
+using SceneProgressFn = std::function<void(const char* phase, size_t done, size_t total)>;
+
+// Plain snapshot of the scene collection, independent of Napi, so capturing
+// and loading can run on a worker thread. Settings are kept as obs_data.
+class SceneCollection {
+public:
+    std::vector<SceneState> scenes;
+    // Scenes on program and in preview when captured; empty when unknown.
+    std::string program_scene;
+    std::string preview_scene;
+
+    // Snapshots every scene in libobs; safe from any thread.
+    void Capture(const SceneProgressFn& progress);
+    // Snapshots only the named scenes, skipping names that no longer exist.
+    void CaptureScenes(const std::vector<std::string>& names);
+
+    // Creates the scenes and their sources. Sources used by several scenes
+    // are created once, and scenes, sources and items naming a source (or
+    // scene) that already exists in libobs reuse it as it is, so a
+    // collection can be loaded in parts or loaded again. Sources are created
+    // in parallel and every new scene is then filled by a single thread, as
+    // scenes do not share state while they are being built. Returns a new
+    // reference to every scene, created or reused, in order.
+    std::vector<obs_source_t*> Load(const SceneLoadOptions& options, const SceneProgressFn& progress,
+                                    SceneLoadStats* stats) const;
+};
+
+// Number of worker threads to use when the caller did not say.
+unsigned DefaultSceneLoadParallelism();
@@ -0,0 +1,610 @@
+#include "scene-json.h"
+
+#include <cerrno>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+
+// --- Writing ---
+
+namespace {
+
+class JsonWriter {
+public:
+    explicit JsonWriter(std::string& out) : out_(out) {}
+
+    void BeginObject() { Separate(); out_ += '{'; first_ = true; }
+    void EndObject() { out_ += '}'; first_ = false; }
+    void BeginArray() { Separate(); out_ += '['; first_ = true; }
+    void EndArray() { out_ += ']'; first_ = false; }
+
+    void Key(const char* key) {
+        Separate();
+        WriteString(key);
+        out_ += ':';
+        after_key_ = true;
+    }
+
+    void String(const char* value) { Separate(); WriteString(value ? value : ""); }
+    void Bool(bool value) { Separate(); out_ += value ? "true" : "false"; }
+    void Int(long long value) { Separate(); Append("%lld", value); }
+
+    // Written like jansson does: enough digits to round-trip, and always
+    // with a fraction or exponent so it reads back as a double.
+    void Double(double value) {
+        Separate();
+        if (!std::isfinite(value)) {
+            out_ += "null";
+            return;
+        }
+        size_t start = out_.size();
+        Append("%.17g", value);
+        if (out_.find_first_of(".eE", start) == std::string::npos) out_ += ".0";
+    }
+
+    // Shortest text that round-trips a float.
+    void Float(float value) {
+        Separate();
+        if (!std::isfinite(value)) {
+            out_ += "0";
+            return;
+        }
+        Append("%.9g", (double)value);
+    }
+
+private:
+    void Separate() {
+        if (after_key_) {
+            after_key_ = false;
+        } else if (!first_) {
+            out_ += ',';
+        }
+        first_ = false;
+    }
+
+    template <typename T>
+    void Append(const char* format, T value) {
+        char buffer[32];
+        int length = snprintf(buffer, sizeof(buffer), format, value);
+        if (length > 0) out_.append(buffer, (size_t)length);
+    }
+
+    void WriteString(const char* value) {
+        out_ += '"';
+        const char* run = value;
+        for (const char* p = value; *p; p++) {
+            unsigned char c = (unsigned char)*p;
+            if (c >= 0x20 && c != '"' && c != '\\') continue;
+            out_.append(run, p - run);
+            run = p + 1;
+            switch (c) {
+                case '"': out_ += "\\\""; break;
+                case '\\': out_ += "\\\\"; break;
+                case '\n': out_ += "\\n"; break;
+                case '\r': out_ += "\\r"; break;
+                case '\t': out_ += "\\t"; break;
+                case '\b': out_ += "\\b"; break;
+                case '\f': out_ += "\\f"; break;
+                default: Append("\\u%04x", (unsigned)c); break;
+            }
+        }
+        out_ += run;
+        out_ += '"';
+    }
+
+    std::string& out_;
+    bool first_ = true;
+    bool after_key_ = false;
+};
+
+} // namespace
+
+static void write_obs_data(JsonWriter& writer, obs_data_t* data);
+
+static void write_obs_array(JsonWriter& writer, obs_data_array_t* array) {
+    writer.BeginArray();
+    size_t count = obs_data_array_count(array);
+    for (size_t i = 0; i < count; i++) {
+        obs_data_t* item = obs_data_array_item(array, i);
+        write_obs_data(writer, item);
+        obs_data_release(item);
+    }
+    writer.EndArray();
+}
+
+static void write_obs_data(JsonWriter& writer, obs_data_t* data) {
+    writer.BeginObject();
+    if (!data) {
+        writer.EndObject();
+        return;
+    }
+    for (obs_data_item_t* item = obs_data_first(data); item; obs_data_item_next(&item)) {
+        // Like obs_data_get_json, defaults are not part of the document.
+        if (!obs_data_item_has_user_value(item)) continue;
+        const char* key = obs_data_item_get_name(item);
+        switch (obs_data_item_gettype(item)) {
+            case OBS_DATA_STRING:
+                writer.Key(key);
+                writer.String(obs_data_item_get_string(item));
+                break;
+            case OBS_DATA_NUMBER:
+                writer.Key(key);
+                if (obs_data_item_numtype(item) == OBS_DATA_NUM_DOUBLE) {
+                    writer.Double(obs_data_item_get_double(item));
+                } else {
+                    writer.Int(obs_data_item_get_int(item));
+                }
+                break;
+            case OBS_DATA_BOOLEAN:
+                writer.Key(key);
+                writer.Bool(obs_data_item_get_bool(item));
+                break;
+            case OBS_DATA_OBJECT: {
+                obs_data_t* obj = obs_data_item_get_obj(item);
+                writer.Key(key);
+                write_obs_data(writer, obj);
+                obs_data_release(obj);
+                break;
+            }
+            case OBS_DATA_ARRAY: {
+                obs_data_array_t* array = obs_data_item_get_array(item);
+                writer.Key(key);
+                if (array) {
+                    write_obs_array(writer, array);
+                } else {
+                    writer.BeginArray();
+                    writer.EndArray();
+                }
+                obs_data_array_release(array);
+                break;
+            }
+            case OBS_DATA_NULL:
+                break;
+        }
+    }
+    writer.EndObject();
+}
+
+static void write_scenes(JsonWriter& writer, const SceneCollection& collection) {
+    if (!collection.program_scene.empty()) {
+        writer.Key("program");
+        writer.String(collection.program_scene.c_str());
+    }
+    if (!collection.preview_scene.empty()) {
+        writer.Key("preview");
+        writer.String(collection.preview_scene.c_str());
+    }
+    writer.Key("scenes");
+    writer.BeginArray();
+    for (auto const& scene : collection.scenes) {
+        writer.BeginObject();
+        writer.Key("name");
+        writer.String(scene.name.c_str());
+        writer.Key("sources");
+        writer.BeginArray();
+        for (auto const& item : scene.items) {
+            writer.BeginObject();
+            writer.Key("name");
+            writer.String(item.name.c_str());
+            writer.Key("id");
+            writer.String(item.id.c_str());
+            writer.Key("settings");
+            write_obs_data(writer, item.settings.get());
+            writer.Key("transform");
+            writer.BeginObject();
+            writer.Key("posX"); writer.Float(item.pos_x);
+            writer.Key("posY"); writer.Float(item.pos_y);
+            writer.Key("rot"); writer.Float(item.rot);
+            writer.Key("scaleX"); writer.Float(item.scale_x);
+            writer.Key("scaleY"); writer.Float(item.scale_y);
+            writer.Key("cropTop"); writer.Int(item.crop_top);
+            writer.Key("cropBottom"); writer.Int(item.crop_bottom);
+            writer.Key("cropLeft"); writer.Int(item.crop_left);
+            writer.Key("cropRight"); writer.Int(item.crop_right);
+            writer.EndObject();
+            writer.EndObject();
+        }
+        writer.EndArray();
+        writer.EndObject();
+    }
+    writer.EndArray();
+}
+
+static void write_names(JsonWriter& writer, const char* key, const std::vector<std::string>& names) {
+    writer.Key(key);
+    writer.BeginArray();
+    for (auto const& name : names) writer.String(name.c_str());
+    writer.EndArray();
+}
+
+std::string SerializeSceneCollection(const SceneCollection& collection) {
+    std::string out;
+    out.reserve(4096);
+    JsonWriter writer(out);
+    writer.BeginObject();
+    write_scenes(writer, collection);
+    writer.EndObject();
+    return out;
+}
+
+std::string SerializeSceneDelta(const SceneDelta& delta, const SceneCollection& collection) {
+    std::string out;
+    out.reserve(1024);
+    JsonWriter writer(out);
+    writer.BeginObject();
+    writer.Key("version");
+    writer.Int((long long)delta.version);
+    writer.Key("full");
+    writer.Bool(delta.full);
+    write_scenes(writer, collection);
+    write_names(writer, "removed", delta.removed);
+    write_names(writer, "order", delta.order);
+    writer.EndObject();
+    return out;
+}
+
+// --- Parsing ---
+
+namespace {
+
+// Recursive descent parser that hands values straight to obs_data or the
+// scene state; nothing is materialized as a generic tree.
+class JsonReader {
+public:
+    JsonReader(const char* json, size_t length) : p_(json), end_(json + length), start_(json) {}
+
+    bool ok() const { return error_.empty(); }
+    const std::string& error() const { return error_; }
+
+    void ParseCollection(SceneCollection* collection) {
+        ParseObject([&](const std::string& key) {
+            if (key == "scenes" && Peek() == '[') {
+                ParseArray([&] {
+                    collection->scenes.emplace_back();
+                    ParseScene(collection->scenes.back());
+                });
+            } else if (key == "program" && Peek() == '"') {
+                ParseString(collection->program_scene);
+            } else if (key == "preview" && Peek() == '"') {
+                ParseString(collection->preview_scene);
+            } else {
+                SkipValue();
+            }
+        });
+        SkipSpace();
+        if (ok() && p_ != end_) Fail("Unexpected data after the document");
+    }
+
+private:
+    static constexpr int kMaxDepth = 512;
+
+    void ParseScene(SceneState& scene) {
+        ParseObject([&](const std::string& key) {
+            if (key == "name") {
+                ParseString(scene.name);
+            } else if (key == "sources" && Peek() == '[') {
+                ParseArray([&] {
+                    scene.items.emplace_back();
+                    ParseItem(scene.items.back());
+                });
+            } else {
+                SkipValue();
+            }
+        });
+    }
+
+    void ParseItem(SceneItemState& item) {
+        ParseObject([&](const std::string& key) {
+            if (key == "name") {
+                ParseString(item.name);
+            } else if (key == "id") {
+                ParseString(item.id);
+            } else if (key == "settings" && Peek() == '{') {
+                item.settings.reset(obs_data_create());
+                ParseObsData(item.settings.get());
+            } else if (key == "transform" && Peek() == '{') {
+                ParseTransform(item);
+            } else {
+                SkipValue();
+            }
+        });
+    }
+
+    void ParseTransform(SceneItemState& item) {
+        ParseObject([&](const std::string& key) {
+            struct FloatField { const char* key; float* value; };
+            struct IntField { const char* key; int* value; };
+            const FloatField floats[] = {
+                {"posX", &item.pos_x}, {"posY", &item.pos_y}, {"rot", &item.rot},
+                {"scaleX", &item.scale_x}, {"scaleY", &item.scale_y},
+            };
+            const IntField ints[] = {
+                {"cropTop", &item.crop_top}, {"cropBottom", &item.crop_bottom},
+                {"cropLeft", &item.crop_left}, {"cropRight", &item.crop_right},
+            };
+            for (auto const& field : floats) {
+                if (key == field.key && IsNumberStart()) {
+                    *field.value = (float)ParseNumber().real;
+                    return;
+                }
+            }
+            for (auto const& field : ints) {
+                if (key == field.key && IsNumberStart()) {
+                    *field.value = (int)ParseNumber().real;
+                    return;
+                }
+            }
+            SkipValue();
+        });
+    }
+
+    void ParseObsData(obs_data_t* data) {
+        ParseObject([&](const std::string& key) {
+            char c = Peek();
+            if (c == '"') {
+                ParseString(string_);
+                obs_data_set_string(data, key.c_str(), string_.c_str());
+            } else if (IsNumberStart()) {
+                Number number = ParseNumber();
+                if (number.is_int) {
+                    obs_data_set_int(data, key.c_str(), number.integer);
+                } else {
+                    obs_data_set_double(data, key.c_str(), number.real);
+                }
+            } else if (c == 't' || c == 'f') {
+                obs_data_set_bool(data, key.c_str(), ParseLiteral());
+            } else if (c == '{') {
+                obs_data_t* obj = obs_data_create();
+                ParseObsData(obj);
+                obs_data_set_obj(data, key.c_str(), obj);
+                obs_data_release(obj);
+            } else if (c == '[') {
+                obs_data_array_t* array = obs_data_array_create();
+                ParseArray([&] {
+                    // obs_data arrays only hold objects.
+                    if (Peek() != '{') {
+                        SkipValue();
+                        return;
+                    }
+                    obs_data_t* obj = obs_data_create();
+                    ParseObsData(obj);
+                    obs_data_array_push_back(array, obj);
+                    obs_data_release(obj);
+                });
+                obs_data_set_array(data, key.c_str(), array);
+                obs_data_array_release(array);
+            } else {
+                SkipValue(); // null
+            }
+        });
+    }
+
+    // --- Primitives ---
+
+    void Fail(const char* message) {
+        if (error_.empty()) {
+            error_ = message;
+            error_ += " at offset " + std::to_string(offset());
+        }
+        p_ = end_;
+    }
+
+    size_t offset() const { return (size_t)(p_ - start_); }
+
+    void SkipSpace() {
+        while (p_ < end_ && (*p_ == ' ' || *p_ == '\n' || *p_ == '\r' || *p_ == '\t')) p_++;
+    }
+
+    char Peek() {
+        SkipSpace();
+        return p_ < end_ ? *p_ : '\0';
+    }
+
+    bool Consume(char c) {
+        if (Peek() != c) return false;
+        p_++;
+        return true;
+    }
+
+    bool IsNumberStart() {
+        char c = Peek();
+        return c == '-' || (c >= '0' && c <= '9');
+    }
+
+    template <typename OnMember>
+    void ParseObject(OnMember on_member) {
+        if (!Consume('{')) return Fail("Expected an object");
+        if (++depth_ > kMaxDepth) return Fail("Document is nested too deeply");
+        std::string key;
+        if (!Consume('}')) {
+            do {
+                if (Peek() != '"') return Fail("Expected a key");
+                ParseString(key);
+                if (!Consume(':')) return Fail("Expected ':'");
+                on_member(key);
+                if (!ok()) return;
+            } while (Consume(','));
+            if (!Consume('}')) return Fail("Expected ',' or '}'");
+        }
+        depth_--;
+    }
+
+    template <typename OnElement>
+    void ParseArray(OnElement on_element) {
+        if (!Consume('[')) return Fail("Expected an array");
+        if (++depth_ > kMaxDepth) return Fail("Document is nested too deeply");
+        if (!Consume(']')) {
+            do {
+                on_element();
+                if (!ok()) return;
+            } while (Consume(','));
+            if (!Consume(']')) return Fail("Expected ',' or ']'");
+        }
+        depth_--;
+    }
+
+    void AppendUtf8(std::string& out, uint32_t cp) {
+        if (cp < 0x80) {
+            out += (char)cp;
+        } else if (cp < 0x800) {
+            out += (char)(0xC0 | (cp >> 6));
+            out += (char)(0x80 | (cp & 0x3F));
+        } else if (cp < 0x10000) {
+            out += (char)(0xE0 | (cp >> 12));
+            out += (char)(0x80 | ((cp >> 6) & 0x3F));
+            out += (char)(0x80 | (cp & 0x3F));
+        } else {
+            out += (char)(0xF0 | (cp >> 18));
+            out += (char)(0x80 | ((cp >> 12) & 0x3F));
+            out += (char)(0x80 | ((cp >> 6) & 0x3F));
+            out += (char)(0x80 | (cp & 0x3F));
+        }
+    }
+
+    bool ParseHex4(uint32_t* value) {
+        if (end_ - p_ < 4) return false;
+        *value = 0;
+        for (int i = 0; i < 4; i++) {
+            char c = *p_++;
+            *value <<= 4;
+            if (c >= '0' && c <= '9') *value |= (uint32_t)(c - '0');
+            else if (c >= 'a' && c <= 'f') *value |= (uint32_t)(c - 'a' + 10);
+            else if (c >= 'A' && c <= 'F') *value |= (uint32_t)(c - 'A' + 10);
+            else return false;
+        }
+        return true;
+    }
+
+    void ParseString(std::string& out) {
+        out.clear();
+        if (!Consume('"')) return Fail("Expected a string");
+        const char* run = p_;
+        while (p_ < end_) {
+            char c = *p_;
+            if (c == '"') {
+                out.append(run, p_ - run);
+                p_++;
+                return;
+            }
+            if ((unsigned char)c < 0x20) return Fail("Control character in string");
+            if (c != '\\') {
+                p_++;
+                continue;
+            }
+            out.append(run, p_ - run);
+            if (++p_ == end_) break;
+            char escape = *p_++;
+            switch (escape) {
+                case '"': out += '"'; break;
+                case '\\': out += '\\'; break;
+                case '/': out += '/'; break;
+                case 'b': out += '\b'; break;
+                case 'f': out += '\f'; break;
+                case 'n': out += '\n'; break;
+                case 'r': out += '\r'; break;
+                case 't': out += '\t'; break;
+                case 'u': {
+                    uint32_t cp;
+                    if (!ParseHex4(&cp)) return Fail("Invalid \\u escape");
+                    if (cp >= 0xD800 && cp < 0xDC00) {
+                        uint32_t low;
+                        if (end_ - p_ < 6 || p_[0] != '\\' || p_[1] != 'u') return Fail("Unpaired surrogate");
+                        p_ += 2;
+                        if (!ParseHex4(&low) || low < 0xDC00 || low > 0xDFFF) return Fail("Unpaired surrogate");
+                        cp = 0x10000 + ((cp - 0xD800) << 10) + (low - 0xDC00);
+                    }
+                    AppendUtf8(out, cp);
+                    break;
+                }
+                default:
+                    return Fail("Invalid escape");
+            }
+            run = p_;
+        }
+        Fail("Unterminated string");
+    }
+
+    struct Number {
+        bool is_int = true;
+        long long integer = 0;
+        double real = 0.0;
+    };
+
+    Number ParseNumber() {
+        Number number;
+        SkipSpace();
+        const char* start = p_;
+        if (p_ < end_ && *p_ == '-') p_++;
+        while (p_ < end_ && ((*p_ >= '0' && *p_ <= '9') || *p_ == '.' || *p_ == 'e' || *p_ == 'E' ||
+                             *p_ == '+' || *p_ == '-')) {
+            if (*p_ == '.' || *p_ == 'e' || *p_ == 'E') number.is_int = false;
+            p_++;
+        }
+        // strtod/strtoll need a terminator; numbers are short.
+        std::string text(start, p_ - start);
+        char* parse_end = nullptr;
+        if (number.is_int) {
+            errno = 0;
+            number.integer = std::strtoll(text.c_str(), &parse_end, 10);
+            // Out of int64 range: keep it as a double, like jansson does.
+            if (errno == ERANGE) number.is_int = false;
+            number.real = (double)number.integer;
+        }
+        if (!number.is_int) number.real = std::strtod(text.c_str(), &parse_end);
+        if (text.empty() || !parse_end || *parse_end) Fail("Invalid number");
+        return number;
+    }
+
+    bool ParseLiteral() {
+        static const char kTrue[] = "true";
+        static const char kFalse[] = "false";
+        static const char kNull[] = "null";
+        SkipSpace();
+        for (const char* literal : {kTrue, kFalse, kNull}) {
+            size_t length = std::char_traits<char>::length(literal);
+            if ((size_t)(end_ - p_) >= length && std::char_traits<char>::compare(p_, literal, length) == 0) {
+                p_ += length;
+                return literal == kTrue;
+            }
+        }
+        Fail("Invalid literal");
+        return false;
+    }
+
+    void SkipValue() {
+        char c = Peek();
+        if (c == '{') {
+            ParseObject([&](const std::string&) { SkipValue(); });
+        } else if (c == '[') {
+            ParseArray([&] { SkipValue(); });
+        } else if (c == '"') {
+            ParseString(string_);
+        } else if (IsNumberStart()) {
+            ParseNumber();
+        } else {
+            ParseLiteral();
+        }
+    }
+
+    const char* p_;
+    const char* const end_;
+    const char* const start_;
+    int depth_ = 0;
+    std::string error_;
+    std::string string_; // Scratch buffer for string values
+};
+
+} // namespace
+
+bool ParseSceneCollection(const char* json, size_t length, SceneCollection* collection, std::string* error) {
+    *collection = SceneCollection();
+    JsonReader reader(json, length);
+    reader.ParseCollection(collection);
+    if (!reader.ok()) {
+        collection->scenes.clear();
+        if (error) *error = reader.error();
+        return false;
+    }
+    return true;
+}
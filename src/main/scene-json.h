@@ -0,0 +1,27 @@
+#pragma once
+
+#include "scene-collection.h"
+#include "scene-tracker.h"
+
+#include <cstddef>
+#include <string>
+
+// Direct JSON text <-> SceneCollection conversion, without building JS
+// objects in between. Settings are written from obs_data the way
+// obs_data_get_json does it (user values only, ints and doubles kept apart,
+// nested objects and arrays included) and parsed straight back into
+// obs_data. The document has the same shape as getFullSceneData():
+// { program, preview, scenes: [{ name, sources: [{ name, id, settings,
+// transform }] }] }.
+// Napi-free, so it can run on worker threads.
+
+std::string SerializeSceneCollection(const SceneCollection& collection);
+
+// { version, full, scenes, removed, order }, matching getSceneDelta().
+// `collection` holds the captured delta.changed scenes.
+std::string SerializeSceneDelta(const SceneDelta& delta, const SceneCollection& collection);
+
+// Fills `collection` from a document written by either function above (or
+// by JSON.stringify of the same shape). Returns false and sets `error` on
+// malformed input.
+bool ParseSceneCollection(const char* json, size_t length, SceneCollection* collection, std::string* error);
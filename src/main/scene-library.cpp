@@ -0,0 +1,257 @@
+#include "scene-library.h"
+
+#include <algorithm>
+#include <deque>
+#include <unordered_set>
+#include <util/platform.h>
+
+SceneLibrary::~SceneLibrary() {
+    StopBackground();
+}
+
+SceneLoadStats SceneLibrary::Load(SceneCollection&& collection, const std::vector<std::string>& eager,
+                                  const SceneLoadOptions& options, const SceneProgressFn& progress) {
+    StopBackground();
+    std::lock_guard<std::mutex> load_lock(load_mutex_);
+    std::vector<std::string> names = eager;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        options_ = options;
+        pending_.clear();
+        order_.clear();
+        stats_ = SceneLibraryStats();
+        for (auto& scene : collection.scenes) {
+            order_.push_back(scene.name);
+            pending_.emplace(scene.name, std::move(scene));
+        }
+        if (names.empty()) names = order_;
+    }
+    collection.scenes.clear();
+
+    SceneLoadStats stats = Materialize(names, options, progress);
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    stats_.eager_scenes = stats.scenes;
+    stats_.eager_ns = stats.duration_ns;
+    return stats;
+}
+
+SceneLoadStats SceneLibrary::Materialize(const std::vector<std::string>& names, const SceneLoadOptions& options,
+                                         const SceneProgressFn& progress) {
+    SceneCollection subset;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        std::deque<std::string> queue(names.begin(), names.end());
+        while (!queue.empty()) {
+            auto it = pending_.find(queue.front());
+            queue.pop_front();
+            if (it == pending_.end()) continue;
+            for (auto const& item : it->second.items) {
+                if (pending_.count(item.name)) queue.push_back(item.name);
+            }
+            materializing_.emplace(it->first, CopySceneState(it->second));
+            subset.scenes.push_back(std::move(it->second));
+            pending_.erase(it);
+        }
+        // Keep the collection's order among the scenes created together.
+        auto position = [&](const std::string& name) {
+            return std::find(order_.begin(), order_.end(), name) - order_.begin();
+        };
+        std::sort(subset.scenes.begin(), subset.scenes.end(), [&](const SceneState& a, const SceneState& b) {
+            return position(a.name) < position(b.name);
+        });
+    }
+    if (subset.scenes.empty()) return SceneLoadStats();
+
+    SceneLoadStats stats;
+    std::vector<obs_source_t*> created = subset.Load(options, progress, &stats);
+
+    // Scenes that already existed come back too, e.g. on a reload; the
+    // library keeps one reference per scene.
+    std::vector<obs_source_t*> duplicates;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        std::unordered_set<obs_source_t*> owned(owned_.begin(), owned_.end());
+        for (obs_source_t* scene : created) {
+            if (owned.insert(scene).second) {
+                owned_.push_back(scene);
+            } else {
+                duplicates.push_back(scene);
+            }
+        }
+        materializing_.clear();
+    }
+    for (obs_source_t* scene : duplicates) obs_source_release(scene);
+    return stats;
+}
+
+void SceneLibrary::StartBackground() {
+    if (background_.joinable()) return;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (pending_.empty()) return;
+        stats_.background_running = true;
+        background_start_ns_ = os_gettime_ns();
+    }
+    stopping_ = false;
+    background_ = std::thread(&SceneLibrary::BackgroundLoop, this);
+}
+
+void SceneLibrary::StopBackground() {
+    if (!background_.joinable()) return;
+    stopping_ = true;
+    background_.join();
+    std::lock_guard<std::mutex> lock(mutex_);
+    stats_.background_running = false;
+}
+
+void SceneLibrary::BackgroundLoop() {
+    while (!stopping_) {
+        std::string next;
+        SceneLoadOptions options;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            for (auto const& name : order_) {
+                if (pending_.count(name)) {
+                    next = name;
+                    break;
+                }
+            }
+            if (next.empty()) {
+                stats_.background_ns = os_gettime_ns() - background_start_ns_;
+                stats_.background_running = false;
+                return;
+            }
+            options = options_;
+        }
+
+        // One scene at a time, so an on-demand Acquire() waits for at most
+        // one scene.
+        std::lock_guard<std::mutex> load_lock(load_mutex_);
+        SceneLoadStats stats = Materialize({next}, options, nullptr);
+        std::lock_guard<std::mutex> lock(mutex_);
+        stats_.background_scenes += stats.scenes;
+    }
+}
+
+obs_source_t* SceneLibrary::Acquire(const std::string& name) {
+    if (IsPending(name)) {
+        std::lock_guard<std::mutex> load_lock(load_mutex_);
+        SceneLoadOptions options;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            options = options_;
+        }
+        SceneLoadStats stats = Materialize({name}, options, nullptr);
+        std::lock_guard<std::mutex> lock(mutex_);
+        stats_.on_demand_scenes += stats.scenes;
+    }
+
+    obs_source_t* source = obs_get_source_by_name(name.c_str());
+    if (source && !obs_source_is_scene(source)) {
+        obs_source_release(source);
+        return nullptr;
+    }
+    return source;
+}
+
+void SceneLibrary::Adopt(obs_source_t* scene) {
+    if (!scene) return;
+    std::string name = obs_source_get_name(scene);
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (std::find(owned_.begin(), owned_.end(), scene) == owned_.end()) owned_.push_back(obs_source_get_ref(scene));
+    if (std::find(order_.begin(), order_.end(), name) == order_.end()) order_.push_back(name);
+}
+
+bool SceneLibrary::IsPending(const std::string& name) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return pending_.count(name) > 0;
+}
+
+std::vector<std::string> SceneLibrary::Order(const std::vector<std::string>& live) const {
+    std::unordered_set<std::string> live_set(live.begin(), live.end());
+    std::vector<std::string> order;
+    order.reserve(live.size());
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::unordered_set<std::string> known(order_.begin(), order_.end());
+    for (auto const& name : order_) {
+        if (live_set.count(name) || pending_.count(name) || materializing_.count(name)) order.push_back(name);
+    }
+    for (auto const& name : live) {
+        if (!known.count(name)) order.push_back(name);
+    }
+    return order;
+}
+
+void SceneLibrary::Complete(SceneCollection* collection) const {
+    // Every scene is pending, being created or in libobs. Scenes being
+    // created are taken from their descriptors: the caller's capture may
+    // have caught them half filled.
+    std::unordered_set<std::string> captured;
+    for (auto const& scene : collection->scenes) captured.insert(scene.name);
+
+    std::vector<SceneState> descriptors;
+    std::unordered_set<std::string> in_flight;
+    std::vector<std::string> created_since;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (auto const& name : order_) {
+            auto it = pending_.find(name);
+            auto creating = materializing_.find(name);
+            if (it != pending_.end()) {
+                descriptors.push_back(CopySceneState(it->second));
+            } else if (creating != materializing_.end()) {
+                descriptors.push_back(CopySceneState(creating->second));
+                in_flight.insert(name);
+            } else if (!captured.count(name)) {
+                created_since.push_back(name);
+            }
+        }
+    }
+    if (!in_flight.empty()) {
+        auto& scenes = collection->scenes;
+        scenes.erase(std::remove_if(scenes.begin(), scenes.end(),
+                                    [&](const SceneState& scene) { return in_flight.count(scene.name) > 0; }),
+                     scenes.end());
+    }
+    for (auto& scene : descriptors) collection->scenes.push_back(std::move(scene));
+    // Scenes the background created after the caller's capture.
+    if (!created_since.empty()) {
+        SceneCollection late;
+        late.CaptureScenes(created_since);
+        for (auto& scene : late.scenes) collection->scenes.push_back(std::move(scene));
+    }
+
+    std::vector<std::string> live;
+    live.reserve(collection->scenes.size());
+    for (auto const& scene : collection->scenes) live.push_back(scene.name);
+    std::vector<std::string> order = Order(live);
+    auto position = [&](const std::string& name) {
+        return std::find(order.begin(), order.end(), name) - order.begin();
+    };
+    std::stable_sort(collection->scenes.begin(), collection->scenes.end(),
+                     [&](const SceneState& a, const SceneState& b) { return position(a.name) < position(b.name); });
+}
+
+SceneLibraryStats SceneLibrary::stats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    SceneLibraryStats stats = stats_;
+    stats.pending_scenes = pending_.size();
+    if (stats.background_running) stats.background_ns = 0;
+    return stats;
+}
+
+void SceneLibrary::Clear() {
+    StopBackground();
+    std::lock_guard<std::mutex> load_lock(load_mutex_);
+    std::vector<obs_source_t*> owned;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        owned.swap(owned_);
+        pending_.clear();
+        materializing_.clear();
+        order_.clear();
+        stats_ = SceneLibraryStats();
+    }
+    for (obs_source_t* scene : owned) obs_source_release(scene);
+}
@@ -0,0 +1,94 @@
+#pragma once
+
+#include "scene-collection.h"
+
+#include <obs.h>
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+struct SceneLibraryStats {
+    size_t eager_scenes = 0;        // Created by Load()
+    size_t background_scenes = 0;   // Created by the background thread
+    size_t on_demand_scenes = 0;    // Created by Acquire() before the background got to them
+    size_t pending_scenes = 0;      // Still descriptors
+    uint64_t eager_ns = 0;
+    uint64_t background_ns = 0;     // Until the last pending scene was created; 0 while running
+    bool background_running = false;
+};
+
+// Owns the scenes of the loaded collection. Scenes that are not needed
+// right away stay as plain SceneState descriptors and are created later,
+// either by a background thread in collection order or on first use through
+// Acquire(), so startup cost does not grow with the collection. A scene is
+// always created together with the pending scenes it nests. Also keeps a
+// reference to every scene it created, so scenes that are neither on
+// program nor in preview stay alive.
+class SceneLibrary {
+public:
+    SceneLibrary() = default;
+    ~SceneLibrary();
+
+    SceneLibrary(const SceneLibrary&) = delete;
+    SceneLibrary& operator=(const SceneLibrary&) = delete;
+
+    // Replaces the pending descriptors with `collection`'s scenes and
+    // creates the `eager` ones (and what they nest) now. An empty `eager`
+    // creates everything.
+    SceneLoadStats Load(SceneCollection&& collection, const std::vector<std::string>& eager,
+                        const SceneLoadOptions& options, const SceneProgressFn& progress);
+    // Creates the remaining descriptors on a background thread, with the
+    // options of the last Load().
+    void StartBackground();
+    void StopBackground();
+
+    // New reference to the scene, creating it first if it is still pending;
+    // nullptr if there is no such scene.
+    obs_source_t* Acquire(const std::string& name);
+    // Keeps a reference to a scene created elsewhere.
+    void Adopt(obs_source_t* scene);
+    bool IsPending(const std::string& name) const;
+
+    // Scene names in collection order: the loaded order first, then scenes
+    // in `live` it does not know about. Pending scenes are included; loaded
+    // ones missing from `live` are not.
+    std::vector<std::string> Order(const std::vector<std::string>& live) const;
+    // Adds copies of the pending descriptors to a captured collection and
+    // sorts its scenes into collection order, so snapshots are complete.
+    // Never waits for scene creation, so it is cheap on the JS thread.
+    void Complete(SceneCollection* collection) const;
+
+    SceneLibraryStats stats() const;
+
+    // Stops the background thread and releases every scene. Call before
+    // obs_shutdown.
+    void Clear();
+
+private:
+    // Moves `names` and the pending scenes they nest out of pending_ and
+    // creates them. Requires load_mutex_.
+    SceneLoadStats Materialize(const std::vector<std::string>& names, const SceneLoadOptions& options,
+                               const SceneProgressFn& progress);
+    void BackgroundLoop();
+
+    // Serializes scene creation; held for the whole of a Materialize call.
+    mutable std::mutex load_mutex_;
+    // Guards the containers below; never held across libobs calls.
+    mutable std::mutex mutex_;
+    std::unordered_map<std::string, SceneState> pending_;
+    // Copies of the descriptors taken out of pending_ and being created
+    // right now; libobs may hold only part of those scenes.
+    std::unordered_map<std::string, SceneState> materializing_;
+    std::vector<std::string> order_;
+    SceneLoadOptions options_;
+    std::vector<obs_source_t*> owned_; // One reference per scene
+    SceneLibraryStats stats_;
+    uint64_t background_start_ns_ = 0;
+
+    std::thread background_;
+    std::atomic<bool> stopping_{false};
+};
@@ -0,0 +1,278 @@
+#include "scene-thumbnails.h"
+#include "profiler.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+// Stands in for the layout hash while the atlas has no tiles.
+static const uint64_t kEmptyLayoutHash = 1;
+
+void SceneThumbnails::Configure(const SceneThumbnailsConfig& config) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    config_ = config;
+}
+
+SceneThumbnailsConfig SceneThumbnails::config() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return config_;
+}
+
+bool SceneThumbnails::LayoutFor(uint64_t sequence, ThumbnailLayout* layout) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (auto it = layouts_.rbegin(); it != layouts_.rend(); ++it) {
+        if (it->sequence <= sequence) {
+            *layout = *it;
+            return true;
+        }
+    }
+    return false;
+}
+
+SceneThumbnailsStats SceneThumbnails::GetStats() const {
+    SceneThumbnailsStats stats;
+    stats.refreshes = refreshes_.load(std::memory_order_relaxed);
+    stats.published = published_.load(std::memory_order_relaxed);
+    stats.dropped = dropped_.load(std::memory_order_relaxed);
+    stats.scenes = scenes_.load(std::memory_order_relaxed);
+    stats.width = width_.load(std::memory_order_relaxed);
+    stats.height = height_.load(std::memory_order_relaxed);
+    return stats;
+}
+
+void SceneThumbnails::Destroy() {
+    SetShowing({});
+    staged_ = false;
+    if (stage_) gs_stagesurface_destroy(stage_);
+    stage_ = nullptr;
+    stage_width_ = stage_height_ = 0;
+    gs_texrender_destroy(texrender_);
+    texrender_ = nullptr;
+    next_due_ns_ = 0;
+}
+
+// Scenes that leave the atlas stop showing; new ones start. Takes over the
+// references in `sources`, which may name a scene more than once (it then
+// has several tiles) but is showing'd once.
+void SceneThumbnails::SetShowing(std::vector<obs_source_t*> sources) {
+    std::sort(sources.begin(), sources.end());
+    size_t kept = 0;
+    for (size_t i = 0; i < sources.size(); i++) {
+        if (kept && sources[kept - 1] == sources[i]) {
+            obs_source_release(sources[i]);
+        } else {
+            sources[kept++] = sources[i];
+        }
+    }
+    sources.resize(kept);
+
+    for (obs_source_t* source : sources) {
+        if (std::find(showing_.begin(), showing_.end(), source) == showing_.end()) obs_source_inc_showing(source);
+    }
+    for (obs_source_t* source : showing_) {
+        if (std::find(sources.begin(), sources.end(), source) == sources.end()) obs_source_dec_showing(source);
+        obs_source_release(source);
+    }
+    showing_ = std::move(sources);
+}
+
+void SceneThumbnails::ResolveScenes(const std::vector<std::string>& names, std::vector<obs_source_t*>* sources,
+                                    ThumbnailLayout* layout) {
+    if (names.empty()) {
+        obs_enum_scenes(
+            [](void* param, obs_source_t* source) {
+                auto* list = static_cast<std::vector<obs_source_t*>*>(param);
+                obs_source_t* ref = obs_source_get_ref(source);
+                if (ref) list->push_back(ref);
+                return true;
+            },
+            sources);
+        for (obs_source_t* source : *sources) {
+            ThumbnailTile tile;
+            tile.scene = obs_source_get_name(source);
+            tile.rendered = true;
+            layout->tiles.push_back(std::move(tile));
+        }
+        return;
+    }
+
+    // Tiles for names that don't resolve stay blank so positions are stable.
+    for (const std::string& name : names) {
+        ThumbnailTile tile;
+        tile.scene = name;
+        obs_source_t* source = obs_get_source_by_name(name.c_str());
+        if (source && obs_scene_from_source(source)) {
+            tile.rendered = true;
+            sources->push_back(source);
+        } else {
+            obs_source_release(source);
+            sources->push_back(nullptr);
+        }
+        layout->tiles.push_back(std::move(tile));
+    }
+}
+
+// The atlas staged on the previous refresh has had at least one output
+// frame to land; map it now.
+void SceneThumbnails::PublishStaged(uint64_t now) {
+    staged_ = false;
+    uint64_t layout_hash = 0;
+    {
+        std::string key = std::to_string(staged_layout_.tile_width) + "x" + std::to_string(staged_layout_.tile_height) +
+                          "/" + std::to_string(staged_layout_.columns);
+        for (const ThumbnailTile& tile : staged_layout_.tiles) key += "|" + tile.scene + (tile.rendered ? "" : "?");
+        layout_hash = HashPixels((const uint8_t*)key.data(), key.size());
+    }
+
+    uint8_t* data = nullptr;
+    uint32_t linesize = 0;
+    if (!gs_stagesurface_map(stage_, &data, &linesize)) {
+        dropped_.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    uint32_t row_bytes = stage_width_ * 4;
+    FrameSlab* slab = frames_.BeginWrite((size_t)row_bytes * stage_height_);
+    if (!slab) {
+        gs_stagesurface_unmap(stage_);
+        dropped_.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    {
+        TITAN_PROFILE_SCOPE("render.thumbnails_copy");
+        for (uint32_t y = 0; y < stage_height_; y++) {
+            memcpy(slab->data + (size_t)y * row_bytes, data + (size_t)y * linesize, row_bytes);
+        }
+    }
+    gs_stagesurface_unmap(stage_);
+    slab->width = stage_width_;
+    slab->height = stage_height_;
+    slab->stride = row_bytes;
+    slab->format = FrameFormat::RGBA;
+
+    // Recorded first so a reader never sees a frame without its layout;
+    // the publish below takes the next sequence number.
+    if (layout_hash != last_layout_hash_) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        staged_layout_.sequence = frames_.latest_sequence() + 1;
+        layouts_.push_back(staged_layout_);
+        if (layouts_.size() > kMaxLayouts) layouts_.pop_front();
+        last_layout_hash_ = layout_hash;
+    }
+    if (frames_.Publish(now, HashPixels(slab->data, slab->size) ^ layout_hash)) {
+        published_.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+void SceneThumbnails::Render(uint32_t base_width, uint32_t base_height, uint64_t now) {
+    if (staged_) PublishStaged(now);
+
+    bool enabled;
+    double fps;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        enabled = config_.enabled;
+        fps = config_.fps;
+    }
+    if (!enabled) {
+        if (!showing_.empty()) SetShowing({});
+        next_due_ns_ = 0;
+        return;
+    }
+
+    // Same fixed grid as the views, without catching up after a stall.
+    uint64_t interval = (uint64_t)(1e9 / std::max(fps, 0.01));
+    uint64_t slack = obs_get_frame_interval_ns() / 2;
+    if (now + slack < next_due_ns_) return;
+    next_due_ns_ = next_due_ns_ + interval + slack <= now ? now + interval : next_due_ns_ + interval;
+
+    TITAN_PROFILE_SCOPE("render.thumbnails");
+    refreshes_.fetch_add(1, std::memory_order_relaxed);
+    SceneThumbnailsConfig config = this->config();
+
+    ThumbnailLayout layout;
+    std::vector<obs_source_t*> sources;
+    ResolveScenes(config.scenes, &sources, &layout);
+    std::vector<obs_source_t*> showing;
+    for (obs_source_t* source : sources) {
+        if (source) showing.push_back(obs_source_get_ref(source));
+    }
+    SetShowing(std::move(showing));
+
+    uint32_t count = (uint32_t)layout.tiles.size();
+    scenes_.store(count, std::memory_order_relaxed);
+    if (count == 0) {
+        for (obs_source_t* source : sources) obs_source_release(source);
+        if (last_layout_hash_ != kEmptyLayoutHash) {
+            std::lock_guard<std::mutex> lock(mutex_);
+            layout.sequence = frames_.latest_sequence() + 1;
+            layouts_.push_back(layout);
+            if (layouts_.size() > kMaxLayouts) layouts_.pop_front();
+            last_layout_hash_ = kEmptyLayoutHash;
+        }
+        frames_.PublishEmpty(now);
+        width_.store(0, std::memory_order_relaxed);
+        height_.store(0, std::memory_order_relaxed);
+        return;
+    }
+
+    uint32_t columns = config.columns ? std::min(config.columns, count)
+                                      : (uint32_t)std::ceil(std::sqrt((double)count));
+    uint32_t rows = (count + columns - 1) / columns;
+    uint32_t tile_width = std::min(config.tile_width, kMaxAtlasSize / columns);
+    uint32_t tile_height = (uint32_t)((uint64_t)tile_width * base_height / base_width);
+    if (tile_height * rows > kMaxAtlasSize) {
+        tile_height = kMaxAtlasSize / rows;
+        tile_width = (uint32_t)((uint64_t)tile_height * base_width / base_height);
+    }
+    tile_width = std::max(tile_width & ~1u, 2u);
+    tile_height = std::max(tile_height & ~1u, 2u);
+    uint32_t width = columns * tile_width;
+    uint32_t height = rows * tile_height;
+    layout.tile_width = tile_width;
+    layout.tile_height = tile_height;
+    layout.columns = columns;
+    layout.rows = rows;
+    for (uint32_t i = 0; i < count; i++) {
+        layout.tiles[i].x = (i % columns) * tile_width;
+        layout.tiles[i].y = (i / columns) * tile_height;
+    }
+
+    if (!texrender_) texrender_ = gs_texrender_create(GS_RGBA, GS_ZS_NONE);
+    gs_texrender_reset(texrender_);
+    if (!gs_texrender_begin(texrender_, width, height)) {
+        for (obs_source_t* source : sources) obs_source_release(source);
+        return;
+    }
+    struct vec4 clear_color;
+    vec4_zero(&clear_color);
+    gs_clear(GS_CLEAR_COLOR, &clear_color, 0.0f, 0);
+    gs_viewport_push();
+    gs_projection_push();
+    for (uint32_t i = 0; i < count; i++) {
+        if (!sources[i]) continue;
+        gs_set_viewport((int)layout.tiles[i].x, (int)layout.tiles[i].y, (int)tile_width, (int)tile_height);
+        gs_ortho(0.0f, (float)base_width, 0.0f, (float)base_height, -100.0f, 100.0f);
+        obs_source_video_render(sources[i]);
+    }
+    gs_projection_pop();
+    gs_viewport_pop();
+    gs_texrender_end(texrender_);
+    for (obs_source_t* source : sources) obs_source_release(source);
+
+    if (width != stage_width_ || height != stage_height_) {
+        if (stage_) gs_stagesurface_destroy(stage_);
+        stage_ = gs_stagesurface_create(width, height, GS_RGBA);
+        stage_width_ = stage_ ? width : 0;
+        stage_height_ = stage_ ? height : 0;
+    }
+    gs_texture_t* texture = gs_texrender_get_texture(texrender_);
+    if (!stage_ || !texture) {
+        dropped_.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    gs_stage_texture(stage_, texture);
+    staged_ = true;
+    staged_layout_ = std::move(layout);
+    width_.store(width, std::memory_order_relaxed);
+    height_.store(height, std::memory_order_relaxed);
+}
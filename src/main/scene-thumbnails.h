@@ -0,0 +1,114 @@
+#pragma once
+
+#include "frame-exchange.h"
+
+#include <obs.h>
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <vector>
+
+struct SceneThumbnailsConfig {
+    bool enabled = false;
+    double fps = 2.0;              // Atlas refreshes per second
+    uint32_t tile_width = 320;     // Tile height follows the canvas aspect
+    uint32_t columns = 0;          // 0: as square a grid as fits
+    std::vector<std::string> scenes;  // Empty: every scene, in libobs' order
+};
+
+struct ThumbnailTile {
+    std::string scene;
+    uint32_t x = 0;
+    uint32_t y = 0;
+    bool rendered = false;         // False if no scene by that name exists
+};
+
+// Where each scene sits in one published atlas.
+struct ThumbnailLayout {
+    uint64_t sequence = 0;         // First atlas frame with this layout
+    uint32_t tile_width = 0;
+    uint32_t tile_height = 0;
+    uint32_t columns = 0;
+    uint32_t rows = 0;
+    std::vector<ThumbnailTile> tiles;
+};
+
+struct SceneThumbnailsStats {
+    uint64_t refreshes = 0;        // Atlas renders
+    uint64_t published = 0;        // Refreshes whose pixels changed
+    uint64_t dropped = 0;          // No free slab, or the map failed
+    uint32_t scenes = 0;           // Tiles in the last refresh
+    uint32_t width = 0;
+    uint32_t height = 0;
+};
+
+// Live thumbnails of many scenes from one render pass: at a low rate each
+// scene is drawn into its own tile of a single atlas texture, which is then
+// staged once and mapped on the next output frame (by then the GPU has
+// long finished the copy), so the cost is one texrender and one readback
+// however many scenes there are. Atlases are published RGBA through a
+// FrameExchange; each published frame has a layout mapping tiles to scenes.
+//
+// While enabled, the scenes in the atlas are marked as showing so their
+// sources keep producing frames, as they would in a projector.
+class SceneThumbnails {
+public:
+    // Atlas dimensions are capped to this; tiles shrink to fit.
+    static constexpr uint32_t kMaxAtlasSize = 4096;
+
+    SceneThumbnails() = default;
+    ~SceneThumbnails() = default;
+
+    SceneThumbnails(const SceneThumbnails&) = delete;
+    SceneThumbnails& operator=(const SceneThumbnails&) = delete;
+
+    // Safe from any thread; applies from the next refresh.
+    void Configure(const SceneThumbnailsConfig& config);
+    SceneThumbnailsConfig config() const;
+
+    // Graphics thread, once per output frame from the main render callback.
+    // `base_width` x `base_height` is the canvas the scenes are drawn in.
+    void Render(uint32_t base_width, uint32_t base_height, uint64_t now);
+    // Releases the scenes and GPU resources; requires the graphics context.
+    void Destroy();
+
+    FrameExchange& frames() { return frames_; }
+    // Layout of the atlas frame with `sequence`; false if it is too old.
+    bool LayoutFor(uint64_t sequence, ThumbnailLayout* layout) const;
+    SceneThumbnailsStats GetStats() const;
+
+private:
+    // Layouts kept for frames JS may still be reading.
+    static constexpr size_t kMaxLayouts = FrameExchange::kMaxSlabs;
+
+    void PublishStaged(uint64_t now);
+    void ResolveScenes(const std::vector<std::string>& names, std::vector<obs_source_t*>* sources,
+                       ThumbnailLayout* layout);
+    void SetShowing(std::vector<obs_source_t*> sources);
+
+    FrameExchange frames_;
+
+    // Graphics thread only.
+    gs_texrender_t* texrender_ = nullptr;
+    gs_stagesurf_t* stage_ = nullptr;
+    uint32_t stage_width_ = 0;
+    uint32_t stage_height_ = 0;
+    bool staged_ = false;          // stage_ holds a refresh not published yet
+    ThumbnailLayout staged_layout_;
+    uint64_t last_layout_hash_ = 0;
+    uint64_t next_due_ns_ = 0;
+    std::vector<obs_source_t*> showing_;  // Strong refs, each inc_showing'd once
+
+    mutable std::mutex mutex_;
+    SceneThumbnailsConfig config_;
+    std::deque<ThumbnailLayout> layouts_;  // Oldest first
+
+    std::atomic<uint64_t> refreshes_{0};
+    std::atomic<uint64_t> published_{0};
+    std::atomic<uint64_t> dropped_{0};
+    std::atomic<uint32_t> scenes_{0};
+    std::atomic<uint32_t> width_{0};
+    std::atomic<uint32_t> height_{0};
+};
@@ -0,0 +1,205 @@
+#include "scene-tracker.h"
+
+#include <algorithm>
+#include <unordered_set>
+
+static const char* const kSceneSignals[] = {
+    "item_add", "item_remove", "reorder", "item_transform", "item_visible", "refresh",
+};
+
+void SceneChangeTracker::Connect() {
+    if (connected_) return;
+    signal_handler_t* handler = obs_get_signal_handler();
+    signal_handler_connect(handler, "source_create", OnSourceCreate, this);
+    signal_handler_connect(handler, "source_remove", OnSourceRemove, this);
+    signal_handler_connect(handler, "source_destroy", OnSourceRemove, this);
+    signal_handler_connect(handler, "source_rename", OnSourceRename, this);
+    connected_ = true;
+
+    auto connect_source = [](void* param, obs_source_t* source) {
+        static_cast<SceneChangeTracker*>(param)->ConnectSource(source);
+        return true;
+    };
+    obs_enum_sources(connect_source, this);
+    obs_enum_scenes(connect_source, this);
+}
+
+void SceneChangeTracker::Disconnect() {
+    if (!connected_) return;
+    signal_handler_t* handler = obs_get_signal_handler();
+    signal_handler_disconnect(handler, "source_create", OnSourceCreate, this);
+    signal_handler_disconnect(handler, "source_remove", OnSourceRemove, this);
+    signal_handler_disconnect(handler, "source_destroy", OnSourceRemove, this);
+    signal_handler_disconnect(handler, "source_rename", OnSourceRename, this);
+
+    auto disconnect_source = [](void* param, obs_source_t* source) {
+        static_cast<SceneChangeTracker*>(param)->DisconnectSource(source);
+        return true;
+    };
+    obs_enum_sources(disconnect_source, this);
+    obs_enum_scenes(disconnect_source, this);
+    connected_ = false;
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    scene_versions_.clear();
+    removed_scenes_.clear();
+    source_versions_.clear();
+    floor_ = ++version_;
+}
+
+void SceneChangeTracker::ConnectSource(obs_source_t* source) {
+    signal_handler_t* handler = obs_source_get_signal_handler(source);
+    if (!handler) return;
+    if (obs_source_is_scene(source)) {
+        for (const char* signal : kSceneSignals) signal_handler_connect(handler, signal, OnSceneChanged, this);
+    } else {
+        signal_handler_connect(handler, "update", OnSourceUpdate, this);
+    }
+}
+
+void SceneChangeTracker::DisconnectSource(obs_source_t* source) {
+    signal_handler_t* handler = obs_source_get_signal_handler(source);
+    if (!handler) return;
+    if (obs_source_is_scene(source)) {
+        for (const char* signal : kSceneSignals) signal_handler_disconnect(handler, signal, OnSceneChanged, this);
+    } else {
+        signal_handler_disconnect(handler, "update", OnSourceUpdate, this);
+    }
+}
+
+void SceneChangeTracker::MarkSceneLocked(const std::string& name) {
+    scene_versions_[name] = ++version_;
+    removed_scenes_.erase(name);
+}
+
+void SceneChangeTracker::MarkSourceLocked(const std::string& name) {
+    source_versions_[name] = ++version_;
+    TrimLocked();
+}
+
+void SceneChangeTracker::TrimLocked() {
+    if (source_versions_.size() + removed_scenes_.size() <= kMaxTracked) return;
+    source_versions_.clear();
+    removed_scenes_.clear();
+    floor_ = version_;
+}
+
+uint64_t SceneChangeTracker::version() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return version_;
+}
+
+SceneDelta SceneChangeTracker::Collect(uint64_t since) const {
+    SceneDelta delta;
+    std::unordered_set<std::string> changed;
+    std::vector<std::string> dirty_sources;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        delta.version = version_;
+        delta.full = since == 0 || since < floor_;
+        if (!delta.full) {
+            for (auto const& [name, version] : scene_versions_) {
+                if (version > since) changed.insert(name);
+            }
+            for (auto const& [name, version] : removed_scenes_) {
+                if (version > since) delta.removed.push_back(name);
+            }
+            for (auto const& [name, version] : source_versions_) {
+                if (version > since) dirty_sources.push_back(name);
+            }
+        }
+    }
+
+    // libobs calls are made without holding the lock; a change racing with
+    // this walk has a version above delta.version and is reported again by
+    // the next call.
+    std::vector<obs_source_t*> scenes;
+    obs_enum_scenes([](void* param, obs_source_t* source) {
+        static_cast<std::vector<obs_source_t*>*>(param)->push_back(obs_source_get_ref(source));
+        return true;
+    }, &scenes);
+
+    for (obs_source_t* source : scenes) {
+        if (!source) continue;
+        std::string name = obs_source_get_name(source);
+        bool dirty = delta.full || changed.count(name) > 0;
+        for (size_t i = 0; !dirty && i < dirty_sources.size(); i++) {
+            dirty = obs_scene_find_source(obs_scene_from_source(source), dirty_sources[i].c_str()) != nullptr;
+        }
+        if (dirty) delta.changed.push_back(name);
+        delta.order.push_back(std::move(name));
+        obs_source_release(source);
+    }
+
+    // A scene removed and re-created under the same name is a change, not a
+    // removal.
+    delta.removed.erase(std::remove_if(delta.removed.begin(), delta.removed.end(), [&](const std::string& name) {
+        return std::find(delta.order.begin(), delta.order.end(), name) != delta.order.end();
+    }), delta.removed.end());
+    return delta;
+}
+
+// Signal handlers run on whichever thread made the change.
+
+void SceneChangeTracker::OnSourceCreate(void* data, calldata_t* cd) {
+    auto* tracker = static_cast<SceneChangeTracker*>(data);
+    obs_source_t* source = static_cast<obs_source_t*>(calldata_ptr(cd, "source"));
+    if (!source) return;
+    tracker->ConnectSource(source);
+    if (obs_source_is_scene(source)) {
+        std::lock_guard<std::mutex> lock(tracker->mutex_);
+        tracker->MarkSceneLocked(obs_source_get_name(source));
+    }
+}
+
+void SceneChangeTracker::OnSourceRemove(void* data, calldata_t* cd) {
+    auto* tracker = static_cast<SceneChangeTracker*>(data);
+    obs_source_t* source = static_cast<obs_source_t*>(calldata_ptr(cd, "source"));
+    if (!source || !obs_source_is_scene(source)) return;
+    const char* name = obs_source_get_name(source);
+    if (!name) return;
+
+    std::lock_guard<std::mutex> lock(tracker->mutex_);
+    tracker->scene_versions_.erase(name);
+    tracker->removed_scenes_[name] = ++tracker->version_;
+    tracker->TrimLocked();
+}
+
+void SceneChangeTracker::OnSourceRename(void* data, calldata_t* cd) {
+    auto* tracker = static_cast<SceneChangeTracker*>(data);
+    obs_source_t* source = static_cast<obs_source_t*>(calldata_ptr(cd, "source"));
+    const char* new_name = calldata_string(cd, "new_name");
+    const char* prev_name = calldata_string(cd, "prev_name");
+    if (!source || !new_name) return;
+
+    std::lock_guard<std::mutex> lock(tracker->mutex_);
+    if (obs_source_is_scene(source)) {
+        if (prev_name) {
+            tracker->scene_versions_.erase(prev_name);
+            tracker->removed_scenes_[prev_name] = ++tracker->version_;
+        }
+        tracker->MarkSceneLocked(new_name);
+    }
+    // Scenes holding the source (or the renamed scene) store it by name.
+    tracker->MarkSourceLocked(new_name);
+}
+
+void SceneChangeTracker::OnSourceUpdate(void* data, calldata_t* cd) {
+    auto* tracker = static_cast<SceneChangeTracker*>(data);
+    obs_source_t* source = static_cast<obs_source_t*>(calldata_ptr(cd, "source"));
+    const char* name = source ? obs_source_get_name(source) : nullptr;
+    if (!name || !*name) return;
+
+    std::lock_guard<std::mutex> lock(tracker->mutex_);
+    tracker->MarkSourceLocked(name);
+}
+
+void SceneChangeTracker::OnSceneChanged(void* data, calldata_t* cd) {
+    auto* tracker = static_cast<SceneChangeTracker*>(data);
+    obs_scene_t* scene = static_cast<obs_scene_t*>(calldata_ptr(cd, "scene"));
+    const char* name = scene ? obs_source_get_name(obs_scene_get_source(scene)) : nullptr;
+    if (!name) return;
+
+    std::lock_guard<std::mutex> lock(tracker->mutex_);
+    tracker->MarkSceneLocked(name);
+}
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <obs.h>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Scenes that changed since a given version, as reported by SceneChangeTracker.
+struct SceneDelta {
+    uint64_t version = 0;
+    // The caller's version is too old (or 0): `changed` lists every scene.
+    bool full = false;
+    std::vector<std::string> changed;
+    std::vector<std::string> removed;
+    // Names of every scene, in libobs' order.
+    std::vector<std::string> order;
+};
+
+// Follows libobs signals to know which scenes need to be persisted again.
+// Every scene item add/remove/reorder/transform/visibility change and every
+// settings update or rename of a source bumps a monotonically increasing
+// version; Collect(since) then names only the scenes touched after `since`,
+// so a save serializes the changed scenes instead of the whole collection.
+// Versions only count within one run.
+class SceneChangeTracker {
+public:
+    SceneChangeTracker() = default;
+    ~SceneChangeTracker() = default;
+
+    SceneChangeTracker(const SceneChangeTracker&) = delete;
+    SceneChangeTracker& operator=(const SceneChangeTracker&) = delete;
+
+    // Hooks up the global and per-source signals. Call after obs_startup.
+    void Connect();
+    // Call before obs_shutdown.
+    void Disconnect();
+
+    uint64_t version() const;
+    SceneDelta Collect(uint64_t since) const;
+
+private:
+    // Dirty sources and removed scenes are remembered individually up to
+    // this many entries; past it they are dropped and callers older than
+    // the drop get a full delta.
+    static constexpr size_t kMaxTracked = 4096;
+
+    static void OnSourceCreate(void* data, calldata_t* cd);
+    static void OnSourceRemove(void* data, calldata_t* cd);
+    static void OnSourceRename(void* data, calldata_t* cd);
+    static void OnSourceUpdate(void* data, calldata_t* cd);
+    static void OnSceneChanged(void* data, calldata_t* cd);
+
+    void ConnectSource(obs_source_t* source);
+    void DisconnectSource(obs_source_t* source);
+    void MarkSceneLocked(const std::string& name);
+    void MarkSourceLocked(const std::string& name);
+    void TrimLocked();
+
+    mutable std::mutex mutex_;
+    uint64_t version_ = 1;
+    // Oldest version a delta can still be computed from.
+    uint64_t floor_ = 1;
+    std::unordered_map<std::string, uint64_t> scene_versions_;
+    std::unordered_map<std::string, uint64_t> removed_scenes_;
+    // Inputs whose settings or name changed; the scenes using them are
+    // resolved when collecting.
+    std::unordered_map<std::string, uint64_t> source_versions_;
+    bool connected_ = false;
+};
@@ -0,0 +1,173 @@
+#include "source-registry.h"
+
+#include <algorithm>
+#include <mutex>
+
+SourceRegistry::~SourceRegistry() {
+    Clear();
+}
+
+void SourceRegistry::Connect() {
+    if (connected_) return;
+    signal_handler_t* handler = obs_get_signal_handler();
+    signal_handler_connect(handler, "source_create", OnSourceCreate, this);
+    signal_handler_connect(handler, "source_destroy", OnSourceDestroy, this);
+    signal_handler_connect(handler, "source_rename", OnSourceRename, this);
+    connected_ = true;
+
+    auto register_source = [](void* param, obs_source_t* source) {
+        static_cast<SourceRegistry*>(param)->Register(source);
+        return true;
+    };
+    obs_enum_sources(register_source, this);
+    obs_enum_scenes(register_source, this);
+}
+
+void SourceRegistry::Disconnect() {
+    if (!connected_) return;
+    signal_handler_t* handler = obs_get_signal_handler();
+    signal_handler_disconnect(handler, "source_create", OnSourceCreate, this);
+    signal_handler_disconnect(handler, "source_destroy", OnSourceDestroy, this);
+    signal_handler_disconnect(handler, "source_rename", OnSourceRename, this);
+    connected_ = false;
+    Clear();
+}
+
+void SourceRegistry::Clear() {
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    for (auto& [handle, entry] : by_handle_) {
+        obs_weak_source_release(entry.weak);
+    }
+    by_handle_.clear();
+    by_name_.clear();
+    by_source_.clear();
+}
+
+SourceRegistry::Handle SourceRegistry::AddLocked(obs_source_t* source) {
+    auto existing = by_source_.find(source);
+    if (existing != by_source_.end()) return existing->second;
+
+    const char* name = obs_source_get_name(source);
+    Handle handle = next_handle_++;
+    Entry entry{obs_source_get_weak_source(source), source, name ? name : ""};
+    // Names are unique among public sources only. A private source may
+    // share a public one's name (or have none), so it is only reachable by
+    // handle and never shadows the public source in name lookups.
+    if (!entry.name.empty() && !obs_obj_is_private(source)) by_name_[entry.name] = handle;
+    by_source_[source] = handle;
+    by_handle_.emplace(handle, std::move(entry));
+    return handle;
+}
+
+void SourceRegistry::RemoveLocked(obs_source_t* source) {
+    auto it = by_source_.find(source);
+    if (it == by_source_.end()) return;
+
+    auto entry = by_handle_.find(it->second);
+    if (entry != by_handle_.end()) {
+        auto name = by_name_.find(entry->second.name);
+        if (name != by_name_.end() && name->second == it->second) by_name_.erase(name);
+        obs_weak_source_release(entry->second.weak);
+        by_handle_.erase(entry);
+    }
+    by_source_.erase(it);
+}
+
+SourceRegistry::Handle SourceRegistry::Register(obs_source_t* source) {
+    if (!source) return kInvalidHandle;
+    {
+        std::shared_lock<std::shared_mutex> lock(mutex_);
+        auto it = by_source_.find(source);
+        if (it != by_source_.end()) return it->second;
+    }
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    return AddLocked(source);
+}
+
+SourceRegistry::Handle SourceRegistry::Find(const std::string& name) const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    auto it = by_name_.find(name);
+    return it != by_name_.end() ? it->second : kInvalidHandle;
+}
+
+SourceRegistry::Handle SourceRegistry::HandleOf(obs_source_t* source) const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    auto it = by_source_.find(source);
+    return it != by_source_.end() ? it->second : kInvalidHandle;
+}
+
+std::string SourceRegistry::NameOf(Handle handle) const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    auto it = by_handle_.find(handle);
+    return it != by_handle_.end() ? it->second.name : std::string();
+}
+
+std::vector<std::pair<SourceRegistry::Handle, std::string>> SourceRegistry::Entries() const {
+    std::vector<std::pair<Handle, std::string>> entries;
+    {
+        std::shared_lock<std::shared_mutex> lock(mutex_);
+        entries.reserve(by_handle_.size());
+        for (auto const& [handle, entry] : by_handle_) {
+            entries.emplace_back(handle, entry.name);
+        }
+    }
+    std::sort(entries.begin(), entries.end());
+    return entries;
+}
+
+obs_source_t* SourceRegistry::Acquire(Handle handle) const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    auto it = by_handle_.find(handle);
+    // Upgrading a weak reference is a single atomic on the source's refcount.
+    return it != by_handle_.end() ? obs_weak_source_get_source(it->second.weak) : nullptr;
+}
+
+obs_source_t* SourceRegistry::AcquireByName(const std::string& name) const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    auto handle = by_name_.find(name);
+    if (handle == by_name_.end()) return nullptr;
+    auto it = by_handle_.find(handle->second);
+    return it != by_handle_.end() ? obs_weak_source_get_source(it->second.weak) : nullptr;
+}
+
+// Signal handlers run on whichever thread created, destroyed or renamed the
+// source.
+
+void SourceRegistry::OnSourceCreate(void* data, calldata_t* cd) {
+    auto* registry = static_cast<SourceRegistry*>(data);
+    obs_source_t* source = static_cast<obs_source_t*>(calldata_ptr(cd, "source"));
+    if (!source) return;
+    std::unique_lock<std::shared_mutex> lock(registry->mutex_);
+    registry->AddLocked(source);
+}
+
+void SourceRegistry::OnSourceDestroy(void* data, calldata_t* cd) {
+    auto* registry = static_cast<SourceRegistry*>(data);
+    obs_source_t* source = static_cast<obs_source_t*>(calldata_ptr(cd, "source"));
+    if (!source) return;
+    std::unique_lock<std::shared_mutex> lock(registry->mutex_);
+    registry->RemoveLocked(source);
+}
+
+void SourceRegistry::OnSourceRename(void* data, calldata_t* cd) {
+    auto* registry = static_cast<SourceRegistry*>(data);
+    obs_source_t* source = static_cast<obs_source_t*>(calldata_ptr(cd, "source"));
+    const char* new_name = calldata_string(cd, "new_name");
+    if (!source || !new_name) return;
+
+    std::unique_lock<std::shared_mutex> lock(registry->mutex_);
+    auto it = registry->by_source_.find(source);
+    if (it == registry->by_source_.end()) {
+        registry->AddLocked(source);
+        return;
+    }
+    Entry& entry = registry->by_handle_.at(it->second);
+    if (obs_obj_is_private(source)) {
+        entry.name = new_name;
+        return;
+    }
+    auto old_name = registry->by_name_.find(entry.name);
+    if (old_name != registry->by_name_.end() && old_name->second == it->second) registry->by_name_.erase(old_name);
+    entry.name = new_name;
+    registry->by_name_[entry.name] = it->second;
+}
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <obs.h>
+#include <cstdint>
+#include <shared_mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Stable numeric handles for libobs sources. The registry follows libobs'
+// global source_create / source_destroy / source_rename signals and keeps a
+// weak reference plus a name index per source, so resolving a handle or a
+// name never walks libobs' source list or takes its lock. Handles are never
+// reused; a handle whose source is gone simply stops resolving.
+class SourceRegistry {
+public:
+    using Handle = uint32_t;
+    static constexpr Handle kInvalidHandle = 0;
+
+    SourceRegistry() = default;
+    ~SourceRegistry();
+
+    SourceRegistry(const SourceRegistry&) = delete;
+    SourceRegistry& operator=(const SourceRegistry&) = delete;
+
+    // Hooks up the libobs signals and registers sources that already exist.
+    // Call after obs_startup.
+    void Connect();
+    // Call before obs_shutdown.
+    void Disconnect();
+
+    // Handle of the source, registering it if the signals missed it (e.g. a
+    // private source). Returns kInvalidHandle for nullptr.
+    Handle Register(obs_source_t* source);
+    // Public sources only; private ones are reachable by handle alone.
+    Handle Find(const std::string& name) const;
+    Handle HandleOf(obs_source_t* source) const;
+    std::string NameOf(Handle handle) const;
+    // Every registered (handle, name), ordered by handle.
+    std::vector<std::pair<Handle, std::string>> Entries() const;
+
+    // Strong reference to the source, or nullptr if it no longer exists.
+    // Release with obs_source_release.
+    obs_source_t* Acquire(Handle handle) const;
+    obs_source_t* AcquireByName(const std::string& name) const;
+
+private:
+    struct Entry {
+        obs_weak_source_t* weak;
+        obs_source_t* source; // Identity only, never dereferenced
+        std::string name;
+    };
+
+    static void OnSourceCreate(void* data, calldata_t* cd);
+    static void OnSourceDestroy(void* data, calldata_t* cd);
+    static void OnSourceRename(void* data, calldata_t* cd);
+
+    Handle AddLocked(obs_source_t* source);
+    void RemoveLocked(obs_source_t* source);
+    void Clear();
+
+    mutable std::shared_mutex mutex_;
+    std::unordered_map<Handle, Entry> by_handle_;
+    std::unordered_map<std::string, Handle> by_name_;
+    std::unordered_map<obs_source_t*, Handle> by_source_;
+    Handle next_handle_ = 1;
+    bool connected_ = false;
+};
@@ -0,0 +1,212 @@
+// titan_frame_consumer: test consumer for the shared-memory program ring.
+//
+// Opens the ring TitanMedia publishes with startFrameShm(), waits on its
+// futex for each new frame and reads the pixels in place, the way a
+// monitoring or QC tool would. Once a second it prints the frame rate,
+// frames skipped (sequence gaps), torn reads (the publisher lapped the
+// reader mid-frame) and publish-to-read latency. --dump writes the last
+// frame as a PPM to check the picture itself.
+
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <string>
+#include <vector>
+#include "frame-shm-reader.h"
+
+// --- Options ---
+
+struct ConsumerOptions {
+    std::string name = kFrameShmDefaultName;
+    double seconds = 0.0;         // 0: until the publisher stops or Ctrl-C
+    std::string dump_path;
+    bool wait_for_publisher = false;
+};
+
+static void print_usage() {
+    printf("Usage: titan_frame_consumer [options]\n"
+           "  --name NAME     segment name (default %s)\n"
+           "  --seconds N     stop after N seconds (default: run until stopped)\n"
+           "  --dump PATH     write the last frame read as a binary PPM\n"
+           "  --wait          retry until the publisher creates the segment\n",
+           kFrameShmDefaultName);
+}
+
+static bool parse_options(int argc, char** argv, ConsumerOptions* options) {
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        auto value = [&](const char** out) {
+            if (i + 1 >= argc) return false;
+            *out = argv[++i];
+            return true;
+        };
+        const char* v = nullptr;
+        if (arg == "--help" || arg == "-h") {
+            print_usage();
+            exit(0);
+        } else if (arg == "--wait") {
+            options->wait_for_publisher = true;
+        } else if (arg == "--name" && value(&v)) {
+            options->name = v;
+        } else if (arg == "--seconds" && value(&v)) {
+            options->seconds = atof(v);
+            if (options->seconds < 0) return false;
+        } else if (arg == "--dump" && value(&v)) {
+            options->dump_path = v;
+        } else {
+            fprintf(stderr, "Unknown or incomplete option: %s\n", arg.c_str());
+            return false;
+        }
+    }
+    return true;
+}
+
+// --- Helpers ---
+
+static volatile sig_atomic_t g_stop = 0;
+
+static void on_signal(int) {
+    g_stop = 1;
+}
+
+static uint64_t monotonic_ns() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+// Touches every byte, standing in for real processing of the frame.
+static uint64_t checksum(const uint8_t* data, size_t size) {
+    uint64_t sum = 0;
+    size_t words = size / 8;
+    for (size_t i = 0; i < words; i++) {
+        uint64_t word;
+        memcpy(&word, data + i * 8, 8);
+        sum += word;
+    }
+    for (size_t i = words * 8; i < size; i++) sum += data[i];
+    return sum;
+}
+
+static bool write_ppm(const std::string& path, const SharedFrame& frame, const std::vector<uint8_t>& pixels) {
+    FILE* file = fopen(path.c_str(), "wb");
+    if (!file) return false;
+    fprintf(file, "P6\n%u %u\n255\n", frame.width, frame.height);
+    std::vector<uint8_t> row((size_t)frame.width * 3);
+    bool bgra = frame.format == FRAME_SHM_BGRA;
+    for (uint32_t y = 0; y < frame.height; y++) {
+        const uint8_t* src = pixels.data() + (size_t)y * frame.stride;
+        for (uint32_t x = 0; x < frame.width; x++) {
+            row[x * 3 + 0] = src[x * 4 + (bgra ? 2 : 0)];
+            row[x * 3 + 1] = src[x * 4 + 1];
+            row[x * 3 + 2] = src[x * 4 + (bgra ? 0 : 2)];
+        }
+        fwrite(row.data(), 1, row.size(), file);
+    }
+    return fclose(file) == 0;
+}
+
+// --- Main ---
+
+int main(int argc, char** argv) {
+    ConsumerOptions options;
+    if (!parse_options(argc, argv, &options)) {
+        print_usage();
+        return 2;
+    }
+    signal(SIGINT, on_signal);
+    signal(SIGTERM, on_signal);
+
+    FrameShmReader reader;
+    std::string error;
+    while (!reader.Open(options.name, &error)) {
+        if (!options.wait_for_publisher || g_stop) {
+            fprintf(stderr, "%s\n", error.c_str());
+            return 1;
+        }
+        struct timespec delay = {0, 200000000L};
+        nanosleep(&delay, nullptr);
+    }
+    printf("Opened %s: %u slots\n", options.name.c_str(), reader.slot_count());
+
+    uint64_t start = monotonic_ns();
+    uint64_t end = options.seconds > 0 ? start + (uint64_t)(options.seconds * 1e9) : 0;
+    uint64_t last_sequence = reader.latest();
+    uint64_t window_start = start;
+    uint64_t frames = 0, gaps = 0, torn = 0, latency_sum = 0, latency_max = 0;
+    uint64_t total_frames = 0, total_gaps = 0, total_torn = 0;
+    uint64_t sink = 0;
+    SharedFrame dump_frame;
+    std::vector<uint8_t> dump_pixels, scratch;
+
+    while (!g_stop && (!end || monotonic_ns() < end)) {
+        if (!reader.WaitForFrame(last_sequence, 500)) {
+            if (!reader.publisher_alive()) {
+                printf("Publisher stopped\n");
+                break;
+            }
+        } else {
+            SharedFrame frame;
+            if (!reader.Acquire(&frame)) {
+                torn++;
+            } else {
+                sink += checksum(frame.data, frame.size);
+                if (!options.dump_path.empty()) scratch.assign(frame.data, frame.data + frame.size);
+                if (!reader.Validate(frame)) {
+                    torn++;
+                } else {
+                    uint64_t now = monotonic_ns();
+                    uint64_t latency = now > frame.timestamp_ns ? now - frame.timestamp_ns : 0;
+                    if (last_sequence && frame.sequence > last_sequence + 1) {
+                        gaps += frame.sequence - last_sequence - 1;
+                    }
+                    last_sequence = frame.sequence;
+                    latency_sum += latency;
+                    if (latency > latency_max) latency_max = latency;
+                    frames++;
+                    if (!options.dump_path.empty()) {
+                        dump_frame = frame;
+                        dump_pixels.swap(scratch);
+                    }
+                }
+            }
+        }
+
+        uint64_t now = monotonic_ns();
+        if (now - window_start >= 1000000000ULL) {
+            double elapsed = (now - window_start) / 1e9;
+            printf("%6.1f fps  %4llu skipped  %3llu torn  latency avg %.2f ms, max %.2f ms  (seq %llu)\n",
+                   frames / elapsed, (unsigned long long)gaps, (unsigned long long)torn,
+                   frames ? latency_sum / 1e6 / frames : 0.0, latency_max / 1e6, (unsigned long long)last_sequence);
+            fflush(stdout);
+            total_frames += frames;
+            total_gaps += gaps;
+            total_torn += torn;
+            frames = gaps = torn = latency_sum = latency_max = 0;
+            window_start = now;
+        }
+    }
+    total_frames += frames;
+    total_gaps += gaps;
+    total_torn += torn;
+
+    printf("Read %llu frames, skipped %llu, torn %llu in %.1f s (checksum %016llx)\n",
+           (unsigned long long)total_frames, (unsigned long long)total_gaps, (unsigned long long)total_torn,
+           (monotonic_ns() - start) / 1e9, (unsigned long long)sink);
+
+    if (!options.dump_path.empty()) {
+        if (!dump_frame.sequence) {
+            fprintf(stderr, "No frame to dump\n");
+            return 1;
+        }
+        if (!write_ppm(options.dump_path, dump_frame, dump_pixels)) {
+            fprintf(stderr, "Could not write %s\n", options.dump_path.c_str());
+            return 1;
+        }
+        printf("Wrote frame %llu (%ux%u) to %s\n", (unsigned long long)dump_frame.sequence, dump_frame.width,
+               dump_frame.height, options.dump_path.c_str());
+    }
+    return 0;
+}
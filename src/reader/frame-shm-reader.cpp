@@ -0,0 +1,171 @@
+#include "frame-shm-reader.h"
+
+#include <cerrno>
+#include <cstring>
+#include <ctime>
+
+#include <fcntl.h>
+#include <linux/futex.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+FrameShmReader::~FrameShmReader() {
+    Close();
+}
+
+bool FrameShmReader::Open(const std::string& name, std::string* error) {
+    Close();
+    // Read-write only so waiters can be counted; the segment is 0600, so
+    // this is the publisher's user either way.
+    int fd = shm_open(name.c_str(), O_RDWR, 0);
+    if (fd < 0) {
+        if (error) *error = "shm_open(" + name + ") failed: " + strerror(errno);
+        return false;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(FrameShmHeader)) {
+        if (error) *error = "Segment " + name + " is not a frame ring.";
+        close(fd);
+        return false;
+    }
+    void* base = mmap(nullptr, (size_t)st.st_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (base == MAP_FAILED) {
+        if (error) *error = std::string("mmap failed: ") + strerror(errno);
+        return false;
+    }
+
+    auto* header = static_cast<FrameShmHeader*>(base);
+    uint32_t magic = header->magic;
+    std::atomic_thread_fence(std::memory_order_acquire);
+    std::string problem;
+    if (magic != kFrameShmMagic) {
+        problem = "Segment " + name + " is not ready or not a frame ring.";
+    } else if (header->version != kFrameShmVersion) {
+        problem = "Frame ring version " + std::to_string(header->version) + " is not supported (expected " +
+                  std::to_string(kFrameShmVersion) + ").";
+    } else if (header->slot_count == 0 ||
+               header->slots_offset + header->slot_stride * header->slot_count > (uint64_t)st.st_size) {
+        problem = "Segment " + name + " is truncated.";
+    }
+    if (!problem.empty()) {
+        if (error) *error = problem;
+        munmap(base, (size_t)st.st_size);
+        return false;
+    }
+
+    base_ = static_cast<uint8_t*>(base);
+    mapped_size_ = (size_t)st.st_size;
+    header_ = header;
+    return true;
+}
+
+void FrameShmReader::Close() {
+    if (!base_) return;
+    munmap(base_, mapped_size_);
+    base_ = nullptr;
+    header_ = nullptr;
+    mapped_size_ = 0;
+}
+
+const FrameShmSlot* FrameShmReader::SlotFor(uint64_t sequence) const {
+    size_t index = (size_t)(sequence % header_->slot_count);
+    return reinterpret_cast<const FrameShmSlot*>(base_ + header_->slots_offset + index * header_->slot_stride);
+}
+
+bool FrameShmReader::WaitForFrame(uint64_t after, int timeout_ms) {
+    if (!header_) return false;
+    struct timespec deadline;
+    clock_gettime(CLOCK_MONOTONIC, &deadline);
+    if (timeout_ms > 0) {
+        deadline.tv_sec += timeout_ms / 1000;
+        deadline.tv_nsec += (long)(timeout_ms % 1000) * 1000000L;
+        if (deadline.tv_nsec >= 1000000000L) {
+            deadline.tv_sec++;
+            deadline.tv_nsec -= 1000000000L;
+        }
+    }
+
+    for (;;) {
+        // Sample the word before checking, so a frame published in between
+        // changes it and FUTEX_WAIT returns at once.
+        uint32_t word = header_->futex_word.load(std::memory_order_acquire);
+        if (header_->latest.load(std::memory_order_acquire) > after) return true;
+        if (header_->state.load(std::memory_order_acquire) != FRAME_SHM_RUNNING) return false;
+        if (timeout_ms == 0) return false;
+
+        struct timespec remaining = {0, 0};
+        struct timespec* timeout = nullptr;
+        if (timeout_ms > 0) {
+            struct timespec now;
+            clock_gettime(CLOCK_MONOTONIC, &now);
+            int64_t left = (int64_t)(deadline.tv_sec - now.tv_sec) * 1000000000LL + (deadline.tv_nsec - now.tv_nsec);
+            if (left <= 0) return false;
+            remaining.tv_sec = (time_t)(left / 1000000000LL);
+            remaining.tv_nsec = (long)(left % 1000000000LL);
+            timeout = &remaining;
+        }
+
+        // Counted so the publisher can skip the wake syscall while idle; the
+        // seq_cst pair with its futex_word bump means one side always sees
+        // the other.
+        header_->waiters.fetch_add(1, std::memory_order_seq_cst);
+        if (header_->futex_word.load(std::memory_order_seq_cst) == word) {
+            // Not FUTEX_PRIVATE_FLAG: the word is shared across processes.
+            syscall(SYS_futex, reinterpret_cast<uint32_t*>(&header_->futex_word), FUTEX_WAIT, word, timeout,
+                    nullptr, 0);
+        }
+        header_->waiters.fetch_sub(1, std::memory_order_seq_cst);
+        // The publisher's process dying never bumps the word; the timeout
+        // and publisher_alive() cover that.
+        if (!publisher_alive()) return false;
+    }
+}
+
+bool FrameShmReader::Acquire(SharedFrame* frame) const {
+    if (!header_) return false;
+    uint64_t sequence = header_->latest.load(std::memory_order_acquire);
+    if (sequence == 0) return false;
+    const FrameShmSlot* slot = SlotFor(sequence);
+    if (slot->sequence.load(std::memory_order_acquire) != sequence) return false;
+
+    frame->sequence = sequence;
+    frame->timestamp_ns = slot->timestamp_ns;
+    frame->width = slot->width;
+    frame->height = slot->height;
+    frame->stride = slot->stride;
+    frame->format = (FrameShmFormat)slot->format;
+    frame->size = (size_t)slot->size;
+    frame->data = reinterpret_cast<const uint8_t*>(slot) + kFrameShmSlotDataOffset;
+    // The metadata above may already belong to the next frame.
+    if (frame->size > header_->slot_stride - kFrameShmSlotDataOffset) return false;
+    return Validate(*frame);
+}
+
+bool FrameShmReader::Validate(const SharedFrame& frame) const {
+    if (!header_ || frame.sequence == 0) return false;
+    // Orders every read of frame.data before the sequence re-check.
+    std::atomic_thread_fence(std::memory_order_acquire);
+    return SlotFor(frame.sequence)->sequence.load(std::memory_order_relaxed) == frame.sequence;
+}
+
+uint64_t FrameShmReader::latest() const {
+    return header_ ? header_->latest.load(std::memory_order_acquire) : 0;
+}
+
+bool FrameShmReader::publisher_alive() const {
+    if (!header_) return false;
+    if (header_->state.load(std::memory_order_acquire) != FRAME_SHM_RUNNING) return false;
+    return kill((pid_t)header_->publisher_pid, 0) == 0 || errno == EPERM;
+}
+
+uint32_t FrameShmReader::slot_count() const {
+    return header_ ? header_->slot_count : 0;
+}
+
+uint64_t FrameShmReader::frames_published() const {
+    return header_ ? header_->frames_published.load(std::memory_order_relaxed) : 0;
+}
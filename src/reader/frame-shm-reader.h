@@ -0,0 +1,77 @@
+#pragma once
+
+#include "frame-shm-layout.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// One frame in the shared ring. `data` points into the shared mapping; it
+// is only valid until the publisher reuses the slot, which
+// FrameShmReader::Validate() reports.
+struct SharedFrame {
+    uint64_t sequence = 0;
+    uint64_t timestamp_ns = 0;     // CLOCK_MONOTONIC, like os_gettime_ns()
+    uint32_t width = 0;
+    uint32_t height = 0;
+    uint32_t stride = 0;
+    FrameShmFormat format = FRAME_SHM_RGBA;
+    const uint8_t* data = nullptr;
+    size_t size = 0;
+};
+
+// Reads program frames that TitanMedia publishes with startFrameShm().
+// Depends on nothing but POSIX; link the static titan_frame_reader library
+// or drop this file and frame-shm-layout.h into another project.
+//
+//   FrameShmReader reader;
+//   std::string error;
+//   if (!reader.Open(kFrameShmDefaultName, &error)) ...
+//   uint64_t last = 0;
+//   while (reader.WaitForFrame(last, 1000)) {
+//       SharedFrame frame;
+//       if (!reader.Acquire(&frame)) continue;
+//       use(frame.data, frame.size);           // in place, no copy
+//       if (reader.Validate(frame)) last = frame.sequence;  // else: torn, drop
+//   }
+//
+// Any number of readers can have the ring open; they never write to it
+// except to count themselves as waiters.
+class FrameShmReader {
+public:
+    FrameShmReader() = default;
+    ~FrameShmReader();
+
+    FrameShmReader(const FrameShmReader&) = delete;
+    FrameShmReader& operator=(const FrameShmReader&) = delete;
+
+    bool Open(const std::string& name, std::string* error);
+    void Close();
+    bool is_open() const { return header_ != nullptr; }
+
+    // Blocks until a frame newer than `after` is available, up to
+    // `timeout_ms` (-1: no limit). False on timeout or once the publisher
+    // has closed the ring.
+    bool WaitForFrame(uint64_t after, int timeout_ms);
+    // The newest frame, in place. False if there is none yet or the
+    // publisher overwrote it while it was being looked up.
+    bool Acquire(SharedFrame* frame) const;
+    // Whether `frame`'s slot still holds it, i.e. whatever was read from
+    // frame.data since Acquire() is intact.
+    bool Validate(const SharedFrame& frame) const;
+
+    // Sequence of the newest frame, 0 if none.
+    uint64_t latest() const;
+    // False once the publisher stopped or its process is gone.
+    bool publisher_alive() const;
+
+    uint32_t slot_count() const;
+    uint64_t frames_published() const;
+
+private:
+    const FrameShmSlot* SlotFor(uint64_t sequence) const;
+
+    uint8_t* base_ = nullptr;
+    size_t mapped_size_ = 0;
+    FrameShmHeader* header_ = nullptr;
+};
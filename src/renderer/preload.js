@@ -5,15 +5,48 @@ const fs = require('fs');
 const addonPath = path.join(__dirname, '../../build/Release/titan_media_core');
 const core = require(addonPath);
 
+// Output and encoder calls go to the main process, whose core instance
+// renders the program and runs the encoder benchmark. An onProgress
+// callback is forwarded over a channel of its own for the call.
+let nextProgressChannel = 1;
+function invokeWithProgress(channel, args, options) {
+  const { onProgress, ...rest } = options || {};
+  if (typeof onProgress !== 'function') return ipcRenderer.invoke(channel, ...args, rest);
+  const progressChannel = `${channel}-progress-${nextProgressChannel++}`;
+  const listener = (_event, progress) => onProgress(progress);
+  ipcRenderer.on(progressChannel, listener);
+  return ipcRenderer.invoke(channel, ...args, { ...rest, progressChannel })
+    .finally(() => ipcRenderer.removeListener(progressChannel, listener));
+}
+
 contextBridge.exposeInMainWorld('core', {
   // Core lifecycle
   startup: () => core.startup(),
   shutdown: () => core.shutdown(),
   getFullSceneData: () => core.getFullSceneData(),
+  getFullSceneJson: () => core.getFullSceneJson(),
+  getStartupTimings: () => core.getStartupTimings(),
   loadFullSceneData: (data) => core.loadFullSceneData(data),
+  getFullSceneDataAsync: (options) => core.getFullSceneDataAsync(options),
+  loadFullSceneDataAsync: (data, options) => core.loadFullSceneDataAsync(data, options),
 
   // Video Rendering
-  getLatestFrame: () => core.getLatestFrame(),
+  getLatestFrame: (options) => core.getLatestFrame(options),
+  setFrameOptions: (options) => core.setFrameOptions(options),
+  onFrame: (callback, options) => core.onFrame(callback, options),
+  offFrame: (subscriptionId) => core.offFrame(subscriptionId),
+  setReadbackLatency: (frames) => core.setReadbackLatency(frames),
+  getReadbackStats: () => core.getReadbackStats(),
+  setViewActive: (view, active) => core.setViewActive(view, active),
+  setViewFps: (view, fps) => core.setViewFps(view, fps),
+  getViewStats: () => core.getViewStats(),
+  // Live scene thumbnails: one RGBA atlas plus a tile -> scene map
+  setSceneThumbnails: (options) => core.setSceneThumbnails(options),
+  getSceneThumbnails: (options) => core.getSceneThumbnails(options),
+  // Program frames in a shared-memory ring for local tools (src/reader)
+  startFrameShm: (options) => core.startFrameShm(options),
+  stopFrameShm: () => core.stopFrameShm(),
+  getFrameShmStats: () => core.getFrameShmStats(),
 
   // Scene Management
   createScene: (name) => core.createScene(name),
@@ -30,19 +63,71 @@ contextBridge.exposeInMainWorld('core', {
   removeSource: (sceneName, sourceName) => core.removeSource(sceneName, sourceName),
   getSourceProperties: (sourceName) => core.getSourceProperties(sourceName),
   updateSourceProperties: (sourceName, properties) => core.updateSourceProperties(sourceName, properties),
+  getSourcePropertyValues: (sourceName) => core.getSourcePropertyValues(sourceName),
+  getSourceTypeProperties: (sourceId) => core.getSourceTypeProperties(sourceId),
+  invalidatePropertyCache: (sourceName) => core.invalidatePropertyCache(sourceName),
+  getPropertyCacheStats: () => core.getPropertyCacheStats(),
+  // Source arguments above also accept the numeric handles returned here
+  getSourceHandle: (sourceName) => core.getSourceHandle(sourceName),
+  getSourceName: (handle) => core.getSourceName(handle),
+  getSourceHandles: () => core.getSourceHandles(),
+  applyBatch: (ops) => core.applyBatch(ops),
 
   // Audio Management
   setSourceMuted: (sourceName, muted) => core.setSourceMuted(sourceName, muted),
   isSourceMuted: (sourceName) => core.isSourceMuted(sourceName),
   getAudioLevels: () => core.getAudioLevels(),
+  getAudioMeters: () => core.getAudioMeters(),
+  setAudioMeterOptions: (options) => core.setAudioMeterOptions(options),
+  onAudioMeters: (callback, options) => core.onAudioMeters(callback, options),
+  offAudioMeters: (subscriptionId) => core.offAudioMeters(subscriptionId),
+  // EBU R128 loudness; target is a source name/handle or { mix }
+  attachLoudness: (target) => core.attachLoudness(target),
+  detachLoudness: (target) => core.detachLoudness(target),
+  resetLoudness: (target) => core.resetLoudness(target),
+  setLoudnessOptions: (options) => core.setLoudnessOptions(options),
+  getLoudness: () => core.getLoudness(),
+
+  // Output Management (main process; see invokeWithProgress)
+  startStreaming: (server, key) => ipcRenderer.invoke('start-streaming', server, key),
+  stopStreaming: () => ipcRenderer.invoke('stop-streaming'),
+  isStreaming: () => ipcRenderer.invoke('is-streaming'),
+  startRecording: () => ipcRenderer.invoke('start-recording'),
+  stopRecording: () => ipcRenderer.invoke('stop-recording'),
+  isRecording: () => ipcRenderer.invoke('is-recording'),
+  startStreamingAsync: (server, key, options) => invokeWithProgress('start-streaming-async', [server, key], options),
+  startRecordingAsync: (options) => invokeWithProgress('start-recording-async', [], options),
+  // Runs in the main process so the result is saved and reused on the next start
+  benchmarkEncoders: (options) => ipcRenderer.invoke('benchmark-encoders', options),
+  getEncoderConfig: () => ipcRenderer.invoke('get-encoder-config'),
+  setEncoderConfig: (config) => ipcRenderer.invoke('set-encoder-config', config),
+  // Named outputs ('stream', 'record', 'replay', ...), each with its own encoder and size
+  setOutputConfig: (name, config) => ipcRenderer.invoke('set-output-config', name, config),
+  startOutputAsync: (name, options) => invokeWithProgress('start-output-async', [name], options),
+  stopOutput: (name) => ipcRenderer.invoke('stop-output', name),
+  isOutputActive: (name) => ipcRenderer.invoke('is-output-active', name),
+  getOutputs: () => ipcRenderer.invoke('get-outputs'),
+  setOutputThreadBudget: (threads) => ipcRenderer.invoke('set-output-thread-budget', threads),
+
+  // Replay Buffer (main process)
+  startReplayBufferAsync: (options) => invokeWithProgress('start-replay-buffer-async', [], options),
+  stopReplayBuffer: () => ipcRenderer.invoke('stop-replay-buffer'),
+  saveReplay: (path, seconds, options) => invokeWithProgress('save-replay', [path, seconds], options),
+  getReplayBufferStats: () => ipcRenderer.invoke('get-replay-buffer-stats'),
+
+  // Performance Stats
+  getPerfStats: (options) => core.getPerfStats(options),
+  setPerfStatsHistory: (seconds) => core.setPerfStatsHistory(seconds),
+  onPerfStats: (callback) => core.onPerfStats(callback),
+  offPerfStats: (subscriptionId) => core.offPerfStats(subscriptionId),
+  // Adjusts the main process' outputs
+  setAdaptiveBitrate: (config) => ipcRenderer.invoke('set-adaptive-bitrate', config),
+  getAdaptiveBitrate: () => ipcRenderer.invoke('get-adaptive-bitrate'),
 
-  // Output Management
-  startStreaming: (server, key) => core.startStreaming(server, key),
-  stopStreaming: () => core.stopStreaming(),
-  isStreaming: () => core.isStreaming(),
-  startRecording: () => core.startRecording(),
-  stopRecording: () => core.stopRecording(),
-  isRecording: () => core.isRecording(),
+  // Profiling (builds with TITAN_ENABLE_PROFILING)
+  getTimings: () => core.getTimings(),
+  resetTimings: () => core.resetTimings(),
+  captureTrace: (path, options) => core.captureTrace(path, options),
 
   // Overlay Management
   getOverlayTemplates: () => {
@@ -54,7 +54,8 @@ const botAddCommandButton = document.getElementById('bot-add-command-button');
 const botCommandList = document.getElementById('bot-command-list');
 
 
-let animationFrameId;
+let audioMeterSubscription;
+const frameSubscriptions = [];
 let previewScene = '';
 let programScene = '';
 let selectedSource = '';
@@ -317,15 +318,15 @@ sourceMenu.addEventListener('click', async (event) => {
 
 // --- Properties Modal Logic ---
 
-// OBS Property Types Enum (for clarity)
-const OBS_PROPERTY_LIST = 4;
-
 async function openPropertiesModal(sourceName) {
     propertiesTitle.textContent = `Propiedades de: ${sourceName}`;
     propertiesFormContainer.innerHTML = ''; // Clear old form
 
     try {
-        const properties = await window.core.getSourceProperties(sourceName);
+        const schema = await window.core.getSourceProperties(sourceName);
+        const current = await window.core.getSourcePropertyValues(sourceName);
+        const values = current ? current.values : {};
+        const properties = schema ? schema.properties : null;
         if (!properties) {
             propertiesFormContainer.innerHTML = '<p>Esta fuente no tiene propiedades configurables.</p>';
             propertiesModal.classList.remove('hidden');
@@ -339,14 +340,17 @@ async function openPropertiesModal(sourceName) {
             label.className = 'block mb-1 text-sm font-medium';
             propContainer.appendChild(label);
 
-            if (prop.type === OBS_PROPERTY_LIST) {
+            if (prop.typeName === 'list') {
                 const select = document.createElement('select');
                 select.name = prop.name;
+                select.dataset.format = prop.format;
                 select.className = 'bg-gray-700 border border-gray-600 rounded w-full p-2';
                 prop.options.forEach(option => {
                     const opt = document.createElement('option');
                     opt.value = option.value;
                     opt.textContent = option.name;
+                    opt.disabled = option.disabled;
+                    opt.selected = values[prop.name] === option.value;
                     select.appendChild(opt);
                 });
                 propContainer.appendChild(select);
@@ -377,9 +381,16 @@ propertiesSaveButton.addEventListener('click', async () => {
     const newSettings = {};
     const formElements = propertiesFormContainer.querySelectorAll('select, input');
     formElements.forEach(el => {
-        // For now, we only handle select (string) values
+        // For now, we only handle select values, typed by the list's format
         if (el.tagName === 'SELECT') {
-            newSettings[el.name] = el.value;
+            const format = el.dataset.format;
+            if (format === 'int' || format === 'float') {
+                newSettings[el.name] = Number(el.value);
+            } else if (format === 'bool') {
+                newSettings[el.name] = el.value === 'true';
+            } else {
+                newSettings[el.name] = el.value;
+            }
         }
         // TODO: Handle other input types
     });
@@ -395,7 +406,7 @@ propertiesSaveButton.addEventListener('click', async () => {
 });
 
 
-// --- Render Loop & Main Execution ---
+// --- Audio Meters & Main Execution ---
 
 function dbToPercent(db) {
     const minDb = -60.0;
@@ -404,42 +415,90 @@ function dbToPercent(db) {
     return 100 * (1 - (db / minDb));
 }
 
-function renderLoop() {
-    animationFrameId = requestAnimationFrame(renderLoop);
+// Ask the native side for frames no larger than what each view's canvas
+// displays, so readback and ImageData cost follow the panel size, not the
+// output size.
+function frameRequestOptions(view) {
+    const canvas = view === 'preview' ? previewCanvas : programCanvas;
+    const dpr = window.devicePixelRatio || 1;
+    return {
+        view,
+        maxWidth: Math.ceil(canvas.clientWidth * dpr),
+        maxHeight: Math.ceil(canvas.clientHeight * dpr),
+        format: 'rgba'
+    };
+}
 
-    window.core.getLatestFrame().then(frames => {
-        if (!frames) return;
+function drawFrame(canvas, ctx, frame, width, height) {
+    if (canvas.width !== width || canvas.height !== height) {
+        canvas.width = width;
+        canvas.height = height;
+    }
+    const imageData = new ImageData(new Uint8ClampedArray(frame.buffer, frame.byteOffset, frame.byteLength), width, height);
+    ctx.putImageData(imageData, 0, 0);
+}
 
-        if (frames.programFrame) {
-             if (programCanvas.width !== frames.width || programCanvas.height !== frames.height) {
-                programCanvas.width = frames.width;
-                programCanvas.height = frames.height;
-            }
-            const imageData = new ImageData(new Uint8ClampedArray(frames.programFrame), frames.width, frames.height);
-            programCtx.putImageData(imageData, 0, 0);
+function subscribeFrames() {
+    const onProgramFrame = (event) => {
+        if (event.frame) {
+            drawFrame(programCanvas, programCtx, event.frame, event.width, event.height);
         }
-
-        if (frames.previewFrame) {
-            if (previewCanvas.width !== frames.width || previewCanvas.height !== frames.height) {
-                previewCanvas.width = frames.width;
-                previewCanvas.height = frames.height;
-            }
-            const imageData = new ImageData(new Uint8ClampedArray(frames.previewFrame), frames.width, frames.height);
-            previewCtx.putImageData(imageData, 0, 0);
+    };
+    const onPreviewFrame = (event) => {
+        if (event.frame) {
+            drawFrame(previewCanvas, previewCtx, event.frame, event.width, event.height);
         } else {
             previewCtx.clearRect(0, 0, previewCanvas.width, previewCanvas.height);
         }
+    };
+
+    // Frames are pushed only when a view's content changes.
+    frameSubscriptions.push(window.core.onFrame(onProgramFrame, { maxFps: 60, ...frameRequestOptions('program') }));
+    frameSubscriptions.push(window.core.onFrame(onPreviewFrame, frameRequestOptions('preview')));
+
+    // The preview only needs to be good enough to line up the next scene.
+    window.core.setViewFps('program', 60);
+    window.core.setViewFps('preview', 15);
+
+    // Don't spend GPU time on views nobody can see.
+    const setViewsActive = () => {
+        const visible = document.visibilityState === 'visible';
+        window.core.setViewActive('program', visible);
+        window.core.setViewActive('preview', visible);
+    };
+    document.addEventListener('visibilitychange', setViewsActive);
+    setViewsActive();
+
+    const resizeObserver = new ResizeObserver((entries) => {
+        for (const entry of entries) {
+            window.core.setFrameOptions(frameRequestOptions(entry.target === previewCanvas ? 'preview' : 'program'));
+        }
     });
+    resizeObserver.observe(programCanvas);
+    resizeObserver.observe(previewCanvas);
+}
 
-    window.core.getAudioLevels().then(levels => {
-        for (const sourceName in levels) {
-            const volMeter = document.getElementById(`volmeter-${sourceName}`);
-            if (volMeter) {
-                const percent = dbToPercent(levels[sourceName]);
-                volMeter.style.width = `${percent}%`;
+// Meters arrive as one packed Float32Array, [sourceIndex][channel][magnitude, peak, inputPeak];
+// the index -> name table only comes along when sources were added or removed.
+function subscribeAudioMeters() {
+    let layout = { sources: 0, channels: 0, names: [] };
+    const onMeters = (meters, newLayout) => {
+        if (newLayout) layout = newLayout;
+        const stride = layout.channels * 3;
+        for (let index = 0; index < layout.sources; index++) {
+            const name = layout.names[index];
+            if (name === null) continue;
+            const volMeter = document.getElementById(`volmeter-${name}`);
+            if (!volMeter) continue;
+
+            let peak = -Infinity;
+            for (let ch = 0; ch < layout.channels; ch++) {
+                peak = Math.max(peak, meters[index * stride + ch * 3 + 1]);
             }
+            volMeter.style.width = `${dbToPercent(peak)}%`;
         }
-    });
+    };
+    audioMeterSubscription = window.core.onAudioMeters(onMeters, { rate: 30 });
 }
 
 async function main() {
@@ -461,7 +520,8 @@ async function main() {
             await setAsPreviewScene(scenes[0]);
         }
 
-        renderLoop();
+        subscribeFrames();
+        subscribeAudioMeters();
         setInterval(updateSceneList, 1000); // Periodically update scene highlights
     } catch (error) {
         console.error("Failed to initialize application:", error);
@@ -475,7 +535,6 @@ async function addOverlayToScene(overlay) {
     }
     try {
         const sourceName = `${overlay.name} Overlay`;
-        await window.core.addSource(previewScene, 'browser_source', sourceName);
 
         const url = new URL(overlay.url);
         url.searchParams.append('name', brandingSettings.name);
@@ -487,7 +546,14 @@ async function addOverlayToScene(overlay) {
             width: 1920,
             height: 1080
         };
-        await window.core.updateSourceProperties(sourceName, settings);
+        // Create and configure the source in one native pass, so the overlay
+        // never shows up unconfigured.
+        const { applied, results } = await window.core.applyBatch([
+            { op: 'addSource', scene: previewScene, id: 'browser_source', name: sourceName, settings }
+        ]);
+        if (!applied || !results[0].ok) {
+            throw new Error(results[0].error || 'Failed to add overlay');
+        }
 
         console.log(`Added and configured overlay '${sourceName}' to scene '${previewScene}'`);
         await updateSourceList(previewScene);
@@ -500,7 +566,8 @@ async function addOverlayToScene(overlay) {
 main();
 
 window.addEventListener('beforeunload', () => {
-    if (animationFrameId) cancelAnimationFrame(animationFrameId);
+    if (audioMeterSubscription) window.core.offAudioMeters(audioMeterSubscription);
+    frameSubscriptions.forEach(id => window.core.offFrame(id));
     // Shutdown is now handled in the main process
 });
 
@@ -771,7 +838,12 @@ startStreamButton.addEventListener('click', async () => {
             alert("Please set the RTMP server and stream key in Settings first.");
             return;
         }
-        await window.core.startStreaming(streamSettings.server, streamSettings.key);
+        // Encoder and output setup happen on a native worker thread.
+        try {
+            await window.core.startStreamingAsync(streamSettings.server, streamSettings.key);
+        } catch (error) {
+            alert(`Error al iniciar la transmisión: ${error.message}`);
+        }
     }
 });
 
@@ -780,7 +852,11 @@ startRecordButton.addEventListener('click', async () => {
     if (recording) {
         await window.core.stopRecording();
     } else {
-        await window.core.startRecording();
+        try {
+            await window.core.startRecordingAsync();
+        } catch (error) {
+            alert(`Error al iniciar la grabación: ${error.message}`);
+        }
     }
 });
 